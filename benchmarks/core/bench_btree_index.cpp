@@ -0,0 +1,146 @@
+/*
+ * Source: benchmarks/core/bench_btree_index.cpp
+ * Purpose: validatePath latency and memory of BTreeIndex at 1M realistic paths
+ *
+ * Paths follow the shape real mounts have: <env>/<team>/<service>/<component>/<key>,
+ * so neighbouring keys share long prefixes (prod/payments/checkout-api/...).
+ * std::set<std::string> is measured alongside as a node-per-key reference.
+ *
+ * Usage: bench_btree_index [path_count] [degree]
+ */
+
+#include "kallisto/btree_index.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <malloc.h>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<std::string> generateRealisticPaths(size_t count, std::mt19937& rng) {
+  const std::vector<std::string> envs = {"prod", "staging", "dev"};
+  const std::vector<std::string> teams = {"payments", "identity", "search", "ledger",
+                                          "notifications", "platform", "risk", "growth"};
+  const std::vector<std::string> components = {"db", "cache", "queue", "api", "tls", "oauth"};
+  const std::vector<std::string> keys = {"password", "username", "token", "private-key",
+                                         "certificate", "dsn"};
+
+  std::vector<std::string> paths;
+  paths.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    paths.push_back(envs[rng() % envs.size()] + "/" + teams[rng() % teams.size()] + "/service-" +
+                    std::to_string(rng() % 5000) + "/" + components[rng() % components.size()] +
+                    "/" + keys[rng() % keys.size()] + "-" + std::to_string(i));
+  }
+  return paths;
+}
+
+size_t heapBytesInUse() { return mallinfo2().uordblks; }
+
+struct LatencyReport {
+  double avg_ns;
+  double p50_ns;
+  double p99_ns;
+};
+
+template <typename Fn>
+LatencyReport measureLookups(const std::vector<std::string>& probes, Fn&& lookup) {
+  std::vector<double> samples;
+  samples.reserve(probes.size());
+  for (const auto& probe : probes) {
+    auto t1 = std::chrono::steady_clock::now();
+    bool found = lookup(probe);
+    auto t2 = std::chrono::steady_clock::now();
+    asm volatile("" : : "r"(found) : "memory");
+    samples.push_back(std::chrono::duration<double, std::nano>(t2 - t1).count());
+  }
+
+  double sum = 0;
+  for (double s : samples) {
+    sum += s;
+  }
+  std::sort(samples.begin(), samples.end());
+  return {sum / samples.size(), samples[samples.size() / 2],
+          samples[static_cast<size_t>(samples.size() * 0.99)]};
+}
+
+void printLatency(const std::string& label, const LatencyReport& r) {
+  std::cout << std::fixed << std::setprecision(1) << "  " << std::left << std::setw(26) << label
+            << " avg " << std::setw(8) << r.avg_ns << " ns | p50 " << std::setw(8) << r.p50_ns
+            << " ns | p99 " << r.p99_ns << " ns\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const size_t path_count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+  const int degree = argc > 2 ? std::stoi(argv[2]) : 16;
+
+  std::cout << "=== Kallisto Benchmark: BTreeIndex validatePath ===\n";
+  std::cout << "[CONFIG] Paths: " << path_count << " | Degree: " << degree << "\n";
+
+  std::mt19937 rng(1337);
+  auto paths = generateRealisticPaths(path_count, rng);
+  size_t raw_key_bytes = 0;
+  for (const auto& p : paths) {
+    raw_key_bytes += p.size();
+  }
+
+  std::vector<std::string> hit_probes = paths;
+  std::shuffle(hit_probes.begin(), hit_probes.end(), rng);
+  std::vector<std::string> miss_probes;
+  miss_probes.reserve(path_count);
+  for (const auto& p : hit_probes) {
+    miss_probes.push_back(p + "-missing");
+  }
+
+  // 1. Build
+  size_t heap_before = heapBytesInUse();
+  auto build_start = std::chrono::steady_clock::now();
+  auto btree = std::make_unique<kallisto::BTreeIndex>(degree);
+  for (const auto& p : paths) {
+    btree->insertPath(p);
+  }
+  auto build_end = std::chrono::steady_clock::now();
+  size_t btree_bytes = heapBytesInUse() - heap_before;
+
+  heap_before = heapBytesInUse();
+  auto reference = std::make_unique<std::set<std::string>>(paths.begin(), paths.end());
+  size_t set_bytes = heapBytesInUse() - heap_before;
+
+  // 2. Lookups
+  auto btree_hits = measureLookups(hit_probes, [&](const std::string& k) { return btree->validatePath(k); });
+  auto btree_misses = measureLookups(miss_probes, [&](const std::string& k) { return btree->validatePath(k); });
+  auto set_hits = measureLookups(hit_probes, [&](const std::string& k) { return reference->count(k) > 0; });
+
+  for (const auto& p : hit_probes) {
+    if (!btree->validatePath(p)) {
+      std::cerr << "Error: Path not found! Logic bug?\n";
+      return 1;
+    }
+  }
+
+  // 3. Report
+  std::chrono::duration<double> build_sec = build_end - build_start;
+  std::cout << "\n=== RESULTS ===\n";
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "Build Time:       " << build_sec.count() << " s ("
+            << static_cast<uint64_t>(path_count / build_sec.count()) << " inserts/s)\n";
+  std::cout << "Raw Key Bytes:    " << raw_key_bytes / (1024.0 * 1024.0) << " MiB\n";
+  std::cout << "BTreeIndex Heap:  " << btree_bytes / (1024.0 * 1024.0) << " MiB ("
+            << static_cast<double>(btree_bytes) / path_count << " B/path)\n";
+  std::cout << "std::set Heap:    " << set_bytes / (1024.0 * 1024.0) << " MiB ("
+            << static_cast<double>(set_bytes) / path_count << " B/path)\n";
+  std::cout << "\nvalidatePath latency:\n";
+  printLatency("BTreeIndex (hit)", btree_hits);
+  printLatency("BTreeIndex (miss)", btree_misses);
+  printLatency("std::set (hit, reference)", set_hits);
+
+  return 0;
+}
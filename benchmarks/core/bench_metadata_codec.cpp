@@ -0,0 +1,119 @@
+/*
+ * Source: benchmarks/core/bench_metadata_codec.cpp
+ * Purpose: Size and decode speed of metadata records, format 1 vs format 2
+ *
+ * Builds a realistic set of KeyMetadata: most secrets hold a single version,
+ * rotated ones up to the default limit of 10, with timestamps spread over a
+ * year, rotations hours to weeks apart and some older versions soft-deleted
+ * or destroyed. Each is encoded in both formats:
+ *   1. FORMAT 1: header + VersionState array copied as raw memory
+ *   2. FORMAT 2: varints, delta-encoded ids and timestamps, flag bitset
+ *
+ * Reported: total and mean record size, and encode/decode time per record
+ * (decode is what every cache miss, recovery scan and compaction pays).
+ *
+ * Usage: bench_metadata_codec [records] [rounds]
+ */
+
+#include "kallisto/engine/metadata_codec.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using kallisto::engine::KeyMetadata;
+using kallisto::engine::VersionState;
+
+std::vector<KeyMetadata> realisticMetadata(size_t count) {
+  std::mt19937_64 rng(42);
+  constexpr uint64_t year_start_ms = 1767225600000; // 2026-01-01
+  constexpr uint64_t hour_ms = 3600 * 1000;
+  std::vector<KeyMetadata> out;
+  out.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    KeyMetadata meta;
+    // 60% never rotated, 25% a few times, 15% at the history limit
+    const uint64_t bucket = rng() % 100;
+    const uint32_t rotations = bucket < 60 ? 1 : bucket < 85 ? 2 + rng() % 8 : 10 + rng() % 40;
+    const uint32_t kept = std::min<uint32_t>(rotations, 10);
+    meta.current_version = rotations;
+    meta.max_versions = bucket % 10 == 0 ? 5 : 0;
+    meta.cas_required = bucket % 4 == 0;
+    meta.delete_version_after_ms = bucket % 3 == 0 ? 90 * 24 * hour_ms : 0;
+
+    uint64_t created = year_start_ms + rng() % (365 * 24 * hour_ms);
+    for (uint32_t id = rotations - kept + 1; id <= rotations; ++id) {
+      VersionState vs{created, 0, id, false};
+      if (id < rotations && rng() % 5 == 0) {
+        vs.deletion_time_ms = created + rng() % (24 * hour_ms);
+        vs.destroyed = rng() % 2 == 0;
+      }
+      meta.versions.push_back(vs);
+      created += hour_ms + rng() % (21 * 24 * hour_ms) + rng() % 1000;
+    }
+    out.push_back(std::move(meta));
+  }
+  return out;
+}
+
+template <typename Encode, typename Decode>
+void measure(const char* name, const std::vector<KeyMetadata>& dataset, size_t rounds, Encode encode,
+             Decode decode) {
+  using Clock = std::chrono::steady_clock;
+  std::vector<std::string> records;
+  records.reserve(dataset.size());
+  size_t bytes = 0;
+
+  auto start = Clock::now();
+  for (const auto& meta : dataset) {
+    records.push_back(encode(meta));
+    bytes += records.back().size();
+  }
+  const double encode_ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+  size_t versions = 0;
+  start = Clock::now();
+  for (size_t round = 0; round < rounds; ++round) {
+    for (const auto& record : records) {
+      auto meta = decode(record);
+      versions += meta ? meta->versions.size() : 0;
+    }
+  }
+  const double decode_ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+  const double n = static_cast<double>(dataset.size());
+  std::cout << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(1)
+            << std::setw(12) << bytes / 1048576.0 << std::setw(14) << bytes / n << std::setw(14)
+            << encode_ns / n << std::setw(14) << decode_ns / (n * rounds) << "   (" << versions / rounds
+            << " versions)\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+  const size_t rounds = argc > 2 ? std::stoul(argv[2]) : 5;
+
+  const auto dataset = realisticMetadata(count);
+  size_t versions = 0;
+  for (const auto& meta : dataset) {
+    versions += meta.versions.size();
+  }
+  std::cout << "=== Kallisto Benchmark: Metadata Record Format ===\n"
+            << "[CONFIG] Records: " << count << " | Versions: " << versions << " (" << std::fixed
+            << std::setprecision(2) << static_cast<double>(versions) / count << " per record)"
+            << " | Decode rounds: " << rounds << "\n\n";
+
+  std::cout << std::left << std::setw(10) << "" << std::right << std::setw(12) << "total (MB)" << std::setw(14)
+            << "B / record" << std::setw(14) << "encode (ns)" << std::setw(14) << "decode (ns)" << "\n";
+  measure("FORMAT 1", dataset, rounds, kallisto::engine::serializeLegacyMetadata,
+          kallisto::engine::deserializeLegacyMetadata);
+  measure("FORMAT 2", dataset, rounds, kallisto::engine::serializeMetadata, kallisto::engine::deserializeMetadata);
+  return 0;
+}
@@ -0,0 +1,185 @@
+/*
+ * Source: benchmarks/core/bench_path_index.cpp
+ * Purpose: Head-to-head BTreeIndex vs ArtPathIndex (insert, validate, memory, RCU update)
+ *
+ * Both backends index the same realistic <env>/<team>/<service>/<component>/<key>
+ * paths. "RCU update" is what TlsBTreeManager pays per new path on a full index:
+ * clone() the master, then insert one path into the copy.
+ *
+ * Usage: bench_path_index [path_count] [btree_degree]
+ */
+
+#include "kallisto/art_path_index.hpp"
+#include "kallisto/btree_index.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <malloc.h>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<std::string> generateRealisticPaths(size_t count, std::mt19937& rng) {
+  const std::vector<std::string> envs = {"prod", "staging", "dev"};
+  const std::vector<std::string> teams = {"payments", "identity", "search", "ledger",
+                                          "notifications", "platform", "risk", "growth"};
+  const std::vector<std::string> components = {"db", "cache", "queue", "api", "tls", "oauth"};
+  const std::vector<std::string> keys = {"password", "username", "token", "private-key",
+                                         "certificate", "dsn"};
+
+  std::vector<std::string> paths;
+  paths.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    paths.push_back(envs[rng() % envs.size()] + "/" + teams[rng() % teams.size()] + "/service-" +
+                    std::to_string(rng() % 5000) + "/" + components[rng() % components.size()] +
+                    "/" + keys[rng() % keys.size()] + "-" + std::to_string(i));
+  }
+  return paths;
+}
+
+size_t heapBytesInUse() { return mallinfo2().uordblks; }
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct LatencyReport {
+  double avg_ns;
+  double p50_ns;
+  double p99_ns;
+};
+
+LatencyReport measureLookups(const std::vector<std::string>& probes, const kallisto::IPathIndex& index) {
+  std::vector<double> samples;
+  samples.reserve(probes.size());
+  for (const auto& probe : probes) {
+    auto t1 = std::chrono::steady_clock::now();
+    bool found = index.validatePath(probe);
+    auto t2 = std::chrono::steady_clock::now();
+    asm volatile("" : : "r"(found) : "memory");
+    samples.push_back(std::chrono::duration<double, std::nano>(t2 - t1).count());
+  }
+
+  double sum = 0;
+  for (double s : samples) {
+    sum += s;
+  }
+  std::sort(samples.begin(), samples.end());
+  return {sum / samples.size(), samples[samples.size() / 2],
+          samples[static_cast<size_t>(samples.size() * 0.99)]};
+}
+
+struct BackendReport {
+  std::string name;
+  double build_sec = 0;
+  size_t heap_bytes = 0;
+  LatencyReport hits{};
+  LatencyReport misses{};
+  double rcu_update_us = 0;
+  size_t prefix_matches = 0;
+  double prefix_scan_us = 0;
+};
+
+BackendReport runBackend(const std::string& name,
+                         const std::function<std::unique_ptr<kallisto::IPathIndex>()>& factory,
+                         const std::vector<std::string>& paths, const std::vector<std::string>& hit_probes,
+                         const std::vector<std::string>& miss_probes, size_t rcu_rounds) {
+  BackendReport report;
+  report.name = name;
+
+  // 1. Build (in place, no snapshots)
+  size_t heap_before = heapBytesInUse();
+  auto start = std::chrono::steady_clock::now();
+  auto index = factory();
+  for (const auto& p : paths) {
+    index->insertPath(p);
+  }
+  report.build_sec = secondsSince(start);
+  report.heap_bytes = heapBytesInUse() - heap_before;
+
+  // 2. Lookups
+  report.hits = measureLookups(hit_probes, *index);
+  report.misses = measureLookups(miss_probes, *index);
+  for (const auto& p : hit_probes) {
+    if (!index->validatePath(p)) {
+      std::cerr << "Error: " << name << " lost path " << p << "\n";
+      std::exit(1);
+    }
+  }
+
+  // 3. RCU update: clone the full master, insert one path, retire the old master
+  std::shared_ptr<const kallisto::IPathIndex> master = std::move(index);
+  start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < rcu_rounds; ++i) {
+    std::shared_ptr<kallisto::IPathIndex> updated = master->clone();
+    updated->insertPath("prod/payments/service-rcu/db/password-" + std::to_string(i));
+    master = std::move(updated);
+  }
+  report.rcu_update_us = secondsSince(start) * 1e6 / rcu_rounds;
+
+  // 4. Prefix listing of one service subtree
+  start = std::chrono::steady_clock::now();
+  master->iteratePrefix("prod/payments/service-42/", [&](const std::string&) { report.prefix_matches++; });
+  report.prefix_scan_us = secondsSince(start) * 1e6;
+
+  return report;
+}
+
+void printLatency(const std::string& label, const LatencyReport& r) {
+  std::cout << std::fixed << std::setprecision(1) << "  " << std::left << std::setw(26) << label
+            << " avg " << std::setw(8) << r.avg_ns << " ns | p50 " << std::setw(8) << r.p50_ns
+            << " ns | p99 " << r.p99_ns << " ns\n";
+}
+
+void printReport(const BackendReport& r, size_t path_count) {
+  std::cout << "\n[" << r.name << "]\n" << std::fixed << std::setprecision(2);
+  std::cout << "  Build Time:       " << r.build_sec << " s ("
+            << static_cast<uint64_t>(path_count / r.build_sec) << " inserts/s)\n";
+  std::cout << "  Heap:             " << r.heap_bytes / (1024.0 * 1024.0) << " MiB ("
+            << static_cast<double>(r.heap_bytes) / path_count << " B/path)\n";
+  printLatency("validatePath (hit)", r.hits);
+  printLatency("validatePath (miss)", r.misses);
+  std::cout << "  RCU update:       " << r.rcu_update_us << " us (clone + insert)\n";
+  std::cout << "  Prefix scan:      " << r.prefix_matches << " paths in " << r.prefix_scan_us << " us\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const size_t path_count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+  const int degree = argc > 2 ? std::stoi(argv[2]) : 16;
+
+  std::cout << "=== Kallisto Benchmark: BTreeIndex vs ArtPathIndex ===\n";
+  std::cout << "[CONFIG] Paths: " << path_count << " | BTree degree: " << degree << "\n";
+
+  std::mt19937 rng(1337);
+  auto paths = generateRealisticPaths(path_count, rng);
+
+  std::vector<std::string> hit_probes = paths;
+  std::shuffle(hit_probes.begin(), hit_probes.end(), rng);
+  std::vector<std::string> miss_probes;
+  miss_probes.reserve(path_count);
+  for (const auto& p : hit_probes) {
+    miss_probes.push_back(p + "-missing");
+  }
+
+  // Deep copies of a full B-Tree are slow; fewer rounds keep the run short
+  auto btree = runBackend(
+      "BTreeIndex", [degree]() { return std::make_unique<kallisto::BTreeIndex>(degree); }, paths,
+      hit_probes, miss_probes, 20);
+  auto art = runBackend(
+      "ArtPathIndex", []() { return std::make_unique<kallisto::ArtPathIndex>(); }, paths, hit_probes,
+      miss_probes, 10000);
+
+  std::cout << "\n=== RESULTS ===";
+  printReport(btree, path_count);
+  printReport(art, path_count);
+
+  return 0;
+}
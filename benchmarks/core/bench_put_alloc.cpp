@@ -0,0 +1,133 @@
+/*
+ * Source: benchmarks/core/bench_put_alloc.cpp
+ * Purpose: Heap allocations performed by one KvEngine put_version
+ *
+ * Global operator new is replaced by a counting wrapper. Each put is
+ * charged with:
+ *   1. CALLER: allocations made on the writing thread (serialization,
+ *              cache insertion, head publication, queue enqueue)
+ *   2. TOTAL:  allocations made by every thread of the process, i.e. the
+ *              caller plus the write-behind flusher's share of the batch
+ *
+ * Every path is written once before counting starts, so the measured puts
+ * are version bumps of existing paths (no path index insertion).
+ *
+ * Usage: bench_put_alloc [puts] [value_bytes] [batch|immediate]
+ */
+
+#include "kallisto/engine/kv_engine.hpp"
+#include "kallisto/logger.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::atomic<uint64_t> g_allocs{0};
+std::atomic<uint64_t> g_bytes{0};
+thread_local uint64_t t_allocs = 0;
+thread_local uint64_t t_bytes = 0;
+
+void* countedAlloc(size_t size, size_t alignment = 0) {
+  g_allocs.fetch_add(1, std::memory_order_relaxed);
+  g_bytes.fetch_add(size, std::memory_order_relaxed);
+  ++t_allocs;
+  t_bytes += size;
+  void* p = alignment > alignof(std::max_align_t)
+                ? std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)
+                : std::malloc(size ? size : 1);
+  return p;
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+  if (void* p = countedAlloc(size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, std::align_val_t al) {
+  if (void* p = countedAlloc(size, static_cast<size_t>(al))) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+void* operator new[](size_t size, std::align_val_t al) { return operator new(size, al); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+int main(int argc, char** argv) {
+  using SyncMode = kallisto::engine::ISecretEngine::SyncMode;
+
+  const size_t puts = argc > 1 ? std::stoul(argv[1]) : 100000;
+  const size_t value_bytes = argc > 2 ? std::stoul(argv[2]) : 256;
+  const bool immediate = argc > 3 && std::string(argv[3]) == "immediate";
+  constexpr size_t num_paths = 1000;
+
+  kallisto::Logger::getInstance().setLevel(kallisto::LogLevel::WARN);
+  const std::string db_path = "/tmp/kallisto_bench_put_alloc";
+  std::filesystem::remove_all(db_path);
+
+  std::cout << "=== Kallisto Benchmark: Allocations per put_version ===\n"
+            << "[CONFIG] Puts: " << puts << " | Value: " << value_bytes << " B | Paths: " << num_paths
+            << " | Sync mode: " << (immediate ? "IMMEDIATE" : "BATCH") << "\n\n";
+
+  {
+    auto engine = std::make_unique<kallisto::engine::KvEngine>(db_path);
+    engine->changeSyncMode(immediate ? SyncMode::IMMEDIATE : SyncMode::BATCH);
+
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < num_paths; ++i) {
+      paths.push_back("team-" + std::to_string(i % 10) + "/svc-" + std::to_string(i));
+    }
+    const kallisto::engine::SecretPayload payload{std::string(value_bytes, 'x'), 3600};
+    for (const auto& path : paths) {
+      engine->put_version(path, payload);
+    }
+    engine->forceFlush();
+
+    const uint64_t caller_allocs = t_allocs;
+    const uint64_t caller_bytes = t_bytes;
+    const uint64_t total_allocs = g_allocs.load();
+    const uint64_t total_bytes = g_bytes.load();
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < puts; ++i) {
+      engine->put_version(paths[i % num_paths], payload);
+    }
+    const auto end = std::chrono::steady_clock::now();
+    engine->forceFlush();
+
+    const double n = static_cast<double>(puts);
+    const double ns = std::chrono::duration<double, std::nano>(end - start).count() / n;
+    std::cout << std::fixed << std::setprecision(1)
+              << std::left << std::setw(10) << "" << std::right << std::setw(14) << "allocs/put"
+              << std::setw(14) << "bytes/put" << "\n"
+              << std::left << std::setw(10) << "CALLER" << std::right
+              << std::setw(14) << (t_allocs - caller_allocs) / n
+              << std::setw(14) << (t_bytes - caller_bytes) / n << "\n"
+              << std::left << std::setw(10) << "TOTAL" << std::right
+              << std::setw(14) << (g_allocs.load() - total_allocs) / n
+              << std::setw(14) << (g_bytes.load() - total_bytes) / n << "\n\n"
+              << "Latency: " << ns << " ns/put\n";
+  }
+  std::filesystem::remove_all(db_path);
+  return 0;
+}
@@ -0,0 +1,145 @@
+/*
+ * Source: benchmarks/core/bench_thundering_herd.cpp
+ * Purpose: RocksDB reads caused by many readers missing on the same key
+ *
+ * Every round, T threads read the same cold path at once (a fresh path per
+ * round, so both its metadata and its payload miss). Reported per round:
+ *   1. GETS:    RocksDB point lookups issued
+ *   2. SHARED:  readers served by another reader's load
+ *   3. LATENCY: wall time until all T readers have the value
+ *
+ * Rows: blocking read_version and read_version_async (the HTTP GET path),
+ * each with miss coalescing off and on (ReadIoOptions::coalesce).
+ *
+ * Usage: bench_thundering_herd [readers] [rounds] [value_bytes]
+ */
+
+#include "kallisto/engine/kv_engine.hpp"
+#include "kallisto/logger.hpp"
+
+#include <barrier>
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using kallisto::engine::KvEngine;
+using kallisto::engine::ReadIoOptions;
+using kallisto::engine::ReadResult;
+
+struct HerdResult {
+  double gets_per_round;
+  double shared_per_round;
+  double us_per_round;
+  size_t failed;
+};
+
+std::string pathFor(size_t round) {
+  return "herd/key-" + std::to_string(round);
+}
+
+HerdResult runHerd(const std::string& db_path, size_t readers, size_t rounds, bool async, bool coalesce) {
+  ReadIoOptions read_io;
+  read_io.coalesce = coalesce;
+  auto engine = std::make_unique<KvEngine>(db_path, kallisto::PathIndexType::BTREE, kallisto::engine::RecoveryOptions{},
+                                           kallisto::engine::MountConfig{}, kallisto::engine::WriteBehindOptions{}, read_io);
+  const uint64_t gets_before = engine->storageReads();
+  const uint64_t shared_before = engine->missLoadStats().shared;
+
+  std::atomic<size_t> failed{0};
+  std::atomic<size_t> round{0};
+  std::chrono::steady_clock::time_point round_start;
+  double total_us = 0;
+  // Phase completion: all readers of the round are done
+  std::barrier sync_point(static_cast<std::ptrdiff_t>(readers), [&]() noexcept {
+    const auto now = std::chrono::steady_clock::now();
+    total_us += std::chrono::duration<double, std::micro>(now - round_start).count();
+    round_start = now;
+    round.fetch_add(1);
+  });
+
+  auto read = [&](const std::string& path) {
+    if (!async) {
+      if (!engine->read_version(path)) {
+        failed.fetch_add(1);
+      }
+      return;
+    }
+    std::promise<ReadResult> parked;
+    auto cached = engine->read_version_async(path, 0, [&](ReadResult result) { parked.set_value(std::move(result)); });
+    ReadResult result = cached ? std::move(*cached) : parked.get_future().get();
+    if (!result) {
+      failed.fetch_add(1);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  round_start = std::chrono::steady_clock::now();
+  for (size_t t = 0; t < readers; ++t) {
+    threads.emplace_back([&]() {
+      for (size_t r = 0; r < rounds; ++r) {
+        read(pathFor(r));
+        sync_point.arrive_and_wait();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  const double n = static_cast<double>(rounds);
+  return HerdResult{(engine->storageReads() - gets_before) / n,
+                    (engine->missLoadStats().shared - shared_before) / n, total_us / n, failed.load()};
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const size_t readers = argc > 1 ? std::stoul(argv[1]) : 32;
+  const size_t rounds = argc > 2 ? std::stoul(argv[2]) : 2000;
+  const size_t value_bytes = argc > 3 ? std::stoul(argv[3]) : 256;
+
+  kallisto::Logger::getInstance().setLevel(kallisto::LogLevel::WARN);
+  const std::string db_path = "/tmp/kallisto_bench_thundering_herd";
+  std::filesystem::remove_all(db_path);
+
+  std::cout << "=== Kallisto Benchmark: Thundering Herd on Cold Keys ===\n"
+            << "[CONFIG] Readers: " << readers << " | Rounds: " << rounds << " | Value: " << value_bytes << " B\n\n";
+
+  {
+    auto engine = std::make_unique<KvEngine>(db_path);
+    const kallisto::engine::SecretPayload payload{std::string(value_bytes, 'x'), 3600};
+    for (size_t r = 0; r < rounds; ++r) {
+      engine->put_version(pathFor(r), payload);
+    }
+    engine->forceFlush();
+  }
+
+  std::cout << std::left << std::setw(8) << "MODE" << std::setw(10) << "COALESCE" << std::right << std::setw(14)
+            << "gets/round" << std::setw(14) << "shared/round" << std::setw(14) << "us/round" << "\n";
+  for (bool async : {false, true}) {
+    for (bool coalesce : {false, true}) {
+      // Each run reopens the engine: every round starts cold
+      const auto result = runHerd(db_path, readers, rounds, async, coalesce);
+      std::cout << std::fixed << std::setprecision(1) << std::left << std::setw(8) << (async ? "ASYNC" : "SYNC")
+                << std::setw(10) << (coalesce ? "on" : "off") << std::right << std::setw(14) << result.gets_per_round
+                << std::setw(14) << result.shared_per_round << std::setw(14) << result.us_per_round;
+      if (result.failed > 0) {
+        std::cout << "  (" << result.failed << " failed reads)";
+      }
+      std::cout << "\n";
+    }
+  }
+  std::cout << "\nWithout coalescing each reader that misses issues its own metadata and payload Gets;\n"
+            << "with it, one load per key serves the whole herd (2 Gets per round at best).\n";
+
+  std::filesystem::remove_all(db_path);
+  return 0;
+}
@@ -0,0 +1,113 @@
+#!/usr/bin/env bash
+#
+# Kallisto PUT Scaling Benchmark
+# Restarts the server once per write-behind worker count and runs the
+# PUT-heavy wrk workload against each, to show write throughput scaling
+# with --write-workers.
+#
+# Usage: ./benchmarks/server/run_put_scaling.sh [threads] [connections] [duration] [worker counts]
+# Default: half the cores, 200 connections, 10s, "1 2 4 8"
+#
+set -euo pipefail
+
+# ── Config ──────────────────────────────────────────────────────────────
+TOTAL_CORES=$(nproc)
+HALF_CORES=$(( TOTAL_CORES / 2 ))
+if [ "$HALF_CORES" -lt 1 ]; then
+    HALF_CORES=1
+fi
+
+THREADS=${1:-$HALF_CORES}
+CONNECTIONS=${2:-200}
+DURATION=${3:-10s}
+WRITE_WORKER_COUNTS=${4:-"1 2 4 8"}
+HTTP_PORT=8200
+export KALLISTO_SOCKET=${KALLISTO_SOCKET:-/tmp/kallisto.sock}
+# Many distinct paths so every write-behind worker gets its share
+export KALLISTO_PUT_KEYS=${KALLISTO_PUT_KEYS:-100000}
+BENCH_DB_PATH="/tmp/kallisto_bench_put_scaling"
+BENCH_LOG="/tmp/kallisto_bench_put_scaling.log"
+SERVER_BIN="./build/kallisto_server"
+CLI_BIN="./build/kallisto"
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+WORKLOAD_DIR="$SCRIPT_DIR/workloads"
+SERVER_PID=""
+
+# ── Colors ──────────────────────────────────────────────────────────────
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+CYAN='\033[0;36m'
+BOLD='\033[1m'
+NC='\033[0m'
+
+check_prereqs() {
+    if ! command -v wrk &>/dev/null; then
+        echo -e "${RED}[ERROR] wrk not found. Install with: sudo apt-get install wrk${NC}"
+        exit 1
+    fi
+    if [ ! -f "$SERVER_BIN" ]; then
+        echo -e "${RED}[ERROR] Server binary not found. Run 'make build-server' first.${NC}"
+        exit 1
+    fi
+}
+
+start_server() {
+    local write_workers=$1
+    pkill -f kallisto_server 2>/dev/null || true
+    rm -f "$KALLISTO_SOCKET" 2>/dev/null
+    rm -rf "$BENCH_DB_PATH" 2>/dev/null
+    sleep 0.5
+
+    $SERVER_BIN --http-port=$HTTP_PORT --workers=$HALF_CORES \
+        --write-workers="$write_workers" \
+        --socket-path="$KALLISTO_SOCKET" \
+        --db-path="$BENCH_DB_PATH" &>"$BENCH_LOG" &
+    SERVER_PID=$!
+
+    for i in $(seq 1 30); do
+        if curl -s --max-time 1 -H "Connection: close" "http://localhost:$HTTP_PORT/v1/sys/health" &>/dev/null; then
+            break
+        fi
+        sleep 0.25
+    done
+    $CLI_BIN "MODE BATCH" >/dev/null
+    sleep 0.5
+}
+
+stop_server() {
+    if [ -n "$SERVER_PID" ]; then
+        kill "$SERVER_PID" 2>/dev/null || true
+        wait "$SERVER_PID" 2>/dev/null || true
+        SERVER_PID=""
+    fi
+}
+
+cleanup() {
+    stop_server
+    rm -rf "$BENCH_DB_PATH" 2>/dev/null
+    rm -f "$BENCH_LOG" 2>/dev/null
+}
+
+trap cleanup EXIT
+
+# ── Main ────────────────────────────────────────────────────────────────
+check_prereqs
+echo -e "${CYAN}     KALLISTO PUT SCALING (wrk, ${THREADS} threads, ${CONNECTIONS} connections, ${DURATION})${NC}"
+echo ""
+
+declare -A RESULTS
+for workers in $WRITE_WORKER_COUNTS; do
+    echo -e "${CYAN}[--write-workers=${workers}] Running PUT benchmark...${NC}"
+    start_server "$workers"
+    OUTPUT=$(wrk -t"$THREADS" -c"$CONNECTIONS" -d"$DURATION" -s "$WORKLOAD_DIR/wrk_put.lua" "http://localhost:$HTTP_PORT" 2>&1)
+    RESULTS[$workers]=$(echo "$OUTPUT" | awk '/=== Kallisto PUT Benchmark ===/{found=1} found && /Requests\/sec:/{print $2; exit}')
+    echo "$OUTPUT" | sed -n '/=== Kallisto PUT Benchmark ===/,$p'
+    $CLI_BIN STATS || true
+    stop_server
+    echo ""
+done
+
+echo -e "${BOLD}${GREEN}Write workers    PUT req/s${NC}"
+for workers in $WRITE_WORKER_COUNTS; do
+    printf "  %-14s %s\n" "$workers" "${RESULTS[$workers]}"
+done
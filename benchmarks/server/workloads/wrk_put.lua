@@ -2,15 +2,17 @@
 -- Tests POST /v1/secret/data/<path> with JSON body
 --
 -- Usage: wrk -t4 -c100 -d10s -s benchmarks/server/workloads/wrk_put.lua http://localhost:8200
+-- KALLISTO_PUT_KEYS sets the number of distinct paths written (default 10000)
 
 counter = -1
+key_space = tonumber(os.getenv("KALLISTO_PUT_KEYS") or "10000")
 
 wrk.method = "POST"
 wrk.headers["Content-Type"] = "application/json"
 
 request = function()
     counter = counter + 1
-    local id = counter % 10000
+    local id = counter % key_space
     local path = "/v1/secret/data/bench/w" .. id
     local body = '{"data":{"value":"bench-val-' .. id .. '"}}'
     return wrk.format("POST", path, nil, body)
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "kallisto/i_path_index.hpp"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace kallisto {
+
+/**
+ * Adaptive Radix Tree (Leis et al., ICDE 2013) for paths.
+ * Alternative backend to BTreeIndex: a lookup walks one node per path byte
+ * group with no key comparisons, and all paths sharing a prefix live in one
+ * subtree, so prefix listing is a plain subtree walk.
+ *
+ * Inner nodes grow through Node4/16/48/256 as their fan-out rises and carry
+ * the bytes they compress (path compression). A path that ends inside the
+ * tree marks its node terminal, so "/a" and "/a/b" coexist.
+ *
+ * Nodes are immutable once linked: writers copy the root-to-target path and
+ * share every other subtree with the previous version. clone() is therefore
+ * O(1) and an RCU update copies O(depth) nodes instead of the whole index.
+ */
+class ArtPathIndex final : public IPathIndex {
+public:
+	ArtPathIndex() = default;
+
+	/**
+	* Structural sharing copy: both indexes point at the same immutable nodes.
+	*/
+	ArtPathIndex(const ArtPathIndex& other) = default;
+
+	bool insertPath(const std::string& path) override;
+	bool validatePath(std::string_view path) const override;
+	bool removePath(const std::string& path) override;
+	void iteratePrefix(std::string_view prefix, const PathVisitor& visitor) const override;
+	void bulkLoad(std::vector<std::string> sorted_paths) override;
+	std::unique_ptr<IPathIndex> clone() const override;
+
+	size_t size() const { return path_count_; }
+
+private:
+	enum class NodeType : uint8_t { LEAF, NODE4, NODE16, NODE48, NODE256 };
+
+	struct Node;
+	using NodePtr = std::shared_ptr<const Node>;
+	using ChildList = std::vector<std::pair<uint8_t, NodePtr>>;
+
+	struct Node {
+		NodeType type;
+		bool is_terminal;       // A path ends right after this node's prefix
+		uint16_t child_count = 0;
+		std::string prefix;     // Compressed path bytes consumed by this node
+
+		Node(NodeType node_type, bool terminal, std::string node_prefix)
+		  : type(node_type), is_terminal(terminal), prefix(std::move(node_prefix)) {}
+	};
+
+	// Node4/Node16: sorted key bytes, child i belongs to keys[i]
+	struct Node4 : Node {
+		std::array<uint8_t, 4> keys{};
+		std::array<NodePtr, 4> children;
+		using Node::Node;
+	};
+
+	struct Node16 : Node {
+		std::array<uint8_t, 16> keys{};
+		std::array<NodePtr, 16> children;
+		using Node::Node;
+	};
+
+	// Node48: byte -> slot+1 (0 = empty), 48 child slots
+	struct Node48 : Node {
+		std::array<uint8_t, 256> child_slots{};
+		std::array<NodePtr, 48> children;
+		using Node::Node;
+	};
+
+	struct Node256 : Node {
+		std::array<NodePtr, 256> children;
+		using Node::Node;
+	};
+
+	NodePtr root_node_;
+	size_t path_count_ = 0;
+
+	static const NodePtr* findChild(const Node& node, uint8_t key_byte);
+
+	/** Children of node in ascending key byte order. */
+	static ChildList collectChildren(const Node& node);
+
+	/**
+	* Builds the smallest node type that fits children (a LEAF when empty).
+	*/
+	static NodePtr buildNode(std::string prefix, bool is_terminal, const ChildList& children);
+
+	/**
+	* Path-copying insert of the remaining key bytes below node.
+	* @return The replacement subtree, or node itself when the path already existed.
+	*/
+	static NodePtr insertAt(const NodePtr& node, std::string_view key, bool& inserted);
+
+	/**
+	* Path-copying removal. Collapses a non-terminal single-child node into its
+	* child so path compression stays maximal.
+	* @return The replacement subtree (nullptr when it became empty).
+	*/
+	static NodePtr removeAt(const NodePtr& node, std::string_view key, bool& removed);
+
+	/**
+	* Builds the subtree for sorted_paths[begin, end), which all share their
+	* first depth bytes. Each node is created once, already at its final type.
+	*/
+	static NodePtr buildSorted(const std::vector<std::string>& sorted_paths, size_t begin, size_t end,
+	                           size_t depth);
+
+	/** Folds parent prefix + key byte into an only child. */
+	static NodePtr mergeWithOnlyChild(const Node& node, uint8_t key_byte, const Node& child);
+
+	/** In-order walk; path_buffer holds the bytes above node. */
+	static void visitSubtree(const Node& node, std::string& path_buffer, const PathVisitor& visitor);
+};
+
+} // namespace kallisto
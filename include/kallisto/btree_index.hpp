@@ -1,16 +1,25 @@
 #pragma once
 
+#include "kallisto/i_path_index.hpp"
+
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <memory>
 
 namespace kallisto {
 
 /**
- * Simplified B-Tree for strings (paths).
+ * Cache-conscious B+-Tree for strings (paths).
  * Acts as a validator before secret lookup in the CuckooTable.
+ *
+ * Paths live only in the leaves; internal nodes hold truncated separators.
+ * Each node stores its keys prefix-compressed: the common prefix once, the
+ * remaining suffixes back-to-back in one arena, plus a fixed-width 8-byte head
+ * per key so the binary search mostly compares integers in one small array.
  */
-class BTreeIndex {
+class BTreeIndex final : public IPathIndex {
 public:
 	/**
 	* @param degree Minimum degree (t). A node can have at most 2t-1 keys.
@@ -28,61 +37,139 @@ public:
 	* @param path The path to insert (e.g., "/prod/db").
 	* @return true if insertion was successful.
 	*/
-	bool insertPath(const std::string& path);
+	bool insertPath(const std::string& path) override;
 
 	/**
 	* Validates if a path exists in the index.
+	* Iterative root-to-leaf descent, no recursion and no allocation.
 	* @param path The path to validate.
 	* @return true if the path exists.
 	*/
-	bool validatePath(const std::string& path) const;
+	bool validatePath(std::string_view path) const override;
+
+	/**
+	* Removes a path from the index, rebalancing with borrow/merge so every
+	* non-root node keeps at least t-1 keys and the tree height shrinks.
+	* @param path The path to remove.
+	* @return true if the path was present and has been removed.
+	*/
+	bool removePath(const std::string& path) override;
+
+	/**
+	* Visits every path starting with prefix in order. Descends to the first
+	* candidate leaf and stops at the first key past the prefix range.
+	*/
+	void iteratePrefix(std::string_view prefix, const PathVisitor& visitor) const override;
+
+	/**
+	* Packs sorted paths into evenly filled leaves, then builds each internal
+	* level from the separators between its children. Every non-root node
+	* ends up with at least t-1 keys, as after regular inserts.
+	*/
+	void bulkLoad(std::vector<std::string> sorted_paths) override;
+
+	/**
+	* Deep copy for RCU publishing.
+	*/
+	std::unique_ptr<IPathIndex> clone() const override;
 
 private:
 	struct Node {
 		bool is_leaf_node;
-		std::vector<std::string> path_keys;
+
+		// Prefix-compressed key block: key[i] = key_prefix + suffix(i)
+		std::string key_prefix;
+		std::vector<uint64_t> key_heads;     // First 8 suffix bytes, big-endian, zero padded
+		std::vector<uint32_t> key_offsets;   // keyCount()+1 offsets into key_arena
+		std::string key_arena;               // Suffixes stored contiguously
+
 		std::vector<std::unique_ptr<Node>> child_nodes;
 
-		Node(bool is_leaf = true) : is_leaf_node(is_leaf) {}
+		Node(bool is_leaf = true) : is_leaf_node(is_leaf), key_offsets{0} {}
 
 		// Deep Copy Constructor
-		Node(const Node& other) : is_leaf_node(other.is_leaf_node), path_keys(other.path_keys) {
+		Node(const Node& other)
+		  : is_leaf_node(other.is_leaf_node), key_prefix(other.key_prefix),
+		    key_heads(other.key_heads), key_offsets(other.key_offsets), key_arena(other.key_arena) {
 			for (const auto& child : other.child_nodes) {
 				child_nodes.push_back(std::make_unique<Node>(*child));
 			}
 		}
+
+		size_t keyCount() const { return key_heads.size(); }
+		std::string_view suffixAt(size_t index) const;
+		std::string keyAt(size_t index) const;
+
+		/** Expands the key block into full keys for a structural change. */
+		std::vector<std::string> decodeKeys() const;
+
+		/** Re-encodes a sorted key list (common prefix, arena and heads). */
+		void encodeKeys(const std::vector<std::string>& sorted_keys);
+	};
+
+	struct SearchResult {
+		size_t index; // First key >= probe
+		bool exact;   // key[index] == probe
 	};
 
 	std::unique_ptr<Node> root_node_;
 	int min_degree_;
 
+	size_t maxKeys() const { return static_cast<size_t>(2 * min_degree_ - 1); }
+
+	/**
+	* Binary search inside one node's key block.
+	* Compares the probe against the node prefix once, then against the fixed
+	* 8-byte heads, touching the suffix arena only when two heads tie.
+	*/
+	static SearchResult searchNode(const Node& node, std::string_view path_key);
+
+	/**
+	* In-order walk of the subtree under node from the first key >= prefix.
+	* @return false once a key past the prefix range was seen.
+	*/
+	static bool visitPrefixRange(const Node& node, std::string_view prefix, const PathVisitor& visitor);
+
+	/** Index of the child that may contain path_key in an internal node. */
+	static size_t childIndexFor(const Node& node, std::string_view path_key);
+
+	/**
+	* Shortest separator s with left_key < s <= right_key (suffix truncation).
+	*/
+	static std::string shortestSeparator(const std::string& left_key, const std::string& right_key);
+
 	/**
 	* Splits a child node that is full into two separate nodes.
-	* Maintains the B-Tree properties during insertion.
-	* 
+	* Leaves copy their first right-hand key up as a truncated separator,
+	* internal nodes move their middle separator up.
+	*
 	* @param parent_node The parent node of the child being split.
 	* @param child_index The index of the child to split in the parent's children array.
-	* @param child_node The actual child node that is full and needs splitting.
-	*/ 
-	void splitChildNode(Node* parent_node, int child_index, Node* child_node);
+	*/
+	void splitChildNode(Node* parent_node, size_t child_index);
+
+	/**
+	* Ensures child_nodes[child_index] holds at least t keys before descending.
+	* Borrows from a sibling when possible, otherwise merges with one.
+	* @return Index of the child to descend into after a possible merge.
+	*/
+	size_t fillChildNode(Node* parent_node, size_t child_index);
+
+	void borrowFromPreviousSibling(Node* parent_node, size_t child_index);
+	void borrowFromNextSibling(Node* parent_node, size_t child_index);
 
 	/**
-	* Inserts a path key into a node that is guaranteed to not be full.
-	* Recursively travels down the tree.
-	* 
-	* @param current_node The node to insert into.
-	* @param path_key The path string to insert.
-	*/ 
-	void insertIntoNonFullNode(Node* current_node, const std::string& path_key);
+	* Merges child_nodes[key_index + 1] into child_nodes[key_index] and drops
+	* their separator (pulled down into internal nodes, discarded for leaves).
+	*/
+	void mergeChildNodes(Node* parent_node, size_t key_index);
 
 	/**
-	* Recursively searches for a path key in the B-Tree starting from a given node.
-	* 
-	* @param current_node The node to begin searching from.
-	* @param path_key The path string to search for.
-	* @return true if the path is found.
-	*/ 
-	bool containsPathRecursive(Node* current_node, const std::string& path_key) const;
+	* Drops an empty internal root so the tree height follows the key count.
+	*/
+	void shrinkRootIfEmpty();
+
+	bool hasSpareKey(const Node* node) const;
 };
 
 } // namespace kallisto
@@ -4,6 +4,7 @@
 
 #include <atomic>
 #include <cstdlib>
+#include <memory>
 #include <optional>
 #include <shared_mutex>
 #include <string>
@@ -22,9 +23,10 @@ public:
   /**
    * Inserts a secret entry into the cuckoo table.
    * Uses the "kicking" mechanism to resolve collisions.
+   * @param overwrite false leaves an existing entry untouched (and still returns true).
    * @return true if insertion was successful, false if a cycle was detected (full table).
    */
-  bool insert(const std::string& key, const SecretEntry& entry);
+  bool insert(const std::string& key, const SecretEntry& entry, bool overwrite = true);
 
   /**
    * Looks up an entry by key. O(1) worst-case.
@@ -32,6 +34,12 @@ public:
    */
   std::optional<SecretEntry> lookup(const std::string& key) const;
 
+  /**
+   * Looks up an entry's shared_value without copying the entry.
+   * @return nullptr if the key is absent or its entry has no shared value.
+   */
+  std::shared_ptr<const std::string> lookupShared(const std::string& key) const;
+
   /**
    * Retrieves all entries from the table (for snapshotting).
    */
@@ -58,6 +66,13 @@ public:
    */
   bool remove(const std::string& key);
 
+  /**
+   * Removes every entry whose key starts with prefix. Scans the whole
+   * table under the writer lock: meant for rare bulk deletes.
+   * @return Entries removed.
+   */
+  size_t removePrefix(const std::string& prefix);
+
   MemoryStats getMemoryStats() const;
 
 private:
@@ -107,6 +122,12 @@ private:
     return tag == 0 ? 1 : tag; // Tag 0 reserved? No, but let's just use raw bits.
   }
 
+  // Storage index of key, or invalid_index. Caller holds rw_lock_.
+  uint32_t findIndex(const std::string& key) const;
+
+  // Empties a slot and recycles its storage. Caller holds the writer lock.
+  void release(Bucket::Slot& slot);
+
   void rehash();
 };
 
@@ -3,9 +3,11 @@
 #include "kallisto/engine/i_secret_engine.hpp"
 #include <concepts>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <tl/expected.hpp>
+#include <vector>
 
 namespace kallisto::engine {
 
@@ -19,10 +21,16 @@ concept ValidEngine = requires(T e,
                                std::string_view path,
                                uint32_t version,
                                const kallisto::engine::SecretPayload& payload,
-                               std::optional<uint32_t> cas) {
+                               std::optional<uint32_t> cas,
+                               std::span<const std::string> paths,
+                               std::span<const kallisto::engine::PathPayload> items,
+                               std::span<const kallisto::engine::TxnOp> txn) {
     { e.read_version(path, version) } -> std::same_as<tl::expected<kallisto::engine::SecretPayload, kallisto::engine::EngineError>>;
     { e.read_metadata(path) } -> std::same_as<tl::expected<kallisto::engine::KeyMetadata, kallisto::engine::EngineError>>;
     { e.put_version(path, payload, cas) } -> std::same_as<tl::expected<void, kallisto::engine::EngineError>>;
+    { e.read_many(paths) } -> std::same_as<std::vector<kallisto::engine::ReadResult>>;
+    { e.put_many(items) } -> std::same_as<std::vector<kallisto::engine::WriteResult>>;
+    { e.transact(txn) } -> std::same_as<kallisto::engine::TxnResult>;
     { e.soft_delete(path, version) } -> std::same_as<tl::expected<void, kallisto::engine::EngineError>>;
     { e.destroy_version(path, version) } -> std::same_as<tl::expected<void, kallisto::engine::EngineError>>;
     { e.engineType() } -> std::convertible_to<std::string>;
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace kallisto::engine {
+
+/**
+ * Log2Histogram — Lock-free histogram with power-of-two buckets.
+ *
+ * Bucket 0 counts zeros, bucket i counts values in [2^(i-1), 2^i).
+ * Recording is two relaxed increments; percentiles report the upper bound
+ * of the bucket holding the quantile, so they are within 2x of the truth.
+ */
+class Log2Histogram {
+public:
+    static constexpr size_t num_buckets = 65;
+
+    void record(uint64_t value);
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+    /**
+     * @param quantile In [0, 1], e.g. 0.99.
+     * @return Upper bound of the bucket holding the quantile, 0 if empty.
+     */
+    uint64_t percentile(double quantile) const;
+
+private:
+    std::array<std::atomic<uint64_t>, num_buckets> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+/**
+ * Tuning of the write-behind flusher (BATCH sync mode).
+ */
+struct FlushPolicy {
+    std::chrono::microseconds target_p99_lag{5000}; // Enqueue-to-written budget
+    size_t max_batch = 4096;                         // Upper bound on records per WriteBatch
+};
+
+/**
+ * Snapshot of the flusher: current decisions and observed distributions.
+ */
+struct FlushStats {
+    uint64_t flushes = 0;
+    uint64_t records = 0;
+
+    // Current decisions
+    size_t batch_limit = 0;
+    uint64_t window_us = 0;
+    double arrival_rate = 0;      // Records per second (EWMA)
+    uint64_t write_latency_us = 0; // RocksDB WriteBatch latency (EWMA)
+
+    // Distributions (p50 / p99 / max)
+    uint64_t queue_depth_p50 = 0, queue_depth_p99 = 0, queue_depth_max = 0;
+    uint64_t batch_size_p50 = 0, batch_size_p99 = 0, batch_size_max = 0;
+    uint64_t lag_p50_us = 0, lag_p99_us = 0, lag_max_us = 0;
+};
+
+/**
+ * FlushScheduler — Adaptive batching policy for the write-behind worker.
+ *
+ * Role: Decides when a partial batch must go to RocksDB. A batch is
+ * flushed once it reaches batchLimit() records or its oldest record has
+ * waited flushWindow(). Both follow the load:
+ *   - the window is the lag budget left after the observed write latency,
+ *     shrunk multiplicatively whenever a flush overshoots the target;
+ *   - the limit is the number of records expected to arrive within one
+ *     window, so a busy engine writes few large batches and an idle one
+ *     writes each record right away.
+ *
+ * recordFlush() and the two decision getters are called by the worker
+ * thread only; setPolicy() and stats() may be called from any thread.
+ */
+class FlushScheduler {
+public:
+    explicit FlushScheduler(FlushPolicy policy = {});
+
+    void setPolicy(const FlushPolicy& policy);
+    FlushPolicy policy() const;
+
+    size_t batchLimit() const { return batch_limit_.load(std::memory_order_relaxed); }
+    std::chrono::microseconds flushWindow() const {
+        return std::chrono::microseconds(window_us_.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * Feeds one completed flush back into the policy.
+     * @param queue_depth Records still queued when the batch was cut.
+     * @param oldest_lag Enqueue-to-written time of the batch's oldest record.
+     */
+    void recordFlush(size_t batch_size, size_t queue_depth, std::chrono::microseconds write_latency,
+                     std::chrono::microseconds oldest_lag, std::chrono::steady_clock::time_point now);
+
+    FlushStats stats() const;
+
+private:
+    std::atomic<int64_t> target_lag_us_;
+    std::atomic<size_t> max_batch_;
+
+    // Published decisions
+    std::atomic<size_t> batch_limit_;
+    std::atomic<uint64_t> window_us_;
+
+    // Worker-side estimates, published for stats()
+    std::atomic<double> arrival_rate_{0};
+    std::atomic<double> write_latency_us_{0};
+    double headroom_ = 1.0; // Fraction of the lag budget used as window
+    std::chrono::steady_clock::time_point last_flush_{};
+
+    std::atomic<uint64_t> flushes_{0};
+    std::atomic<uint64_t> records_{0};
+    Log2Histogram queue_depth_;
+    Log2Histogram batch_size_;
+    Log2Histogram lag_us_;
+};
+
+} // namespace kallisto::engine
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "kallisto/rocksdb_storage.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace kallisto::engine {
+
+/**
+ * Counters of a GroupCommitter since construction.
+ */
+struct GroupCommitStats {
+    uint64_t commits = 0; // commit() calls, i.e. logical durable writes
+    uint64_t groups = 0;  // WriteBatches written, i.e. fsyncs
+    uint64_t max_group = 0;
+
+    double averageGroup() const { return groups ? static_cast<double>(commits) / groups : 0.0; }
+};
+
+/**
+ * GroupCommitter — Leader/follower group commit for synchronous writes.
+ *
+ * Role: Every caller of commit() needs its records durable before it
+ * returns. Instead of one fsync per caller, the first caller to find no
+ * commit in flight becomes the leader: it takes every request queued so
+ * far, writes them as one WriteBatch with sync=true, and wakes the
+ * followers whose records went out with it. Callers arriving while that
+ * fsync runs queue up and form the next group, so the group size grows
+ * with concurrency and the fsync rate stays bounded by the disk.
+ *
+ * Each request's records are one contiguous run inside the merged batch,
+ * so a request is applied atomically: all of its records or none.
+ */
+class GroupCommitter {
+public:
+    explicit GroupCommitter(RocksDBStorage& storage) : storage_(storage) {}
+
+    GroupCommitter(const GroupCommitter&) = delete;
+    GroupCommitter& operator=(const GroupCommitter&) = delete;
+
+    /**
+     * Blocks until ops are durable (or the group's write failed). The
+     * caller owns the bytes ops point to; they are not copied.
+     * @return true if the batch carrying ops was written and synced.
+     */
+    bool commit(std::vector<RocksDBStorage::BatchOpView> ops);
+
+    GroupCommitStats stats() const;
+
+private:
+    struct Request {
+        std::vector<RocksDBStorage::BatchOpView> ops;
+        bool done = false;
+        bool ok = false;
+    };
+
+    RocksDBStorage& storage_;
+
+    std::mutex mutex_;
+    std::condition_variable done_cv_;
+    std::vector<Request*> pending_;
+    bool leader_active_ = false;
+
+    std::atomic<uint64_t> commits_{0};
+    std::atomic<uint64_t> groups_{0};
+    std::atomic<uint64_t> max_group_{0};
+};
+
+} // namespace kallisto::engine
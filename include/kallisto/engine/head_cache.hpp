@@ -0,0 +1,136 @@
+#pragma once
+
+#include "kallisto/engine/i_secret_engine.hpp"
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace kallisto::engine {
+
+/**
+ * Serialized record shared, immutable, by every layer that holds it: a
+ * payload is encoded once per write and the same buffer is referenced by
+ * the payload cache, the path's head and the pending write.
+ */
+using SharedBytes = std::shared_ptr<const std::string>;
+
+/**
+ * Head record of a path: decoded metadata co-located with the payload of
+ * its current version, so a latest-version read is a single probe.
+ */
+struct PathHead {
+    KeyMetadata meta;
+    SharedBytes latest; // Serialized payload of meta.current_version, once known
+};
+
+/**
+ * Immutable once published. Writers never modify a cached head; they build
+ * a new one and replace the cache entry.
+ */
+using HeadPtr = std::shared_ptr<const PathHead>;
+
+/**
+ * SharedCache — Immutable shared objects keyed by string.
+ *
+ * A hit hands back a shared pointer to the cached object (one atomic
+ * increment) instead of copying a serialized record and parsing it into
+ * fresh allocations. Entries are replaced wholesale, never modified.
+ *
+ * Same sharding as ShardedCuckooTable: 64 shards, each behind its own
+ * shared_mutex. Lookups take a string_view and never build a key string.
+ */
+template <typename T>
+class SharedCache {
+public:
+    using Ptr = std::shared_ptr<const T>;
+
+    static constexpr size_t num_shards = 64;
+
+    /**
+     * @param capacity Maximum number of keys, split evenly across shards.
+     */
+    explicit SharedCache(size_t capacity);
+
+    /**
+     * @return The cached object, or nullptr on a miss.
+     */
+    Ptr lookup(std::string_view key) const;
+
+    /**
+     * Batched lookup: keys are grouped by shard and each shard is locked
+     * once, however many of the keys it holds.
+     * @param out Same size as keys; out[i] is set to keys[i]'s object or nullptr.
+     */
+    void lookupMany(std::span<const std::string_view> keys, std::span<Ptr> out) const;
+
+    /**
+     * @param overwrite false leaves an existing entry untouched (and still returns true).
+     * @return false if the key is new and its shard is full.
+     */
+    bool insert(std::string_view key, Ptr value, bool overwrite = true);
+
+    /**
+     * Inserts or replaces, past the shard's capacity if need be. For
+     * writers: until write-behind flushes a head, the cache holds the only
+     * copy of it, so capacity only bounds the entries reads fill in.
+     */
+    void publish(std::string_view key, Ptr value);
+
+    /**
+     * Replaces the entry only if it is still expected, so a reader filling
+     * in an entry never clobbers one a writer published meanwhile.
+     * @return true if desired was published.
+     */
+    bool replaceIf(std::string_view key, const Ptr& expected, Ptr desired);
+
+    void remove(std::string_view key);
+
+    /**
+     * Removes the entry only if it is still expected.
+     */
+    bool removeIf(std::string_view key, const Ptr& expected);
+
+    /**
+     * Removes every key starting with prefix, one shard lock at a time.
+     * Scans the whole cache: meant for rare bulk deletes.
+     * @return Entries removed.
+     */
+    size_t removePrefix(std::string_view prefix);
+
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+private:
+    struct KeyHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view key) const { return std::hash<std::string_view>{}(key); }
+    };
+
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, Ptr, KeyHash, std::equal_to<>> entries;
+    };
+
+    size_t shardIndex(std::string_view key) const;
+    Shard& shardFor(std::string_view key) const;
+
+    std::unique_ptr<std::array<Shard, num_shards>> shards_;
+    size_t shard_capacity_;
+    std::atomic<size_t> size_{0};
+};
+
+/**
+ * HeadCache — PathHead records keyed by secret path.
+ * Serialization only happens on the write-behind path to RocksDB.
+ */
+using HeadCache = SharedCache<PathHead>;
+
+extern template class SharedCache<PathHead>;
+
+} // namespace kallisto::engine
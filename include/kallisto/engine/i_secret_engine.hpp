@@ -2,9 +2,12 @@
 
 #include "kallisto/secret_entry.hpp"
 #include <tl/expected.hpp>
+#include <functional>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 #include <cstdint>
 
@@ -35,6 +38,15 @@ struct SecretPayload {
     uint64_t ttl = 0;
 };
 
+/**
+ * Where a write sits in its engine's write-behind stream, for callers that
+ * must not acknowledge it before it is on disk.
+ */
+struct WriteTicket {
+    uint32_t stream = 0;   // Write-behind queue the write was routed to
+    uint64_t sequence = 0; // Increasing per stream; 0 = already durable on return
+};
+
 enum class EngineError {
     NotFound,
     SoftDeleted,
@@ -45,6 +57,37 @@ enum class EngineError {
     QueueFull
 };
 
+using ReadResult = tl::expected<SecretPayload, EngineError>;
+using ReadCallback = std::function<void(ReadResult)>;
+using ReadManyCallback = std::function<void(std::vector<ReadResult>)>;
+using WriteResult = tl::expected<void, EngineError>;
+
+// One put_many item: the path and the payload of its new version
+using PathPayload = std::pair<std::string, SecretPayload>;
+
+/**
+ * One step of a transaction. PUT adds a version, DELETE destroys the
+ * current one (as DELETE on the HTTP API does), CHECK writes nothing.
+ * With cas set, the step requires the path's current version before the
+ * transaction to equal it (0: the path has never been written).
+ */
+struct TxnOp {
+    enum class Type { PUT, DELETE, CHECK };
+    Type type = Type::CHECK;
+    std::string path;
+    SecretPayload payload; // PUT only
+    std::optional<uint32_t> cas;
+};
+
+// Why a transaction wrote nothing: the failing step (ops.size() for the
+// commit itself) and its error
+struct TxnError {
+    size_t op;
+    EngineError error;
+};
+using TxnResult = tl::expected<void, TxnError>;
+using TxnCallback = std::function<void(TxnResult)>;
+
 /**
  * ISecretEngine — Port interface for all secret engines.
  *
@@ -70,9 +113,104 @@ public:
     // --- V2 Domain Behaviors ---
     virtual tl::expected<SecretPayload, EngineError> read_version(std::string_view path, uint32_t version = 0) = 0;
     
+    /**
+     * read_version that never blocks the caller on disk. When memory can
+     * answer, returns the result and done is never called. Otherwise returns
+     * nullopt and calls done(result) later from an I/O thread: post it back
+     * to the caller's event loop. See ReadVersionAwaiter for coroutines.
+     * Engines without an I/O pool read synchronously.
+     */
+    virtual std::optional<ReadResult> read_version_async(std::string_view path, uint32_t version, ReadCallback done) {
+        (void)done;
+        return read_version(path, version);
+    }
+    
+    /**
+     * Latest version of each path, in order: one call for a set of paths,
+     * such as a service loading its secrets at boot. Engines may batch the
+     * cache and disk lookups; this default reads them one by one.
+     */
+    virtual std::vector<ReadResult> read_many(std::span<const std::string> paths) {
+        std::vector<ReadResult> results;
+        results.reserve(paths.size());
+        for (const auto& path : paths) {
+            results.push_back(read_version(path));
+        }
+        return results;
+    }
+
+    /**
+     * read_many that never blocks the caller on disk, like
+     * read_version_async: returns the results when memory answers every
+     * path, else nullopt and calls done(results) later from an I/O thread.
+     */
+    virtual std::optional<std::vector<ReadResult>> read_many_async(std::span<const std::string> paths, ReadManyCallback done) {
+        (void)done;
+        return read_many(paths);
+    }
+
     virtual tl::expected<KeyMetadata, EngineError> read_metadata(std::string_view path) = 0;
     
     virtual tl::expected<void, EngineError> put_version(std::string_view path, const SecretPayload& payload, std::optional<uint32_t> cas = std::nullopt) = 0;
+
+    /**
+     * A new version of each path, in order (a path listed twice gets two).
+     * Not atomic across paths: each item has its own result. Engines may
+     * commit the set as one write per queue; this default puts one by one.
+     */
+    virtual std::vector<WriteResult> put_many(std::span<const PathPayload> items) {
+        std::vector<WriteResult> results;
+        results.reserve(items.size());
+        for (const auto& [path, payload] : items) {
+            results.push_back(put_version(path, payload));
+        }
+        return results;
+    }
+    
+    /**
+     * Applies every step or none: all cas conditions are checked against
+     * the state before the transaction, then the writes commit together and
+     * become visible together. No default: steps applied one by one would
+     * be neither isolated from concurrent writers nor crash-atomic.
+     */
+    virtual TxnResult transact(std::span<const TxnOp> ops) = 0;
+
+    /**
+     * transact that never blocks the caller on disk, like read_version_async:
+     * returns the result if the engine settled it in place, else nullopt
+     * and calls done(result) later from an I/O thread.
+     * Engines without an I/O pool commit synchronously.
+     */
+    virtual std::optional<TxnResult> transact_async(std::vector<TxnOp> ops, TxnCallback done) {
+        (void)done;
+        return transact(ops);
+    }
+
+    /**
+     * put_version whose write is fsynced even in BATCH mode, by the same
+     * flush that carries it to disk. Returns as soon as the write is queued;
+     * pass the ticket to whenDurable() to learn when it is on disk.
+     * Engines without a write-behind path write, then flush, before returning.
+     */
+    virtual tl::expected<WriteTicket, EngineError> put_version_durable(std::string_view path, const SecretPayload& payload, std::optional<uint32_t> cas = std::nullopt) {
+        auto res = put_version(path, payload, cas);
+        if (!res) {
+            return tl::unexpected(res.error());
+        }
+        forceFlush();
+        return WriteTicket{};
+    }
+
+    /**
+     * Calls callback(true) once the write behind ticket is durable, or
+     * callback(false) if the flush carrying it failed: right away if already
+     * settled, else from the flushing thread. The callback must be cheap and
+     * thread-safe (e.g. post to an event loop).
+     */
+    virtual void whenDurable(const WriteTicket& ticket, std::function<void(bool durable)> callback) {
+        (void)ticket;
+        callback(true);
+    }
     
     virtual tl::expected<void, EngineError> soft_delete(std::string_view path, uint32_t version) = 0;
     
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace kallisto::engine {
+
+/**
+ * Counters of an IoPool since construction.
+ */
+struct IoPoolStats {
+    uint64_t submitted = 0; // Tasks accepted
+    uint64_t rejected = 0;  // Tasks refused: queue at max_pending, or stopping
+    size_t pending = 0;     // Queued, not yet started
+};
+
+/**
+ * IoPool — Fixed set of threads running blocking I/O off the event loops.
+ *
+ * Role: Event-loop threads must never wait on disk. Work that may block
+ * (a RocksDB Get on a cache miss) is submitted here and runs in FIFO order
+ * on one of the pool's threads; its continuation is the task's own business
+ * (typically posting the result back to the originating Dispatcher).
+ *
+ * The queue is bounded: past max_pending, submit() refuses the task so the
+ * caller can shed load instead of queueing unbounded latency.
+ * Destruction runs every task already queued, then joins the threads.
+ */
+class IoPool {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @param threads At least one.
+     * @param max_pending Tasks queued and not yet started beyond which submit() fails.
+     */
+    IoPool(size_t threads, size_t max_pending);
+    ~IoPool();
+
+    IoPool(const IoPool&) = delete;
+    IoPool& operator=(const IoPool&) = delete;
+
+    /**
+     * Queues task. Thread-safe.
+     * @return false if the queue is full or the pool is stopping; task is dropped.
+     */
+    bool submit(Task task);
+
+    size_t threadCount() const { return threads_.size(); }
+    IoPoolStats stats() const;
+
+private:
+    void run();
+
+    const size_t max_pending_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Task> tasks_;
+    bool stopping_ = false;
+    uint64_t submitted_ = 0;
+    uint64_t rejected_ = 0;
+    std::vector<std::thread> threads_;
+};
+
+} // namespace kallisto::engine
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace kallisto::engine {
+
+/**
+ * RocksDB record keys of the KV engine (format 2).
+ *
+ * Every key starts with a record type byte. A path is written escaped
+ * (0x00 -> 0x00 0xFF) and terminated by 0x00 0x01, and a version as a
+ * 4-byte big-endian integer:
+ *
+ *   metadata:  0x01 <escaped path> 0x00 0x01
+ *   payload:   0x02 <escaped path> 0x00 0x01 <version, big-endian>
+ *   internal:  0x00 <name>
+ *
+ * Byte order of the keys is (path, version) order: the terminator sorts
+ * below any continuation of the path, and big-endian versions sort
+ * numerically. The records of every path starting with a given prefix are
+ * one contiguous range per type, whatever bytes the prefix holds, so
+ * recovery bulk-loads paths in key order and a subtree is dropped with
+ * range tombstones.
+ *
+ * Format 1 keys were text: "m:<path>" and "v:<path>:<decimal version>".
+ * Decimal versions sorted 10 before 9, and a ':' in a path made version
+ * keys of different paths share a prefix.
+ */
+
+inline constexpr uint8_t key_format_version = 2;
+
+// Internal record holding key_format_version; absent on format 1 databases
+inline constexpr std::string_view key_format_key{"\x00key-format", 11};
+
+inline constexpr std::string_view legacy_meta_key_prefix = "m:";
+inline constexpr std::string_view legacy_version_key_prefix = "v:";
+
+/**
+ * A version key split into its path and version.
+ */
+struct VersionKey {
+    std::string path;
+    uint32_t version = 0;
+};
+
+std::string buildMetaKey(std::string_view path);
+std::string buildVersionKey(std::string_view path, uint32_t version);
+
+/**
+ * Key prefix shared by the metadata (resp. payload) records of every path
+ * starting with path_prefix. An empty path_prefix covers all of them.
+ */
+std::string metaKeyPrefix(std::string_view path_prefix);
+std::string versionKeyPrefix(std::string_view path_prefix);
+
+/**
+ * @return The path of a metadata key, nullopt if key is not one.
+ */
+std::optional<std::string> parseMetaKey(std::string_view key);
+
+/**
+ * @return The path and version of a payload key, nullopt if key is not one.
+ */
+std::optional<VersionKey> parseVersionKey(std::string_view key);
+
+/**
+ * @return The path and version of a format 1 "v:<path>:<version>" key.
+ * The path is everything up to the last ':'.
+ */
+std::optional<VersionKey> parseLegacyVersionKey(std::string_view key);
+
+} // namespace kallisto::engine
@@ -2,35 +2,256 @@
 
 #include "kallisto/engine/i_secret_engine.hpp"
 #include "kallisto/engine/engine_concept.hpp"
+#include "kallisto/engine/flush_scheduler.hpp"
+#include "kallisto/engine/group_commit.hpp"
+#include "kallisto/engine/head_cache.hpp"
+#include "kallisto/engine/io_pool.hpp"
+#include "kallisto/engine/negative_cache.hpp"
+#include "kallisto/engine/record_ring.hpp"
+#include "kallisto/engine/single_flight.hpp"
+#include "kallisto/rocksdb_storage.hpp"
 #include "kallisto/sharded_cuckoo_table.hpp"
 #include "kallisto/tls_btree_manager.hpp"
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <thread>
-#include "kallisto/engine/lock_free_queue.hpp"
-
-namespace kallisto {
-class RocksDBStorage; // Forward declaration
-}
+#include <utility>
+#include <vector>
+#include "kallisto/engine/striped_mutex.hpp"
 
 namespace kallisto::engine {
 
+/**
+ * Startup recovery tuning for KvEngine.
+ */
+struct RecoveryOptions {
+    size_t threads = 0;        // Parallel range scanners (0 = hardware concurrency)
+    bool warm_cache = false;   // Also load every metadata record into the cache
+    bool background = false;   // Rebuild on a background thread; the engine serves immediately
+};
+
+/**
+ * Mount-level KV configuration (Vault's /config endpoint).
+ */
+struct MountConfig {
+    uint32_t max_versions = 10; // History kept per key when its own limit is 0; 0 = unlimited
+};
+
+/**
+ * Write-behind (BATCH sync mode) configuration.
+ */
+struct WriteBehindOptions {
+    size_t workers = 4;                 // I/O threads, each draining its own queue; records are routed by path
+    size_t queue_bytes = size_t{8} << 20; // Per-worker queue buffer; a write larger than half of it is rejected
+    FlushPolicy flush;                  // Applied to every worker
+};
+
+/**
+ * Cache-miss reads issued through read_version_async.
+ */
+struct ReadIoOptions {
+    size_t threads = 4;          // RocksDB reads run here, never on an event loop
+    size_t max_pending = 65536;  // Queued misses beyond this fail with QueueFull
+    bool coalesce = true;        // Concurrent misses on one key share a single RocksDB read
+    std::chrono::milliseconds negative_ttl{1000}; // NotFound answered from memory this long; 0 disables
+    size_t negative_capacity = 65536;             // Missing paths remembered at most
+};
+
+/**
+ * Outcome of the last startup recovery.
+ */
+struct RecoveryStats {
+    size_t paths = 0;          // Paths loaded into the index
+    size_t ranges = 0;         // Key ranges scanned
+    size_t threads = 0;        // Scanner threads used
+    double seconds = 0;        // Scan + index build, excluding the store open
+};
+
+/**
+ * Progress of startup recovery, for health checks and load balancer weights.
+ */
+struct WarmupStatus {
+    bool ready = false;        // Path index rebuilt and writes applied to it directly
+    size_t ranges_done = 0;
+    size_t ranges_total = 0;
+    size_t paths = 0;          // Live paths scanned so far
+
+    double progress() const {
+        if (ready) {
+            return 1.0;
+        }
+        return ranges_total > 0 ? static_cast<double>(ranges_done) / ranges_total : 0.0;
+    }
+};
+
 /**
  * KvEngine — KV Secrets Engine v1.
  *
  * `final` enables compiler devirtualization (see MACM analysis).
- * Owns all storage layers: ShardedCuckooTable + RocksDB + BTree index.
+ * Owns all storage layers: head and payload caches + RocksDB + BTree index.
  */
 class KvEngine final : public ISecretEngine {
 public:
-    explicit KvEngine(const std::string& db_path = "/var/lib/kallisto/data");
+    /**
+     * @param path_index_type Path validator backend (B+-Tree or ART).
+     * @param recovery How the path index (and optionally the cache) is rebuilt from disk.
+     * @param config Mount-level defaults for every key.
+     * @param write_behind Write-behind workers used in BATCH sync mode.
+     * @param read_io I/O threads serving read_version_async cache misses.
+     */
+    explicit KvEngine(const std::string& db_path = "/var/lib/kallisto/data",
+                      PathIndexType path_index_type = PathIndexType::BTREE,
+                      RecoveryOptions recovery = {},
+                      MountConfig config = {},
+                      WriteBehindOptions write_behind = {},
+                      ReadIoOptions read_io = {});
     ~KvEngine() override;
 
+    /**
+     * Hands the server's workers to the path index so each worker validates
+     * paths against its own thread-local snapshot. See TlsBTreeManager::attachWorkers.
+     */
+    void attachWorkers(event::WorkerPool& workers, tls::Instance& tls);
+
+    /**
+     * @return true if path has a live version according to the path index.
+     * Lock-free; served from the calling worker's snapshot when attached.
+     * While a background recovery is still running the answer comes from
+     * the path's metadata record instead (cache, then RocksDB).
+     */
+    bool isIndexedPath(std::string_view path) const;
+
+    /**
+     * Valid once warmupStatus().ready; see waitUntilReady().
+     */
+    const RecoveryStats& recoveryStats() const { return recovery_stats_; }
+
+    WarmupStatus warmupStatus() const;
+
+    /**
+     * Durable writes issued in IMMEDIATE mode and the fsyncs they shared.
+     */
+    GroupCommitStats groupCommitStats() const { return group_commit_->stats(); }
+
+    /**
+     * Write-behind flushers (BATCH mode), merged across workers: counts and
+     * rates are summed; limits, windows and percentiles are the worst
+     * worker's (an upper bound on the merged distribution).
+     */
+    FlushStats flushStats() const;
+    size_t writeWorkerCount() const { return write_workers_.size(); }
+
+    /**
+     * Cache misses handed to the read I/O threads by read_version_async.
+     */
+    IoPoolStats readIoStats() const { return read_pool_->stats(); }
+
+    /**
+     * Cache-miss loads: RocksDB reads run (loads) and misses that attached
+     * to another caller's load instead (shared), blocking and async alike.
+     */
+    SingleFlightStats missLoadStats() const;
+
+    /**
+     * RocksDB point lookups issued so far.
+     */
+    uint64_t storageReads() const { return rocksdb_persistence_->pointReads(); }
+
+    /**
+     * Tombstones of missing paths: hits, expirations, write invalidations.
+     */
+    NegativeCacheStats negativeCacheStats() const { return negative_cache_->stats(); }
+
+    /**
+     * Changes every flusher's p99 lag target and batch cap at runtime.
+     */
+    void setFlushPolicy(const FlushPolicy& policy);
+
+    /**
+     * Blocks until startup recovery has finished. Returns immediately
+     * unless RecoveryOptions::background was set.
+     */
+    void waitUntilReady();
+
+    /**
+     * Changes the mount-level history limit. Keys over the new limit are
+     * trimmed on their next write or by compactVersionHistory().
+     */
+    void setMaxVersions(uint32_t max_versions);
+    uint32_t maxVersions() const { return max_versions_.load(std::memory_order_relaxed); }
+
+    /**
+     * Sets a per-key history limit (0 = use the mount limit) and trims the
+     * key's history down to it right away.
+     */
+    tl::expected<void, EngineError> set_max_versions(std::string_view path, uint32_t max_versions);
+
+    /**
+     * Trims every key whose history exceeds its limit: the oldest versions
+     * are dropped from the metadata and their payloads deleted. Runs once on
+     * a background thread after startup recovery.
+     * @return Number of versions pruned.
+     */
+    size_t compactVersionHistory();
+
+    /**
+     * Destroys every path starting with prefix: metadata and all versions
+     * go, as if never written. Two range tombstones over the prefix's
+     * metadata and payload keys, fsynced, replace a read-modify-write and deletes per path;
+     * cached heads and payloads are dropped shard by shard and the paths
+     * leave the index in one publication. Writers are held off meanwhile.
+     * Waits for startup recovery first.
+     * A prefix names a directory: one not ending in '/' has it appended,
+     * so apps/old never reaches apps/older. An empty prefix is refused
+     * (InvalidVersion) rather than wiping every path.
+     * @return Paths destroyed (those the index listed as live).
+     */
+    tl::expected<size_t, EngineError> destroyPrefix(std::string_view prefix);
+
+    using DestroyResult = tl::expected<size_t, EngineError>;
+    using DestroyCallback = std::function<void(DestroyResult)>;
+
+    /**
+     * Runs destroyPrefix on the write pool: settled in place only when the
+     * pool is full (QueueFull).
+     */
+    std::optional<DestroyResult> destroyPrefixAsync(std::string prefix, DestroyCallback done);
+
+    // put_many items staged under one set of path locks: bounds the stripes held at once
+    static constexpr size_t put_many_chunk = 32;
+
     // --- ISecretEngine interface (V2) ---
     tl::expected<SecretPayload, EngineError> read_version(std::string_view path, uint32_t version = 0) override;
+    std::optional<ReadResult> read_version_async(std::string_view path, uint32_t version, ReadCallback done) override;
+    std::vector<ReadResult> read_many(std::span<const std::string> paths) override;
+    std::optional<std::vector<ReadResult>> read_many_async(std::span<const std::string> paths, ReadManyCallback done) override;
     tl::expected<KeyMetadata, EngineError> read_metadata(std::string_view path) override;
     tl::expected<void, EngineError> put_version(std::string_view path, const SecretPayload& payload, std::optional<uint32_t> cas = std::nullopt) override;
+    std::vector<WriteResult> put_many(std::span<const PathPayload> items) override;
+
+    /**
+     * Checks and stages every step under the locks of all its paths, then
+     * commits the writes as one fsynced WriteBatch and publishes the new
+     * heads. A read_many of several of its paths sees all of it or none of
+     * it (see publish_seqs_). In BATCH mode the paths' write-behind workers
+     * are first drained of the writes queued before it, which the commit
+     * must not be overtaken by.
+     */
+    TxnResult transact(std::span<const TxnOp> ops) override;
+
+    /**
+     * Runs transact on the write pool: never settled in place.
+     */
+    std::optional<TxnResult> transact_async(std::vector<TxnOp> ops, TxnCallback done) override;
+    tl::expected<WriteTicket, EngineError> put_version_durable(std::string_view path, const SecretPayload& payload, std::optional<uint32_t> cas = std::nullopt) override;
+    void whenDurable(const WriteTicket& ticket, std::function<void(bool durable)> callback) override;
     tl::expected<void, EngineError> soft_delete(std::string_view path, uint32_t version) override;
     tl::expected<void, EngineError> destroy_version(std::string_view path, uint32_t version) override;
     std::string engineType() const override { return "kv"; }
@@ -40,30 +261,283 @@ public:
     void forceFlush() override;
 
 private:
-    std::unique_ptr<ShardedCuckooTable> storage_;
+    /**
+     * One record of a write. A payload is referenced, not copied: the same
+     * buffer is held by the payload cache and the path's head.
+     */
+    struct WriteOp {
+        RocksDBStorage::BatchOp::Type type;
+        std::string key;
+        SharedBytes shared{}; // Payload records
+        std::string value{};  // Other records (metadata), owned
+        std::string_view bytes() const { return shared ? std::string_view(*shared) : std::string_view(value); }
+    };
+    using WriteOps = std::vector<WriteOp>;
+
+    std::unique_ptr<ShardedCuckooTable> payload_cache_; // Serialized payloads, by version key
+    std::unique_ptr<HeadCache> head_cache_;        // Metadata + latest payload, by path
     std::unique_ptr<TlsBTreeManager> path_index_;
     std::unique_ptr<RocksDBStorage> rocksdb_persistence_;
+    std::unique_ptr<GroupCommitter> group_commit_;  // IMMEDIATE-mode writes
+    std::unique_ptr<IoPool> read_pool_;             // read_version_async cache misses
+    std::unique_ptr<IoPool> write_pool_;            // Fsync-bound writes off the event loops: transact_async, destroyPrefixAsync
+    std::unique_ptr<NegativeCache> negative_cache_; // Recently missing paths
+
+    // Single-flight cache-miss loads: metadata by path, payloads by version key,
+    // and queued async reads by (path, version)
+    bool coalesce_misses_ = true;
+    SingleFlight<tl::expected<HeadPtr, EngineError>> head_loads_;
+    SingleFlight<tl::expected<SharedBytes, EngineError>> payload_loads_;
+    SingleFlight<ReadResult> async_reads_;
+
+    // Bumped by destroyPrefix once its range deletes are written; see cacheLoadedHead
+    std::atomic<uint64_t> prefix_destroys_{0};
 
     std::atomic<SyncMode> sync_mode_{SyncMode::IMMEDIATE};
+    std::atomic<uint32_t> max_versions_;
+    RecoveryStats recovery_stats_;
+
+    // Serializes metadata read-modify-write per path (put, soft delete, destroy).
+    // 4096 stripes x 64 B = 256 KB; distinct paths collide with probability 1/4096.
+    StripedMutex<4096> path_write_locks_;
+
+    // Per path_write_locks_ stripe, bumped by its holder: odd while a
+    // transaction commits and publishes paths of the stripe. read_many
+    // retries a read that overlapped one: it sees all of it or none of it.
+    std::array<std::atomic<uint64_t>, decltype(path_write_locks_)::stripeCount()> publish_seqs_{};
+
+    // --- Startup recovery (serve-while-warming) and history compaction ---
+    std::thread recovery_thread_;
+    std::thread compaction_thread_;
+    std::mutex compaction_mutex_; // One compaction pass at a time: COMPACT waits for the startup pass
+    std::atomic<bool> background_cancelled_{false};
+    std::atomic<bool> index_ready_{false};
+    std::atomic<size_t> recovery_ranges_done_{0};
+    std::atomic<size_t> recovery_ranges_total_{0};
+    std::atomic<size_t> recovery_paths_{0};
+    std::mutex warmup_mutex_;
+    std::condition_variable warmup_cv_;
+    std::vector<std::pair<std::string, bool>> warmup_index_ops_; // (path, live) in write order
+
+    static constexpr size_t default_payload_cache_size = 2097152;
+    static constexpr size_t default_head_cache_size = 2097152;
+    static constexpr int default_btree_degree = 16; // <= 31 keys: 8-byte heads fit in 4 cache lines
+    static constexpr size_t write_pool_threads = 2;
+    static constexpr size_t write_pool_pending = 4096;
+
+    // WriteBatch size of the format migrations
+    static constexpr size_t migration_batch_ops = 2048;
+
+    /**
+     * Rewrites the records of a format 1 database ("m:" / "v:" text keys)
+     * under format 2 keys (see key_codec.hpp), then records the format.
+     * Runs once, before recovery. Version keys that do not parse are
+     * counted, logged and left in place. Throws if the rewrite fails or
+     * the database records a key format newer than this build's.
+     * @return Records migrated.
+     */
+    size_t migrateKeyFormat();
+
+    /**
+     * Re-encodes format 1 metadata records (raw VersionState memory) in
+     * the compact format 2 (see metadata_codec.hpp). Runs once, after
+     * migrateKeyFormat. Records that do not decode are counted, logged
+     * and left in place. Stops at the first batch that fails to write, so
+     * the resume marker never passes a record still in format 1; then throws.
+     * @return Records migrated.
+     */
+    size_t migrateMetadataFormat();
+
+    /**
+     * Rebuilds the path index from the metadata records only. Key ranges are
+     * scanned in parallel, each yielding a sorted run; the runs are
+     * concatenated and the index is bulk-built in one pass.
+     */
+    void recoverPathIndex(const RecoveryOptions& options);
+
+    /**
+     * Adds (live) or drops a path in the index. Until recovery is done the
+     * update is logged instead and replayed on top of the bulk-built index,
+     * which would otherwise discard it.
+     */
+    void updatePathIndex(std::string_view path, bool live);
+
+    /**
+     * Cached head of path; on a miss decodes the metadata record once and caches
+     * it without a payload. Never overwrites a newer head published meanwhile.
+     */
+    tl::expected<HeadPtr, EngineError> loadHead(std::string_view path);
+    tl::expected<HeadPtr, EngineError> loadHeadFromDisk(std::string_view path);
+
+    /**
+     * Caches a head read from disk unless one is already cached. destroys
+     * is prefix_destroys_ as loaded before the read: if a prefix destroy
+     * has since emptied the cache, the head is taken back out.
+     */
+    void cacheLoadedHead(std::string_view path, const HeadPtr& head, uint64_t destroys);
+
+    /**
+     * Persists head.meta together with ops (payload PUTs/DELs of the same
+     * operation) as one atomic batch, then publishes head as the path's
+     * cached head.
+     */
+    tl::expected<WriteTicket, EngineError> storeHead(std::string_view path, PathHead head, WriteOps ops = {},
+                                                     bool durable = false);
+
+    /**
+     * Makes head the path's cached head, once its write is queued or committed.
+     */
+    void publishHead(std::string_view path, PathHead head);
 
-    static constexpr size_t default_cuckoo_size = 2097152;
-    static constexpr int default_btree_degree = 100;
+    /**
+     * Appends a new version holding payload to head (latest included),
+     * caches its serialized payload and adds its PUT, plus the DELs of the
+     * versions trimmed to make room, to ops. @return The new version.
+     */
+    uint32_t stageVersion(std::string_view path, PathHead& head, const SecretPayload& payload, WriteOps& ops);
+
+    /**
+     * put_many of at most put_many_chunk items: staged under their path
+     * locks, written as one record per worker (one group commit in
+     * IMMEDIATE mode), then published.
+     */
+    void putManyChunk(std::span<const PathPayload> items, std::span<WriteResult> results);
+
+    /**
+     * Drops the oldest versions beyond the key's effective limit (its own
+     * max_versions, else the mount's). The current version is never dropped.
+     * @return The dropped versions.
+     */
+    std::vector<VersionState> trimVersionHistory(KeyMetadata& meta) const;
+
+    // Versions a key keeps: its own max_versions, else the mount's (0: unlimited)
+    uint32_t versionLimit(uint32_t key_max_versions) const;
+
+    /**
+     * Adds DELs of the trimmed versions' payloads to ops and evicts them
+     * from the cache. Committed in the same batch as the trimmed metadata.
+     */
+    void deletePrunedPayloads(std::string_view path, const std::vector<VersionState>& pruned, WriteOps& ops);
+
+    /**
+     * Trims one key under its write lock. @return Number of versions pruned.
+     */
+    size_t compactPath(std::string_view path);
+
+    /**
+     * put_version; durable marks its write-behind record for an fsynced flush.
+     */
+    tl::expected<WriteTicket, EngineError> putVersion(std::string_view path, const SecretPayload& payload,
+                                                      std::optional<uint32_t> cas, bool durable);
+
+    /**
+     * read_version from the caches alone. nullopt: answering needs RocksDB.
+     */
+    std::optional<ReadResult> readVersionCached(std::string_view path, uint32_t version);
+
+    /**
+     * read_many from the caches alone, heads looked up shard by shard.
+     * Sets results[i] for every path memory answers and heads[i] to the
+     * cached head (if any) of the others. @return Paths left unanswered.
+     */
+    size_t readManyCached(std::span<const std::string> paths, std::vector<HeadPtr>& heads,
+                          std::vector<std::optional<ReadResult>>& results);
+
+    /**
+     * read_many without the publication check: caches, then RocksDB.
+     */
+    std::vector<ReadResult> readManyUnchecked(std::span<const std::string> paths);
+
+    /**
+     * Seqlock read side over the stripes of paths (see publish_seqs_).
+     * stampPublishes fills stamp, or returns false if a transaction is
+     * publishing one of them; publishesUnchanged then tells whether one
+     * published meanwhile. A single path is always read whole: no stamp.
+     */
+    bool stampPublishes(std::span<const std::string> paths, std::vector<uint64_t>& stamp) const;
+    bool publishesUnchanged(std::span<const std::string> paths, const std::vector<uint64_t>& stamp) const;
+
+    /**
+     * Two-step read of one version's serialized payload: payload cache, then RocksDB.
+     */
+    tl::expected<SharedBytes, EngineError> readPayload(std::string_view path, uint32_t version);
 
     void checkAndSync();
     std::string buildFullKey(const std::string& path, const std::string& key) const;
 
     // --- Background I/O Worker for Eventual Consistency ---
-    struct AsyncOp {
-        enum class Type { PUT, DEL } type;
-        std::string key;
-        std::string value;
+
+    /**
+     * One write-behind I/O thread and the queue it alone drains. Each queued
+     * record is one whole write: its enqueue time and every BatchOp it
+     * commits. A path always maps to the same worker, so its records reach
+     * RocksDB in order; different workers' WriteBatches run concurrently
+     * (concurrent memtable writes). An idle worker sleeps on its eventfd;
+     * producers signal it only while it is parked.
+     *
+     * A record's ring sequence number doubles as its durability ticket.
+     * A batch holding a durable record is fsynced, which also covers every
+     * write before it in the WAL; durable then advances to the batch's
+     * release position and the waiters it passes are called.
+     */
+    struct WriteBehindWorker {
+        explicit WriteBehindWorker(const WriteBehindOptions& options)
+            : queue(options.queue_bytes), scheduler(options.flush) {}
+
+        RecordRing queue;
+        FlushScheduler scheduler;
+        int event_fd = -1;
+        std::atomic<bool> parked{false};
+        std::thread thread;
+
+        std::atomic<uint64_t> durable{0};  // Every sequence up to this is on disk
+        std::mutex waiters_mutex;
+        std::vector<std::pair<uint64_t, std::function<void(bool)>>> waiters; // (sequence, callback)
     };
-    LockFreeQueue<AsyncOp, 262144> async_queue_;
-    std::thread async_worker_;
+    std::vector<std::unique_ptr<WriteBehindWorker>> write_workers_;
     std::atomic<bool> async_running_{true};
 
-    void asyncWorkerLoop();
-    tl::expected<void, EngineError> enqueueOrExecute(AsyncOp::Type type, const std::string& key, const std::string& value = "");
+    size_t workerFor(std::string_view path) const; // Index into write_workers_
+    void asyncWorkerLoop(WriteBehindWorker& worker);
+
+    /**
+     * nullopt: sleeps until a producer signals (returns at once if the
+     * queue is not empty). Otherwise sleeps for timeout, shutdown aside.
+     */
+    void parkFlusher(WriteBehindWorker& worker, std::optional<std::chrono::microseconds> timeout);
+    void wakeFlusher(WriteBehindWorker& worker);
+
+    /**
+     * Writes the records peeked so far (batch views into the queue) as one
+     * WriteBatch, frees them and reports the flush to the worker's scheduler.
+     * sync: fsync the batch and advance the worker's durable watermark.
+     */
+    void flushBatch(WriteBehindWorker& worker, std::vector<RocksDBStorage::BatchOpView>& batch, size_t& records,
+                    std::chrono::steady_clock::time_point oldest, bool& sync);
+
+    /**
+     * After an fsynced flush up to position: publishes it as the worker's
+     * watermark (if written) and calls the waiters it covers with written.
+     */
+    void publishDurable(WriteBehindWorker& worker, uint64_t position, bool written);
+
+    /**
+     * IMMEDIATE: commits ops as one durable batch through the group
+     * committer. BATCH: hands them to path's write-behind worker, marked
+     * for an fsynced flush if durable.
+     * @return The write's ticket; sequence 0 when already durable.
+     */
+    tl::expected<WriteTicket, EngineError> enqueueOrExecute(std::string_view path, WriteOps ops, bool durable = false);
+
+    // The two halves of enqueueOrExecute: IMMEDIATE commit, BATCH enqueue on one worker
+    bool commitImmediate(const WriteOps& ops);
+    tl::expected<WriteTicket, EngineError> enqueueOn(size_t stream, const WriteOps& ops, bool durable);
+
+    /**
+     * Blocks until every record queued so far on streams is fsynced: an
+     * empty durable record is queued on each and waited for.
+     */
+    tl::expected<void, EngineError> drainWorkers(std::span<const size_t> streams);
 };
 
 // Compile-time contract validation
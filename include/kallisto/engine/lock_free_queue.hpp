@@ -1,82 +0,0 @@
-#pragma once
-
-#include <atomic>
-#include <array>
-#include <cstdint>
-
-namespace kallisto::engine {
-
-/**
- * LockFreeQueue - Dmitry Vyukov's MPMC Lock-Free Queue.
- *
- * Role: Provides ultra-low latency lock-free message passing.
- * Eliminates all OS context switches, mutexes, and cond_vars on the hot path.
- * 
- * Capacity MUST be a power of 2.
- */
-template <typename T, size_t Capacity>
-class LockFreeQueue {
-    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
-
-    struct alignas(64) Node {
-        std::atomic<size_t> sequence;
-        T data;
-    };
-
-    alignas(64) std::array<Node, Capacity> buffer_;
-    alignas(64) std::atomic<size_t> enqueue_pos_{0};
-    alignas(64) std::atomic<size_t> dequeue_pos_{0};
-
-public:
-    LockFreeQueue() {
-        for (size_t i = 0; i < Capacity; ++i) {
-            buffer_[i].sequence.store(i, std::memory_order_relaxed);
-        }
-    }
-
-    bool enqueue(T&& data) {
-        Node* cell;
-        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
-        for (;;) {
-            cell = &buffer_[pos & (Capacity - 1)];
-            size_t seq = cell->sequence.load(std::memory_order_acquire);
-            intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
-            if (dif == 0) {
-                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
-                    break;
-                }
-            } else if (dif < 0) {
-                return false; // Queue full
-            } else {
-                pos = enqueue_pos_.load(std::memory_order_relaxed);
-            }
-        }
-        cell->data = std::move(data);
-        cell->sequence.store(pos + 1, std::memory_order_release);
-        return true;
-    }
-
-    bool dequeue(T& data) {
-        Node* cell;
-        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
-        for (;;) {
-            cell = &buffer_[pos & (Capacity - 1)];
-            size_t seq = cell->sequence.load(std::memory_order_acquire);
-            intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
-            if (dif == 0) {
-                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
-                    break;
-                }
-            } else if (dif < 0) {
-                return false; // Queue empty
-            } else {
-                pos = dequeue_pos_.load(std::memory_order_relaxed);
-            }
-        }
-        data = std::move(cell->data);
-        cell->sequence.store(pos + Capacity, std::memory_order_release);
-        return true;
-    }
-};
-
-} // namespace kallisto::engine
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "kallisto/engine/i_secret_engine.hpp"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace kallisto::engine {
+
+/**
+ * On-disk encoding of KeyMetadata (format 2).
+ *
+ *   u8      format (= metadata_format_version)
+ *   varint  current_version
+ *   varint  max_versions
+ *   u8      flags (bit 0: cas_required)
+ *   varint  delete_version_after_ms
+ *   varint  version count n
+ *   bytes   ceil(2n / 8): per version, bit 2i = soft-deleted, 2i+1 = destroyed
+ *   n x     varint  version_id - previous version_id (the first: from 0)
+ *           varint  zigzag(created_time_ms - previous created_time_ms)
+ *           varint  zigzag(deletion_time_ms - created_time_ms), soft-deleted only
+ *
+ * Deltas wrap modulo 2^32 (ids) and 2^64 (timestamps): any history
+ * round-trips, and the usual ascending one costs a few bytes per version.
+ * Scalars and the version count come first: deserializeMetadataHeader
+ * reads them without decoding the history.
+ *
+ * Format 1 was the header fields and the VersionState array copied as
+ * raw host-endian memory, padding included: 24 bytes per version.
+ */
+
+inline constexpr uint8_t metadata_format_version = 2;
+
+// Internal record holding metadata_format_version; see KvEngine::migrateMetadataFormat
+inline constexpr std::string_view metadata_format_key{"\x00meta-format", 12};
+
+std::string serializeMetadata(const KeyMetadata& meta);
+
+/**
+ * @return nullopt if data is not a complete format 2 record.
+ */
+std::optional<KeyMetadata> deserializeMetadata(std::string_view data);
+
+/**
+ * The fields ahead of the history, for scans that only filter records.
+ */
+struct MetadataHeader {
+    uint32_t current_version = 0;
+    uint32_t max_versions = 0;
+    bool cas_required = false;
+    uint64_t delete_version_after_ms = 0;
+    size_t version_count = 0;
+};
+
+/**
+ * Decodes the header alone; the history is not checked.
+ * @return nullopt if data does not start with a well-formed format 2 header.
+ */
+std::optional<MetadataHeader> deserializeMetadataHeader(std::string_view data);
+
+/**
+ * Format 1 codec, as older builds wrote it on this host. The encoder only
+ * builds migration fixtures and size comparisons; the decoder rejects a
+ * record shorter than its version count says.
+ */
+std::string serializeLegacyMetadata(const KeyMetadata& meta);
+std::optional<KeyMetadata> deserializeLegacyMetadata(std::string_view data);
+
+} // namespace kallisto::engine
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace kallisto::engine {
+
+/**
+ * Counters of a NegativeCache since construction.
+ */
+struct NegativeCacheStats {
+    uint64_t hits = 0;          // Lookups answered NotFound from memory
+    uint64_t inserts = 0;       // Tombstones recorded
+    uint64_t invalidations = 0; // Tombstones dropped by a write to their path
+    uint64_t expired = 0;       // Tombstones dropped after their TTL
+    uint64_t rejected = 0;      // Inserts refused: shard full, or raced with a write
+    size_t size = 0;            // Tombstones held, expired ones included
+};
+
+/**
+ * NegativeCache — Bounded, time-limited record of paths known to be absent.
+ *
+ * Role: Absence is never cached by the head cache, so a client retrying a
+ * missing path in a loop costs one RocksDB Get per request. A tombstone
+ * answers such lookups NotFound from memory until it expires (ttl) or a
+ * write creates the path.
+ *
+ * A reader that finds a path missing on disk may race with the write that
+ * creates it. Each shard carries a generation bumped by every invalidation:
+ * the reader takes generation() before its RocksDB read and insert() only
+ * records the tombstone if no write to the shard happened since.
+ *
+ * Same sharding as SharedCache: 64 shards, each behind its own mutex. A full
+ * shard first drops its expired tombstones, then refuses new ones.
+ */
+class NegativeCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t num_shards = 64;
+
+    /**
+     * @param capacity Maximum number of tombstones, split evenly across shards.
+     * @param ttl How long a tombstone answers; zero disables the cache.
+     */
+    NegativeCache(size_t capacity, std::chrono::milliseconds ttl);
+
+    NegativeCache(const NegativeCache&) = delete;
+    NegativeCache& operator=(const NegativeCache&) = delete;
+
+    bool enabled() const { return ttl_.count() > 0; }
+
+    /**
+     * @return true if key has a live tombstone. An expired one is dropped.
+     */
+    bool contains(std::string_view key, Clock::time_point now = Clock::now());
+
+    /**
+     * Snapshot to pass to insert(), taken before reading key from disk.
+     */
+    uint64_t generation(std::string_view key) const;
+
+    /**
+     * Records key as absent until now + ttl, unless key's shard was
+     * invalidated since generation was taken.
+     * @return true if the tombstone was recorded.
+     */
+    bool insert(std::string_view key, uint64_t generation, Clock::time_point now = Clock::now());
+
+    /**
+     * Drops key's tombstone, if any, and fails in-flight inserts to its shard.
+     * Call after the write that creates key is visible to readers.
+     */
+    void invalidate(std::string_view key);
+
+    NegativeCacheStats stats() const;
+
+private:
+    struct KeyHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view key) const { return std::hash<std::string_view>{}(key); }
+    };
+
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::atomic<uint64_t> generation{0};
+        std::unordered_map<std::string, Clock::time_point, KeyHash, std::equal_to<>> expiries;
+    };
+
+    Shard& shardFor(std::string_view key) const;
+
+    // Drops the shard's expired tombstones. Shard lock held.
+    void sweep(Shard& shard, Clock::time_point now);
+
+    std::unique_ptr<std::array<Shard, num_shards>> shards_;
+    size_t shard_capacity_;
+    std::chrono::milliseconds ttl_;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> inserts_{0};
+    std::atomic<uint64_t> invalidations_{0};
+    std::atomic<uint64_t> expired_{0};
+    std::atomic<uint64_t> rejected_{0};
+    std::atomic<size_t> size_{0};
+};
+
+} // namespace kallisto::engine
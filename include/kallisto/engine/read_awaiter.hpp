@@ -0,0 +1,54 @@
+#pragma once
+
+#include "kallisto/engine/i_secret_engine.hpp"
+#include <coroutine>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace kallisto::engine {
+
+/**
+ * ReadVersionAwaiter — co_await adapter over ISecretEngine::read_version_async.
+ *
+ *   ReadResult r = co_await readVersion(engine, "app/db");
+ *
+ * A read memory can answer completes without suspending. A miss suspends
+ * the coroutine and resumes it on the engine's I/O thread that finished
+ * the read; a coroutine bound to an event loop should post itself back
+ * (e.g. co_await a Dispatcher::post awaiter) before touching loop state.
+ */
+class ReadVersionAwaiter {
+public:
+    ReadVersionAwaiter(ISecretEngine& engine, std::string_view path, uint32_t version)
+        : engine_(engine), path_(path), version_(version) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+        auto cached = engine_.read_version_async(path_, version_, [this, handle](ReadResult result) {
+            result_ = std::move(result);
+            handle.resume();
+        });
+        if (!cached) {
+            // The I/O thread owns the resumption; *this may already be gone
+            return true;
+        }
+        result_ = std::move(*cached);
+        return false;
+    }
+
+    ReadResult await_resume() { return std::move(*result_); }
+
+private:
+    ISecretEngine& engine_;
+    std::string path_;
+    uint32_t version_;
+    std::optional<ReadResult> result_;
+};
+
+inline ReadVersionAwaiter readVersion(ISecretEngine& engine, std::string_view path, uint32_t version = 0) {
+    return ReadVersionAwaiter(engine, path, version);
+}
+
+} // namespace kallisto::engine
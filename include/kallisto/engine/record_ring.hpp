@@ -0,0 +1,166 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace kallisto::engine {
+
+/**
+ * RecordRing — Byte-oriented MPSC ring of variable-length records.
+ *
+ * Role: Write-behind queue between request threads and one flush worker.
+ * A record is stored in place as an 8-byte header followed by its bytes,
+ * padded to 8. Producers reserve space with one CAS on the tail and write
+ * the record directly into the ring: no per-record allocation, and the
+ * footprint is the byte capacity, however many records it holds.
+ *
+ * Records never wrap: one that does not fit before the end of the buffer
+ * is preceded by a padding record up to the end. A header is published
+ * (release) only once its bytes are written, so records become visible in
+ * reservation order even when producers finish out of order.
+ *
+ * The consumer reads in two steps: peek() visits committed records without
+ * freeing them, so the bytes can be handed to RocksDB as slices; release()
+ * then frees everything visited so far.
+ *
+ * Positions are byte offsets counted from the ring's creation, never
+ * wrapped: a record's end position is its sequence number, increasing in
+ * queue order, and a record is released once the release position reaches it.
+ */
+class RecordRing {
+public:
+    // Largest capacity: a record's size must fit the header's 30-bit size field
+    static constexpr size_t max_capacity = size_t{512} << 20;
+
+    /**
+     * @param capacity_bytes Rounded up to a power of two, at least 4 KB.
+     * The buffer is calloc'ed: pages are only touched as records reach them.
+     * @throws std::length_error if capacity_bytes exceeds max_capacity.
+     */
+    explicit RecordRing(size_t capacity_bytes);
+
+    RecordRing(const RecordRing&) = delete;
+    RecordRing& operator=(const RecordRing&) = delete;
+
+    size_t capacity() const { return capacity_; }
+
+    /**
+     * Largest record push() accepts. Half the capacity, so an empty ring
+     * accepts any record wherever its tail is.
+     */
+    size_t maxRecordSize() const { return capacity_ / 2 - header_size; }
+
+    // --- Producers (any thread) ---
+
+    /**
+     * Reserves size bytes and calls fill(std::byte* dst) to write them.
+     * @return The record's sequence number (its end position, never 0), or
+     * 0 if the ring is full or size exceeds maxRecordSize().
+     */
+    template <typename Fill>
+    uint64_t push(size_t size, Fill&& fill) {
+        uint64_t end;
+        auto slot = reserve(size, end);
+        if (!slot) {
+            return 0;
+        }
+        fill(slot + header_size);
+        commit(slot, size);
+        return end;
+    }
+
+    // --- Consumer (one thread) ---
+
+    /**
+     * Calls visit(std::span<const std::byte>) on up to max_records committed
+     * records following the last one visited. The spans stay valid until release().
+     * @return Number of records visited.
+     */
+    template <typename Visit>
+    size_t peek(size_t max_records, Visit&& visit) {
+        size_t visited = 0;
+        while (visited < max_records && !allVisited()) {
+            const uint32_t state = headerAt(read_pos_).load(std::memory_order_acquire);
+            if ((state & committed_bit) == 0) {
+                break;
+            }
+            if (state & padding_bit) {
+                read_pos_ += capacity_ - (read_pos_ & mask_);
+                continue;
+            }
+            const size_t size = state & size_mask;
+            visit(std::span<const std::byte>(buffer_.get() + (read_pos_ & mask_) + header_size, size));
+            read_pos_ += footprint(size);
+            ++visited;
+        }
+        visited_ += visited;
+        return visited;
+    }
+
+    /**
+     * Frees the records visited by peek() for reuse by producers.
+     * @return The release position: every record whose sequence number is
+     * at most this has been released.
+     */
+    uint64_t release();
+
+    /**
+     * @return true if no committed record follows the last one visited.
+     * Consumer only.
+     */
+    bool empty() const;
+
+    /**
+     * Records pushed and not yet released; exact only when no operation is in flight.
+     */
+    size_t sizeApprox() const;
+
+    /**
+     * Bytes reserved and not yet released, headers and padding included.
+     */
+    size_t bytesApprox() const;
+
+private:
+    static constexpr size_t header_size = 8;
+    static constexpr uint32_t committed_bit = 1u << 31;
+    static constexpr uint32_t padding_bit = 1u << 30;
+    static constexpr uint32_t size_mask = padding_bit - 1;
+    static_assert(max_capacity / 2 <= size_mask, "maxRecordSize() must fit the size field");
+
+    struct FreeDeleter {
+        void operator()(std::byte* p) const;
+    };
+
+    static size_t footprint(size_t size) { return header_size + ((size + 7) & ~size_t{7}); }
+
+    std::atomic_ref<uint32_t> headerAt(uint64_t pos) const {
+        return std::atomic_ref<uint32_t>(*reinterpret_cast<uint32_t*>(buffer_.get() + (pos & mask_)));
+    }
+
+    // Every byte up to head_ + capacity_ visited: the header at read_pos_ is the head's
+    bool allVisited() const { return read_pos_ - head_.load(std::memory_order_relaxed) == capacity_; }
+
+    std::byte* reserve(size_t size, uint64_t& end);
+    void commit(std::byte* slot, size_t size);
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<std::byte[], FreeDeleter> buffer_;
+
+    // Producers: next free byte, records committed
+    alignas(64) std::atomic<uint64_t> tail_{0};
+    std::atomic<uint64_t> pushed_{0};
+
+    // Consumer: first unreleased byte (published), records released
+    alignas(64) std::atomic<uint64_t> head_{0};
+    std::atomic<uint64_t> released_{0};
+
+    // Consumer-private cursor
+    alignas(64) uint64_t read_pos_ = 0;
+    uint64_t visited_ = 0;
+};
+
+} // namespace kallisto::engine
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace kallisto::engine {
+
+/**
+ * Counters of a SingleFlight since construction.
+ */
+struct SingleFlightStats {
+    uint64_t loads = 0;  // Loads actually run (leaders)
+    uint64_t shared = 0; // Callers served by another caller's load
+};
+
+/**
+ * SingleFlight — At most one load per key in flight.
+ *
+ * Role: When a hot key is missing from the cache, every caller would read
+ * the same record from RocksDB and insert it. Here the first caller to
+ * miss becomes the key's leader and runs the load; callers arriving while
+ * it runs attach to the flight and get its result instead of loading.
+ * The flight ends when its result is published, so a later miss (after an
+ * eviction, say) starts a fresh load.
+ *
+ * Callers either block (run) or register a callback (join + complete),
+ * and both kinds can share one flight. Same sharding as SharedCache: 64
+ * shards, each a mutex and a map of the keys in flight.
+ */
+template <typename Result>
+class SingleFlight {
+public:
+    using Callback = std::function<void(const Result&)>;
+
+    static constexpr size_t num_shards = 64;
+
+    /**
+     * Blocking: returns load()'s result, running it only if no load of key
+     * is in flight; otherwise waits for that load and returns its result.
+     * If load() throws, the flight ends and every caller blocked on it
+     * rethrows the exception. Callbacks attached by join() cannot take an
+     * exception and are dropped: only share a key with join() callers if
+     * load() does not throw.
+     */
+    template <typename Load>
+    Result run(std::string_view key, Load&& load) {
+        auto [flight, leader] = attach<Callback>(key, nullptr);
+        if (leader) {
+            std::optional<Result> result;
+            try {
+                result.emplace(load());
+            } catch (...) {
+                abandon(key, flight, std::current_exception());
+                throw;
+            }
+            publish(key, flight, *result);
+            return std::move(*result);
+        }
+        std::unique_lock lock(flight->mutex);
+        flight->cv.wait(lock, [&]() { return flight->result.has_value() || flight->exception; });
+        if (flight->exception) {
+            std::rethrow_exception(flight->exception);
+        }
+        return *flight->result;
+    }
+
+    /**
+     * Non-blocking. If a load of key is in flight, done(result) is called
+     * with its result, from the thread that publishes it.
+     * done is moved from only then.
+     * @return true if the caller is the leader instead: done is left alone,
+     * and the caller must run the load and hand its result to complete(key, result).
+     */
+    template <typename Done>
+    bool join(std::string_view key, Done& done) {
+        return attach(key, &done).second;
+    }
+
+    /**
+     * Ends the flight a join() leader started: every waiter gets result.
+     */
+    void complete(std::string_view key, const Result& result) {
+        Shard& shard = shardFor(key);
+        std::shared_ptr<Flight> flight;
+        {
+            std::lock_guard lock(shard.mutex);
+            auto it = shard.flights.find(key);
+            if (it == shard.flights.end()) {
+                return;
+            }
+            flight = it->second;
+        }
+        publish(key, flight, result);
+    }
+
+    SingleFlightStats stats() const {
+        return SingleFlightStats{loads_.load(std::memory_order_relaxed), shared_.load(std::memory_order_relaxed)};
+    }
+
+private:
+    struct Flight {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::optional<Result> result;
+        std::exception_ptr exception; // Set instead of result if the leader's load threw
+        std::vector<Callback> callbacks;
+    };
+
+    struct KeyHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view key) const { return std::hash<std::string_view>{}(key); }
+    };
+
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::shared_ptr<Flight>, KeyHash, std::equal_to<>> flights;
+    };
+
+    Shard& shardFor(std::string_view key) {
+        return shards_[std::hash<std::string_view>{}(key) % num_shards];
+    }
+
+    // Joins key's flight, starting one if there is none. @return (flight, leader)
+    template <typename Done>
+    std::pair<std::shared_ptr<Flight>, bool> attach(std::string_view key, Done* done) {
+        Shard& shard = shardFor(key);
+        std::lock_guard lock(shard.mutex);
+        auto it = shard.flights.find(key);
+        if (it != shard.flights.end()) {
+            shared_.fetch_add(1, std::memory_order_relaxed);
+            if (done) {
+                std::lock_guard flight_lock(it->second->mutex);
+                it->second->callbacks.emplace_back(std::move(*done));
+            }
+            return {it->second, false};
+        }
+        auto flight = std::make_shared<Flight>();
+        shard.flights.emplace(std::string(key), flight);
+        loads_.fetch_add(1, std::memory_order_relaxed);
+        return {flight, true};
+    }
+
+    // Unlists flight, unless a completion already did: a caller arriving
+    // from now on starts a new load
+    void unlist(std::string_view key, const std::shared_ptr<Flight>& flight) {
+        Shard& shard = shardFor(key);
+        std::lock_guard lock(shard.mutex);
+        auto it = shard.flights.find(key);
+        if (it != shard.flights.end() && it->second == flight) {
+            shard.flights.erase(it);
+        }
+    }
+
+    void abandon(std::string_view key, const std::shared_ptr<Flight>& flight, std::exception_ptr exception) {
+        unlist(key, flight);
+        {
+            std::lock_guard lock(flight->mutex);
+            flight->exception = std::move(exception);
+            flight->callbacks.clear();
+        }
+        flight->cv.notify_all();
+    }
+
+    void publish(std::string_view key, const std::shared_ptr<Flight>& flight, const Result& result) {
+        unlist(key, flight);
+        std::vector<Callback> callbacks;
+        {
+            std::lock_guard lock(flight->mutex);
+            flight->result = result;
+            callbacks.swap(flight->callbacks);
+        }
+        flight->cv.notify_all();
+        for (auto& callback : callbacks) {
+            callback(result);
+        }
+    }
+
+    std::array<Shard, num_shards> shards_;
+    std::atomic<uint64_t> loads_{0};
+    std::atomic<uint64_t> shared_{0};
+};
+
+} // namespace kallisto::engine
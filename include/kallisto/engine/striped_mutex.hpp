@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <algorithm>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace kallisto::engine {
+
+/**
+ * StripedMutex - Fixed table of mutexes selected by key hash.
+ *
+ * Role: Serializes read-modify-write sequences per key without a global
+ * lock. Two keys contend only when they land on the same stripe, so with
+ * enough stripes writers to different paths effectively never block each
+ * other, while writers to the same path are always linearizable.
+ *
+ * Each stripe owns a cache line to avoid false sharing between stripes.
+ * Stripes MUST be a power of 2.
+ */
+template <size_t Stripes>
+class StripedMutex {
+    static_assert((Stripes & (Stripes - 1)) == 0, "Stripes must be a power of 2");
+
+    struct alignas(64) Stripe {
+        std::mutex mutex;
+    };
+
+    std::array<Stripe, Stripes> stripes_;
+
+public:
+    std::mutex& forKey(std::string_view key) {
+        return stripes_[stripeIndex(key)].mutex;
+    }
+
+    /**
+     * Locks the stripes of every key, each once and in index order, so two
+     * callers locking overlapping sets never deadlock.
+     */
+    template <typename Key>
+    std::vector<std::unique_lock<std::mutex>> lockAll(std::span<const Key> keys) {
+        std::vector<size_t> indices;
+        indices.reserve(keys.size());
+        for (const auto& key : keys) {
+            indices.push_back(stripeIndex(key));
+        }
+        std::sort(indices.begin(), indices.end());
+        indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+
+        std::vector<std::unique_lock<std::mutex>> locks;
+        locks.reserve(indices.size());
+        for (size_t index : indices) {
+            locks.emplace_back(stripes_[index].mutex);
+        }
+        return locks;
+    }
+
+    /**
+     * Locks every stripe, in index order: excludes all writers at once.
+     */
+    std::vector<std::unique_lock<std::mutex>> lockEvery() {
+        std::vector<std::unique_lock<std::mutex>> locks;
+        locks.reserve(Stripes);
+        for (auto& stripe : stripes_) {
+            locks.emplace_back(stripe.mutex);
+        }
+        return locks;
+    }
+
+    static size_t stripeIndex(std::string_view key) {
+        return std::hash<std::string_view>{}(key) & (Stripes - 1);
+    }
+
+    static constexpr size_t stripeCount() { return Stripes; }
+};
+
+} // namespace kallisto::engine
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace kallisto {
+
+/**
+ * Selects the data structure behind the path validator.
+ */
+enum class PathIndexType {
+	BTREE, // BTreeIndex: prefix-compressed B+-Tree, ordered by byte-wise comparison
+	ART    // ArtPathIndex: Adaptive Radix Tree, O(path length) lookup
+};
+
+/**
+ * IPathIndex — contract shared by every path validator backend.
+ *
+ * TlsBTreeManager only talks to this interface, so backends can be swapped
+ * without touching the RCU publishing logic. Backends are `final` so calls
+ * made through a concrete type devirtualize.
+ */
+class IPathIndex {
+public:
+	using PathVisitor = std::function<void(const std::string& path)>;
+
+	virtual ~IPathIndex() = default;
+
+	/**
+	* Inserts a path into the index.
+	* @return true if insertion was successful.
+	*/
+	virtual bool insertPath(const std::string& path) = 0;
+
+	/**
+	* @return true if the path exists.
+	*/
+	virtual bool validatePath(std::string_view path) const = 0;
+
+	/**
+	* @return true if the path was present and has been removed.
+	*/
+	virtual bool removePath(const std::string& path) = 0;
+
+	/**
+	* Visits every indexed path starting with prefix, in ascending byte order.
+	*/
+	virtual void iteratePrefix(std::string_view prefix, const PathVisitor& visitor) const = 0;
+
+	/**
+	* Replaces the contents with sorted_paths in one bottom-up pass, without
+	* the per-path descents and splits of insertPath. Used for recovery.
+	* @param sorted_paths Ascending byte order; duplicates are dropped.
+	*/
+	virtual void bulkLoad(std::vector<std::string> sorted_paths) = 0;
+
+	/**
+	* Returns a copy the writer may mutate while readers keep using this one.
+	*/
+	virtual std::unique_ptr<IPathIndex> clone() const = 0;
+};
+
+} // namespace kallisto
@@ -19,7 +19,19 @@ namespace kallisto {
  */
 class KallistoCore {
 public:
-    explicit KallistoCore(const std::string& db_path = "/var/lib/kallisto/data");
+    /**
+     * @param recovery Startup recovery of the default engine. With
+     * recovery.background the constructor returns before the path index is
+     * rebuilt; see warmupStatus().
+     * @param config Mount-level configuration of the default engine.
+     * @param write_behind BATCH-mode write-behind workers of the default engine.
+     * @param read_io Cache-miss read threads of the default engine.
+     */
+    explicit KallistoCore(const std::string& db_path = "/var/lib/kallisto/data",
+                          engine::RecoveryOptions recovery = {},
+                          engine::MountConfig config = {},
+                          engine::WriteBehindOptions write_behind = {},
+                          engine::ReadIoOptions read_io = {});
     ~KallistoCore();
 
     KallistoCore(const KallistoCore&) = delete;
@@ -36,6 +48,42 @@ public:
     SyncMode getSyncMode() const;
     void forceFlush();
 
+    /**
+     * Binds the default engine's path index to the server's worker threads.
+     */
+    void attachWorkers(event::WorkerPool& workers, tls::Instance& tls);
+
+    /**
+     * Startup recovery progress of the default engine (GET /v1/sys/health).
+     */
+    engine::WarmupStatus warmupStatus() const;
+
+    /**
+     * Trims every key of the default engine down to its history limit (UDS COMPACT).
+     * @return Number of versions pruned.
+     */
+    size_t compactVersionHistory();
+
+    /**
+     * Destroys every path of the default engine under prefix
+     * (DELETE /v1/secret/prefix/..., UDS DESTROY_PREFIX).
+     * @return Number of paths destroyed.
+     */
+    tl::expected<size_t, engine::EngineError> destroyPrefix(std::string_view prefix);
+
+    /**
+     * destroyPrefix off the caller's thread; see KvEngine::destroyPrefixAsync.
+     * @return The result if settled in place, else nullopt and done is called later.
+     */
+    std::optional<engine::KvEngine::DestroyResult> destroyPrefixAsync(std::string prefix,
+                                                                      engine::KvEngine::DestroyCallback done);
+
+    /**
+     * Write-behind flusher of the default engine (UDS STATS).
+     */
+    engine::FlushStats flushStats() const;
+    void setFlushPolicy(const engine::FlushPolicy& policy);
+
     // --- New Hexagonal API ---
     engine::EngineRegistry& registry() { return registry_; }
     const engine::EngineRegistry& registry() const { return registry_; }
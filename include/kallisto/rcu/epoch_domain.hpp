@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace kallisto {
+namespace rcu {
+
+class EpochGuard;
+
+/**
+ * EpochDomain — epoch-based memory reclamation shared by all RCU users.
+ *
+ * Writers unpublish an object and hand it to retire(); it is freed once no
+ * reader can still hold it. Readers never touch a reference count:
+ *
+ * - Event loop threads go online once (QSBR) and report a quiescent state on
+ *   every Dispatcher loop iteration, so their read path costs nothing. They
+ *   go offline while blocked in epoll_wait and stop delaying reclamation.
+ * - Any other thread pins the domain with an EpochGuard (EBR) for the
+ *   duration of its read-side section: one store on entry and one on exit.
+ *
+ * Each thread announces the epoch its references are at least as new as
+ * (0 = holds nothing). An object retired at epoch R is freed once every
+ * announced epoch is 0 or >= R.
+ *
+ * Inspired by liburcu's QSBR flavor and Fraser's epoch-based reclamation.
+ */
+class EpochDomain {
+public:
+    /**
+     * Process-wide domain used by the Dispatcher loop and every RCU user.
+     */
+    static EpochDomain& global();
+
+    ~EpochDomain();
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+
+    /**
+     * Marks the calling thread online: from now on it is only considered
+     * quiescent when it calls quiescentState() or goes offline.
+     */
+    void onlineThread();
+
+    /**
+     * Marks the calling thread offline: it holds no RCU references until
+     * it comes back online or pins.
+     */
+    void offlineThread();
+
+    /**
+     * Reports that the calling online thread holds no RCU references.
+     * No-op while an EpochGuard is alive on this thread.
+     */
+    void quiescentState();
+
+    /**
+     * Enters a read-side section on any thread. Nested guards are free.
+     */
+    EpochGuard pin();
+
+    /**
+     * Queues deleter until every reader has moved past the current epoch.
+     * The caller must already have unpublished the object.
+     */
+    void retire(std::function<void()> deleter);
+
+    template<typename T>
+    void retireObject(const T* object) {
+        retire([object]() { delete object; });
+    }
+
+    /**
+     * Runs the deleters whose grace period has elapsed.
+     * @return Number of objects freed.
+     */
+    size_t reclaim();
+
+    /**
+     * reclaim() for the event loop: returns immediately when nothing is
+     * pending or another thread is already reclaiming.
+     */
+    size_t tryReclaim();
+
+    /**
+     * @return Number of retired objects still waiting for a grace period.
+     */
+    size_t pendingCount() const { return pending_count_.load(std::memory_order_relaxed); }
+
+private:
+    friend class EpochGuard;
+
+    struct alignas(64) ThreadRecord {
+        std::atomic<uint64_t> active_epoch{0};  // 0 = holds no references
+    };
+
+    struct ThreadState;
+
+    struct RetiredObject {
+        uint64_t retire_epoch;
+        std::function<void()> deleter;
+    };
+
+    EpochDomain() = default;
+
+    ThreadState& localState();
+    void unpin();
+    void announce(ThreadRecord& record);
+    uint64_t minimumActiveEpoch() const;
+    size_t reclaimLocked(std::unique_lock<std::mutex>& retire_lock);
+
+    std::atomic<uint64_t> global_epoch_{1};
+
+    mutable std::mutex registry_mutex_;
+    std::vector<ThreadRecord*> thread_records_;
+
+    std::mutex retire_mutex_;
+    std::deque<RetiredObject> retired_objects_;  // Ascending retire_epoch
+    std::atomic<size_t> pending_count_{0};
+};
+
+/**
+ * RAII read-side section. Pointers loaded from RCU-published state stay
+ * valid until the guard is destroyed, which must happen on the same thread.
+ */
+class EpochGuard {
+public:
+    EpochGuard(EpochGuard&& other) noexcept : domain_(other.domain_) { other.domain_ = nullptr; }
+    EpochGuard& operator=(EpochGuard&&) = delete;
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+
+    ~EpochGuard() {
+        if (domain_) {
+            domain_->unpin();
+        }
+    }
+
+private:
+    friend class EpochDomain;
+    explicit EpochGuard(EpochDomain* domain) : domain_(domain) {}
+
+    EpochDomain* domain_;
+};
+
+} // namespace rcu
+} // namespace kallisto
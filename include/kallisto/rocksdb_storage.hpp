@@ -1,8 +1,13 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <optional>
 #include <cstring>
+#include <functional>
+#include <vector>
 #include "kallisto/secret_entry.hpp"
 
 #ifdef KALLISTO_HAS_ROCKSDB
@@ -57,6 +62,13 @@ public:
     std::optional<std::string> getRaw(const std::string& key) const;
     bool delRaw(const std::string& key);
 
+    /**
+     * Batched getRaw: one MultiGet for all keys, sharing the block lookups
+     * and the memtable/SST probes RocksDB can batch.
+     * @return One entry per key, in order; nullopt if missing or on error.
+     */
+    std::vector<std::optional<std::string>> multiGetRaw(const std::vector<std::string>& keys) const;
+
     struct BatchOp {
         enum class Type { PUT, DEL } type;
         std::string key;
@@ -64,6 +76,31 @@ public:
     };
     bool applyBatch(const std::vector<BatchOp>& ops);
 
+    /**
+     * Atomic batch write with explicit durability, independent of setSync().
+     * @param sync true → fsync the WAL before returning.
+     */
+    bool applyBatch(const std::vector<BatchOp>& ops, bool sync);
+
+    /**
+     * Non-owning BatchOp: lets the write-behind flusher hand records to
+     * RocksDB straight from its queue buffer, without copying them out.
+     */
+    struct BatchOpView {
+        BatchOp::Type type;
+        std::string_view key;
+        std::string_view value;
+    };
+    bool applyBatch(const std::vector<BatchOpView>& ops);
+    bool applyBatch(const std::vector<BatchOpView>& ops, bool sync);
+
+    /**
+     * Deletes every key starting with one of prefixes as one fsynced batch
+     * of range tombstones (DeleteRange): the cost does not grow with the
+     * number of keys covered.
+     */
+    bool deletePrefixes(const std::vector<std::string>& prefixes);
+
     /**
      * Iterate over all entries in the database.
      * Useful for rebuilding indices on startup without loading all data into memory.
@@ -71,6 +108,24 @@ public:
      */
     void iterateAll(std::function<void(const SecretEntry&)> callback) const;
 
+    using RawVisitor = std::function<void(std::string_view key, std::string_view value)>;
+
+    /**
+     * Visits raw records with begin <= key < end in key order.
+     * Bypasses the block cache so a full scan does not evict the hot set.
+     * Safe to call concurrently on disjoint ranges.
+     */
+    void iterateRange(const std::string& begin, const std::string& end, const RawVisitor& callback) const;
+
+    /**
+     * Splits the keys starting with prefix into at most max_parts ranges of
+     * similar on-disk size, using SST file boundaries. Falls back to even
+     * splits on the first byte after prefix when there are too few files
+     * (e.g. data still in the memtable).
+     * @return Ascending boundaries: front() == prefix, back() == first key past the prefix.
+     */
+    std::vector<std::string> partitionPrefix(const std::string& prefix, size_t max_parts) const;
+
     /**
      * Force flush WAL to disk (maps to SAVE command).
      */
@@ -88,12 +143,22 @@ public:
      */
     bool isOpen() const;
 
+    /**
+     * Point lookups issued (get/getRaw, one per multiGetRaw key) since construction.
+     */
+    uint64_t pointReads() const { return point_reads_.load(std::memory_order_relaxed); }
+
 private:
+    mutable std::atomic<uint64_t> point_reads_{0};
+
 #ifdef KALLISTO_HAS_ROCKSDB
     std::unique_ptr<rocksdb::DB> db_;
     rocksdb::Options options_;
     rocksdb::WriteOptions write_opts_;
     rocksdb::ReadOptions read_opts_;
+
+    template <typename Op>
+    bool writeBatch(const std::vector<Op>& ops, const rocksdb::WriteOptions& write_opts);
 #endif
 
     /**
@@ -3,6 +3,7 @@
 #include <string>
 #include <chrono>
 #include <cstdint>
+#include <memory>
 
 namespace kallisto {
 
@@ -15,6 +16,9 @@ struct SecretEntry {
     std::string path;
     std::chrono::system_clock::time_point created_at;
     uint32_t ttl; // in seconds
+    // Read-only value shared with other owners instead of copied into value:
+    // the engine's payload cache holds the buffer its heads and writes hold
+    std::shared_ptr<const std::string> shared_value{};
 };
 
 } // namespace kallisto
@@ -1,10 +1,14 @@
 #pragma once
 
+#include "kallisto/event/dispatcher.hpp"
 #include "kallisto/kallisto_core.hpp"
 
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 
 namespace kallisto {
@@ -24,6 +28,18 @@ namespace server {
  *   GET    /v1/secret/data/:path  -> lookup
  *   POST   /v1/secret/data/:path  -> insert
  *   DELETE /v1/secret/data/:path  -> remove
+ *   POST   /v1/secret/batch/read  -> latest version of each listed path
+ *   POST   /v1/secret/batch/write -> new version of each listed path
+ *   POST   /v1/secret/txn         -> all listed operations or none
+ *   DELETE /v1/secret/prefix/:prefix -> destroy every path under the prefix
+ *   GET    /v1/sys/health         -> readiness (200 ready, 429 warming up)
+ *
+ * The workers never wait on disk. A GET that misses the caches is read on
+ * the engine's I/O threads, and a POST carrying "X-Kallisto-Durable: true"
+ * is acknowledged only once the write-behind flush carrying it has been
+ * fsynced. Either way the response is parked until the engine posts its
+ * completion back to this dispatcher; later pipelined requests on that
+ * connection wait behind it.
  * 
  * Each Worker has its own HttpHandler — no shared state.
  */
@@ -54,6 +70,8 @@ private:
         std::string write_buffer;
         size_t write_offset{0};
         bool keep_alive{false};
+        uint64_t id{0};                 // Tells a reused fd from the connection a parked response belongs to
+        bool awaiting_response{false};  // Response parked: requests are buffered, not handled
     };
     
     // HTTP request (parsed)
@@ -64,13 +82,26 @@ private:
         int content_length{0};
         size_t bytes_consumed{0};
         bool keep_alive{true};
+        bool durable{false};
         bool valid{false};
     };
+
+    // Shared with engine completions, which may fire after the handler is gone
+    struct Liveness {
+        std::mutex mutex;
+        HttpHandler* handler;
+    };
+    
+    // Sends a parked response, on this handler's worker
+    using Respond = std::function<void(HttpHandler&, Connection&)>;
     
     void onReadable(int fd);
     void onWritable(int fd);
     void closeConnection(int fd);
     
+    // Handle the complete requests buffered on conn, until one is parked
+    void processRequests(Connection& conn);
+    
     // Parse HTTP request from buffer
     HttpRequest parseRequest(const std::string& buffer);
     
@@ -80,8 +111,33 @@ private:
     // Vault API handlers
     void handleGetSecret(Connection& conn, const std::string& path);
     void handlePutSecret(Connection& conn, const std::string& path, 
-                         const std::string& body);
+                         const std::string& body, bool durable);
     void handleDeleteSecret(Connection& conn, const std::string& path);
+    // DELETE /v1/secret/prefix/:prefix -> {"data":{"destroyed":N}}
+    void handleDestroyPrefix(Connection& conn, const std::string& prefix);
+    void sendDestroyed(Connection& conn, const engine::KvEngine::DestroyResult& destroyed);
+    void handleHealth(Connection& conn);
+    
+    void sendSecret(Connection& conn, const engine::ReadResult& result);
+    
+    // Batch API: {"paths":[...]} / {"secrets":[{"path","value","ttl"}...]},
+    // answered with one {"path", value or error} entry per item, in order
+    void handleBatchRead(Connection& conn, const std::string& body);
+    void handleBatchWrite(Connection& conn, const std::string& body);
+    void sendBatchRead(Connection& conn, const std::vector<std::string>& paths,
+                       const std::vector<engine::ReadResult>& results);
+    
+    // Transaction API: {"ops":[{"op":"put"|"delete"|"check","path","value","ttl","cas"}...]},
+    // all committed or none; a failure names the step that aborted it.
+    // Committed on an engine I/O thread: the connection is parked meanwhile
+    void handleTransaction(Connection& conn, const std::string& body);
+    void sendTransaction(Connection& conn, size_t op_count, const engine::TxnResult& result);
+    
+    // Parked responses: any thread hands respond back to the connection's
+    // worker, which runs it unless the connection has gone away meanwhile
+    static void postResponse(const std::shared_ptr<Liveness>& liveness, int fd,
+                             uint64_t connection_id, Respond respond);
+    void completeParked(int fd, uint64_t connection_id, const Respond& respond);
     
     // HTTP response helpers
     void sendResponse(Connection& conn, int status_code, 
@@ -92,6 +148,8 @@ private:
     event::Dispatcher& dispatcher_;
     std::shared_ptr<KallistoCore> core_;
     std::unordered_map<int, std::unique_ptr<Connection>> connections_;
+    uint64_t next_connection_id_{0};
+    std::shared_ptr<Liveness> liveness_;
 };
 
 } // namespace server
@@ -42,10 +42,16 @@ class ShardedCuckooTable
 	explicit ShardedCuckooTable(size_t total_capacity = 1024 * 1024);
 
 	// Proxy methods - delegate to appropriate shard
-	bool insert(const std::string &key, const SecretEntry &entry);
+	bool insert(const std::string &key, const SecretEntry &entry,
+		    bool overwrite = true);
 	std::optional<SecretEntry> lookup(const std::string &key) const;
+	std::shared_ptr<const std::string>
+	lookupShared(const std::string &key) const;
 	bool remove(const std::string &key);
 
+	// Visits every shard, one writer lock at a time
+	size_t removePrefix(const std::string &prefix);
+
 	// Aggregate stats from all shards
 	CuckooTable::MemoryStats getMemoryStats() const;
 	std::vector<SecretEntry> getAllEntries() const;
@@ -1,58 +1,161 @@
 #pragma once
 
+#include "kallisto/art_path_index.hpp"
 #include "kallisto/btree_index.hpp"
-#include "kallisto/event/worker.hpp"
+#include "kallisto/rcu/epoch_domain.hpp"
+#include "kallisto/thread_local/thread_local.hpp"
+#include <atomic>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 namespace kallisto {
 
+namespace event {
+class WorkerPool;
+}
+
+/**
+ * Read-side handle on a published path index.
+ * Keeps the calling thread's epoch pinned, so the index cannot be reclaimed
+ * until the handle is destroyed (on the same thread).
+ */
+class PathIndexSnapshot {
+public:
+    const IPathIndex* operator->() const { return index_; }
+    const IPathIndex& operator*() const { return *index_; }
+    const IPathIndex* get() const { return index_; }
+
+private:
+    friend class TlsBTreeManager;
+    PathIndexSnapshot(rcu::EpochGuard guard, const IPathIndex* index)
+        : guard_(std::move(guard)), index_(index) {}
+
+    rcu::EpochGuard guard_;
+    const IPathIndex* index_;
+};
+
 /**
- * TlsBTreeManager manages an Envoy-style RCU (Read-Copy-Update) synchronization 
- * for the BTreeIndex across multiple threads.
+ * TlsBTreeManager manages RCU (Read-Copy-Update) synchronization for the
+ * path index across multiple threads.
  * 
- * It eliminates the need for a global Read-Write Lock, allowing workers to perform
- * lock-free GET operations using thread-local snapshots. Writes (PUT/DELETE) use a 
- * Deep Copy mechanism and push updates to workers via Event Dispatchers.
+ * It eliminates the need for a global Read-Write Lock. Readers load the
+ * published master with a single atomic load and never touch a reference
+ * count; writes (PUT/DELETE) copy the master, publish the copy and retire
+ * the old master to the global rcu::EpochDomain, which frees it once every
+ * reader has passed a quiescent point.
+ *
+ * The index backend is chosen at construction (see PathIndexType). BTreeIndex
+ * snapshots are deep copies; ArtPathIndex snapshots share unchanged subtrees.
+ *
+ * Once attached to the server's workers (attachWorkers), each worker keeps
+ * the master it last saw in a tls::Slot and only reloads it when the
+ * published version moved, so steady-state reads touch the shared master
+ * pointer not at all and the version counter once.
  */
 class TlsBTreeManager {
 public:
-    TlsBTreeManager(int degree, event::WorkerPool* worker_pool);
+    /**
+     * @param degree Minimum degree of the BTreeIndex backend (ignored for ART).
+     * @param index_type Backend used for every snapshot.
+     */
+    explicit TlsBTreeManager(int degree, PathIndexType index_type = PathIndexType::BTREE);
+    ~TlsBTreeManager();
+
+    TlsBTreeManager(const TlsBTreeManager&) = delete;
+    TlsBTreeManager& operator=(const TlsBTreeManager&) = delete;
 
     /**
-     * Returns the current thread's lock-free BTree snapshot.
-     * Falls back to the master copy if the thread hasn't received an update yet.
+     * Gives every worker thread its own cached view of the master.
+     * Call once from the main thread. Worker threads must be registered
+     * with tls (before or after this call); both must outlive the manager.
      */
-    std::shared_ptr<const BTreeIndex> getLocalSnapshot() const;
+    void attachWorkers(event::WorkerPool& workers, tls::Instance& tls);
+
+    /**
+     * Returns the current lock-free index snapshot.
+     * Free on Dispatcher threads (QSBR); one epoch pin on any other thread.
+     * Attached workers serve it from their slot after a version check.
+     */
+    PathIndexSnapshot getLocalSnapshot() const;
 
     /**
      * Inserts a path into the global B-Tree if it doesn't already exist,
-     * then dispatches the updated snapshot to all worker threads.
+     * then publishes the updated snapshot.
      * @return true if path was newly inserted, false if already present.
      */
-    bool insertPathIfAbsent(const std::string& path);
+    bool insertPathIfAbsent(std::string_view path);
+
+    /**
+     * Removes a path from the global B-Tree if present,
+     * then publishes the pruned snapshot.
+     * @return true if path was removed, false if it was not indexed.
+     */
+    bool removePathIfPresent(std::string_view path);
 
     /**
-     * Reclaims memory from old BTree snapshots that are no longer referenced.
-     * Should be called by the writer thread after dispatching updates.
+     * Removes every path starting with prefix from one copy of the master,
+     * published once: a single clone however many paths go.
+     * @return The removed paths, in ascending order.
+     */
+    std::vector<std::string> removePrefix(std::string_view prefix);
+
+    /**
+     * Replaces the master with an index built bottom-up from sorted_paths
+     * (see IPathIndex::bulkLoad) and publishes it. Used by startup recovery.
+     */
+    void bulkLoad(std::vector<std::string> sorted_paths);
+
+    /**
+     * Reclaims memory from old snapshots whose grace period has elapsed.
+     * Should be called by the writer thread after publishing updates.
      */
     static void drainGarbage();
 
+    /**
+     * @return Number of times a worker reloaded its cached view because
+     *         the master version moved (observability/tests).
+     */
+    uint64_t localViewRefreshes() const { return local_view_refreshes_.load(std::memory_order_relaxed); }
+
 private:
-    std::shared_ptr<const BTreeIndex> createUpdatedMaster(const std::string& path);
-    void dispatchUpdate(const std::shared_ptr<const BTreeIndex>& new_master) const;
-    static void updateLocalSnapshot(std::shared_ptr<const BTreeIndex> new_master);
+    /**
+     * Per-worker cache of the published master. Only read and written by the
+     * owning worker thread; the pointer is dereferenced only after its version
+     * matched master_version_ inside a read-side section.
+     */
+    struct LocalIndexView : public tls::ThreadLocalObject {
+        uint64_t version = 0;  // 0 = never loaded
+        const IPathIndex* index = nullptr;
+    };
+
+    /** Empty index of the configured backend. */
+    std::unique_ptr<IPathIndex> createIndex() const;
+
+    /**
+     * Swaps in new_master, bumps master_version_ and retires the previous one.
+     * Caller must hold master_mutex_.
+     */
+    void publishMaster(std::unique_ptr<IPathIndex> new_master);
+
+    /**
+     * Returns the calling worker's view, reloaded if stale.
+     * nullptr on threads not registered with the TLS instance.
+     */
+    const IPathIndex* loadLocalView() const;
 
-    std::shared_ptr<const BTreeIndex> master_btree_;
-    std::mutex master_mutex_;
-    event::WorkerPool* worker_pool_;
+    int degree_;
+    PathIndexType index_type_;
 
-    static thread_local std::shared_ptr<const BTreeIndex> tls_btree;
+    std::atomic<const IPathIndex*> master_index_;
+    std::atomic<uint64_t> master_version_{1};  // Bumped after every publish, before the retire
+    std::mutex master_mutex_; // Serializes writers only
 
-    // GC queue: old snapshots awaiting deallocation off the hot path
-    static std::mutex gc_mutex;
-    static std::vector<std::shared_ptr<const BTreeIndex>> gc_queue;
+    tls::SlotPtr local_view_slot_;  // Set by attachWorkers
+    mutable std::atomic<uint64_t> local_view_refreshes_{0};
 };
 
 } // namespace kallisto
@@ -0,0 +1,388 @@
+#include "kallisto/art_path_index.hpp"
+
+#include <algorithm>
+
+namespace kallisto {
+
+namespace {
+
+size_t commonPrefixLength(std::string_view a, std::string_view b) {
+  size_t limit = std::min(a.size(), b.size());
+  size_t length = 0;
+  while (length < limit && a[length] == b[length]) {
+    length++;
+  }
+  return length;
+}
+
+uint8_t keyByte(std::string_view key) { return static_cast<uint8_t>(key.front()); }
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Public API
+// ---------------------------------------------------------------------------
+
+bool ArtPathIndex::insertPath(const std::string& path) {
+  bool inserted = false;
+  NodePtr new_root = insertAt(root_node_, path, inserted);
+  if (inserted) {
+    root_node_ = std::move(new_root);
+    path_count_++;
+  }
+  return true;
+}
+
+bool ArtPathIndex::validatePath(std::string_view path) const {
+  const Node* current_node = root_node_.get();
+  while (current_node) {
+    const std::string& prefix = current_node->prefix;
+    if (path.size() < prefix.size() || path.compare(0, prefix.size(), prefix) != 0) {
+      return false;
+    }
+    path.remove_prefix(prefix.size());
+    if (path.empty()) {
+      return current_node->is_terminal;
+    }
+
+    const NodePtr* child = findChild(*current_node, keyByte(path));
+    if (!child) {
+      return false;
+    }
+    path.remove_prefix(1);
+    current_node = child->get();
+  }
+  return false;
+}
+
+bool ArtPathIndex::removePath(const std::string& path) {
+  if (!root_node_) {
+    return false;
+  }
+
+  bool removed = false;
+  NodePtr new_root = removeAt(root_node_, path, removed);
+  if (removed) {
+    root_node_ = std::move(new_root);
+    path_count_--;
+  }
+  return removed;
+}
+
+void ArtPathIndex::iteratePrefix(std::string_view prefix, const PathVisitor& visitor) const {
+  std::string path_buffer;
+  const Node* current_node = root_node_.get();
+
+  while (current_node) {
+    const std::string& node_prefix = current_node->prefix;
+    if (prefix.size() <= node_prefix.size()) {
+      // The requested prefix ends inside this node: the whole subtree matches or nothing does
+      if (std::string_view(node_prefix).starts_with(prefix)) {
+        visitSubtree(*current_node, path_buffer, visitor);
+      }
+      return;
+    }
+    if (!prefix.starts_with(node_prefix)) {
+      return;
+    }
+
+    prefix.remove_prefix(node_prefix.size());
+    const NodePtr* child = findChild(*current_node, keyByte(prefix));
+    if (!child) {
+      return;
+    }
+    path_buffer.append(node_prefix);
+    path_buffer.push_back(prefix.front());
+    prefix.remove_prefix(1);
+    current_node = child->get();
+  }
+}
+
+void ArtPathIndex::bulkLoad(std::vector<std::string> sorted_paths) {
+  sorted_paths.erase(std::unique(sorted_paths.begin(), sorted_paths.end()), sorted_paths.end());
+  path_count_ = sorted_paths.size();
+  root_node_ = sorted_paths.empty() ? nullptr : buildSorted(sorted_paths, 0, sorted_paths.size(), 0);
+}
+
+std::unique_ptr<IPathIndex> ArtPathIndex::clone() const { return std::make_unique<ArtPathIndex>(*this); }
+
+// ---------------------------------------------------------------------------
+// Node access
+// ---------------------------------------------------------------------------
+
+const ArtPathIndex::NodePtr* ArtPathIndex::findChild(const Node& node, uint8_t key_byte) {
+  switch (node.type) {
+  case NodeType::NODE4: {
+    const auto& n = static_cast<const Node4&>(node);
+    for (size_t i = 0; i < n.child_count; ++i) {
+      if (n.keys[i] == key_byte) {
+        return &n.children[i];
+      }
+    }
+    return nullptr;
+  }
+  case NodeType::NODE16: {
+    // Fixed 16-byte scan over a zero-filled array: branch free, auto-vectorized
+    const auto& n = static_cast<const Node16&>(node);
+    uint32_t match_mask = 0;
+    for (size_t i = 0; i < n.keys.size(); ++i) {
+      match_mask |= static_cast<uint32_t>(n.keys[i] == key_byte) << i;
+    }
+    match_mask &= (1u << n.child_count) - 1;
+    return match_mask ? &n.children[__builtin_ctz(match_mask)] : nullptr;
+  }
+  case NodeType::NODE48: {
+    const auto& n = static_cast<const Node48&>(node);
+    uint8_t slot = n.child_slots[key_byte];
+    return slot ? &n.children[slot - 1] : nullptr;
+  }
+  case NodeType::NODE256: {
+    const auto& n = static_cast<const Node256&>(node);
+    return n.children[key_byte] ? &n.children[key_byte] : nullptr;
+  }
+  case NodeType::LEAF:
+    break;
+  }
+  return nullptr;
+}
+
+ArtPathIndex::ChildList ArtPathIndex::collectChildren(const Node& node) {
+  ChildList children;
+  children.reserve(node.child_count + 1);
+
+  switch (node.type) {
+  case NodeType::NODE4: {
+    const auto& n = static_cast<const Node4&>(node);
+    for (size_t i = 0; i < n.child_count; ++i) {
+      children.emplace_back(n.keys[i], n.children[i]);
+    }
+    break;
+  }
+  case NodeType::NODE16: {
+    const auto& n = static_cast<const Node16&>(node);
+    for (size_t i = 0; i < n.child_count; ++i) {
+      children.emplace_back(n.keys[i], n.children[i]);
+    }
+    break;
+  }
+  case NodeType::NODE48: {
+    const auto& n = static_cast<const Node48&>(node);
+    for (size_t byte = 0; byte < n.child_slots.size(); ++byte) {
+      if (uint8_t slot = n.child_slots[byte]) {
+        children.emplace_back(static_cast<uint8_t>(byte), n.children[slot - 1]);
+      }
+    }
+    break;
+  }
+  case NodeType::NODE256: {
+    const auto& n = static_cast<const Node256&>(node);
+    for (size_t byte = 0; byte < n.children.size(); ++byte) {
+      if (n.children[byte]) {
+        children.emplace_back(static_cast<uint8_t>(byte), n.children[byte]);
+      }
+    }
+    break;
+  }
+  case NodeType::LEAF:
+    break;
+  }
+  return children;
+}
+
+ArtPathIndex::NodePtr ArtPathIndex::buildNode(std::string prefix, bool is_terminal, const ChildList& children) {
+  const auto child_count = static_cast<uint16_t>(children.size());
+
+  if (children.empty()) {
+    return std::make_shared<Node>(NodeType::LEAF, is_terminal, std::move(prefix));
+  }
+  if (children.size() <= 4) {
+    auto node = std::make_shared<Node4>(NodeType::NODE4, is_terminal, std::move(prefix));
+    for (size_t i = 0; i < children.size(); ++i) {
+      node->keys[i] = children[i].first;
+      node->children[i] = children[i].second;
+    }
+    node->child_count = child_count;
+    return node;
+  }
+  if (children.size() <= 16) {
+    auto node = std::make_shared<Node16>(NodeType::NODE16, is_terminal, std::move(prefix));
+    for (size_t i = 0; i < children.size(); ++i) {
+      node->keys[i] = children[i].first;
+      node->children[i] = children[i].second;
+    }
+    node->child_count = child_count;
+    return node;
+  }
+  if (children.size() <= 48) {
+    auto node = std::make_shared<Node48>(NodeType::NODE48, is_terminal, std::move(prefix));
+    for (size_t i = 0; i < children.size(); ++i) {
+      node->child_slots[children[i].first] = static_cast<uint8_t>(i + 1);
+      node->children[i] = children[i].second;
+    }
+    node->child_count = child_count;
+    return node;
+  }
+  auto node = std::make_shared<Node256>(NodeType::NODE256, is_terminal, std::move(prefix));
+  for (const auto& [key_byte, child] : children) {
+    node->children[key_byte] = child;
+  }
+  node->child_count = child_count;
+  return node;
+}
+
+ArtPathIndex::NodePtr ArtPathIndex::buildSorted(const std::vector<std::string>& sorted_paths, size_t begin,
+                                                size_t end, size_t depth) {
+  // Sorted input: the prefix shared by the first and last path is shared by all
+  std::string_view first = std::string_view(sorted_paths[begin]).substr(depth);
+  std::string_view last = std::string_view(sorted_paths[end - 1]).substr(depth);
+  const size_t prefix_length = commonPrefixLength(first, last);
+  const size_t child_depth = depth + prefix_length;
+
+  // A path ending at this node is the shortest one, so it sorts first
+  const bool is_terminal = sorted_paths[begin].size() == child_depth;
+  ChildList children;
+  for (size_t run = begin + (is_terminal ? 1 : 0); run < end;) {
+    const char key_byte = sorted_paths[run][child_depth];
+    size_t run_end = run + 1;
+    while (run_end < end && sorted_paths[run_end][child_depth] == key_byte) {
+      run_end++;
+    }
+    children.emplace_back(static_cast<uint8_t>(key_byte),
+                          buildSorted(sorted_paths, run, run_end, child_depth + 1));
+    run = run_end;
+  }
+  return buildNode(std::string(first.substr(0, prefix_length)), is_terminal, children);
+}
+
+// ---------------------------------------------------------------------------
+// Path-copying updates
+// ---------------------------------------------------------------------------
+
+ArtPathIndex::NodePtr ArtPathIndex::insertAt(const NodePtr& node, std::string_view key, bool& inserted) {
+  if (!node) {
+    inserted = true;
+    return buildNode(std::string(key), true, {});
+  }
+
+  const std::string& prefix = node->prefix;
+  size_t matched = commonPrefixLength(prefix, key);
+
+  if (matched < prefix.size()) {
+    // Key diverges inside the compressed prefix: split it at the mismatch
+    ChildList children;
+    children.emplace_back(static_cast<uint8_t>(prefix[matched]),
+                          buildNode(prefix.substr(matched + 1), node->is_terminal, collectChildren(*node)));
+    bool key_ends_here = matched == key.size();
+    if (!key_ends_here) {
+      children.emplace_back(static_cast<uint8_t>(key[matched]),
+                            buildNode(std::string(key.substr(matched + 1)), true, {}));
+      if (children[1].first < children[0].first) {
+        std::swap(children[0], children[1]);
+      }
+    }
+    inserted = true;
+    return buildNode(prefix.substr(0, matched), key_ends_here, children);
+  }
+
+  key.remove_prefix(prefix.size());
+  if (key.empty()) {
+    if (node->is_terminal) {
+      return node;
+    }
+    inserted = true;
+    return buildNode(prefix, true, collectChildren(*node));
+  }
+
+  const uint8_t key_byte = keyByte(key);
+  ChildList children = collectChildren(*node);
+  auto slot = std::lower_bound(children.begin(), children.end(), key_byte,
+                               [](const auto& entry, uint8_t byte) { return entry.first < byte; });
+
+  if (slot != children.end() && slot->first == key_byte) {
+    NodePtr new_child = insertAt(slot->second, key.substr(1), inserted);
+    if (!inserted) {
+      return node;
+    }
+    slot->second = std::move(new_child);
+  } else {
+    inserted = true;
+    children.insert(slot, {key_byte, buildNode(std::string(key.substr(1)), true, {})});
+  }
+  return buildNode(prefix, node->is_terminal, children);
+}
+
+ArtPathIndex::NodePtr ArtPathIndex::removeAt(const NodePtr& node, std::string_view key, bool& removed) {
+  const std::string& prefix = node->prefix;
+  if (!key.starts_with(prefix)) {
+    return node;
+  }
+
+  key.remove_prefix(prefix.size());
+  bool is_terminal = node->is_terminal;
+  ChildList children = collectChildren(*node);
+
+  if (key.empty()) {
+    if (!is_terminal) {
+      return node;
+    }
+    is_terminal = false;
+  } else {
+    const NodePtr* child = findChild(*node, keyByte(key));
+    if (!child) {
+      return node;
+    }
+    NodePtr new_child = removeAt(*child, key.substr(1), removed);
+    if (!removed) {
+      return node;
+    }
+
+    auto slot = std::find_if(children.begin(), children.end(),
+                             [&](const auto& entry) { return entry.first == keyByte(key); });
+    if (new_child) {
+      slot->second = std::move(new_child);
+    } else {
+      children.erase(slot);
+    }
+  }
+  removed = true;
+
+  if (!is_terminal && children.empty()) {
+    return nullptr;
+  }
+  if (!is_terminal && children.size() == 1) {
+    return mergeWithOnlyChild(*node, children.front().first, *children.front().second);
+  }
+  return buildNode(prefix, is_terminal, children);
+}
+
+ArtPathIndex::NodePtr ArtPathIndex::mergeWithOnlyChild(const Node& node, uint8_t key_byte, const Node& child) {
+  std::string merged_prefix;
+  merged_prefix.reserve(node.prefix.size() + 1 + child.prefix.size());
+  merged_prefix.append(node.prefix);
+  merged_prefix.push_back(static_cast<char>(key_byte));
+  merged_prefix.append(child.prefix);
+  return buildNode(std::move(merged_prefix), child.is_terminal, collectChildren(child));
+}
+
+// ---------------------------------------------------------------------------
+// Traversal
+// ---------------------------------------------------------------------------
+
+void ArtPathIndex::visitSubtree(const Node& node, std::string& path_buffer, const PathVisitor& visitor) {
+  const size_t base_length = path_buffer.size();
+  path_buffer.append(node.prefix);
+
+  // A path ending here sorts before every longer path below it
+  if (node.is_terminal) {
+    visitor(path_buffer);
+  }
+  for (const auto& [key_byte, child] : collectChildren(node)) {
+    path_buffer.push_back(static_cast<char>(key_byte));
+    visitSubtree(*child, path_buffer, visitor);
+    path_buffer.pop_back();
+  }
+
+  path_buffer.resize(base_length);
+}
+
+} // namespace kallisto
@@ -1,7 +1,91 @@
 #include "kallisto/btree_index.hpp"
 
+#include <algorithm>
+
 namespace kallisto {
 
+namespace {
+
+constexpr size_t head_width = sizeof(uint64_t);
+
+// Packs the first 8 bytes big-endian so integer order equals byte-wise string order.
+uint64_t packHead(std::string_view suffix) {
+  uint64_t head = 0;
+  for (size_t i = 0; i < head_width; ++i) {
+    uint8_t byte = i < suffix.size() ? static_cast<uint8_t>(suffix[i]) : 0;
+    head = (head << 8) | byte;
+  }
+  return head;
+}
+
+// Start of part index when count items are split into parts near-equal runs
+size_t evenSplit(size_t count, size_t parts, size_t index) { return count * index / parts; }
+
+size_t commonPrefixLength(std::string_view a, std::string_view b) {
+  size_t limit = std::min(a.size(), b.size());
+  size_t length = 0;
+  while (length < limit && a[length] == b[length]) {
+    length++;
+  }
+  return length;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Node key block
+// ---------------------------------------------------------------------------
+
+std::string_view BTreeIndex::Node::suffixAt(size_t index) const {
+  return std::string_view(key_arena).substr(key_offsets[index],
+                                            key_offsets[index + 1] - key_offsets[index]);
+}
+
+std::string BTreeIndex::Node::keyAt(size_t index) const {
+  std::string key;
+  std::string_view suffix = suffixAt(index);
+  key.reserve(key_prefix.size() + suffix.size());
+  key.append(key_prefix);
+  key.append(suffix);
+  return key;
+}
+
+std::vector<std::string> BTreeIndex::Node::decodeKeys() const {
+  std::vector<std::string> keys;
+  keys.reserve(keyCount() + 1);
+  for (size_t i = 0; i < keyCount(); ++i) {
+    keys.push_back(keyAt(i));
+  }
+  return keys;
+}
+
+void BTreeIndex::Node::encodeKeys(const std::vector<std::string>& sorted_keys) {
+  // Keys are sorted, so the prefix shared by first and last is shared by all
+  key_prefix.clear();
+  if (!sorted_keys.empty()) {
+    size_t shared = commonPrefixLength(sorted_keys.front(), sorted_keys.back());
+    key_prefix.assign(sorted_keys.front(), 0, shared);
+  }
+
+  key_arena.clear();
+  key_heads.clear();
+  key_offsets.assign(1, 0);
+  key_heads.reserve(sorted_keys.size());
+  key_offsets.reserve(sorted_keys.size() + 1);
+
+  for (const auto& key : sorted_keys) {
+    std::string_view suffix = std::string_view(key).substr(key_prefix.size());
+    key_arena.append(suffix);
+    key_offsets.push_back(static_cast<uint32_t>(key_arena.size()));
+    key_heads.push_back(packHead(suffix));
+  }
+  key_arena.shrink_to_fit();
+}
+
+// ---------------------------------------------------------------------------
+// Public API
+// ---------------------------------------------------------------------------
+
 BTreeIndex::BTreeIndex(int degree) : min_degree_(degree) { root_node_ = std::make_unique<Node>(true); }
 
 BTreeIndex::BTreeIndex(const BTreeIndex& other) : min_degree_(other.min_degree_) {
@@ -13,87 +97,349 @@ BTreeIndex::BTreeIndex(const BTreeIndex& other) : min_degree_(other.min_degree_)
 }
 
 bool BTreeIndex::insertPath(const std::string& path) {
-  if (containsPathRecursive(root_node_.get(), path)) {
+  if (validatePath(path)) {
     return true;
   }
 
-  Node* root_ptr = root_node_.get();
-  if (root_ptr->path_keys.size() == static_cast<size_t>(2 * min_degree_ - 1)) {
+  if (root_node_->keyCount() == maxKeys()) {
     auto new_root = std::make_unique<Node>(false);
     new_root->child_nodes.push_back(std::move(root_node_));
     root_node_ = std::move(new_root);
-    splitChildNode(root_node_.get(), 0, root_node_->child_nodes[0].get());
-    insertIntoNonFullNode(root_node_.get(), path);
-  } else {
-    insertIntoNonFullNode(root_ptr, path);
+    splitChildNode(root_node_.get(), 0);
+  }
+
+  // Top-down: split any full child before stepping into it
+  Node* current_node = root_node_.get();
+  while (!current_node->is_leaf_node) {
+    size_t index = childIndexFor(*current_node, path);
+    if (current_node->child_nodes[index]->keyCount() == maxKeys()) {
+      splitChildNode(current_node, index);
+      index = childIndexFor(*current_node, path);
+    }
+    current_node = current_node->child_nodes[index].get();
   }
+
+  auto keys = current_node->decodeKeys();
+  keys.insert(keys.begin() + searchNode(*current_node, path).index, path);
+  current_node->encodeKeys(keys);
   return true;
 }
 
-bool BTreeIndex::validatePath(const std::string& path) const { return containsPathRecursive(root_node_.get(), path); }
+bool BTreeIndex::validatePath(std::string_view path) const {
+  const Node* current_node = root_node_.get();
+  while (!current_node->is_leaf_node) {
+    current_node = current_node->child_nodes[childIndexFor(*current_node, path)].get();
+  }
+  return searchNode(*current_node, path).exact;
+}
 
-bool BTreeIndex::containsPathRecursive(Node* current_node, const std::string& path_key) const {
-  size_t index = 0;
-  while (index < current_node->path_keys.size() && path_key > current_node->path_keys[index]) {
-    index++;
+bool BTreeIndex::removePath(const std::string& path) {
+  if (!validatePath(path)) {
+    return false;
   }
 
-  if (index < current_node->path_keys.size() && current_node->path_keys[index] == path_key) {
-    return true;
+  // Top-down: top up every child to t keys before stepping into it
+  Node* current_node = root_node_.get();
+  while (!current_node->is_leaf_node) {
+    size_t index = childIndexFor(*current_node, path);
+    if (!hasSpareKey(current_node->child_nodes[index].get())) {
+      index = fillChildNode(current_node, index);
+    }
+    current_node = current_node->child_nodes[index].get();
   }
 
-  if (current_node->is_leaf_node) {
-    return false;
+  auto keys = current_node->decodeKeys();
+  keys.erase(keys.begin() + searchNode(*current_node, path).index);
+  current_node->encodeKeys(keys);
+
+  shrinkRootIfEmpty();
+  return true;
+}
+
+void BTreeIndex::iteratePrefix(std::string_view prefix, const PathVisitor& visitor) const {
+  visitPrefixRange(*root_node_, prefix, visitor);
+}
+
+void BTreeIndex::bulkLoad(std::vector<std::string> sorted_paths) {
+  sorted_paths.erase(std::unique(sorted_paths.begin(), sorted_paths.end()), sorted_paths.end());
+  root_node_ = std::make_unique<Node>(true);
+  if (sorted_paths.empty()) {
+    return;
+  }
+
+  // Leaves: near-equal runs of at most maxKeys() paths, so each holds >= t-1.
+  // separators[i] routes between level[i] and level[i + 1].
+  const size_t path_count = sorted_paths.size();
+  const size_t leaf_count = (path_count + maxKeys() - 1) / maxKeys();
+  std::vector<std::string> separators;
+  separators.reserve(leaf_count);
+  for (size_t i = 1; i < leaf_count; ++i) {
+    size_t first = evenSplit(path_count, leaf_count, i);
+    separators.push_back(shortestSeparator(sorted_paths[first - 1], sorted_paths[first]));
   }
 
-  return containsPathRecursive(current_node->child_nodes[index].get(), path_key);
+  std::vector<std::unique_ptr<Node>> level;
+  level.reserve(leaf_count);
+  for (size_t i = 0; i < leaf_count; ++i) {
+    auto begin = sorted_paths.begin() + evenSplit(path_count, leaf_count, i);
+    auto end = sorted_paths.begin() + evenSplit(path_count, leaf_count, i + 1);
+    auto leaf = std::make_unique<Node>(true);
+    leaf->encodeKeys(std::vector<std::string>(std::make_move_iterator(begin), std::make_move_iterator(end)));
+    level.push_back(std::move(leaf));
+  }
+
+  // Internal levels: near-equal groups of at most 2t children, so each holds >= t.
+  // The separators inside a group become its keys, the ones between groups move up.
+  const size_t max_children = maxKeys() + 1;
+  while (level.size() > 1) {
+    const size_t child_count = level.size();
+    const size_t parent_count = (child_count + max_children - 1) / max_children;
+    std::vector<std::unique_ptr<Node>> parents;
+    std::vector<std::string> parent_separators;
+    parents.reserve(parent_count);
+
+    for (size_t i = 0; i < parent_count; ++i) {
+      size_t begin = evenSplit(child_count, parent_count, i);
+      size_t end = evenSplit(child_count, parent_count, i + 1);
+      if (i > 0) {
+        parent_separators.push_back(std::move(separators[begin - 1]));
+      }
+
+      auto parent = std::make_unique<Node>(false);
+      parent->encodeKeys(std::vector<std::string>(std::make_move_iterator(separators.begin() + begin),
+                                                  std::make_move_iterator(separators.begin() + end - 1)));
+      for (size_t child = begin; child < end; ++child) {
+        parent->child_nodes.push_back(std::move(level[child]));
+      }
+      parents.push_back(std::move(parent));
+    }
+
+    level = std::move(parents);
+    separators = std::move(parent_separators);
+  }
+  root_node_ = std::move(level.front());
 }
 
-void BTreeIndex::insertIntoNonFullNode(Node* current_node, const std::string& path_key) {
-  int index = current_node->path_keys.size() - 1;
+std::unique_ptr<IPathIndex> BTreeIndex::clone() const { return std::make_unique<BTreeIndex>(*this); }
+
+// ---------------------------------------------------------------------------
+// Search
+// ---------------------------------------------------------------------------
+
+BTreeIndex::SearchResult BTreeIndex::searchNode(const Node& node, std::string_view path_key) {
+  const size_t key_count = node.keyCount();
+  std::string_view prefix = node.key_prefix;
 
-  if (current_node->is_leaf_node) {
-    current_node->path_keys.push_back("");
-    while (index >= 0 && path_key < current_node->path_keys[index]) {
-      current_node->path_keys[index + 1] = current_node->path_keys[index];
-      index--;
+  // One comparison against the shared prefix places the probe before, after or inside the block
+  size_t comparable = std::min(prefix.size(), path_key.size());
+  int prefix_order = path_key.substr(0, comparable).compare(prefix.substr(0, comparable));
+  if (prefix_order < 0 || (prefix_order == 0 && path_key.size() < prefix.size())) {
+    return {0, false};
+  }
+  if (prefix_order > 0) {
+    return {key_count, false};
+  }
+
+  std::string_view probe_suffix = path_key.substr(prefix.size());
+  const uint64_t probe_head = packHead(probe_suffix);
+
+  auto compareAt = [&](size_t index) {
+    uint64_t head = node.key_heads[index];
+    if (head != probe_head) {
+      return head < probe_head ? -1 : 1;
     }
-    current_node->path_keys[index + 1] = path_key;
-  } else {
-    while (index >= 0 && path_key < current_node->path_keys[index]) {
-      index--;
+    return node.suffixAt(index).compare(probe_suffix);
+  };
+
+  size_t low = 0;
+  size_t high = key_count;
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    if (compareAt(mid) < 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
     }
-    index++;
-    if (current_node->child_nodes[index]->path_keys.size() == static_cast<size_t>(2 * min_degree_ - 1)) {
-      splitChildNode(current_node, index, current_node->child_nodes[index].get());
-      if (path_key > current_node->path_keys[index]) {
-        index++;
+  }
+
+  return {low, low < key_count && compareAt(low) == 0};
+}
+
+bool BTreeIndex::visitPrefixRange(const Node& node, std::string_view prefix, const PathVisitor& visitor) {
+  if (!node.is_leaf_node) {
+    // Every key starting with prefix is >= prefix, so earlier children cannot hold one
+    for (size_t i = childIndexFor(node, prefix); i < node.child_nodes.size(); ++i) {
+      if (!visitPrefixRange(*node.child_nodes[i], prefix, visitor)) {
+        return false;
       }
     }
-    insertIntoNonFullNode(current_node->child_nodes[index].get(), path_key);
+    return true;
+  }
+
+  for (size_t i = searchNode(node, prefix).index; i < node.keyCount(); ++i) {
+    std::string key = node.keyAt(i);
+    if (!std::string_view(key).starts_with(prefix)) {
+      return false;
+    }
+    visitor(key);
   }
+  return true;
+}
+
+size_t BTreeIndex::childIndexFor(const Node& node, std::string_view path_key) {
+  // Separator s routes keys >= s to the right-hand child
+  auto result = searchNode(node, path_key);
+  return result.exact ? result.index + 1 : result.index;
 }
 
-void BTreeIndex::splitChildNode(Node* parent_node, int child_index, Node* child_node) {
+std::string BTreeIndex::shortestSeparator(const std::string& left_key, const std::string& right_key) {
+  return right_key.substr(0, commonPrefixLength(left_key, right_key) + 1);
+}
+
+// ---------------------------------------------------------------------------
+// Structural changes
+// ---------------------------------------------------------------------------
+
+void BTreeIndex::splitChildNode(Node* parent_node, size_t child_index) {
+  Node* child_node = parent_node->child_nodes[child_index].get();
   auto new_sibling_node = std::make_unique<Node>(child_node->is_leaf_node);
+  auto keys = child_node->decodeKeys();
+  const size_t t = static_cast<size_t>(min_degree_);
+
+  std::string separator;
+  std::vector<std::string> left_keys;
+  std::vector<std::string> right_keys;
 
-  // Move mid_degree-1 keys to the new sibling node
-  for (int j = 0; j < min_degree_ - 1; j++) {
-    new_sibling_node->path_keys.push_back(child_node->path_keys[j + min_degree_]);
+  if (child_node->is_leaf_node) {
+    left_keys.assign(keys.begin(), keys.begin() + t);
+    right_keys.assign(keys.begin() + t, keys.end());
+    separator = shortestSeparator(left_keys.back(), right_keys.front());
+  } else {
+    left_keys.assign(keys.begin(), keys.begin() + t - 1);
+    separator = keys[t - 1];
+    right_keys.assign(keys.begin() + t, keys.end());
+
+    for (size_t j = t; j < child_node->child_nodes.size(); ++j) {
+      new_sibling_node->child_nodes.push_back(std::move(child_node->child_nodes[j]));
+    }
+    child_node->child_nodes.resize(t);
   }
 
+  child_node->encodeKeys(left_keys);
+  new_sibling_node->encodeKeys(right_keys);
+
+  auto parent_keys = parent_node->decodeKeys();
+  parent_keys.insert(parent_keys.begin() + child_index, separator);
+  parent_node->encodeKeys(parent_keys);
+  parent_node->child_nodes.insert(parent_node->child_nodes.begin() + child_index + 1,
+                                  std::move(new_sibling_node));
+}
+
+size_t BTreeIndex::fillChildNode(Node* parent_node, size_t child_index) {
+  size_t key_count = parent_node->keyCount();
+
+  if (child_index > 0 && hasSpareKey(parent_node->child_nodes[child_index - 1].get())) {
+    borrowFromPreviousSibling(parent_node, child_index);
+    return child_index;
+  }
+  if (child_index < key_count && hasSpareKey(parent_node->child_nodes[child_index + 1].get())) {
+    borrowFromNextSibling(parent_node, child_index);
+    return child_index;
+  }
+  if (child_index < key_count) {
+    mergeChildNodes(parent_node, child_index);
+    return child_index;
+  }
+  mergeChildNodes(parent_node, child_index - 1);
+  return child_index - 1;
+}
+
+void BTreeIndex::borrowFromPreviousSibling(Node* parent_node, size_t child_index) {
+  Node* child_node = parent_node->child_nodes[child_index].get();
+  Node* sibling_node = parent_node->child_nodes[child_index - 1].get();
+  auto parent_keys = parent_node->decodeKeys();
+  auto child_keys = child_node->decodeKeys();
+  auto sibling_keys = sibling_node->decodeKeys();
+
+  if (child_node->is_leaf_node) {
+    // Move the sibling's last path over and re-derive the separator
+    child_keys.insert(child_keys.begin(), std::move(sibling_keys.back()));
+    sibling_keys.pop_back();
+    parent_keys[child_index - 1] = shortestSeparator(sibling_keys.back(), child_keys.front());
+  } else {
+    // Rotate right: separator moves down, sibling's last key moves up
+    child_keys.insert(child_keys.begin(), std::move(parent_keys[child_index - 1]));
+    parent_keys[child_index - 1] = std::move(sibling_keys.back());
+    sibling_keys.pop_back();
+    child_node->child_nodes.insert(child_node->child_nodes.begin(),
+                                   std::move(sibling_node->child_nodes.back()));
+    sibling_node->child_nodes.pop_back();
+  }
+
+  parent_node->encodeKeys(parent_keys);
+  child_node->encodeKeys(child_keys);
+  sibling_node->encodeKeys(sibling_keys);
+}
+
+void BTreeIndex::borrowFromNextSibling(Node* parent_node, size_t child_index) {
+  Node* child_node = parent_node->child_nodes[child_index].get();
+  Node* sibling_node = parent_node->child_nodes[child_index + 1].get();
+  auto parent_keys = parent_node->decodeKeys();
+  auto child_keys = child_node->decodeKeys();
+  auto sibling_keys = sibling_node->decodeKeys();
+
+  if (child_node->is_leaf_node) {
+    // Move the sibling's first path over and re-derive the separator
+    child_keys.push_back(std::move(sibling_keys.front()));
+    sibling_keys.erase(sibling_keys.begin());
+    parent_keys[child_index] = shortestSeparator(child_keys.back(), sibling_keys.front());
+  } else {
+    // Rotate left: separator moves down, sibling's first key moves up
+    child_keys.push_back(std::move(parent_keys[child_index]));
+    parent_keys[child_index] = std::move(sibling_keys.front());
+    sibling_keys.erase(sibling_keys.begin());
+    child_node->child_nodes.push_back(std::move(sibling_node->child_nodes.front()));
+    sibling_node->child_nodes.erase(sibling_node->child_nodes.begin());
+  }
+
+  parent_node->encodeKeys(parent_keys);
+  child_node->encodeKeys(child_keys);
+  sibling_node->encodeKeys(sibling_keys);
+}
+
+void BTreeIndex::mergeChildNodes(Node* parent_node, size_t key_index) {
+  Node* child_node = parent_node->child_nodes[key_index].get();
+  std::unique_ptr<Node> sibling_node = std::move(parent_node->child_nodes[key_index + 1]);
+  auto parent_keys = parent_node->decodeKeys();
+  auto child_keys = child_node->decodeKeys();
+
+  // Leaves already hold every path, so their separator is simply dropped
   if (!child_node->is_leaf_node) {
-    for (int j = 0; j < min_degree_; j++) {
-      new_sibling_node->child_nodes.push_back(std::move(child_node->child_nodes[j + min_degree_]));
-    }
-    child_node->child_nodes.erase(child_node->child_nodes.begin() + min_degree_, child_node->child_nodes.end());
+    child_keys.push_back(std::move(parent_keys[key_index]));
+  }
+  for (auto& key : sibling_node->decodeKeys()) {
+    child_keys.push_back(std::move(key));
+  }
+  for (auto& child : sibling_node->child_nodes) {
+    child_node->child_nodes.push_back(std::move(child));
   }
 
-  std::string middle_key = child_node->path_keys[min_degree_ - 1];
-  child_node->path_keys.erase(child_node->path_keys.begin() + min_degree_ - 1, child_node->path_keys.end());
+  parent_keys.erase(parent_keys.begin() + key_index);
+  parent_node->child_nodes.erase(parent_node->child_nodes.begin() + key_index + 1);
+
+  parent_node->encodeKeys(parent_keys);
+  child_node->encodeKeys(child_keys);
+}
+
+void BTreeIndex::shrinkRootIfEmpty() {
+  if (root_node_->keyCount() == 0 && !root_node_->is_leaf_node) {
+    std::unique_ptr<Node> new_root = std::move(root_node_->child_nodes.front());
+    root_node_ = std::move(new_root);
+  }
+}
 
-  parent_node->child_nodes.insert(parent_node->child_nodes.begin() + child_index + 1, std::move(new_sibling_node));
-  parent_node->path_keys.insert(parent_node->path_keys.begin() + child_index, middle_key);
+bool BTreeIndex::hasSpareKey(const Node* node) const {
+  return node->keyCount() >= static_cast<size_t>(min_degree_);
 }
 
 } // namespace kallisto
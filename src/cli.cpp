@@ -8,6 +8,9 @@
  *   kallisto SAVE
  *   kallisto MODE BATCH
  *   kallisto MODE IMMEDIATE
+ *   kallisto COMPACT
+ *   kallisto DESTROY_PREFIX apps/billing/
+ *   kallisto STATS
  */
 
 #include <cstring>
@@ -55,7 +58,10 @@ void printUsage() {
             << "Commands:\n"
             << "  SAVE             Force flush RocksDB to disk\n"
             << "  MODE BATCH       Switch to asynchronous batch persistence\n"
-            << "  MODE IMMEDIATE   Switch to synchronous strict persistence\n";
+            << "  MODE IMMEDIATE   Switch to synchronous strict persistence\n"
+            << "  COMPACT          Prune versions beyond each key's history limit\n"
+            << "  DESTROY_PREFIX p Destroy every secret whose path starts with p\n"
+            << "  STATS            Write-behind flusher: batch sizes, queue depth, lag\n";
 }
 
 std::string buildCommandFromArgs(int argc, char** argv) {
@@ -44,7 +44,7 @@ uint64_t CuckooTable::hash2Full(const std::string& key) const {
   return SipHash::hash(key, 0xFACEB00C64, 0xDEADC0DE64);
 }
 
-bool CuckooTable::insert(const std::string& key, const SecretEntry& entry) {
+bool CuckooTable::insert(const std::string& key, const SecretEntry& entry, bool overwrite) {
   std::unique_lock<std::shared_mutex> lock(rw_lock_); // WRITER LOCK (Exclusive)
 
   // ... [Logic for update/insert remains same] ...
@@ -57,6 +57,9 @@ bool CuckooTable::insert(const std::string& key, const SecretEntry& entry) {
   for (const auto& slot : table_1_[idx1].slots) {
     if (slot.index != invalid_index && slot.tag == tag) {
       if (storage_[slot.index].key == key) {
+        if (!overwrite) {
+          return true;
+        }
         storage_[slot.index] = entry; // Update in place
         storage_[slot.index].key = key;
         return true;
@@ -70,6 +73,9 @@ bool CuckooTable::insert(const std::string& key, const SecretEntry& entry) {
   for (const auto& slot : table_2_[idx2].slots) {
     if (slot.index != invalid_index) {
       if (slot.tag == tag && storage_[slot.index].key == key) {
+        if (!overwrite) {
+          return true;
+        }
         storage_[slot.index] = entry;
         storage_[slot.index].key = key;
         return true;
@@ -142,6 +148,8 @@ bool CuckooTable::insert(const std::string& key, const SecretEntry& entry) {
   // In a real DB we would need a transaction rollback here.
   // For MVP, valid data is left "floating" in storage but unreachable by hash.
   // It's a leak in terms of capacity, but safe in terms of logic.
+  // A shared buffer is not kept alive by the floating entry, though.
+  storage_[current_index].shared_value.reset();
   return false;
 }
 
@@ -174,6 +182,36 @@ std::optional<SecretEntry> CuckooTable::lookup(const std::string& key) const {
   return std::nullopt;
 }
 
+uint32_t CuckooTable::findIndex(const std::string& key) const {
+  uint64_t h1_raw = hash1Full(key);
+  uint32_t tag = getTag(h1_raw);
+  size_t idx1 = h1_raw % capacity_;
+
+  for (const auto& slot : table_1_[idx1].slots) {
+    if (slot.index != invalid_index && slot.tag == tag && storage_[slot.index].key == key) {
+      return slot.index;
+    }
+  }
+
+  size_t idx2 = hash2Full(key) % capacity_;
+  for (const auto& slot : table_2_[idx2].slots) {
+    if (slot.index != invalid_index && slot.tag == tag && storage_[slot.index].key == key) {
+      return slot.index;
+    }
+  }
+  return invalid_index;
+}
+
+std::shared_ptr<const std::string> CuckooTable::lookupShared(const std::string& key) const {
+  std::shared_lock<std::shared_mutex> lock(rw_lock_); // READER LOCK (Shared)
+
+  uint32_t index = findIndex(key);
+  if (index == invalid_index) {
+    return nullptr;
+  }
+  return storage_[index].shared_value;
+}
+
 std::vector<SecretEntry> CuckooTable::getAllEntries() const {
   std::shared_lock<std::shared_mutex> lock(rw_lock_); // READER LOCK (Shared)
 
@@ -207,11 +245,7 @@ bool CuckooTable::remove(const std::string& key) {
   for (auto& slot : table_1_[idx1].slots) {
     if (slot.index != invalid_index && slot.tag == tag) {
       if (storage_[slot.index].key == key) {
-        uint32_t removed_index = slot.index;
-        slot.index = invalid_index;
-        slot.tag = 0;
-        free_list_.push_back(removed_index);
-        shadow_free_list_size_.store(free_list_.size(), std::memory_order_relaxed);
+        release(slot);
         return true;
       }
     }
@@ -223,11 +257,7 @@ bool CuckooTable::remove(const std::string& key) {
   for (auto& slot : table_2_[idx2].slots) {
     if (slot.index != invalid_index && slot.tag == tag) {
       if (storage_[slot.index].key == key) {
-        uint32_t removed_index = slot.index;
-        slot.index = invalid_index;
-        slot.tag = 0;
-        free_list_.push_back(removed_index);
-        shadow_free_list_size_.store(free_list_.size(), std::memory_order_relaxed);
+        release(slot);
         return true;
       }
     }
@@ -236,6 +266,32 @@ bool CuckooTable::remove(const std::string& key) {
   return false;
 }
 
+size_t CuckooTable::removePrefix(const std::string& prefix) {
+  std::unique_lock<std::shared_mutex> lock(rw_lock_); // WRITER LOCK (Exclusive)
+
+  size_t removed = 0;
+  for (auto* table : {&table_1_, &table_2_}) {
+    for (auto& bucket : *table) {
+      for (auto& slot : bucket.slots) {
+        if (slot.index != invalid_index && storage_[slot.index].key.starts_with(prefix)) {
+          release(slot);
+          ++removed;
+        }
+      }
+    }
+  }
+  return removed;
+}
+
+void CuckooTable::release(Bucket::Slot& slot) {
+  // Drop the shared buffer now rather than when the storage is reused
+  storage_[slot.index].shared_value.reset();
+  free_list_.push_back(slot.index);
+  shadow_free_list_size_.store(free_list_.size(), std::memory_order_relaxed);
+  slot.index = invalid_index;
+  slot.tag = 0;
+}
+
 void CuckooTable::rehash() {
   // ARCHITECTURAL DECISION: No Rehash
   // We intentionally disable dynamic resizing. In high-security environments:
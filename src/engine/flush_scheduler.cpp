@@ -0,0 +1,135 @@
+#include "kallisto/engine/flush_scheduler.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+namespace kallisto::engine {
+
+// =============================================================================
+// Log2Histogram
+// =============================================================================
+
+void Log2Histogram::record(uint64_t value) {
+    buckets_[std::bit_width(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    uint64_t seen = max_.load(std::memory_order_relaxed);
+    while (value > seen && !max_.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t Log2Histogram::percentile(double quantile) const {
+    const uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+    const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(quantile * total)));
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < num_buckets; ++bucket) {
+        seen += buckets_[bucket].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            const uint64_t upper = bucket == 0 ? 0
+                                 : bucket == 64 ? std::numeric_limits<uint64_t>::max()
+                                 : (uint64_t{1} << bucket) - 1;
+            return std::min(upper, max());
+        }
+    }
+    return max();
+}
+
+// =============================================================================
+// FlushScheduler
+// =============================================================================
+
+FlushScheduler::FlushScheduler(FlushPolicy policy)
+    : target_lag_us_(policy.target_p99_lag.count())
+    , max_batch_(std::max<size_t>(1, policy.max_batch))
+    , batch_limit_(std::min<size_t>(1024, max_batch_.load()))
+    , window_us_(static_cast<uint64_t>(std::max<int64_t>(0, policy.target_p99_lag.count() / 2))) {
+}
+
+void FlushScheduler::setPolicy(const FlushPolicy& policy) {
+    target_lag_us_.store(policy.target_p99_lag.count(), std::memory_order_relaxed);
+    max_batch_.store(std::max<size_t>(1, policy.max_batch), std::memory_order_relaxed);
+    // Takes effect now; the next flush recomputes both from the new target
+    batch_limit_.store(std::min(batch_limit_.load(std::memory_order_relaxed), max_batch_.load()),
+                       std::memory_order_relaxed);
+    window_us_.store(std::min<uint64_t>(window_us_.load(std::memory_order_relaxed),
+                                        std::max<int64_t>(0, policy.target_p99_lag.count())),
+                     std::memory_order_relaxed);
+}
+
+FlushPolicy FlushScheduler::policy() const {
+    FlushPolicy policy;
+    policy.target_p99_lag = std::chrono::microseconds(target_lag_us_.load(std::memory_order_relaxed));
+    policy.max_batch = max_batch_.load(std::memory_order_relaxed);
+    return policy;
+}
+
+void FlushScheduler::recordFlush(size_t batch_size, size_t queue_depth, std::chrono::microseconds write_latency,
+                                 std::chrono::microseconds oldest_lag, std::chrono::steady_clock::time_point now) {
+    flushes_.fetch_add(1, std::memory_order_relaxed);
+    records_.fetch_add(batch_size, std::memory_order_relaxed);
+    queue_depth_.record(queue_depth);
+    batch_size_.record(batch_size);
+    lag_us_.record(static_cast<uint64_t>(std::max<int64_t>(0, oldest_lag.count())));
+
+    // EWMAs (alpha = 0.2): react within a handful of flushes, ignore single outliers
+    const double write_us = static_cast<double>(write_latency.count());
+    double latency = write_latency_us_.load(std::memory_order_relaxed);
+    latency = latency == 0 ? write_us : 0.8 * latency + 0.2 * write_us;
+    write_latency_us_.store(latency, std::memory_order_relaxed);
+
+    double rate = arrival_rate_.load(std::memory_order_relaxed);
+    if (last_flush_ != std::chrono::steady_clock::time_point{}) {
+        const double interval_s = std::chrono::duration<double>(now - last_flush_).count();
+        if (interval_s > 0) {
+            const double sample = static_cast<double>(batch_size) / interval_s;
+            rate = rate == 0 ? sample : 0.8 * rate + 0.2 * sample;
+            arrival_rate_.store(rate, std::memory_order_relaxed);
+        }
+    }
+    last_flush_ = now;
+
+    // Overshooting the target backs off fast; recovery is gradual
+    const auto target_us = static_cast<double>(target_lag_us_.load(std::memory_order_relaxed));
+    if (static_cast<double>(oldest_lag.count()) > target_us) {
+        headroom_ = std::max(0.05, headroom_ * 0.7);
+    } else {
+        headroom_ = std::min(1.0, headroom_ + 0.02);
+    }
+
+    // Twice the mean write latency is kept aside for its variance
+    const double window_us = std::max(0.0, target_us - 2 * latency) * headroom_;
+    window_us_.store(static_cast<uint64_t>(window_us), std::memory_order_relaxed);
+
+    const size_t max_batch = max_batch_.load(std::memory_order_relaxed);
+    auto limit = static_cast<size_t>(std::clamp(rate * window_us / 1e6, 1.0, static_cast<double>(max_batch)));
+    if (queue_depth > 0) {
+        // Backlog: the rate estimate lags behind, grow batches until caught up
+        limit = std::min(max_batch, std::max(limit, batch_size * 2));
+    }
+    batch_limit_.store(limit, std::memory_order_relaxed);
+}
+
+FlushStats FlushScheduler::stats() const {
+    FlushStats stats;
+    stats.flushes = flushes_.load(std::memory_order_relaxed);
+    stats.records = records_.load(std::memory_order_relaxed);
+    stats.batch_limit = batchLimit();
+    stats.window_us = window_us_.load(std::memory_order_relaxed);
+    stats.arrival_rate = arrival_rate_.load(std::memory_order_relaxed);
+    stats.write_latency_us = static_cast<uint64_t>(write_latency_us_.load(std::memory_order_relaxed));
+    stats.queue_depth_p50 = queue_depth_.percentile(0.50);
+    stats.queue_depth_p99 = queue_depth_.percentile(0.99);
+    stats.queue_depth_max = queue_depth_.max();
+    stats.batch_size_p50 = batch_size_.percentile(0.50);
+    stats.batch_size_p99 = batch_size_.percentile(0.99);
+    stats.batch_size_max = batch_size_.max();
+    stats.lag_p50_us = lag_us_.percentile(0.50);
+    stats.lag_p99_us = lag_us_.percentile(0.99);
+    stats.lag_max_us = lag_us_.max();
+    return stats;
+}
+
+} // namespace kallisto::engine
@@ -0,0 +1,67 @@
+#include "kallisto/engine/group_commit.hpp"
+
+namespace kallisto::engine {
+
+bool GroupCommitter::commit(std::vector<RocksDBStorage::BatchOpView> ops) {
+    if (ops.empty()) {
+        return true;
+    }
+    Request request{std::move(ops)};
+
+    std::unique_lock lock(mutex_);
+    pending_.push_back(&request);
+    while (!request.done) {
+        if (leader_active_) {
+            done_cv_.wait(lock);
+            continue;
+        }
+
+        // Lead: everything queued so far goes out in this group
+        leader_active_ = true;
+        std::vector<Request*> group;
+        group.swap(pending_);
+        lock.unlock();
+
+        std::vector<RocksDBStorage::BatchOpView> merged;
+        if (group.size() == 1) {
+            merged = std::move(group.front()->ops);
+        } else {
+            size_t total = 0;
+            for (const Request* member : group) {
+                total += member->ops.size();
+            }
+            merged.reserve(total);
+            for (Request* member : group) {
+                merged.insert(merged.end(), member->ops.begin(), member->ops.end());
+            }
+        }
+        const bool ok = storage_.applyBatch(merged, true);
+
+        commits_.fetch_add(group.size(), std::memory_order_relaxed);
+        groups_.fetch_add(1, std::memory_order_relaxed);
+        uint64_t largest = max_group_.load(std::memory_order_relaxed);
+        while (group.size() > largest &&
+               !max_group_.compare_exchange_weak(largest, group.size(), std::memory_order_relaxed)) {
+        }
+
+        lock.lock();
+        for (Request* member : group) {
+            member->ok = ok;
+            member->done = true;
+        }
+        leader_active_ = false;
+        // Wakes this group's followers and lets a queued caller lead the next one
+        done_cv_.notify_all();
+    }
+    return request.ok;
+}
+
+GroupCommitStats GroupCommitter::stats() const {
+    GroupCommitStats stats;
+    stats.commits = commits_.load(std::memory_order_relaxed);
+    stats.groups = groups_.load(std::memory_order_relaxed);
+    stats.max_group = max_group_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace kallisto::engine
@@ -0,0 +1,140 @@
+#include "kallisto/engine/head_cache.hpp"
+#include <algorithm>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace kallisto::engine {
+
+template <typename T>
+SharedCache<T>::SharedCache(size_t capacity)
+    : shards_(std::make_unique<std::array<Shard, num_shards>>())
+    , shard_capacity_(std::max<size_t>(1, capacity / num_shards)) {
+}
+
+template <typename T>
+size_t SharedCache<T>::shardIndex(std::string_view key) const {
+    // High bits pick the shard; the map's buckets use the low ones
+    return (KeyHash{}(key) >> 48) & (num_shards - 1);
+}
+
+template <typename T>
+typename SharedCache<T>::Shard& SharedCache<T>::shardFor(std::string_view key) const {
+    return (*shards_)[shardIndex(key)];
+}
+
+template <typename T>
+typename SharedCache<T>::Ptr SharedCache<T>::lookup(std::string_view key) const {
+    const Shard& shard = shardFor(key);
+    std::shared_lock lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it == shard.entries.end()) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+template <typename T>
+void SharedCache<T>::lookupMany(std::span<const std::string_view> keys, std::span<Ptr> out) const {
+    std::vector<std::pair<size_t, size_t>> order; // (shard, key index)
+    order.reserve(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        order.emplace_back(shardIndex(keys[i]), i);
+    }
+    std::sort(order.begin(), order.end());
+
+    for (size_t begin = 0; begin < order.size();) {
+        const Shard& shard = (*shards_)[order[begin].first];
+        size_t end = begin;
+        std::shared_lock lock(shard.mutex);
+        for (; end < order.size() && order[end].first == order[begin].first; ++end) {
+            const size_t i = order[end].second;
+            auto it = shard.entries.find(keys[i]);
+            out[i] = it == shard.entries.end() ? nullptr : it->second;
+        }
+        begin = end;
+    }
+}
+
+template <typename T>
+bool SharedCache<T>::insert(std::string_view key, Ptr value, bool overwrite) {
+    Shard& shard = shardFor(key);
+    std::unique_lock lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it != shard.entries.end()) {
+        if (overwrite) {
+            it->second = std::move(value);
+        }
+        return true;
+    }
+    if (shard.entries.size() >= shard_capacity_) {
+        return false;
+    }
+    shard.entries.emplace(std::string(key), std::move(value));
+    size_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+template <typename T>
+void SharedCache<T>::publish(std::string_view key, Ptr value) {
+    Shard& shard = shardFor(key);
+    std::unique_lock lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it != shard.entries.end()) {
+        it->second = std::move(value);
+        return;
+    }
+    shard.entries.emplace(std::string(key), std::move(value));
+    size_.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename T>
+bool SharedCache<T>::replaceIf(std::string_view key, const Ptr& expected, Ptr desired) {
+    Shard& shard = shardFor(key);
+    std::unique_lock lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it == shard.entries.end() || it->second != expected) {
+        return false;
+    }
+    it->second = std::move(desired);
+    return true;
+}
+
+template <typename T>
+void SharedCache<T>::remove(std::string_view key) {
+    Shard& shard = shardFor(key);
+    std::unique_lock lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it != shard.entries.end()) {
+        shard.entries.erase(it);
+        size_.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+bool SharedCache<T>::removeIf(std::string_view key, const Ptr& expected) {
+    Shard& shard = shardFor(key);
+    std::unique_lock lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it == shard.entries.end() || it->second != expected) {
+        return false;
+    }
+    shard.entries.erase(it);
+    size_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+template <typename T>
+size_t SharedCache<T>::removePrefix(std::string_view prefix) {
+    size_t removed = 0;
+    for (auto& shard : *shards_) {
+        std::unique_lock lock(shard.mutex);
+        removed += std::erase_if(shard.entries, [prefix](const auto& entry) { return entry.first.starts_with(prefix); });
+    }
+    size_.fetch_sub(removed, std::memory_order_relaxed);
+    return removed;
+}
+
+template class SharedCache<PathHead>;
+
+} // namespace kallisto::engine
@@ -0,0 +1,62 @@
+#include "kallisto/engine/io_pool.hpp"
+#include <algorithm>
+
+namespace kallisto::engine {
+
+IoPool::IoPool(size_t threads, size_t max_pending)
+    : max_pending_(std::max<size_t>(1, max_pending)) {
+    const size_t count = std::max<size_t>(1, threads);
+    threads_.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        threads_.emplace_back(&IoPool::run, this);
+    }
+}
+
+IoPool::~IoPool() {
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+bool IoPool::submit(Task task) {
+    {
+        std::lock_guard lock(mutex_);
+        if (stopping_ || tasks_.size() >= max_pending_) {
+            ++rejected_;
+            return false;
+        }
+        tasks_.push_back(std::move(task));
+        ++submitted_;
+    }
+    cv_.notify_one();
+    return true;
+}
+
+IoPoolStats IoPool::stats() const {
+    std::lock_guard lock(mutex_);
+    return IoPoolStats{submitted_, rejected_, tasks_.size()};
+}
+
+void IoPool::run() {
+    for (;;) {
+        Task task;
+        {
+            std::unique_lock lock(mutex_);
+            cv_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+            // Drain before exiting: every accepted task runs
+            if (tasks_.empty()) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
+
+} // namespace kallisto::engine
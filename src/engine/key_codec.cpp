@@ -0,0 +1,147 @@
+#include "kallisto/engine/key_codec.hpp"
+#include <charconv>
+#include <cstring>
+
+namespace kallisto::engine {
+
+namespace {
+
+constexpr char meta_record = '\x01';
+constexpr char version_record = '\x02';
+constexpr char escape_byte = '\x00';
+constexpr char escaped_zero = '\xFF';
+constexpr char terminator = '\x01';
+
+void appendEscaped(std::string& key, std::string_view path) {
+    // Fast path: paths almost never hold a zero byte
+    if (std::memchr(path.data(), 0, path.size()) == nullptr) {
+        key.append(path);
+        return;
+    }
+    for (char c : path) {
+        key.push_back(c);
+        if (c == escape_byte) {
+            key.push_back(escaped_zero);
+        }
+    }
+}
+
+std::string pathKey(char record, std::string_view path, size_t suffix_size) {
+    std::string key;
+    key.reserve(1 + path.size() + 2 + suffix_size);
+    key.push_back(record);
+    appendEscaped(key, path);
+    key.push_back(escape_byte);
+    key.push_back(terminator);
+    return key;
+}
+
+/**
+ * Decodes the escaped, terminated path at the start of encoded.
+ * @return The path, and in consumed the bytes read, terminator included.
+ */
+std::optional<std::string> decodePath(std::string_view encoded, size_t& consumed) {
+    const void* zero = std::memchr(encoded.data(), 0, encoded.size());
+    if (zero == nullptr) {
+        return std::nullopt;
+    }
+    size_t pos = static_cast<const char*>(zero) - encoded.data();
+    if (pos + 1 < encoded.size() && encoded[pos + 1] == terminator) {
+        consumed = pos + 2;
+        return std::string(encoded.substr(0, pos));
+    }
+
+    std::string path(encoded.substr(0, pos));
+    for (; pos + 1 < encoded.size(); ++pos) {
+        const char c = encoded[pos];
+        if (c != escape_byte) {
+            path.push_back(c);
+            continue;
+        }
+        const char next = encoded[++pos];
+        if (next == terminator) {
+            consumed = pos + 1;
+            return path;
+        }
+        if (next != escaped_zero) {
+            return std::nullopt;
+        }
+        path.push_back(escape_byte);
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+std::string buildMetaKey(std::string_view path) {
+    return pathKey(meta_record, path, 0);
+}
+
+std::string buildVersionKey(std::string_view path, uint32_t version) {
+    std::string key = pathKey(version_record, path, 4);
+    key.push_back(static_cast<char>(version >> 24));
+    key.push_back(static_cast<char>(version >> 16));
+    key.push_back(static_cast<char>(version >> 8));
+    key.push_back(static_cast<char>(version));
+    return key;
+}
+
+std::string metaKeyPrefix(std::string_view path_prefix) {
+    std::string key(1, meta_record);
+    appendEscaped(key, path_prefix);
+    return key;
+}
+
+std::string versionKeyPrefix(std::string_view path_prefix) {
+    std::string key(1, version_record);
+    appendEscaped(key, path_prefix);
+    return key;
+}
+
+std::optional<std::string> parseMetaKey(std::string_view key) {
+    if (key.empty() || key[0] != meta_record) {
+        return std::nullopt;
+    }
+    size_t consumed = 0;
+    auto path = decodePath(key.substr(1), consumed);
+    if (!path || 1 + consumed != key.size()) {
+        return std::nullopt;
+    }
+    return path;
+}
+
+std::optional<VersionKey> parseVersionKey(std::string_view key) {
+    if (key.empty() || key[0] != version_record) {
+        return std::nullopt;
+    }
+    size_t consumed = 0;
+    auto path = decodePath(key.substr(1), consumed);
+    if (!path || 1 + consumed + 4 != key.size()) {
+        return std::nullopt;
+    }
+    const auto* bytes = reinterpret_cast<const unsigned char*>(key.data() + 1 + consumed);
+    const uint32_t version = (uint32_t{bytes[0]} << 24) | (uint32_t{bytes[1]} << 16) |
+                             (uint32_t{bytes[2]} << 8) | uint32_t{bytes[3]};
+    return VersionKey{std::move(*path), version};
+}
+
+std::optional<VersionKey> parseLegacyVersionKey(std::string_view key) {
+    if (!key.starts_with(legacy_version_key_prefix)) {
+        return std::nullopt;
+    }
+    key.remove_prefix(legacy_version_key_prefix.size());
+    const size_t separator = key.rfind(':');
+    if (separator == std::string_view::npos) {
+        return std::nullopt;
+    }
+    uint32_t version = 0;
+    const char* first = key.data() + separator + 1;
+    const char* last = key.data() + key.size();
+    auto [end, ec] = std::from_chars(first, last, version);
+    if (ec != std::errc() || end != last || first == last) {
+        return std::nullopt;
+    }
+    return VersionKey{std::string(key.substr(0, separator)), version};
+}
+
+} // namespace kallisto::engine
@@ -1,7 +1,23 @@
 #include "kallisto/engine/kv_engine.hpp"
+#include "kallisto/engine/key_codec.hpp"
+#include "kallisto/engine/metadata_codec.hpp"
 #include "kallisto/rocksdb_storage.hpp"
+#include "kallisto/logger.hpp"
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
+#include <cstdint>
 #include <cstring>
+#include <future>
+#include <iterator>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 namespace kallisto::engine {
 
@@ -30,47 +46,47 @@ std::optional<SecretPayload> deserializePayload(const std::string& data) {
     return p;
 }
 
-std::string serializeMetadata(const KeyMetadata& meta) {
-    std::string buf;
-    size_t size = 4 + 4 + 1 + 8 + 4 + meta.versions.size() * sizeof(VersionState);
-    buf.reserve(size);
-    buf.append(reinterpret_cast<const char*>(&meta.current_version), 4);
-    buf.append(reinterpret_cast<const char*>(&meta.max_versions), 4);
-    buf.append(reinterpret_cast<const char*>(&meta.cas_required), 1);
-    buf.append(reinterpret_cast<const char*>(&meta.delete_version_after_ms), 8);
-    uint32_t v_size = meta.versions.size();
-    buf.append(reinterpret_cast<const char*>(&v_size), 4);
-    if (v_size > 0) {
-        buf.append(reinterpret_cast<const char*>(meta.versions.data()), v_size * sizeof(VersionState));
-    }
-    return buf;
-}
-
-std::optional<KeyMetadata> deserializeMetadata(const std::string& data) {
-    if (data.size() < 21) { 
-		return std::nullopt;
-	}
-    KeyMetadata m;
-    const char* ptr = data.data();
-    std::memcpy(&m.current_version, ptr, 4); ptr += 4;
-    std::memcpy(&m.max_versions, ptr, 4); ptr += 4;
-    std::memcpy(&m.cas_required, ptr, 1); ptr += 1;
-    std::memcpy(&m.delete_version_after_ms, ptr, 8); ptr += 8;
-    uint32_t v_size;
-    std::memcpy(&v_size, ptr, 4); ptr += 4;
-    if (v_size > 0 && data.size() >= 21 + v_size * sizeof(VersionState)) {
-        m.versions.resize(v_size);
-        std::memcpy(m.versions.data(), ptr, v_size * sizeof(VersionState));
+tl::expected<SecretPayload, EngineError> decodePayload(const std::string& data) {
+    auto payload = deserializePayload(data);
+    if (!payload) {
+        return tl::unexpected(EngineError::StorageError);
     }
-    return m;
+    return std::move(*payload);
 }
 
-std::string buildMetaKey(std::string_view path) {
-    return "m:" + std::string(path);
+bool allVersionsDestroyed(const KeyMetadata& meta) {
+    return std::all_of(meta.versions.begin(), meta.versions.end(),
+                       [](const VersionState& vs) { return vs.destroyed; });
 }
 
-std::string buildVersionKey(std::string_view path, uint32_t version) {
-    return "v:" + std::string(path) + ":" + std::to_string(version);
+/**
+ * The version a read of version (0 = latest) targets, if it can be served.
+ */
+tl::expected<uint32_t, EngineError> resolveVersion(const KeyMetadata& meta, uint32_t version) {
+    uint32_t target_version = (version == 0) ? meta.current_version : version;
+    
+    if (target_version == 0 || target_version > meta.current_version) {
+        return tl::unexpected(EngineError::InvalidVersion);
+    }
+    
+    const VersionState* state = nullptr;
+    for (const auto& vs : meta.versions) {
+        if (vs.version_id == target_version) {
+            state = &vs;
+            break;
+        }
+    }
+    
+    if (!state) { 
+		return tl::unexpected(EngineError::InvalidVersion);
+	}
+    if (state->destroyed) { 
+		return tl::unexpected(EngineError::Destroyed);
+	}
+    if (state->deletion_time_ms > 0) { 
+		return tl::unexpected(EngineError::SoftDeleted);
+	}
+    return target_version;
 }
 
 uint64_t nowMs() {
@@ -82,36 +98,85 @@ uint64_t nowMs() {
 // CuckooTable Adapter (Legacy Seam)
 // ==========================================
 
-void cacheRaw(ShardedCuckooTable* cache, const std::string& raw_key, const std::string& serialized) {
+bool cacheShared(ShardedCuckooTable& cache, const std::string& vkey, SharedBytes bytes, bool overwrite = true) {
     SecretEntry entry;
-    entry.path = raw_key;
-    entry.key = "";
-    entry.value = serialized;
     entry.ttl = 0;
-    cache->insert(raw_key, entry);
+    entry.shared_value = std::move(bytes);
+    return cache.insert(vkey, entry, overwrite);
 }
 
-std::optional<std::string> getCachedRaw(ShardedCuckooTable* cache, const std::string& raw_key) {
-    auto res = cache->lookup(raw_key);
-    if (res) {
-		return res->value;
-	}
-    return std::nullopt;
+// ==========================================
+// Write-Behind Record Codec
+// ==========================================
+// [enqueued_at:8B][op_count:4B][sync:1B] then per op [type:1B][key_len:4B][value_len:4B][key][value]
+
+using BatchOp = RocksDBStorage::BatchOp;
+using BatchOpView = RocksDBStorage::BatchOpView;
+
+template <typename WriteOps>
+size_t encodedRecordSize(const WriteOps& ops) {
+    size_t size = 8 + 4 + 1;
+    for (const auto& op : ops) {
+        size += 1 + 4 + 4 + op.key.size() + op.bytes().size();
+    }
+    return size;
 }
 
-void uncacheRaw(ShardedCuckooTable* cache, const std::string& raw_key) {
-    cache->remove(raw_key);
+std::byte* putBytes(std::byte* dst, const void* src, size_t size) {
+    std::memcpy(dst, src, size);
+    return dst + size;
 }
 
-std::optional<std::string> readRawOptimistic(RocksDBStorage* db, ShardedCuckooTable* cache, const std::string& key) {
-    if (auto cached = getCachedRaw(cache, key)) {
-        return cached;
+template <typename WriteOps>
+void encodeRecord(std::byte* dst, const WriteOps& ops, std::chrono::steady_clock::time_point enqueued_at, bool sync) {
+    const int64_t ticks = enqueued_at.time_since_epoch().count();
+    const auto count = static_cast<uint32_t>(ops.size());
+    const uint8_t sync_flag = sync ? 1 : 0;
+    dst = putBytes(dst, &ticks, sizeof(ticks));
+    dst = putBytes(dst, &count, sizeof(count));
+    dst = putBytes(dst, &sync_flag, sizeof(sync_flag));
+    for (const auto& op : ops) {
+        const std::string_view value = op.bytes();
+        const uint8_t type = op.type == BatchOp::Type::PUT ? 0 : 1;
+        const auto key_len = static_cast<uint32_t>(op.key.size());
+        const auto value_len = static_cast<uint32_t>(value.size());
+        dst = putBytes(dst, &type, sizeof(type));
+        dst = putBytes(dst, &key_len, sizeof(key_len));
+        dst = putBytes(dst, &value_len, sizeof(value_len));
+        dst = putBytes(dst, op.key.data(), key_len);
+        dst = putBytes(dst, value.data(), value_len);
     }
-    if (auto disk = db->getRaw(key)) {
-        cacheRaw(cache, key, *disk);
-        return disk;
+}
+
+struct RecordHeader {
+    std::chrono::steady_clock::time_point enqueued_at;
+    bool sync; // Must be fsynced before its ticket is reported durable
+};
+
+/**
+ * Appends the record's ops to batch as views into the record's bytes.
+ */
+RecordHeader decodeRecord(std::span<const std::byte> record, std::vector<BatchOpView>& batch) {
+    const auto* src = reinterpret_cast<const char*>(record.data());
+    int64_t ticks;
+    uint32_t count;
+    uint8_t sync_flag;
+    std::memcpy(&ticks, src, sizeof(ticks));
+    std::memcpy(&count, src + 8, sizeof(count));
+    std::memcpy(&sync_flag, src + 12, sizeof(sync_flag));
+    src += 8 + 4 + 1;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint8_t type;
+        uint32_t key_len, value_len;
+        std::memcpy(&type, src, sizeof(type));
+        std::memcpy(&key_len, src + 1, sizeof(key_len));
+        std::memcpy(&value_len, src + 5, sizeof(value_len));
+        src += 9;
+        batch.push_back({type == 0 ? BatchOp::Type::PUT : BatchOp::Type::DEL,
+                         std::string_view(src, key_len), std::string_view(src + key_len, value_len)});
+        src += key_len + value_len;
     }
-    return std::nullopt;
+    return {std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(ticks)), sync_flag != 0};
 }
 
 } // namespace
@@ -120,89 +185,578 @@ std::optional<std::string> readRawOptimistic(RocksDBStorage* db, ShardedCuckooTa
 // Engine Implementation
 // ==========================================
 
-KvEngine::KvEngine(const std::string& db_path) {
-    storage_ = std::make_unique<ShardedCuckooTable>(default_cuckoo_size);
-    path_index_ = std::make_unique<TlsBTreeManager>(default_btree_degree, nullptr);
+KvEngine::KvEngine(const std::string& db_path, PathIndexType path_index_type, RecoveryOptions recovery,
+                   MountConfig config, WriteBehindOptions write_behind, ReadIoOptions read_io)
+    : max_versions_(config.max_versions) {
+    payload_cache_ = std::make_unique<ShardedCuckooTable>(default_payload_cache_size);
+    head_cache_ = std::make_unique<HeadCache>(default_head_cache_size);
+    path_index_ = std::make_unique<TlsBTreeManager>(default_btree_degree, path_index_type);
     rocksdb_persistence_ = std::make_unique<RocksDBStorage>(db_path);
+    group_commit_ = std::make_unique<GroupCommitter>(*rocksdb_persistence_);
+    read_pool_ = std::make_unique<IoPool>(read_io.threads, read_io.max_pending);
+    write_pool_ = std::make_unique<IoPool>(write_pool_threads, write_pool_pending);
+    coalesce_misses_ = read_io.coalesce;
+    negative_cache_ = std::make_unique<NegativeCache>(read_io.negative_capacity, read_io.negative_ttl);
 
     rocksdb_persistence_->setSync(sync_mode_.load(std::memory_order_relaxed) == SyncMode::IMMEDIATE);
 
-    // Rebuild B-Tree index from WAL
-    rocksdb_persistence_->iterateAll([this](const SecretEntry& entry) {
-        path_index_->insertPathIfAbsent(entry.path);
-    });
+    // Before anything reads a record: recovery and disk reads expect the current formats
+    migrateKeyFormat();
+    migrateMetadataFormat();
 
-    async_worker_ = std::thread(&KvEngine::asyncWorkerLoop, this);
+    // Every worker and fd before the first thread: a throw past this point
+    // would destroy running std::threads
+    const size_t worker_count = std::max<size_t>(1, write_behind.workers);
+    try {
+        for (size_t i = 0; i < worker_count; ++i) {
+            auto worker = std::make_unique<WriteBehindWorker>(write_behind);
+            worker->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (worker->event_fd < 0) {
+                throw std::runtime_error("eventfd failed: " + std::string(strerror(errno)));
+            }
+            write_workers_.push_back(std::move(worker));
+        }
+    } catch (...) {
+        for (auto& created : write_workers_) {
+            ::close(created->event_fd);
+        }
+        throw;
+    }
+
+    if (recovery.background) {
+        recovery_thread_ = std::thread(&KvEngine::recoverPathIndex, this, recovery);
+    } else {
+        recoverPathIndex(recovery);
+    }
+
+    for (auto& worker : write_workers_) {
+        worker->thread = std::thread(&KvEngine::asyncWorkerLoop, this, std::ref(*worker));
+    }
+
+    // Trim histories left over-long by older builds or a lowered limit
+    compaction_thread_ = std::thread([this]() {
+        {
+            std::unique_lock lock(warmup_mutex_);
+            warmup_cv_.wait(lock, [this]() {
+                return index_ready_.load(std::memory_order_relaxed) ||
+                       background_cancelled_.load(std::memory_order_relaxed);
+            });
+        }
+        size_t pruned = compactVersionHistory();
+        if (pruned > 0) {
+            LOG_INFO("[KV_ENGINE] Startup compaction pruned " + std::to_string(pruned) + " versions");
+        }
+    });
 }
 
 KvEngine::~KvEngine() {
+    // Finishes the queued reads and writes first: they use every layer below
+    read_pool_.reset();
+    write_pool_.reset();
+    {
+        std::lock_guard lock(warmup_mutex_);
+        background_cancelled_.store(true, std::memory_order_relaxed);
+    }
+    warmup_cv_.notify_all();
+    if (recovery_thread_.joinable()) {
+        recovery_thread_.join();
+    }
+    if (compaction_thread_.joinable()) {
+        compaction_thread_.join();
+    }
     async_running_.store(false, std::memory_order_relaxed);
-    if (async_worker_.joinable()) {
-        async_worker_.join();
+    for (auto& worker : write_workers_) {
+        // Unconditional: also cuts short a timed wait on a partial batch
+        uint64_t signal = 1;
+        [[maybe_unused]] ssize_t written = ::write(worker->event_fd, &signal, sizeof(signal));
+    }
+    for (auto& worker : write_workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+        ::close(worker->event_fd);
     }
     forceFlush();
 }
 
-tl::expected<void, EngineError> KvEngine::enqueueOrExecute(AsyncOp::Type type, const std::string& key, const std::string& value) {
-    if (sync_mode_.load(std::memory_order_relaxed) == SyncMode::IMMEDIATE) {
-        bool ok = false;
-        if (type == AsyncOp::Type::PUT) {
-            ok = rocksdb_persistence_->putRaw(key, value);
-        } else {
-            ok = rocksdb_persistence_->delRaw(key);
+size_t KvEngine::migrateKeyFormat() {
+    if (!rocksdb_persistence_->isOpen()) {
+        return 0;
+    }
+    auto format = rocksdb_persistence_->getRaw(std::string(key_format_key));
+    if (format && !format->empty()) {
+        const auto on_disk = static_cast<uint8_t>(format->front());
+        if (on_disk > key_format_version) {
+            // Its keys would read as missing or as other paths: never serve them
+            throw std::runtime_error("Key format " + std::to_string(on_disk) + " is newer than this build's " +
+                                     std::to_string(key_format_version));
         }
+        if (on_disk == key_format_version) {
+            return 0;
+        }
+    }
+
+    // Each batch puts records under their new keys and deletes the old ones
+    // atomically: a migration cut short resumes on the next start
+    const auto start = std::chrono::steady_clock::now();
+    size_t migrated = 0;
+    size_t unparsable = 0;
+    bool ok = true;
+    std::vector<RocksDBStorage::BatchOp> batch;
+    auto flush = [&]() {
+        if (!batch.empty()) {
+            ok = rocksdb_persistence_->applyBatch(batch, false) && ok;
+            batch.clear();
+        }
+    };
+    auto move = [&](std::string_view old_key, std::string new_key, std::string_view value) {
+        batch.push_back({RocksDBStorage::BatchOp::Type::PUT, std::move(new_key), std::string(value)});
+        batch.push_back({RocksDBStorage::BatchOp::Type::DEL, std::string(old_key), {}});
+        ++migrated;
+        if (batch.size() >= migration_batch_ops) {
+            flush();
+        }
+    };
+
+    // "m;" and "v;": the first keys past the "m:" and "v:" ranges
+    rocksdb_persistence_->iterateRange(std::string(legacy_meta_key_prefix), "m;",
+        [&](std::string_view key, std::string_view value) {
+            move(key, buildMetaKey(key.substr(legacy_meta_key_prefix.size())), value);
+        });
+    rocksdb_persistence_->iterateRange(std::string(legacy_version_key_prefix), "v;",
+        [&](std::string_view key, std::string_view value) {
+            if (auto parsed = parseLegacyVersionKey(key)) {
+                move(key, buildVersionKey(parsed->path, parsed->version), value);
+            } else {
+                ++unparsable;
+            }
+        });
+    flush();
+
+    // Synced: also makes every batch above durable
+    batch.push_back({RocksDBStorage::BatchOp::Type::PUT, std::string(key_format_key),
+                     std::string(1, static_cast<char>(key_format_version))});
+    if (!ok || !rocksdb_persistence_->applyBatch(batch, true)) {
+        throw std::runtime_error("Key format migration failed");
+    }
+    if (unparsable > 0) {
+        // No path or version to file them under: left as they are, outside every format 2 range
+        LOG_WARN("[KV_ENGINE] Key migration left " + std::to_string(unparsable) + " unparsable version keys in place");
+    }
+    if (migrated > 0) {
+        const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        LOG_INFO("[KV_ENGINE] Migrated " + std::to_string(migrated) + " records to key format " +
+                 std::to_string(key_format_version) + " in " + std::to_string(ms) + " ms");
+    }
+    return migrated;
+}
+
+size_t KvEngine::migrateMetadataFormat() {
+    if (!rocksdb_persistence_->isOpen()) {
+        return 0;
+    }
+    const std::string marker_key(metadata_format_key);
+    auto marker = rocksdb_persistence_->getRaw(marker_key);
+    if (marker && !marker->empty() && static_cast<uint8_t>(marker->front()) >= metadata_format_version) {
+        return 0;
+    }
+
+    // Records are rewritten in place, so format 1 and 2 values cannot be
+    // told apart: each batch also saves its last key in the marker, and an
+    // interrupted migration resumes right after it
+    const auto start = std::chrono::steady_clock::now();
+    const auto bounds = rocksdb_persistence_->partitionPrefix(metaKeyPrefix(""), 1);
+    std::string from = bounds.front();
+    if (marker && marker->size() > 1) {
+        from = marker->substr(1);
+        from.push_back('\0');
+    }
+
+    size_t migrated = 0;
+    size_t unreadable = 0;
+    bool ok = true;
+    std::vector<RocksDBStorage::BatchOp> batch;
+    rocksdb_persistence_->iterateRange(from, bounds.back(), [&](std::string_view key, std::string_view value) {
+        // Past a failed batch the marker would skip its records on resume
         if (!ok) {
-            return tl::unexpected(EngineError::StorageError);
+            return;
+        }
+        auto meta = deserializeLegacyMetadata(value);
+        if (!meta) {
+            ++unreadable;
+            return;
         }
+        batch.push_back({RocksDBStorage::BatchOp::Type::PUT, std::string(key), serializeMetadata(*meta)});
+        ++migrated;
+        if (batch.size() >= migration_batch_ops) {
+            batch.push_back({RocksDBStorage::BatchOp::Type::PUT, marker_key, '\x01' + std::string(key)});
+            ok = rocksdb_persistence_->applyBatch(batch, false);
+            batch.clear();
+        }
+    });
+
+    // Synced: also makes every batch above durable
+    batch.push_back({RocksDBStorage::BatchOp::Type::PUT, marker_key,
+                     std::string(1, static_cast<char>(metadata_format_version))});
+    if (!ok || !rocksdb_persistence_->applyBatch(batch, true)) {
+        throw std::runtime_error("Metadata format migration failed");
+    }
+    if (unreadable > 0) {
+        LOG_WARN("[KV_ENGINE] Metadata migration left " + std::to_string(unreadable) + " unreadable records in place");
+    }
+    if (migrated > 0) {
+        const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        LOG_INFO("[KV_ENGINE] Migrated " + std::to_string(migrated) + " metadata records to format " +
+                 std::to_string(metadata_format_version) + " in " + std::to_string(ms) + " ms");
+    }
+    return migrated;
+}
+
+void KvEngine::recoverPathIndex(const RecoveryOptions& options) {
+    const auto start = std::chrono::steady_clock::now();
+    const size_t thread_count = options.threads > 0
+        ? options.threads
+        : std::max(1u, std::thread::hardware_concurrency());
+
+    // More ranges than threads, so one dense range does not stall the others
+    const auto boundaries = rocksdb_persistence_->partitionPrefix(metaKeyPrefix(""), thread_count * 4);
+    const size_t range_count = boundaries.size() - 1;
+    recovery_ranges_total_.store(range_count, std::memory_order_relaxed);
+    std::vector<std::vector<std::string>> sorted_runs(range_count);
+    std::atomic<size_t> next_range{0};
+    std::atomic<bool> cache_full{!options.warm_cache};
+
+    auto scanRanges = [&]() {
+        for (size_t range = next_range.fetch_add(1); range < range_count; range = next_range.fetch_add(1)) {
+            if (background_cancelled_.load(std::memory_order_relaxed)) {
+                return;
+            }
+            auto& run = sorted_runs[range];
+            rocksdb_persistence_->iterateRange(boundaries[range], boundaries[range + 1],
+                [&](std::string_view key, std::string_view value) {
+                    auto meta = deserializeMetadata(value);
+                    // Same rule as destroy_version: no live payload, no index entry
+                    if (!meta || allVersionsDestroyed(*meta)) {
+                        return;
+                    }
+                    auto path = parseMetaKey(key);
+                    if (!path) {
+                        return;
+                    }
+                    run.push_back(std::move(*path));
+                    // Never overwrite: a write served during warm-up is newer than the scan
+                    if (!cache_full.load(std::memory_order_relaxed) &&
+                        !head_cache_->insert(run.back(), std::make_shared<const PathHead>(PathHead{std::move(*meta), {}}), false)) {
+                        cache_full.store(true, std::memory_order_relaxed);
+                    }
+                });
+            recovery_paths_.fetch_add(run.size(), std::memory_order_relaxed);
+            recovery_ranges_done_.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+
+    std::vector<std::thread> scanners;
+    for (size_t i = 1; i < std::min(thread_count, range_count); ++i) {
+        scanners.emplace_back(scanRanges);
+    }
+    scanRanges();
+    for (auto& scanner : scanners) {
+        scanner.join();
+    }
+    if (background_cancelled_.load(std::memory_order_relaxed)) {
+        LOG_WARN("[KV_ENGINE] Recovery cancelled by shutdown");
+        return;
+    }
+
+    // Ranges are disjoint and ascending: merging the sorted runs is a concatenation
+    size_t path_count = 0;
+    for (const auto& run : sorted_runs) {
+        path_count += run.size();
+    }
+    std::vector<std::string> paths;
+    paths.reserve(path_count);
+    for (auto& run : sorted_runs) {
+        std::move(run.begin(), run.end(), std::back_inserter(paths));
+    }
+    path_index_->bulkLoad(std::move(paths));
+
+    size_t replayed = 0;
+    {
+        // Writers check index_ready_ under this lock, so none can slip between replay and flip
+        std::lock_guard lock(warmup_mutex_);
+        for (const auto& [path, live] : warmup_index_ops_) {
+            if (live) {
+                path_index_->insertPathIfAbsent(path);
+            } else {
+                path_index_->removePathIfPresent(path);
+            }
+        }
+        replayed = warmup_index_ops_.size();
+        warmup_index_ops_ = {};
+
+        recovery_stats_.paths = path_count;
+        recovery_stats_.ranges = range_count;
+        recovery_stats_.threads = thread_count;
+        recovery_stats_.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        index_ready_.store(true, std::memory_order_release);
+    }
+    warmup_cv_.notify_all();
+
+    LOG_INFO("[KV_ENGINE] Recovered " + std::to_string(path_count) + " paths from " +
+             std::to_string(range_count) + " ranges on " + std::to_string(thread_count) +
+             " threads in " + std::to_string(recovery_stats_.seconds) + " s, replayed " +
+             std::to_string(replayed) + " warm-up writes");
+}
+
+void KvEngine::updatePathIndex(std::string_view path, bool live) {
+    if (!index_ready_.load(std::memory_order_acquire)) {
+        std::lock_guard lock(warmup_mutex_);
+        if (!index_ready_.load(std::memory_order_relaxed)) {
+            warmup_index_ops_.emplace_back(path, live);
+            return;
+        }
+    }
+    if (live) {
+        path_index_->insertPathIfAbsent(path);
     } else {
-        // Lock-free enqueue
-        AsyncOp op{type, key, value};
-        if (!async_queue_.enqueue(std::move(op))) {
-            return tl::unexpected(EngineError::QueueFull);
+        path_index_->removePathIfPresent(path);
+    }
+}
+
+WarmupStatus KvEngine::warmupStatus() const {
+    WarmupStatus status;
+    status.ready = index_ready_.load(std::memory_order_acquire);
+    status.ranges_done = recovery_ranges_done_.load(std::memory_order_relaxed);
+    status.ranges_total = recovery_ranges_total_.load(std::memory_order_relaxed);
+    status.paths = recovery_paths_.load(std::memory_order_relaxed);
+    return status;
+}
+
+void KvEngine::waitUntilReady() {
+    std::unique_lock lock(warmup_mutex_);
+    warmup_cv_.wait(lock, [this]() { return index_ready_.load(std::memory_order_relaxed); });
+}
+
+void KvEngine::attachWorkers(event::WorkerPool& workers, tls::Instance& tls) {
+    path_index_->attachWorkers(workers, tls);
+}
+
+bool KvEngine::isIndexedPath(std::string_view path) const {
+    if (!index_ready_.load(std::memory_order_acquire)) {
+        // Slow path while warming: the index does not know every path yet
+        if (auto cached = head_cache_->lookup(path)) {
+            return !allVersionsDestroyed(cached->meta);
         }
+        auto raw = rocksdb_persistence_->getRaw(buildMetaKey(path));
+        auto meta = raw ? deserializeMetadata(*raw) : std::nullopt;
+        return meta && !allVersionsDestroyed(*meta);
     }
-    return {};
+    return path_index_->getLocalSnapshot()->validatePath(path);
 }
 
-void KvEngine::asyncWorkerLoop() {
-    AsyncOp op;
-    std::vector<RocksDBStorage::BatchOp> batch;
-    batch.reserve(1024);
+size_t KvEngine::workerFor(std::string_view path) const {
+    return std::hash<std::string_view>{}(path) % write_workers_.size();
+}
+
+tl::expected<WriteTicket, EngineError> KvEngine::enqueueOrExecute(std::string_view path, WriteOps ops, bool durable) {
+    if (sync_mode_.load(std::memory_order_relaxed) == SyncMode::IMMEDIATE) {
+        if (!commitImmediate(ops)) {
+            return tl::unexpected(EngineError::StorageError);
+        }
+        return WriteTicket{};
+    }
+    // Every record of a path goes to the same worker
+    return enqueueOn(workerFor(path), ops, durable);
+}
+
+bool KvEngine::commitImmediate(const WriteOps& ops) {
+    // One fsync shared with every concurrent IMMEDIATE writer; ops outlives the commit
+    std::vector<RocksDBStorage::BatchOpView> views;
+    views.reserve(ops.size());
+    for (const auto& op : ops) {
+        views.push_back({op.type, op.key, op.bytes()});
+    }
+    return group_commit_->commit(std::move(views));
+}
 
-    auto last_flush_time = std::chrono::steady_clock::now();
+tl::expected<WriteTicket, EngineError> KvEngine::enqueueOn(size_t stream, const WriteOps& ops, bool durable) {
+    // Lock-free enqueue of the whole write as one record, written in place
+    WriteBehindWorker& worker = *write_workers_[stream];
+    const auto now = std::chrono::steady_clock::now();
+    const uint64_t sequence = worker.queue.push(encodedRecordSize(ops), [&](std::byte* dst) {
+        encodeRecord(dst, ops, now, durable);
+    });
+    wakeFlusher(worker);
+    if (sequence == 0) {
+        return tl::unexpected(EngineError::QueueFull);
+    }
+    return WriteTicket{static_cast<uint32_t>(stream), sequence};
+}
+
+tl::expected<void, EngineError> KvEngine::drainWorkers(std::span<const size_t> streams) {
+    // A worker writes its queue in order: once the marker is fsynced, so is everything ahead of it
+    std::vector<std::future<bool>> drained;
+    drained.reserve(streams.size());
+    for (size_t stream : streams) {
+        auto ticket = enqueueOn(stream, WriteOps{}, true);
+        if (!ticket) {
+            return tl::unexpected(ticket.error());
+        }
+        auto done = std::make_shared<std::promise<bool>>();
+        drained.push_back(done->get_future());
+        whenDurable(*ticket, [done](bool durable) { done->set_value(durable); });
+    }
+    bool written = true;
+    for (auto& flush : drained) {
+        written &= flush.get();
+    }
+    if (!written) {
+        return tl::unexpected(EngineError::StorageError);
+    }
+    return {};
+}
+
+void KvEngine::asyncWorkerLoop(WriteBehindWorker& worker) {
+    std::vector<RocksDBStorage::BatchOpView> batch;
+    batch.reserve(4096);
+    size_t records = 0;
+    std::chrono::steady_clock::time_point oldest;
+    bool sync = false;
+    auto collect = [&](std::span<const std::byte> record) {
+        const auto header = decodeRecord(record, batch);
+        sync |= header.sync;
+        if (records++ == 0) {
+            oldest = header.enqueued_at;
+        }
+    };
 
     while (async_running_.load(std::memory_order_relaxed)) {
-        bool dequeued = async_queue_.dequeue(op);
-        
-        if (dequeued) {
-            auto btype = (op.type == AsyncOp::Type::PUT) 
-                       ? RocksDBStorage::BatchOp::Type::PUT 
-                       : RocksDBStorage::BatchOp::Type::DEL;
-            batch.push_back({btype, std::move(op.key), std::move(op.value)});
-        }
-        
-        auto now = std::chrono::steady_clock::now();
-        bool timeout_reached = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_flush_time).count() >= 5;
-
-        if (batch.size() >= 1024 || (timeout_reached && !batch.empty())) {
-            rocksdb_persistence_->applyBatch(batch);
-            batch.clear();
-            last_flush_time = std::chrono::steady_clock::now();
-        } else if (!dequeued) {
-            // Sleep slightly if idle to prevent 100% CPU burn
-            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        const size_t limit = worker.scheduler.batchLimit();
+        if (records < limit) {
+            worker.queue.peek(limit - records, collect);
+        }
+
+        if (records == 0) {
+            // Idle: no wakeups at all until a producer signals
+            parkFlusher(worker, std::nullopt);
+            continue;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        const auto deadline = oldest + worker.scheduler.flushWindow();
+        if (records >= limit || now >= deadline) {
+            flushBatch(worker, batch, records, oldest, sync);
+        } else {
+            // Partial batch: wait for more records, at most until its window closes
+            parkFlusher(worker, std::chrono::duration_cast<std::chrono::microseconds>(deadline - now));
         }
     }
 
-    // Flush any remaining ops on shutdown
-    while (async_queue_.dequeue(op)) {
-        auto btype = (op.type == AsyncOp::Type::PUT) 
-                   ? RocksDBStorage::BatchOp::Type::PUT 
-                   : RocksDBStorage::BatchOp::Type::DEL;
-        batch.push_back({btype, std::move(op.key), std::move(op.value)});
+    // Flush any remaining records on shutdown
+    while (worker.queue.peek(SIZE_MAX, collect) > 0 || records > 0) {
+        flushBatch(worker, batch, records, oldest, sync);
     }
-    if (!batch.empty()) {
-        rocksdb_persistence_->applyBatch(batch);
+}
+
+void KvEngine::flushBatch(WriteBehindWorker& worker, std::vector<RocksDBStorage::BatchOpView>& batch, size_t& records,
+                          std::chrono::steady_clock::time_point oldest, bool& sync) {
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+
+    const auto start = std::chrono::steady_clock::now();
+    // One fsync for every durable record in the batch: group commit for write-behind.
+    // Only drain markers: nothing to write, everything before them already is.
+    const bool written = batch.empty() ||
+                         (sync ? rocksdb_persistence_->applyBatch(batch, true) : rocksdb_persistence_->applyBatch(batch));
+    const auto end = std::chrono::steady_clock::now();
+    // The views point into the queue: free the records only once written
+    const uint64_t released = worker.queue.release();
+    worker.scheduler.recordFlush(records, worker.queue.sizeApprox(), duration_cast<microseconds>(end - start),
+                                 duration_cast<microseconds>(end - oldest), end);
+    if (sync) {
+        publishDurable(worker, released, written);
+    }
+    batch.clear();
+    records = 0;
+    sync = false;
+}
+
+void KvEngine::publishDurable(WriteBehindWorker& worker, uint64_t position, bool written) {
+    std::vector<std::function<void(bool)>> passed;
+    {
+        std::lock_guard lock(worker.waiters_mutex);
+        if (written) {
+            worker.durable.store(position, std::memory_order_relaxed);
+        }
+        auto it = std::partition(worker.waiters.begin(), worker.waiters.end(),
+                                 [position](const auto& waiter) { return waiter.first > position; });
+        for (auto waiter = it; waiter != worker.waiters.end(); ++waiter) {
+            passed.push_back(std::move(waiter->second));
+        }
+        worker.waiters.erase(it, worker.waiters.end());
+    }
+    if (!written) {
+        LOG_ERROR("[KV_ENGINE] Durable write-behind batch failed; " + std::to_string(passed.size()) +
+                  " waiters notified");
+    }
+    // Outside the lock: a callback may register another waiter
+    for (auto& callback : passed) {
+        callback(written);
+    }
+}
+
+void KvEngine::whenDurable(const WriteTicket& ticket, std::function<void(bool durable)> callback) {
+    if (ticket.sequence == 0) {
+        callback(true);
+        return;
+    }
+    if (ticket.stream >= write_workers_.size()) {
+        callback(false);
+        return;
+    }
+    WriteBehindWorker& worker = *write_workers_[ticket.stream];
+    {
+        std::lock_guard lock(worker.waiters_mutex);
+        if (worker.durable.load(std::memory_order_relaxed) < ticket.sequence) {
+            worker.waiters.emplace_back(ticket.sequence, std::move(callback));
+            return;
+        }
+    }
+    callback(true);
+}
+
+void KvEngine::parkFlusher(WriteBehindWorker& worker, std::optional<std::chrono::microseconds> timeout) {
+    struct pollfd pfd{worker.event_fd, POLLIN, 0};
+    if (timeout) {
+        // Not advertised: it ends within the flush window anyway, and producers
+        // signalling every record of a partial batch would cost a syscall each
+        struct timespec ts{};
+        ts.tv_sec = timeout->count() / 1000000;
+        ts.tv_nsec = (timeout->count() % 1000000) * 1000;
+        ::ppoll(&pfd, 1, &ts, nullptr);
+    } else {
+        worker.parked.store(true, std::memory_order_relaxed);
+        // Pairs with the fence in wakeFlusher(): either this thread sees the
+        // producer's record (or shutdown), or the producer sees it parked
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (worker.queue.empty() && async_running_.load(std::memory_order_relaxed)) {
+            ::ppoll(&pfd, 1, nullptr, nullptr);
+        }
+        worker.parked.store(false, std::memory_order_relaxed);
+    }
+
+    // A signal raced with un-parking at worst causes one spurious wakeup
+    uint64_t signals;
+    while (::read(worker.event_fd, &signals, sizeof(signals)) > 0) {}
+}
+
+void KvEngine::wakeFlusher(WriteBehindWorker& worker) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (worker.parked.load(std::memory_order_relaxed)) {
+        uint64_t signal = 1;
+        [[maybe_unused]] ssize_t written = ::write(worker.event_fd, &signal, sizeof(signal));
     }
 }
 
@@ -210,9 +764,36 @@ std::string KvEngine::buildFullKey(const std::string& path, const std::string& k
     return path + ":" + key; // V1 legacy fallback
 }
 
-tl::expected<KeyMetadata, EngineError> KvEngine::read_metadata(std::string_view path) {
-    auto raw = readRawOptimistic(rocksdb_persistence_.get(), storage_.get(), buildMetaKey(path));
+tl::expected<HeadPtr, EngineError> KvEngine::loadHead(std::string_view path) {
+    if (auto cached = head_cache_->lookup(path)) {
+        return cached;
+    }
+    if (negative_cache_->contains(path)) {
+        return tl::unexpected(EngineError::NotFound);
+    }
+    if (!coalesce_misses_) {
+        return loadHeadFromDisk(path);
+    }
+    // One RocksDB read per path however many callers miss at once
+    return head_loads_.run(path, [&]() -> tl::expected<HeadPtr, EngineError> {
+        // A flight that just ended may have cached it
+        if (auto cached = head_cache_->lookup(path)) {
+            return cached;
+        }
+        return loadHeadFromDisk(path);
+    });
+}
+
+tl::expected<HeadPtr, EngineError> KvEngine::loadHeadFromDisk(std::string_view path) {
+    const uint64_t generation = negative_cache_->generation(path);
+    const uint64_t destroys = prefix_destroys_.load(std::memory_order_acquire);
+    auto raw = rocksdb_persistence_->getRaw(buildMetaKey(path));
     if (!raw) { 
+		// A write may have published the path since the cache lookup
+		if (auto cached = head_cache_->lookup(path)) {
+			return cached;
+		}
+		negative_cache_->insert(path, generation);
 		return tl::unexpected(EngineError::NotFound);
 	}
     
@@ -220,68 +801,564 @@ tl::expected<KeyMetadata, EngineError> KvEngine::read_metadata(std::string_view
     if (!meta) { 
 		return tl::unexpected(EngineError::StorageError);
 	}
-    
-    return *meta;
+
+    auto head = std::make_shared<const PathHead>(PathHead{std::move(*meta), {}});
+    cacheLoadedHead(path, head, destroys);
+    return head;
 }
 
-tl::expected<SecretPayload, EngineError> KvEngine::read_version(std::string_view path, uint32_t version) {
-    auto meta_res = read_metadata(path);
-    if (!meta_res) { 
-		return tl::unexpected(meta_res.error());
-	}
-    
-    KeyMetadata meta = meta_res.value();
-    uint32_t target_version = (version == 0) ? meta.current_version : version;
-    
-    if (target_version == 0 || target_version > meta.current_version) {
-        return tl::unexpected(EngineError::InvalidVersion);
+void KvEngine::cacheLoadedHead(std::string_view path, const HeadPtr& head, uint64_t destroys) {
+    head_cache_->insert(path, head, false);
+    // The destroy bumps the counter before clearing the shards: an insert
+    // the clear missed sees it here, and a read from before the range
+    // deletes never brings the path back
+    if (prefix_destroys_.load(std::memory_order_acquire) != destroys) {
+        head_cache_->removeIf(path, head);
     }
-    
-    const VersionState* state = nullptr;
-    for (const auto& vs : meta.versions) {
-        if (vs.version_id == target_version) {
-            state = &vs;
+}
+
+tl::expected<WriteTicket, EngineError> KvEngine::storeHead(std::string_view path, PathHead head, WriteOps ops,
+                                                           bool durable) {
+    ops.push_back({RocksDBStorage::BatchOp::Type::PUT, buildMetaKey(path), nullptr, serializeMetadata(head.meta)});
+    auto ticket = enqueueOrExecute(path, std::move(ops), durable);
+    if (!ticket) {
+        return tl::unexpected(ticket.error());
+    }
+    publishHead(path, std::move(head));
+    return ticket;
+}
+
+void KvEngine::publishHead(std::string_view path, PathHead head) {
+    // Never dropped for a full shard: the next write to path would derive its
+    // version from a record write-behind may not have flushed yet
+    head_cache_->publish(path, std::make_shared<const PathHead>(std::move(head)));
+    // After the head: a reader either sees it or has its tombstone refused
+    negative_cache_->invalidate(path);
+}
+
+uint32_t KvEngine::versionLimit(uint32_t key_max_versions) const {
+    return key_max_versions > 0 ? key_max_versions : max_versions_.load(std::memory_order_relaxed);
+}
+
+std::vector<VersionState> KvEngine::trimVersionHistory(KeyMetadata& meta) const {
+    const uint32_t limit = versionLimit(meta.max_versions);
+    if (limit == 0 || meta.versions.size() <= limit) {
+        return {};
+    }
+    // Versions are appended in order: the oldest are at the front
+    const auto keep_from = meta.versions.end() - limit;
+    std::vector<VersionState> pruned(meta.versions.begin(), keep_from);
+    meta.versions.erase(meta.versions.begin(), keep_from);
+    return pruned;
+}
+
+void KvEngine::deletePrunedPayloads(std::string_view path, const std::vector<VersionState>& pruned, WriteOps& ops) {
+    for (const auto& vs : pruned) {
+        if (vs.destroyed) {
+            continue; // Payload already deleted by destroy_version
+        }
+        std::string vkey = buildVersionKey(path, vs.version_id);
+        payload_cache_->remove(vkey);
+        ops.push_back({RocksDBStorage::BatchOp::Type::DEL, std::move(vkey)});
+    }
+}
+
+size_t KvEngine::compactPath(std::string_view path) {
+    std::lock_guard write_lock(path_write_locks_.forKey(path));
+    auto current = loadHead(path);
+    if (!current) {
+        return 0;
+    }
+
+    PathHead head = **current;
+    auto pruned = trimVersionHistory(head.meta);
+    if (pruned.empty()) {
+        return 0;
+    }
+    const bool no_live_versions = allVersionsDestroyed(head.meta);
+    WriteOps ops;
+    deletePrunedPayloads(path, pruned, ops);
+    if (!storeHead(path, std::move(head), std::move(ops))) {
+        return 0;
+    }
+    if (no_live_versions) {
+        updatePathIndex(path, false);
+    }
+    return pruned.size();
+}
+
+size_t KvEngine::compactVersionHistory() {
+    std::lock_guard compaction_lock(compaction_mutex_);
+    // Candidates come from disk; compactPath re-checks against the cached head
+    const auto boundaries = rocksdb_persistence_->partitionPrefix(metaKeyPrefix(""), 64);
+    std::vector<std::string> oversized;
+    for (size_t range = 0; range + 1 < boundaries.size(); ++range) {
+        if (background_cancelled_.load(std::memory_order_relaxed)) {
+            return 0;
+        }
+        rocksdb_persistence_->iterateRange(boundaries[range], boundaries[range + 1],
+            [&](std::string_view key, std::string_view value) {
+                // The header has the count: no history is decoded for keys within their limit
+                auto header = deserializeMetadataHeader(value);
+                if (!header) {
+                    return;
+                }
+                const uint32_t limit = versionLimit(header->max_versions);
+                if (limit > 0 && header->version_count > limit) {
+                    if (auto path = parseMetaKey(key)) {
+                        oversized.push_back(std::move(*path));
+                    }
+                }
+            });
+    }
+
+    size_t pruned = 0;
+    for (const auto& path : oversized) {
+        if (background_cancelled_.load(std::memory_order_relaxed)) {
             break;
         }
+        pruned += compactPath(path);
     }
-    
-    if (!state) { 
+    return pruned;
+}
+
+tl::expected<size_t, EngineError> KvEngine::destroyPrefix(std::string_view prefix) {
+    // Its range tombstones would cover the whole keyspace
+    if (prefix.empty()) { 
 		return tl::unexpected(EngineError::InvalidVersion);
 	}
-    if (state->destroyed) { 
-		return tl::unexpected(EngineError::Destroyed);
-	}
-    if (state->deletion_time_ms > 0) { 
-		return tl::unexpected(EngineError::SoftDeleted);
+    // Paths are matched by bytes: without the separator apps/old would cover apps/older
+    std::string directory(prefix);
+    if (directory.back() != '/') {
+        directory.push_back('/');
+    }
+    prefix = directory;
+
+    // The index must list every path before the ones under prefix are dropped from it
+    waitUntilReady();
+
+    // No write may land between the range deletes and the cache clear, or
+    // be queued behind them and bring a path back
+    auto write_locks = path_write_locks_.lockEvery();
+    if (sync_mode_.load(std::memory_order_relaxed) == SyncMode::BATCH) {
+        std::vector<size_t> streams(write_workers_.size());
+        std::iota(streams.begin(), streams.end(), 0);
+        if (auto drained = drainWorkers(streams); !drained) {
+            return tl::unexpected(drained.error());
+        }
+    }
+
+    const std::string version_prefix = versionKeyPrefix(prefix);
+    if (!rocksdb_persistence_->deletePrefixes({metaKeyPrefix(prefix), version_prefix})) { 
+		return tl::unexpected(EngineError::StorageError);
 	}
-    
-    auto raw_payload = readRawOptimistic(rocksdb_persistence_.get(), storage_.get(), buildVersionKey(path, target_version));
-    if (!raw_payload) { 
-		return tl::unexpected(EngineError::StorageError); 
+    prefix_destroys_.fetch_add(1, std::memory_order_release);
+    head_cache_->removePrefix(prefix);
+    payload_cache_->removePrefix(version_prefix);
+    // Missing paths answer NotFound anyway: tombstones under prefix stay valid
+
+    const size_t destroyed = path_index_->removePrefix(prefix).size();
+    LOG_INFO("[KV_ENGINE] Destroyed " + std::to_string(destroyed) + " paths under prefix: " + std::string(prefix));
+    return destroyed;
+}
+
+std::optional<KvEngine::DestroyResult> KvEngine::destroyPrefixAsync(std::string prefix, DestroyCallback done) {
+    if (!write_pool_->submit([this, prefix = std::move(prefix), done = std::move(done)]() { done(destroyPrefix(prefix)); })) {
+        return tl::unexpected(EngineError::QueueFull);
+    }
+    return std::nullopt;
+}
+
+void KvEngine::setMaxVersions(uint32_t max_versions) {
+    max_versions_.store(max_versions, std::memory_order_relaxed);
+}
+
+tl::expected<void, EngineError> KvEngine::set_max_versions(std::string_view path, uint32_t max_versions) {
+    std::lock_guard write_lock(path_write_locks_.forKey(path));
+    auto current = loadHead(path);
+    if (!current) {
+        return tl::unexpected(current.error());
+    }
+
+    PathHead head = **current;
+    head.meta.max_versions = max_versions;
+    auto pruned = trimVersionHistory(head.meta);
+    const bool no_live_versions = allVersionsDestroyed(head.meta);
+    WriteOps ops;
+    deletePrunedPayloads(path, pruned, ops);
+    auto res = storeHead(path, std::move(head), std::move(ops));
+    if (!res) {
+        return tl::unexpected(res.error());
+    }
+    if (no_live_versions) {
+        updatePathIndex(path, false);
+    }
+    return {};
+}
+
+tl::expected<SharedBytes, EngineError> KvEngine::readPayload(std::string_view path, uint32_t version) {
+    std::string vkey = buildVersionKey(path, version);
+    if (auto cached = payload_cache_->lookupShared(vkey)) {
+        return cached;
+    }
+    auto load = [&]() -> tl::expected<SharedBytes, EngineError> {
+        if (auto cached = payload_cache_->lookupShared(vkey)) {
+            return cached;
+        }
+        auto raw = rocksdb_persistence_->getRaw(vkey);
+        if (!raw) { 
+			return tl::unexpected(EngineError::StorageError); 
+		}
+        auto bytes = std::make_shared<const std::string>(std::move(*raw));
+        // Payloads are immutable: never replace the buffer a writer cached
+        cacheShared(*payload_cache_, vkey, bytes, false);
+        return bytes;
+    };
+    return coalesce_misses_ ? payload_loads_.run(vkey, load) : load();
+}
+
+tl::expected<KeyMetadata, EngineError> KvEngine::read_metadata(std::string_view path) {
+    auto head = loadHead(path);
+    if (!head) { 
+		return tl::unexpected(head.error());
 	}
     
-    auto payload = deserializePayload(*raw_payload);
-    if (!payload) { 
-		return tl::unexpected(EngineError::StorageError);
+    return (*head)->meta;
+}
+
+tl::expected<SecretPayload, EngineError> KvEngine::read_version(std::string_view path, uint32_t version) {
+    auto head_res = loadHead(path);
+    if (!head_res) { 
+		return tl::unexpected(head_res.error());
 	}
     
-    return *payload;
+    // Read in place: the cached head is immutable and pinned by head_res
+    const HeadPtr& head = *head_res;
+    const KeyMetadata& meta = head->meta;
+    auto target = resolveVersion(meta, version);
+    if (!target) {
+        return tl::unexpected(target.error());
+    }
+    const uint32_t target_version = *target;
+
+    if (target_version != meta.current_version) {
+        auto bytes = readPayload(path, target_version);
+        if (!bytes) {
+            return tl::unexpected(bytes.error());
+        }
+        return decodePayload(**bytes);
+    }
+
+    // Latest version: served from the head, one probe in total
+    if (head->latest) {
+        return decodePayload(*head->latest);
+    }
+    auto bytes = readPayload(path, target_version);
+    if (!bytes) {
+        return tl::unexpected(bytes.error());
+    }
+    head_cache_->replaceIf(path, head, std::make_shared<const PathHead>(PathHead{meta, *bytes}));
+    return decodePayload(**bytes);
+}
+
+std::optional<ReadResult> KvEngine::readVersionCached(std::string_view path, uint32_t version) {
+    HeadPtr head = head_cache_->lookup(path);
+    if (!head) {
+        if (negative_cache_->contains(path)) {
+            return tl::unexpected(EngineError::NotFound);
+        }
+        return std::nullopt;
+    }
+    auto target = resolveVersion(head->meta, version);
+    if (!target) {
+        return tl::unexpected(target.error());
+    }
+    if (*target == head->meta.current_version) {
+        if (head->latest) {
+            return decodePayload(*head->latest);
+        }
+        return std::nullopt;
+    }
+    if (auto bytes = payload_cache_->lookupShared(buildVersionKey(path, *target))) {
+        return decodePayload(*bytes);
+    }
+    return std::nullopt;
+}
+
+std::optional<ReadResult> KvEngine::read_version_async(std::string_view path, uint32_t version, ReadCallback done) {
+    if (auto cached = readVersionCached(path, version)) {
+        return cached;
+    }
+    // Miss: the RocksDB reads run on an I/O thread, never on the caller's event loop
+    if (!coalesce_misses_) {
+        if (!read_pool_->submit([this, path = std::string(path), version, done = std::move(done)]() {
+                done(read_version(path, version));
+            })) {
+            return tl::unexpected(EngineError::QueueFull);
+        }
+        return std::nullopt;
+    }
+
+    // One queued read per (path, version): later misses attach to it
+    // instead of taking an I/O thread each
+    std::string key = buildVersionKey(path, version);
+    if (!async_reads_.join(key, done)) {
+        return std::nullopt;
+    }
+    if (!read_pool_->submit([this, path = std::string(path), version, key, done = std::move(done)]() {
+            auto result = read_version(path, version);
+            async_reads_.complete(key, result);
+            done(std::move(result));
+        })) {
+        // Also fails the callers that attached meanwhile
+        async_reads_.complete(key, tl::unexpected(EngineError::QueueFull));
+        return tl::unexpected(EngineError::QueueFull);
+    }
+    return std::nullopt;
+}
+
+size_t KvEngine::readManyCached(std::span<const std::string> paths, std::vector<HeadPtr>& heads,
+                                std::vector<std::optional<ReadResult>>& results) {
+    std::vector<std::string_view> keys(paths.begin(), paths.end());
+    heads.assign(paths.size(), nullptr);
+    results.assign(paths.size(), std::nullopt);
+    head_cache_->lookupMany(keys, heads);
+
+    size_t unanswered = 0;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if (!heads[i]) {
+            if (negative_cache_->contains(paths[i])) {
+                results[i] = tl::unexpected(EngineError::NotFound);
+            } else {
+                ++unanswered;
+            }
+            continue;
+        }
+        auto target = resolveVersion(heads[i]->meta, 0);
+        if (!target) {
+            results[i] = tl::unexpected(target.error());
+        } else if (heads[i]->latest) {
+            results[i] = decodePayload(*heads[i]->latest);
+        } else if (auto bytes = payload_cache_->lookupShared(buildVersionKey(paths[i], *target))) {
+            results[i] = decodePayload(*bytes);
+        } else {
+            ++unanswered;
+        }
+    }
+    return unanswered;
+}
+
+std::vector<ReadResult> KvEngine::read_many(std::span<const std::string> paths) {
+    std::vector<uint64_t> stamp;
+    for (;;) {
+        if (!stampPublishes(paths, stamp)) {
+            // The transaction holds the stripe until it has published: wait it out
+            for (const auto& path : paths) {
+                if (publish_seqs_[decltype(path_write_locks_)::stripeIndex(path)].load(std::memory_order_acquire) & 1) {
+                    std::lock_guard published(path_write_locks_.forKey(path));
+                }
+            }
+            continue;
+        }
+        auto results = readManyUnchecked(paths);
+        if (publishesUnchanged(paths, stamp)) {
+            return results;
+        }
+    }
+}
+
+bool KvEngine::stampPublishes(std::span<const std::string> paths, std::vector<uint64_t>& stamp) const {
+    stamp.clear();
+    if (paths.size() < 2) {
+        return true;
+    }
+    stamp.reserve(paths.size());
+    for (const auto& path : paths) {
+        const uint64_t seq = publish_seqs_[decltype(path_write_locks_)::stripeIndex(path)].load(std::memory_order_acquire);
+        if (seq & 1) {
+            return false;
+        }
+        stamp.push_back(seq);
+    }
+    return true;
+}
+
+bool KvEngine::publishesUnchanged(std::span<const std::string> paths, const std::vector<uint64_t>& stamp) const {
+    // Orders the reads being validated before the sequences are loaded again
+    std::atomic_thread_fence(std::memory_order_acquire);
+    for (size_t i = 0; i < stamp.size(); ++i) {
+        if (publish_seqs_[decltype(path_write_locks_)::stripeIndex(paths[i])].load(std::memory_order_relaxed) != stamp[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<ReadResult> KvEngine::readManyUnchecked(std::span<const std::string> paths) {
+    std::vector<HeadPtr> heads;
+    std::vector<std::optional<ReadResult>> answered;
+    if (readManyCached(paths, heads, answered) > 0) {
+        // Metadata of the uncached paths: one MultiGet
+        std::vector<size_t> missing;
+        std::vector<std::string> meta_keys;
+        std::vector<uint64_t> generations;
+        const uint64_t destroys = prefix_destroys_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < paths.size(); ++i) {
+            if (!answered[i] && !heads[i]) {
+                missing.push_back(i);
+                meta_keys.push_back(buildMetaKey(paths[i]));
+                generations.push_back(negative_cache_->generation(paths[i]));
+            }
+        }
+        if (!meta_keys.empty()) {
+            auto raws = rocksdb_persistence_->multiGetRaw(meta_keys);
+            for (size_t j = 0; j < missing.size(); ++j) {
+                const size_t i = missing[j];
+                if (!raws[j]) {
+                    // As in loadHeadFromDisk: a write may have published the path meanwhile
+                    if (!(heads[i] = head_cache_->lookup(paths[i]))) {
+                        negative_cache_->insert(paths[i], generations[j]);
+                        answered[i] = tl::unexpected(EngineError::NotFound);
+                    }
+                    continue;
+                }
+                auto meta = deserializeMetadata(*raws[j]);
+                if (!meta) {
+                    answered[i] = tl::unexpected(EngineError::StorageError);
+                    continue;
+                }
+                heads[i] = std::make_shared<const PathHead>(PathHead{std::move(*meta), {}});
+                cacheLoadedHead(paths[i], heads[i], destroys);
+            }
+        }
+
+        // Latest payloads neither the head nor the payload cache holds: one more MultiGet
+        std::vector<size_t> unloaded;
+        std::vector<std::string> payload_keys;
+        for (size_t i = 0; i < paths.size(); ++i) {
+            if (answered[i]) {
+                continue;
+            }
+            auto target = resolveVersion(heads[i]->meta, 0);
+            if (!target) {
+                answered[i] = tl::unexpected(target.error());
+            } else if (heads[i]->latest) {
+                answered[i] = decodePayload(*heads[i]->latest);
+            } else {
+                std::string vkey = buildVersionKey(paths[i], *target);
+                if (auto bytes = payload_cache_->lookupShared(vkey)) {
+                    answered[i] = decodePayload(*bytes);
+                } else {
+                    unloaded.push_back(i);
+                    payload_keys.push_back(std::move(vkey));
+                }
+            }
+        }
+        if (!payload_keys.empty()) {
+            auto raws = rocksdb_persistence_->multiGetRaw(payload_keys);
+            for (size_t j = 0; j < unloaded.size(); ++j) {
+                const size_t i = unloaded[j];
+                if (!raws[j]) {
+                    answered[i] = tl::unexpected(EngineError::StorageError);
+                    continue;
+                }
+                auto bytes = std::make_shared<const std::string>(std::move(*raws[j]));
+                cacheShared(*payload_cache_, payload_keys[j], bytes, false);
+                head_cache_->replaceIf(paths[i], heads[i],
+                                       std::make_shared<const PathHead>(PathHead{heads[i]->meta, bytes}));
+                answered[i] = decodePayload(*bytes);
+            }
+        }
+    }
+
+    std::vector<ReadResult> results;
+    results.reserve(paths.size());
+    for (auto& result : answered) {
+        results.push_back(std::move(*result));
+    }
+    return results;
+}
+
+std::optional<std::vector<ReadResult>> KvEngine::read_many_async(std::span<const std::string> paths,
+                                                                 ReadManyCallback done) {
+    std::vector<HeadPtr> heads;
+    std::vector<std::optional<ReadResult>> answered;
+    std::vector<uint64_t> stamp;
+    if (stampPublishes(paths, stamp) && readManyCached(paths, heads, answered) == 0 &&
+        publishesUnchanged(paths, stamp)) {
+        std::vector<ReadResult> results;
+        results.reserve(paths.size());
+        for (auto& result : answered) {
+            results.push_back(std::move(*result));
+        }
+        return results;
+    }
+    // Some path needs RocksDB, or a transaction published one meanwhile:
+    // the whole set is read on an I/O thread
+    if (!read_pool_->submit([this, paths = std::vector<std::string>(paths.begin(), paths.end()),
+                             done = std::move(done)]() { done(read_many(paths)); })) {
+        return std::vector<ReadResult>(paths.size(), tl::unexpected(EngineError::QueueFull));
+    }
+    return std::nullopt;
+}
+
+SingleFlightStats KvEngine::missLoadStats() const {
+    const auto heads = head_loads_.stats();
+    const auto payloads = payload_loads_.stats();
+    return SingleFlightStats{heads.loads + payloads.loads,
+                             heads.shared + payloads.shared + async_reads_.stats().shared};
 }
 
 tl::expected<void, EngineError> KvEngine::put_version(std::string_view path, const SecretPayload& payload, std::optional<uint32_t> cas) {
-    std::string mkey = buildMetaKey(path);
-    KeyMetadata meta;
-    
-    if (auto raw_meta = readRawOptimistic(rocksdb_persistence_.get(), storage_.get(), mkey)) {
-        if (auto m = deserializeMetadata(*raw_meta)) { 
-			meta = *m;
-		}
+    auto ticket = putVersion(path, payload, cas, false);
+    if (!ticket) {
+        return tl::unexpected(ticket.error());
     }
-    
-    if (cas.has_value() && meta.current_version != cas.value()) { 
+    return {};
+}
+
+tl::expected<WriteTicket, EngineError> KvEngine::put_version_durable(std::string_view path, const SecretPayload& payload,
+                                                                     std::optional<uint32_t> cas) {
+    return putVersion(path, payload, cas, true);
+}
+
+tl::expected<WriteTicket, EngineError> KvEngine::putVersion(std::string_view path, const SecretPayload& payload,
+                                                            std::optional<uint32_t> cas, bool durable) {
+    // Held until the new head is published: concurrent writers to this path
+    // must not both derive version N+1 or pass the same CAS check
+    std::lock_guard write_lock(path_write_locks_.forKey(path));
+    PathHead head;
+    auto current = loadHead(path);
+    if (current) { 
+		head.meta = (*current)->meta;
+		// Room for the new version up front: appending never reallocates
+		head.meta.versions.reserve(head.meta.versions.size() + 1);
+	} else if (current.error() != EngineError::NotFound) { 
+		// Only a missing path starts at version 1: an unreadable one keeps its history
+		return tl::unexpected(current.error());
+	}
+    if (cas.has_value() && head.meta.current_version != cas.value()) { 
 		return tl::unexpected(EngineError::CasMismatch);
 	}
     
+    // Payload, metadata and pruned payloads commit as one batch: a crash
+    // never leaves metadata naming a version whose payload was not written
+    WriteOps ops;
+    ops.reserve(3);
+    const uint32_t version = stageVersion(path, head, payload, ops);
+    auto ticket = storeHead(path, std::move(head), std::move(ops), durable);
+    if (!ticket) {
+        payload_cache_->remove(buildVersionKey(path, version));
+        return tl::unexpected(ticket.error());
+    }
+    
+    updatePathIndex(path, true);
+    
+    return ticket;
+}
+
+uint32_t KvEngine::stageVersion(std::string_view path, PathHead& head, const SecretPayload& payload, WriteOps& ops) {
+    KeyMetadata& meta = head.meta;
     meta.current_version++;
     VersionState vs;
     vs.version_id = meta.current_version;
@@ -290,39 +1367,282 @@ tl::expected<void, EngineError> KvEngine::put_version(std::string_view path, con
     vs.destroyed = false;
     meta.versions.push_back(vs);
     
+    // Serialized once: the payload cache, the head and the write share this buffer
+    auto bytes = std::make_shared<const std::string>(serializePayload(payload));
     std::string vkey = buildVersionKey(path, vs.version_id);
+    // Explicit ?version=N reads keep working after later writes move the head on
+    cacheShared(*payload_cache_, vkey, bytes);
+    ops.push_back({RocksDBStorage::BatchOp::Type::PUT, std::move(vkey), bytes});
+    auto pruned = trimVersionHistory(meta);
+    deletePrunedPayloads(path, pruned, ops);
     
-    auto res_v = enqueueOrExecute(AsyncOp::Type::PUT, vkey, serializePayload(payload));
-    if (!res_v) {
-        return tl::unexpected(res_v.error());
+    head.latest = std::move(bytes);
+    return vs.version_id;
+}
+
+std::vector<WriteResult> KvEngine::put_many(std::span<const PathPayload> items) {
+    std::vector<WriteResult> results(items.size());
+    for (size_t begin = 0; begin < items.size(); begin += put_many_chunk) {
+        const size_t count = std::min(put_many_chunk, items.size() - begin);
+        putManyChunk(items.subspan(begin, count), std::span<WriteResult>(results).subspan(begin, count));
     }
-    cacheRaw(storage_.get(), vkey, serializePayload(payload));
-    
-    auto res_m = enqueueOrExecute(AsyncOp::Type::PUT, mkey, serializeMetadata(meta));
-    if (!res_m) {
-        return tl::unexpected(res_m.error());
+    return results;
+}
+
+void KvEngine::putManyChunk(std::span<const PathPayload> items, std::span<WriteResult> results) {
+    std::vector<std::string_view> paths;
+    paths.reserve(items.size());
+    for (const auto& item : items) {
+        paths.push_back(item.first);
     }
-	cacheRaw(storage_.get(), mkey, serializeMetadata(meta));
-    
-    path_index_->insertPathIfAbsent(std::string(path));
-    
+    // Every stripe of the batch, held until the heads are published, as in putVersion
+    auto write_locks = path_write_locks_.lockAll(std::span<const std::string_view>(paths));
+
+    // One head per distinct path, carrying all of its versions in item order
+    struct Staged {
+        std::string_view path;
+        PathHead head;
+        WriteOps ops;
+        std::vector<uint32_t> versions;
+        std::optional<EngineError> error;
+    };
+    std::vector<Staged> staged;
+    std::unordered_map<std::string_view, size_t> slot_of;
+    std::vector<size_t> item_slot(items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        auto [it, fresh] = slot_of.try_emplace(paths[i], staged.size());
+        if (fresh) {
+            Staged next{paths[i], {}, {}, {}, std::nullopt};
+            auto current = loadHead(paths[i]);
+            if (current) {
+                next.head = **current;
+            } else if (current.error() != EngineError::NotFound) {
+                next.error = current.error(); // As in putVersion: nothing is written to the path
+            }
+            staged.push_back(std::move(next));
+        }
+        Staged& slot = staged[it->second];
+        item_slot[i] = it->second;
+        if (!slot.error) {
+            slot.versions.push_back(stageVersion(slot.path, slot.head, items[i].second, slot.ops));
+        }
+    }
+    for (auto& slot : staged) {
+        if (slot.error) {
+            continue;
+        }
+        slot.ops.push_back({RocksDBStorage::BatchOp::Type::PUT, buildMetaKey(slot.path), nullptr,
+                            serializeMetadata(slot.head.meta)});
+    }
+
+    if (sync_mode_.load(std::memory_order_relaxed) == SyncMode::IMMEDIATE) {
+        // The whole set as one WriteBatch and one (shared) fsync
+        WriteOps all;
+        for (auto& slot : staged) {
+            std::move(slot.ops.begin(), slot.ops.end(), std::back_inserter(all));
+        }
+        if (!all.empty() && !commitImmediate(all)) {
+            for (auto& slot : staged) {
+                slot.error = EngineError::StorageError;
+            }
+        }
+    } else {
+        // One record per worker instead of one per path. A record stays
+        // within the ring's size limit: a large set is cut into several.
+        std::vector<std::vector<size_t>> by_worker(write_workers_.size());
+        for (size_t s = 0; s < staged.size(); ++s) {
+            by_worker[workerFor(staged[s].path)].push_back(s);
+        }
+        for (size_t w = 0; w < by_worker.size(); ++w) {
+            const size_t max_record = write_workers_[w]->queue.maxRecordSize();
+            WriteOps record;
+            std::vector<size_t> members;
+            auto enqueue = [&]() {
+                if (!members.empty() && !enqueueOn(w, record, false)) {
+                    for (size_t s : members) {
+                        staged[s].error = EngineError::QueueFull;
+                    }
+                }
+                record.clear();
+                members.clear();
+            };
+            for (size_t s : by_worker[w]) {
+                if (staged[s].error) {
+                    continue;
+                }
+                if (!members.empty() && encodedRecordSize(record) + encodedRecordSize(staged[s].ops) > max_record) {
+                    enqueue();
+                }
+                std::move(staged[s].ops.begin(), staged[s].ops.end(), std::back_inserter(record));
+                members.push_back(s);
+            }
+            enqueue();
+        }
+    }
+
+    for (auto& slot : staged) {
+        if (slot.error) {
+            for (uint32_t version : slot.versions) {
+                payload_cache_->remove(buildVersionKey(slot.path, version));
+            }
+            continue;
+        }
+        publishHead(slot.path, std::move(slot.head));
+        updatePathIndex(slot.path, true);
+    }
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (const auto& error = staged[item_slot[i]].error) {
+            results[i] = tl::unexpected(*error);
+        }
+    }
+}
+
+TxnResult KvEngine::transact(std::span<const TxnOp> ops) {
+    if (ops.empty()) {
+        return {};
+    }
+    std::vector<std::string_view> paths;
+    paths.reserve(ops.size());
+    for (const auto& op : ops) {
+        paths.push_back(op.path);
+    }
+    // Held from the checks to the publication: no other write to these
+    // paths can land in between, nor see part of the transaction
+    auto write_locks = path_write_locks_.lockAll(std::span<const std::string_view>(paths));
+
+    struct Staged {
+        std::string_view path;
+        PathHead head;
+        bool written = false;
+        std::vector<uint32_t> versions; // Payloads cached by this transaction
+    };
+    std::vector<Staged> staged;
+    std::unordered_map<std::string_view, size_t> slot_of;
+    std::vector<size_t> op_slot(ops.size());
+    for (size_t i = 0; i < ops.size(); ++i) {
+        auto [it, fresh] = slot_of.try_emplace(paths[i], staged.size());
+        if (fresh) {
+            Staged next{paths[i], {}, false, {}};
+            auto current = loadHead(paths[i]);
+            if (current) {
+                next.head = **current;
+            } else if (current.error() != EngineError::NotFound) { 
+				return tl::unexpected(TxnError{i, current.error()});
+			}
+            staged.push_back(std::move(next));
+        }
+        op_slot[i] = it->second;
+        // Against the heads before the transaction: nothing is staged yet
+        if (ops[i].cas && staged[it->second].head.meta.current_version != *ops[i].cas) { 
+			return tl::unexpected(TxnError{i, EngineError::CasMismatch});
+		}
+    }
+
+    auto discard = [&]() {
+        for (const auto& slot : staged) {
+            for (uint32_t version : slot.versions) {
+                payload_cache_->remove(buildVersionKey(slot.path, version));
+            }
+        }
+    };
+    WriteOps writes;
+    for (size_t i = 0; i < ops.size(); ++i) {
+        Staged& slot = staged[op_slot[i]];
+        if (ops[i].type == TxnOp::Type::PUT) {
+            slot.versions.push_back(stageVersion(slot.path, slot.head, ops[i].payload, writes));
+            slot.written = true;
+        } else if (ops[i].type == TxnOp::Type::DELETE) {
+            KeyMetadata& meta = slot.head.meta;
+            auto vs = std::find_if(meta.versions.begin(), meta.versions.end(),
+                                   [&](const VersionState& v) { return v.version_id == meta.current_version; });
+            if (vs == meta.versions.end()) { 
+				discard();
+				return tl::unexpected(TxnError{i, EngineError::NotFound});
+			}
+            // As destroy_version: the DEL follows any PUT of the version staged above
+            vs->destroyed = true;
+            std::string vkey = buildVersionKey(slot.path, vs->version_id);
+            payload_cache_->remove(vkey);
+            writes.push_back({RocksDBStorage::BatchOp::Type::DEL, std::move(vkey)});
+            slot.head.latest.reset();
+            slot.written = true;
+        }
+    }
+    std::vector<size_t> streams;
+    std::vector<size_t> stripes;
+    for (const auto& slot : staged) {
+        if (slot.written) {
+            writes.push_back({RocksDBStorage::BatchOp::Type::PUT, buildMetaKey(slot.path), nullptr,
+                              serializeMetadata(slot.head.meta)});
+            streams.push_back(workerFor(slot.path));
+            stripes.push_back(decltype(path_write_locks_)::stripeIndex(slot.path));
+        }
+    }
+    if (writes.empty()) {
+        return {}; // Checks only
+    }
+
+    if (sync_mode_.load(std::memory_order_relaxed) == SyncMode::BATCH) {
+        // Earlier writes of these paths may still be queued behind their
+        // workers: written after the transaction, they would undo it
+        std::sort(streams.begin(), streams.end());
+        streams.erase(std::unique(streams.begin(), streams.end()), streams.end());
+        if (auto drained = drainWorkers(streams); !drained) { 
+			discard();
+			return tl::unexpected(TxnError{ops.size(), drained.error()});
+		}
+    }
+    // Odd from the commit to the last publication: a read_many of several
+    // of these paths, from the caches or from disk, retries instead of
+    // seeing part of the transaction
+    std::sort(stripes.begin(), stripes.end());
+    stripes.erase(std::unique(stripes.begin(), stripes.end()), stripes.end());
+    auto bumpPublishes = [&](std::memory_order order) {
+        for (size_t stripe : stripes) {
+            publish_seqs_[stripe].store(publish_seqs_[stripe].load(std::memory_order_relaxed) + 1, order);
+        }
+    };
+    bumpPublishes(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    // One WriteBatch, fsynced: all of the transaction is on disk or none of it
+    if (!commitImmediate(writes)) { 
+		bumpPublishes(std::memory_order_release);
+		discard();
+		return tl::unexpected(TxnError{ops.size(), EngineError::StorageError});
+	}
+
+    for (auto& slot : staged) {
+        if (!slot.written) {
+            continue;
+        }
+        const bool live = !allVersionsDestroyed(slot.head.meta);
+        publishHead(slot.path, std::move(slot.head));
+        updatePathIndex(slot.path, live);
+    }
+    bumpPublishes(std::memory_order_release);
     return {};
 }
 
+std::optional<TxnResult> KvEngine::transact_async(std::vector<TxnOp> ops, TxnCallback done) {
+    const size_t count = ops.size();
+    if (!write_pool_->submit([this, ops = std::move(ops), done = std::move(done)]() { done(transact(ops)); })) {
+        return tl::unexpected(TxnError{count, EngineError::QueueFull});
+    }
+    return std::nullopt;
+}
+
 tl::expected<void, EngineError> KvEngine::soft_delete(std::string_view path, uint32_t version) {
-    std::string mkey = buildMetaKey(path);
-    auto raw_meta = readRawOptimistic(rocksdb_persistence_.get(), storage_.get(), mkey);
-    if (!raw_meta) { 
-		return tl::unexpected(EngineError::NotFound);
-	}
-    
-    auto meta = deserializeMetadata(*raw_meta);
-    if (!meta) { 
-		return tl::unexpected(EngineError::StorageError);
+    std::lock_guard write_lock(path_write_locks_.forKey(path));
+    auto current = loadHead(path);
+    if (!current) { 
+		return tl::unexpected(current.error());
 	}
     
+    // The latest payload stays cached: read_version checks the version state first
+    PathHead head = **current;
     bool found = false;
-    for (auto& vs : meta->versions) {
+    for (auto& vs : head.meta.versions) {
         if (vs.version_id == version) {
             vs.deletion_time_ms = nowMs();
             found = true;
@@ -333,29 +1653,23 @@ tl::expected<void, EngineError> KvEngine::soft_delete(std::string_view path, uin
 		return tl::unexpected(EngineError::InvalidVersion);
 	}
     
-    auto res = enqueueOrExecute(AsyncOp::Type::PUT, mkey, serializeMetadata(*meta));
+    auto res = storeHead(path, std::move(head));
     if (!res) {
         return tl::unexpected(res.error());
     }
-    cacheRaw(storage_.get(), mkey, serializeMetadata(*meta));
-    
     return {};
 }
 
 tl::expected<void, EngineError> KvEngine::destroy_version(std::string_view path, uint32_t version) {
-    std::string mkey = buildMetaKey(path);
-    auto raw_meta = readRawOptimistic(rocksdb_persistence_.get(), storage_.get(), mkey);
-    if (!raw_meta) { 
-		return tl::unexpected(EngineError::NotFound);
-	}
-    
-    auto meta = deserializeMetadata(*raw_meta);
-    if (!meta) { 
-		return tl::unexpected(EngineError::StorageError);
+    std::lock_guard write_lock(path_write_locks_.forKey(path));
+    auto current = loadHead(path);
+    if (!current) { 
+		return tl::unexpected(current.error());
 	}
     
+    PathHead head = **current;
     bool found = false;
-    for (auto& vs : meta->versions) {
+    for (auto& vs : head.meta.versions) {
         if (vs.version_id == version) {
             vs.destroyed = true;
             found = true;
@@ -367,17 +1681,23 @@ tl::expected<void, EngineError> KvEngine::destroy_version(std::string_view path,
 	}
     
     std::string vkey = buildVersionKey(path, version);
-    auto res_v = enqueueOrExecute(AsyncOp::Type::DEL, vkey, "");
-    if (!res_v) {
-        return tl::unexpected(res_v.error());
+    payload_cache_->remove(vkey);
+    WriteOps ops;
+    ops.push_back({RocksDBStorage::BatchOp::Type::DEL, std::move(vkey)});
+    if (version == head.meta.current_version) {
+        head.latest.reset(); // Never serve a destroyed payload from the head
     }
-    uncacheRaw(storage_.get(), vkey);
     
-    auto res_m = enqueueOrExecute(AsyncOp::Type::PUT, mkey, serializeMetadata(*meta));
+    const bool no_live_versions = allVersionsDestroyed(head.meta);
+    auto res_m = storeHead(path, std::move(head), std::move(ops));
     if (!res_m) {
         return tl::unexpected(res_m.error());
     }
-    cacheRaw(storage_.get(), mkey, serializeMetadata(*meta));
+
+    // No live payload left: drop the path so RCU snapshots stop copying it
+    if (no_live_versions) {
+        updatePathIndex(path, false);
+    }
     
     return {};
 }
@@ -393,6 +1713,35 @@ ISecretEngine::SyncMode KvEngine::getSyncMode() const {
     return sync_mode_.load(std::memory_order_relaxed);
 }
 
+FlushStats KvEngine::flushStats() const {
+    FlushStats merged;
+    for (const auto& worker : write_workers_) {
+        const FlushStats stats = worker->scheduler.stats();
+        merged.flushes += stats.flushes;
+        merged.records += stats.records;
+        merged.arrival_rate += stats.arrival_rate;
+        merged.batch_limit = std::max(merged.batch_limit, stats.batch_limit);
+        merged.window_us = std::max(merged.window_us, stats.window_us);
+        merged.write_latency_us = std::max(merged.write_latency_us, stats.write_latency_us);
+        merged.queue_depth_p50 = std::max(merged.queue_depth_p50, stats.queue_depth_p50);
+        merged.queue_depth_p99 = std::max(merged.queue_depth_p99, stats.queue_depth_p99);
+        merged.queue_depth_max = std::max(merged.queue_depth_max, stats.queue_depth_max);
+        merged.batch_size_p50 = std::max(merged.batch_size_p50, stats.batch_size_p50);
+        merged.batch_size_p99 = std::max(merged.batch_size_p99, stats.batch_size_p99);
+        merged.batch_size_max = std::max(merged.batch_size_max, stats.batch_size_max);
+        merged.lag_p50_us = std::max(merged.lag_p50_us, stats.lag_p50_us);
+        merged.lag_p99_us = std::max(merged.lag_p99_us, stats.lag_p99_us);
+        merged.lag_max_us = std::max(merged.lag_max_us, stats.lag_max_us);
+    }
+    return merged;
+}
+
+void KvEngine::setFlushPolicy(const FlushPolicy& policy) {
+    for (auto& worker : write_workers_) {
+        worker->scheduler.setPolicy(policy);
+    }
+}
+
 void KvEngine::forceFlush() {
     if (rocksdb_persistence_) {
         rocksdb_persistence_->flush();
@@ -0,0 +1,224 @@
+#include "kallisto/engine/metadata_codec.hpp"
+#include <cstring>
+
+namespace kallisto::engine {
+
+namespace {
+
+constexpr uint8_t cas_required_flag = 0x01;
+constexpr size_t legacy_header_size = 21;
+
+void putVarint(std::string& buf, uint64_t value) {
+    while (value >= 0x80) {
+        buf.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    buf.push_back(static_cast<char>(value));
+}
+
+uint64_t zigzag(uint64_t delta) {
+    const auto signed_delta = static_cast<int64_t>(delta);
+    return (static_cast<uint64_t>(signed_delta) << 1) ^ static_cast<uint64_t>(signed_delta >> 63);
+}
+
+uint64_t unzigzag(uint64_t value) {
+    return (value >> 1) ^ (~(value & 1) + 1);
+}
+
+/**
+ * Bounds-checked reader: every get fails once the input runs out or
+ * holds a malformed varint, and ok() stays false from then on.
+ */
+class Reader {
+public:
+    explicit Reader(std::string_view data)
+        : pos_(reinterpret_cast<const uint8_t*>(data.data())), end_(pos_ + data.size()) {}
+
+    bool ok() const { return ok_; }
+    bool atEnd() const { return pos_ == end_; }
+    size_t remaining() const { return end_ - pos_; }
+
+    uint8_t byte() {
+        if (pos_ == end_) {
+            ok_ = false;
+            return 0;
+        }
+        return *pos_++;
+    }
+
+    uint64_t varint() {
+        // Most fields fit one byte: ids, flags, counts
+        if (pos_ != end_ && *pos_ < 0x80) {
+            return *pos_++;
+        }
+        uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            if (pos_ == end_) {
+                break;
+            }
+            const uint8_t b = *pos_++;
+            value |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) {
+                return value;
+            }
+        }
+        ok_ = false;
+        return 0;
+    }
+
+    const uint8_t* skip(size_t n) {
+        if (remaining() < n) {
+            ok_ = false;
+            return nullptr;
+        }
+        const uint8_t* start = pos_;
+        pos_ += n;
+        return start;
+    }
+
+private:
+    const uint8_t* pos_;
+    const uint8_t* end_;
+    bool ok_ = true;
+};
+
+std::optional<MetadataHeader> readHeader(Reader& in) {
+    if (in.byte() != metadata_format_version) {
+        return std::nullopt;
+    }
+    const uint64_t current_version = in.varint();
+    const uint64_t max_versions = in.varint();
+    const uint8_t flags = in.byte();
+    const uint64_t delete_version_after_ms = in.varint();
+    const uint64_t count = in.varint();
+    // Every version takes at least two bytes: a corrupt count cannot over-allocate
+    if (!in.ok() || current_version > UINT32_MAX || max_versions > UINT32_MAX || count > in.remaining() / 2) {
+        return std::nullopt;
+    }
+    return MetadataHeader{static_cast<uint32_t>(current_version), static_cast<uint32_t>(max_versions),
+                          (flags & cas_required_flag) != 0, delete_version_after_ms, static_cast<size_t>(count)};
+}
+
+} // namespace
+
+std::string serializeMetadata(const KeyMetadata& meta) {
+    const size_t count = meta.versions.size();
+    std::string buf;
+    // Header <= 1 + 5 + 5 + 1 + 10 + 10; ascending histories take ~6 bytes a version
+    buf.reserve(32 + (count * 2 + 7) / 8 + count * 8);
+    buf.push_back(static_cast<char>(metadata_format_version));
+    putVarint(buf, meta.current_version);
+    putVarint(buf, meta.max_versions);
+    buf.push_back(static_cast<char>(meta.cas_required ? cas_required_flag : 0));
+    putVarint(buf, meta.delete_version_after_ms);
+    putVarint(buf, count);
+
+    const size_t bitset_at = buf.size();
+    buf.append((count * 2 + 7) / 8, '\0');
+    for (size_t i = 0; i < count; ++i) {
+        const VersionState& vs = meta.versions[i];
+        uint8_t bits = (vs.deletion_time_ms > 0 ? 1 : 0) | (vs.destroyed ? 2 : 0);
+        buf[bitset_at + i / 4] = static_cast<char>(static_cast<uint8_t>(buf[bitset_at + i / 4]) | (bits << (i % 4 * 2)));
+    }
+
+    uint32_t previous_id = 0;
+    uint64_t previous_created = 0;
+    for (const VersionState& vs : meta.versions) {
+        putVarint(buf, static_cast<uint32_t>(vs.version_id - previous_id));
+        putVarint(buf, zigzag(vs.created_time_ms - previous_created));
+        if (vs.deletion_time_ms > 0) {
+            putVarint(buf, zigzag(vs.deletion_time_ms - vs.created_time_ms));
+        }
+        previous_id = vs.version_id;
+        previous_created = vs.created_time_ms;
+    }
+    return buf;
+}
+
+std::optional<KeyMetadata> deserializeMetadata(std::string_view data) {
+    Reader in(data);
+    auto header = readHeader(in);
+    if (!header) {
+        return std::nullopt;
+    }
+    KeyMetadata m;
+    m.current_version = header->current_version;
+    m.max_versions = header->max_versions;
+    m.cas_required = header->cas_required;
+    m.delete_version_after_ms = header->delete_version_after_ms;
+    const size_t count = header->version_count;
+
+    const uint8_t* bitset = in.skip((count * 2 + 7) / 8);
+    if (!in.ok()) {
+        return std::nullopt;
+    }
+    m.versions.resize(count);
+    uint32_t previous_id = 0;
+    uint64_t previous_created = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t bits = (bitset[i / 4] >> (i % 4 * 2)) & 3;
+        VersionState& vs = m.versions[i];
+        const uint64_t id_delta = in.varint();
+        if (id_delta > UINT32_MAX) {
+            return std::nullopt;
+        }
+        vs.version_id = previous_id + static_cast<uint32_t>(id_delta);
+        vs.created_time_ms = previous_created + unzigzag(in.varint());
+        if (bits & 1) {
+            vs.deletion_time_ms = vs.created_time_ms + unzigzag(in.varint());
+        }
+        vs.destroyed = (bits & 2) != 0;
+        previous_id = vs.version_id;
+        previous_created = vs.created_time_ms;
+    }
+    if (!in.ok() || !in.atEnd()) {
+        return std::nullopt;
+    }
+    return m;
+}
+
+std::optional<MetadataHeader> deserializeMetadataHeader(std::string_view data) {
+    Reader in(data);
+    return readHeader(in);
+}
+
+std::string serializeLegacyMetadata(const KeyMetadata& meta) {
+    std::string buf;
+    size_t size = 4 + 4 + 1 + 8 + 4 + meta.versions.size() * sizeof(VersionState);
+    buf.reserve(size);
+    buf.append(reinterpret_cast<const char*>(&meta.current_version), 4);
+    buf.append(reinterpret_cast<const char*>(&meta.max_versions), 4);
+    buf.append(reinterpret_cast<const char*>(&meta.cas_required), 1);
+    buf.append(reinterpret_cast<const char*>(&meta.delete_version_after_ms), 8);
+    uint32_t v_size = meta.versions.size();
+    buf.append(reinterpret_cast<const char*>(&v_size), 4);
+    if (v_size > 0) {
+        buf.append(reinterpret_cast<const char*>(meta.versions.data()), v_size * sizeof(VersionState));
+    }
+    return buf;
+}
+
+std::optional<KeyMetadata> deserializeLegacyMetadata(std::string_view data) {
+    if (data.size() < legacy_header_size) {
+		return std::nullopt;
+	}
+    KeyMetadata m;
+    const char* ptr = data.data();
+    std::memcpy(&m.current_version, ptr, 4); ptr += 4;
+    std::memcpy(&m.max_versions, ptr, 4); ptr += 4;
+    std::memcpy(&m.cas_required, ptr, 1); ptr += 1;
+    std::memcpy(&m.delete_version_after_ms, ptr, 8); ptr += 8;
+    uint32_t v_size;
+    std::memcpy(&v_size, ptr, 4); ptr += 4;
+    // A truncated history is unreadable, not empty
+    if (data.size() - legacy_header_size < static_cast<uint64_t>(v_size) * sizeof(VersionState)) {
+		return std::nullopt;
+	}
+    m.versions.resize(v_size);
+    if (v_size > 0) {
+        std::memcpy(m.versions.data(), ptr, v_size * sizeof(VersionState));
+    }
+    return m;
+}
+
+} // namespace kallisto::engine
@@ -0,0 +1,94 @@
+#include "kallisto/engine/negative_cache.hpp"
+#include <algorithm>
+
+namespace kallisto::engine {
+
+NegativeCache::NegativeCache(size_t capacity, std::chrono::milliseconds ttl)
+    : shards_(std::make_unique<std::array<Shard, num_shards>>())
+    , shard_capacity_(std::max<size_t>(1, capacity / num_shards))
+    , ttl_(std::max(ttl, std::chrono::milliseconds::zero())) {}
+
+NegativeCache::Shard& NegativeCache::shardFor(std::string_view key) const {
+    return (*shards_)[std::hash<std::string_view>{}(key) % num_shards];
+}
+
+bool NegativeCache::contains(std::string_view key, Clock::time_point now) {
+    if (!enabled()) {
+        return false;
+    }
+    Shard& shard = shardFor(key);
+    std::lock_guard lock(shard.mutex);
+    auto it = shard.expiries.find(key);
+    if (it == shard.expiries.end()) {
+        return false;
+    }
+    if (now >= it->second) {
+        shard.expiries.erase(it);
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        expired_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+uint64_t NegativeCache::generation(std::string_view key) const {
+    return shardFor(key).generation.load(std::memory_order_acquire);
+}
+
+bool NegativeCache::insert(std::string_view key, uint64_t generation, Clock::time_point now) {
+    if (!enabled()) {
+        return false;
+    }
+    Shard& shard = shardFor(key);
+    std::lock_guard lock(shard.mutex);
+    // A write to the shard since the snapshot may have created key
+    if (shard.generation.load(std::memory_order_relaxed) != generation) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    auto it = shard.expiries.find(key);
+    if (it != shard.expiries.end()) {
+        it->second = now + ttl_;
+        return true;
+    }
+    if (shard.expiries.size() >= shard_capacity_) {
+        sweep(shard, now);
+        if (shard.expiries.size() >= shard_capacity_) {
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+    shard.expiries.emplace(std::string(key), now + ttl_);
+    size_.fetch_add(1, std::memory_order_relaxed);
+    inserts_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void NegativeCache::invalidate(std::string_view key) {
+    if (!enabled()) {
+        return;
+    }
+    Shard& shard = shardFor(key);
+    std::lock_guard lock(shard.mutex);
+    shard.generation.fetch_add(1, std::memory_order_release);
+    if (auto it = shard.expiries.find(key); it != shard.expiries.end()) {
+        shard.expiries.erase(it);
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        invalidations_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void NegativeCache::sweep(Shard& shard, Clock::time_point now) {
+    const size_t dropped = std::erase_if(shard.expiries, [&](const auto& entry) { return now >= entry.second; });
+    size_.fetch_sub(dropped, std::memory_order_relaxed);
+    expired_.fetch_add(dropped, std::memory_order_relaxed);
+}
+
+NegativeCacheStats NegativeCache::stats() const {
+    return NegativeCacheStats{hits_.load(std::memory_order_relaxed),        inserts_.load(std::memory_order_relaxed),
+                              invalidations_.load(std::memory_order_relaxed), expired_.load(std::memory_order_relaxed),
+                              rejected_.load(std::memory_order_relaxed),    size_.load(std::memory_order_relaxed)};
+}
+
+} // namespace kallisto::engine
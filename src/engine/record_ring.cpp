@@ -0,0 +1,113 @@
+#include "kallisto/engine/record_ring.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+namespace kallisto::engine {
+
+void RecordRing::FreeDeleter::operator()(std::byte* p) const {
+    std::free(p);
+}
+
+namespace {
+
+size_t checkedCapacity(size_t capacity_bytes) {
+    if (capacity_bytes > RecordRing::max_capacity) {
+        throw std::length_error("RecordRing capacity exceeds " + std::to_string(RecordRing::max_capacity >> 20) +
+                                " MB");
+    }
+    return std::bit_ceil(std::max<size_t>(capacity_bytes, 4096));
+}
+
+} // namespace
+
+RecordRing::RecordRing(size_t capacity_bytes)
+    : capacity_(checkedCapacity(capacity_bytes))
+    , mask_(capacity_ - 1)
+    , buffer_(static_cast<std::byte*>(std::calloc(capacity_, 1))) {
+    if (!buffer_) {
+        throw std::bad_alloc();
+    }
+}
+
+std::byte* RecordRing::reserve(size_t size, uint64_t& end) {
+    if (size > maxRecordSize()) {
+        return nullptr;
+    }
+    const size_t needed = footprint(size);
+
+    uint64_t pos = tail_.load(std::memory_order_relaxed);
+    size_t padding;
+    for (;;) {
+        const size_t offset = pos & mask_;
+        padding = offset + needed > capacity_ ? capacity_ - offset : 0;
+        // Acquire: the consumer zeroed the space before publishing head_
+        const uint64_t head = head_.load(std::memory_order_acquire);
+        if (pos + padding + needed - head > capacity_) {
+            // A stale pos may already be behind head: only the current tail
+            // can tell a full ring
+            const uint64_t current = tail_.load(std::memory_order_relaxed);
+            if (current != pos) {
+                pos = current;
+                continue;
+            }
+            return nullptr; // Full
+        }
+        if (tail_.compare_exchange_weak(pos, pos + padding + needed, std::memory_order_relaxed)) {
+            break;
+        }
+    }
+
+    if (padding > 0) {
+        headerAt(pos).store(committed_bit | padding_bit, std::memory_order_release);
+        pos += padding;
+    }
+    end = pos + needed;
+    return buffer_.get() + (pos & mask_);
+}
+
+void RecordRing::commit(std::byte* slot, size_t size) {
+    std::atomic_ref<uint32_t>(*reinterpret_cast<uint32_t*>(slot))
+        .store(committed_bit | static_cast<uint32_t>(size), std::memory_order_release);
+    pushed_.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t RecordRing::release() {
+    const uint64_t head = head_.load(std::memory_order_relaxed);
+    if (read_pos_ == head) {
+        return head;
+    }
+    // Zero the freed bytes: a header word reads as uncommitted until its
+    // producer publishes it, wherever the next records land
+    const size_t begin = head & mask_;
+    const size_t length = read_pos_ - head;
+    const size_t first = std::min(length, capacity_ - begin);
+    std::memset(buffer_.get() + begin, 0, first);
+    std::memset(buffer_.get(), 0, length - first);
+
+    released_.store(visited_, std::memory_order_relaxed);
+    head_.store(read_pos_, std::memory_order_release);
+    return read_pos_;
+}
+
+bool RecordRing::empty() const {
+    return allVisited() || (headerAt(read_pos_).load(std::memory_order_acquire) & committed_bit) == 0;
+}
+
+size_t RecordRing::sizeApprox() const {
+    const uint64_t pushed = pushed_.load(std::memory_order_relaxed);
+    const uint64_t released = released_.load(std::memory_order_relaxed);
+    return pushed > released ? pushed - released : 0;
+}
+
+size_t RecordRing::bytesApprox() const {
+    const uint64_t tail = tail_.load(std::memory_order_relaxed);
+    const uint64_t head = head_.load(std::memory_order_relaxed);
+    return tail > head ? tail - head : 0;
+}
+
+} // namespace kallisto::engine
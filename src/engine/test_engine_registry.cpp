@@ -17,6 +17,7 @@ public:
     MOCK_METHOD((tl::expected<void, EngineError>), put_version, (std::string_view, const SecretPayload&, std::optional<uint32_t>), (override));
     MOCK_METHOD((tl::expected<void, EngineError>), soft_delete, (std::string_view, uint32_t), (override));
     MOCK_METHOD((tl::expected<void, EngineError>), destroy_version, (std::string_view, uint32_t), (override));
+    MOCK_METHOD(TxnResult, transact, (std::span<const TxnOp>), (override));
     MOCK_METHOD(std::string, engineType, (), (const, override));
     MOCK_METHOD(void, changeSyncMode, (SyncMode), (override));
     MOCK_METHOD(SyncMode, getSyncMode, (), (const, override));
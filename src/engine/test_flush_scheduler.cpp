@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include "kallisto/engine/flush_scheduler.hpp"
+
+#include <chrono>
+
+using namespace kallisto::engine;
+using namespace std::chrono_literals;
+
+// =============================================================================
+// FLUSH SCHEDULER TEST SUITE
+//
+// Problem Description:
+//   The write-behind worker used fixed 1024-record / 5 ms batches whatever
+//   the load. The scheduler sizes batches from the observed arrival rate and
+//   sets the flush window from the lag budget left after RocksDB's write
+//   latency, backing off when flushes overshoot the p99 target.
+//
+// Coverage:
+//   1. Histogram percentiles are bucket upper bounds, capped by the max
+//   2. A trickle of records is flushed one by one, with the full window
+//   3. Overshooting the target shrinks the window
+//   4. A backlog grows the batch limit up to max_batch
+//   5. Policy changes apply immediately
+// =============================================================================
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+} // namespace
+
+TEST(FlushSchedulerTest, HistogramPercentiles) {
+    Log2Histogram histogram;
+    EXPECT_EQ(histogram.percentile(0.99), 0u);
+
+    for (uint64_t v = 1; v <= 1000; ++v) {
+        histogram.record(v);
+    }
+    histogram.record(0);
+    EXPECT_EQ(histogram.count(), 1001u);
+    EXPECT_EQ(histogram.max(), 1000u);
+    EXPECT_EQ(histogram.percentile(0.0), 0u);
+    // 500 lies in [256, 512)
+    EXPECT_EQ(histogram.percentile(0.5), 511u);
+    // The top bucket [512, 1024) is capped by the observed max
+    EXPECT_EQ(histogram.percentile(0.99), 1000u);
+}
+
+TEST(FlushSchedulerTest, TrickleFlushesEachRecordRightAway) {
+    FlushScheduler scheduler(FlushPolicy{5000us, 4096});
+    auto now = Clock::now();
+    // 10 records/s, 100 us writes, well within the target
+    for (int i = 0; i < 50; ++i) {
+        now += 100ms;
+        scheduler.recordFlush(1, 0, 100us, 150us, now);
+    }
+    EXPECT_EQ(scheduler.batchLimit(), 1u);
+    // Whole budget minus twice the write latency
+    EXPECT_EQ(scheduler.flushWindow(), 4800us);
+
+    auto stats = scheduler.stats();
+    EXPECT_EQ(stats.flushes, 50u);
+    EXPECT_EQ(stats.records, 50u);
+    EXPECT_EQ(stats.write_latency_us, 100u);
+    EXPECT_NEAR(stats.arrival_rate, 10.0, 0.5);
+    EXPECT_EQ(stats.batch_size_max, 1u);
+}
+
+TEST(FlushSchedulerTest, OvershootShrinksWindow) {
+    FlushScheduler scheduler(FlushPolicy{5000us, 4096});
+    auto now = Clock::now();
+    for (int i = 0; i < 10; ++i) {
+        now += 1ms;
+        scheduler.recordFlush(100, 0, 100us, 2000us, now);
+    }
+    const auto relaxed = scheduler.flushWindow();
+
+    for (int i = 0; i < 3; ++i) {
+        now += 1ms;
+        scheduler.recordFlush(100, 0, 100us, 9000us, now);
+    }
+    EXPECT_LT(scheduler.flushWindow().count(), relaxed.count() / 2);
+    EXPECT_GE(scheduler.stats().lag_max_us, 9000u);
+}
+
+TEST(FlushSchedulerTest, BacklogGrowsBatchLimit) {
+    FlushScheduler scheduler(FlushPolicy{5000us, 4096});
+    auto now = Clock::now();
+    // A slow trickle first: the limit drops to 1
+    for (int i = 0; i < 20; ++i) {
+        now += 100ms;
+        scheduler.recordFlush(1, 0, 100us, 150us, now);
+    }
+    ASSERT_EQ(scheduler.batchLimit(), 1u);
+
+    // Then a burst leaves records queued behind every flush
+    size_t batch = scheduler.batchLimit();
+    for (int i = 0; i < 20; ++i) {
+        now += 200us;
+        scheduler.recordFlush(batch, 100000, 300us, 1000us, now);
+        EXPECT_GE(scheduler.batchLimit(), std::min<size_t>(batch * 2, 4096));
+        batch = scheduler.batchLimit();
+    }
+    EXPECT_EQ(scheduler.batchLimit(), 4096u);
+    EXPECT_GE(scheduler.stats().queue_depth_p99, 100000u);
+}
+
+TEST(FlushSchedulerTest, PolicyChangeAppliesImmediately) {
+    FlushScheduler scheduler;
+    EXPECT_EQ(scheduler.policy().target_p99_lag, 5000us);
+    EXPECT_EQ(scheduler.batchLimit(), 1024u);
+
+    scheduler.setPolicy(FlushPolicy{1000us, 64});
+    EXPECT_EQ(scheduler.policy().max_batch, 64u);
+    EXPECT_LE(scheduler.batchLimit(), 64u);
+    EXPECT_LE(scheduler.flushWindow(), 1000us);
+}
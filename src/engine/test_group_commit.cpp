@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include "kallisto/engine/group_commit.hpp"
+
+#include <filesystem>
+#include <latch>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace kallisto;
+using namespace kallisto::engine;
+
+// =============================================================================
+// GROUP COMMIT TEST SUITE
+//
+// Problem Description:
+//   In IMMEDIATE mode every write must be fsynced before it is acknowledged.
+//   Concurrent writers hand their records to one leader, which writes them
+//   as one WriteBatch and one fsync. No request may be acknowledged before
+//   its records are durable, and no request's records may be split.
+//
+// Coverage:
+//   1. A lone commit is written and counted as its own group
+//   2. Concurrent commits all land, each exactly once, in at most one group each
+//   3. Empty requests complete without touching the disk
+// =============================================================================
+
+namespace {
+
+using Op = RocksDBStorage::BatchOp;
+
+class GroupCommitTest : public ::testing::Test {
+protected:
+    std::string db_path = "/tmp/kallisto_group_commit_test_db";
+
+    void SetUp() override { std::filesystem::remove_all(db_path); }
+    void TearDown() override { std::filesystem::remove_all(db_path); }
+};
+
+} // namespace
+
+TEST_F(GroupCommitTest, SingleCommitIsDurable) {
+    {
+        RocksDBStorage storage(db_path);
+        GroupCommitter committer(storage);
+        ASSERT_TRUE(committer.commit({{Op::Type::PUT, "v:app/db:1", "payload"},
+                                      {Op::Type::PUT, "m:app/db", "meta"}}));
+
+        auto stats = committer.stats();
+        EXPECT_EQ(stats.commits, 1u);
+        EXPECT_EQ(stats.groups, 1u);
+        EXPECT_EQ(stats.max_group, 1u);
+    }
+
+    RocksDBStorage reopened(db_path);
+    EXPECT_EQ(reopened.getRaw("v:app/db:1"), "payload");
+    EXPECT_EQ(reopened.getRaw("m:app/db"), "meta");
+}
+
+TEST_F(GroupCommitTest, ConcurrentCommitsAllLand) {
+    // Problem: followers must wake only once their own group is written,
+    // and a request queued during a leader's fsync must lead or join the next group.
+    constexpr int num_threads = 8;
+    constexpr int commits_per_thread = 50;
+    {
+        RocksDBStorage storage(db_path);
+        GroupCommitter committer(storage);
+
+        std::latch start(num_threads);
+        std::vector<std::thread> writers;
+        for (int t = 0; t < num_threads; ++t) {
+            writers.emplace_back([&, t]() {
+                start.arrive_and_wait();
+                for (int i = 0; i < commits_per_thread; ++i) {
+                    std::string key = std::to_string(t) + "/" + std::to_string(i);
+                    EXPECT_TRUE(committer.commit({{Op::Type::PUT, "v:" + key, "payload"},
+                                                  {Op::Type::PUT, "m:" + key, "meta"}}));
+                }
+            });
+        }
+        for (auto& writer : writers) {
+            writer.join();
+        }
+
+        auto stats = committer.stats();
+        EXPECT_EQ(stats.commits, static_cast<uint64_t>(num_threads * commits_per_thread));
+        EXPECT_GE(stats.groups, 1u);
+        EXPECT_LE(stats.groups, stats.commits);
+        EXPECT_LE(stats.max_group, static_cast<uint64_t>(num_threads));
+    }
+
+    RocksDBStorage reopened(db_path);
+    for (int t = 0; t < num_threads; ++t) {
+        for (int i = 0; i < commits_per_thread; ++i) {
+            std::string key = std::to_string(t) + "/" + std::to_string(i);
+            EXPECT_TRUE(reopened.getRaw("v:" + key).has_value()) << key;
+            EXPECT_TRUE(reopened.getRaw("m:" + key).has_value()) << key;
+        }
+    }
+}
+
+TEST_F(GroupCommitTest, EmptyRequestCompletesImmediately) {
+    RocksDBStorage storage(db_path);
+    GroupCommitter committer(storage);
+    EXPECT_TRUE(committer.commit({}));
+    EXPECT_EQ(committer.stats().groups, 0u);
+}
@@ -0,0 +1,207 @@
+#include <gtest/gtest.h>
+
+#include "kallisto/engine/head_cache.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace kallisto::engine;
+
+// =============================================================================
+// HEAD CACHE TEST SUITE
+//
+// Problem Description:
+//   KvEngine keeps a decoded head (metadata + latest payload) per path so a
+//   latest-version read is one probe with no parsing. Heads are immutable and
+//   replaced wholesale; a reader holding an old pointer must keep seeing a
+//   consistent object.
+//
+// Coverage:
+//   1. Hits return the published object itself, not a copy
+//   2. Replacing an entry leaves earlier readers' objects intact
+//   3. overwrite = false never replaces a newer entry
+//   4. replaceIf only swaps the head the caller read
+//   5. Capacity is enforced per shard for new paths only; writer
+//      publishes land past it
+//   6. Prefix removal clears matching entries in every shard, and removeIf
+//      only drops the entry the caller inserted
+//   7. Concurrent readers and writers
+// =============================================================================
+
+namespace {
+
+HeadPtr makeHead(uint32_t current_version) {
+    PathHead head;
+    head.meta.current_version = current_version;
+    for (uint32_t v = 1; v <= current_version; ++v) {
+        head.meta.versions.push_back(VersionState{v * 1000, 0, v, false});
+    }
+    head.latest = std::make_shared<const std::string>("value-" + std::to_string(current_version));
+    return std::make_shared<const PathHead>(std::move(head));
+}
+
+} // namespace
+
+TEST(HeadCacheTest, HitReturnsPublishedObject) {
+    HeadCache cache(1024);
+    EXPECT_EQ(cache.lookup("app/db"), nullptr);
+
+    auto head = makeHead(3);
+    ASSERT_TRUE(cache.insert("app/db", head));
+
+    auto hit = cache.lookup(std::string_view("app/db/extra").substr(0, 6));
+    EXPECT_EQ(hit.get(), head.get());
+    EXPECT_EQ(hit->meta.versions.size(), 3u);
+    EXPECT_EQ(*hit->latest, "value-3");
+    EXPECT_EQ(cache.size(), 1u);
+
+    cache.remove("app/db");
+    EXPECT_EQ(cache.lookup("app/db"), nullptr);
+    EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST(HeadCacheTest, ReplacementKeepsReaderSnapshot) {
+    // Problem: A GET holding the old pointer while a PUT publishes version 2
+    // must finish against version 1, not a half-updated object.
+    HeadCache cache(1024);
+    cache.insert("app/db", makeHead(1));
+    auto reader_view = cache.lookup("app/db");
+
+    cache.insert("app/db", makeHead(2));
+    EXPECT_EQ(reader_view->meta.current_version, 1u);
+    EXPECT_EQ(cache.lookup("app/db")->meta.current_version, 2u);
+    EXPECT_EQ(cache.size(), 1u);
+}
+
+TEST(HeadCacheTest, NonOverwritingInsertKeepsNewerEntry) {
+    // Problem: Recovery and cache-miss fills decode records read from disk; a
+    // write published in the meantime is newer and must win.
+    HeadCache cache(1024);
+    cache.insert("app/db", makeHead(5));
+    EXPECT_TRUE(cache.insert("app/db", makeHead(4), false));
+    EXPECT_EQ(cache.lookup("app/db")->meta.current_version, 5u);
+
+    EXPECT_TRUE(cache.insert("app/new", makeHead(1), false));
+    EXPECT_EQ(cache.lookup("app/new")->meta.current_version, 1u);
+}
+
+TEST(HeadCacheTest, ReplaceIfOnlySwapsTheHeadThatWasRead) {
+    // Problem: A GET that fetched the latest payload from disk fills it into
+    // the head it read. If a PUT published a newer head in between, the fill
+    // must be dropped rather than resurrect the older version.
+    HeadCache cache(1024);
+    auto read_head = makeHead(1);
+    cache.insert("app/db", read_head);
+    EXPECT_TRUE(cache.replaceIf("app/db", read_head, makeHead(1)));
+
+    auto stale = cache.lookup("app/db");
+    cache.insert("app/db", makeHead(2));
+    EXPECT_FALSE(cache.replaceIf("app/db", stale, makeHead(1)));
+    EXPECT_EQ(cache.lookup("app/db")->meta.current_version, 2u);
+    EXPECT_FALSE(cache.replaceIf("app/missing", nullptr, makeHead(1)));
+}
+
+TEST(HeadCacheTest, CapacityLimitsNewPathsOnly) {
+    HeadCache cache(HeadCache::num_shards); // One entry per shard
+    size_t accepted = 0;
+    std::string first_accepted;
+    for (int i = 0; i < 1000; ++i) {
+        std::string path = "svc/" + std::to_string(i);
+        if (cache.insert(path, makeHead(1))) {
+            if (accepted++ == 0) {
+                first_accepted = path;
+            }
+        }
+    }
+    EXPECT_LE(accepted, HeadCache::num_shards);
+    EXPECT_EQ(cache.size(), accepted);
+
+    // Updates to cached paths still succeed when the shard is full
+    EXPECT_TRUE(cache.insert(first_accepted, makeHead(2)));
+    EXPECT_EQ(cache.lookup(first_accepted)->meta.current_version, 2u);
+}
+
+TEST(HeadCacheTest, PublishLandsInAFullShard) {
+    // Problem: A write's head dropped for a full shard sent the next write
+    // of the path to RocksDB, before write-behind had flushed the first one:
+    // its version went backwards and a stale CAS passed.
+    HeadCache cache(HeadCache::num_shards);
+    for (int i = 0; i < 1000; ++i) {
+        cache.insert("svc/" + std::to_string(i), makeHead(1));
+    }
+    ASSERT_LE(cache.size(), HeadCache::num_shards);
+
+    const size_t before = cache.size();
+    for (int i = 0; i < 1000; ++i) {
+        cache.publish("svc/" + std::to_string(i), makeHead(2));
+    }
+    EXPECT_EQ(cache.size(), 1000u);
+    EXPECT_GT(cache.size(), before);
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(cache.lookup("svc/" + std::to_string(i))->meta.current_version, 2u) << i;
+    }
+}
+
+TEST(HeadCacheTest, RemovePrefixClearsEveryShard) {
+    // Problem: Destroying apps/<name>/ must drop every cached head under it,
+    // whichever shards they hashed to, and leave the neighbours alone.
+    HeadCache cache(1 << 16);
+    for (int i = 0; i < 500; ++i) {
+        cache.insert("apps/billing/key-" + std::to_string(i), makeHead(1));
+        cache.insert("apps/billing-v2/key-" + std::to_string(i), makeHead(1));
+    }
+    EXPECT_EQ(cache.removePrefix("apps/billing/"), 500u);
+    EXPECT_EQ(cache.size(), 500u);
+    EXPECT_EQ(cache.lookup("apps/billing/key-7"), nullptr);
+    EXPECT_NE(cache.lookup("apps/billing-v2/key-7"), nullptr);
+
+    // A load that raced the removal takes back only its own entry
+    auto loaded = makeHead(1);
+    cache.insert("apps/billing/key-7", loaded, false);
+    auto newer = makeHead(2);
+    cache.insert("apps/billing-v2/key-7", newer);
+    EXPECT_FALSE(cache.removeIf("apps/billing-v2/key-7", loaded));
+    EXPECT_TRUE(cache.removeIf("apps/billing/key-7", loaded));
+    EXPECT_EQ(cache.lookup("apps/billing/key-7"), nullptr);
+    EXPECT_EQ(cache.size(), 500u);
+}
+
+TEST(HeadCacheTest, ConcurrentReadersAndWriters) {
+    HeadCache cache(4096);
+    constexpr int path_count = 64;
+    for (int i = 0; i < path_count; ++i) {
+        cache.insert("p/" + std::to_string(i), makeHead(1));
+    }
+
+    std::atomic<bool> running{true};
+    std::atomic<int> inconsistent{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&]() {
+            while (running.load()) {
+                for (int i = 0; i < path_count; ++i) {
+                    auto head = cache.lookup("p/" + std::to_string(i));
+                    if (!head || head->meta.versions.size() != head->meta.current_version ||
+                        *head->latest != "value-" + std::to_string(head->meta.current_version)) {
+                        inconsistent.fetch_add(1);
+                    }
+                }
+            }
+        });
+    }
+
+    for (uint32_t version = 2; version <= 50; ++version) {
+        for (int i = 0; i < path_count; ++i) {
+            cache.insert("p/" + std::to_string(i), makeHead(version));
+        }
+    }
+    running.store(false);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_EQ(inconsistent.load(), 0);
+    EXPECT_EQ(cache.lookup("p/7")->meta.current_version, 50u);
+}
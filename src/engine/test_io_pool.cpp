@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include "kallisto/engine/io_pool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+using namespace kallisto::engine;
+
+// =============================================================================
+// IO POOL TEST SUITE
+//
+// Problem Description:
+//   Cache-miss reads block on RocksDB. They are moved off the event loops
+//   onto a small pool of I/O threads. Every accepted task must run, a full
+//   queue must refuse work instead of growing, and shutdown must not drop
+//   tasks already accepted (their callers are waiting on a continuation).
+//
+// Coverage:
+//   1. Tasks run off the submitting thread, each exactly once
+//   2. A full queue rejects, and accepts again once drained
+//   3. Destruction runs the tasks still queued
+// =============================================================================
+
+TEST(IoPoolTest, TasksRunOffTheCallerExactlyOnce) {
+    IoPool pool(3, 1024);
+    EXPECT_EQ(pool.threadCount(), 3u);
+
+    constexpr int tasks = 500;
+    std::atomic<int> ran{0};
+    std::atomic<int> on_caller{0};
+    const auto caller = std::this_thread::get_id();
+    for (int i = 0; i < tasks; ++i) {
+        ASSERT_TRUE(pool.submit([&]() {
+            if (std::this_thread::get_id() == caller) {
+                on_caller.fetch_add(1);
+            }
+            ran.fetch_add(1);
+        }));
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (ran.load() < tasks && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(ran.load(), tasks);
+    EXPECT_EQ(on_caller.load(), 0);
+    EXPECT_EQ(pool.stats().submitted, static_cast<uint64_t>(tasks));
+}
+
+TEST(IoPoolTest, FullQueueRejects) {
+    IoPool pool(1, 2);
+    // Problem: hold the only thread so submitted tasks stay queued
+    std::promise<void> release;
+    std::shared_future<void> gate = release.get_future().share();
+    std::promise<void> started;
+    ASSERT_TRUE(pool.submit([&]() {
+        started.set_value();
+        gate.wait();
+    }));
+    started.get_future().wait();
+
+    std::atomic<int> ran{0};
+    EXPECT_TRUE(pool.submit([&]() { ran.fetch_add(1); }));
+    EXPECT_TRUE(pool.submit([&]() { ran.fetch_add(1); }));
+    EXPECT_FALSE(pool.submit([&]() { ran.fetch_add(1); }));
+    auto stats = pool.stats();
+    EXPECT_EQ(stats.pending, 2u);
+    EXPECT_EQ(stats.rejected, 1u);
+
+    release.set_value();
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (ran.load() < 2 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(ran.load(), 2);
+    EXPECT_TRUE(pool.submit([&]() { ran.fetch_add(1); }));
+}
+
+TEST(IoPoolTest, DestructionRunsQueuedTasks) {
+    std::atomic<int> ran{0};
+    {
+        IoPool pool(1, 1024);
+        for (int i = 0; i < 100; ++i) {
+            ASSERT_TRUE(pool.submit([&]() {
+                std::this_thread::sleep_for(std::chrono::microseconds(10));
+                ran.fetch_add(1);
+            }));
+        }
+    }
+    EXPECT_EQ(ran.load(), 100);
+}
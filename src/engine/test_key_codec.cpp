@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include "kallisto/engine/key_codec.hpp"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace kallisto::engine;
+
+// =============================================================================
+// KEY CODEC TEST SUITE
+//
+// Problem Description:
+//   Record keys were text: "v:<path>:<decimal version>". Versions sorted
+//   10 before 9, and a ':' in a path put another path's versions under its
+//   prefix, so neither version scans nor range deletes could trust key
+//   order. Format 2 keys must sort in (path, version) order for any path
+//   bytes, keep every prefix's records contiguous, and decode back exactly.
+//
+// Coverage:
+//   1. Keys round-trip, zero bytes and separators included
+//   2. Byte order is (path, version) order
+//   3. A prefix range holds exactly the paths starting with the prefix
+//   4. Malformed and format 1 keys are told apart
+// =============================================================================
+
+namespace {
+
+const std::vector<std::string> tricky_paths = {
+    "",
+    "a",
+    "a:1",
+    "a/b",
+    std::string("a\0", 2),
+    std::string("a\0\x01", 3),
+    std::string("a\0\xFF", 3),
+    "a\x01",
+    "a\xFF",
+    "b",
+    "\xFF\xFF",
+};
+
+bool startsWith(const std::string& s, const std::string& prefix) {
+    return s.compare(0, prefix.size(), prefix) == 0;
+}
+
+} // namespace
+
+TEST(KeyCodecTest, KeysRoundTrip) {
+    for (const auto& path : tricky_paths) {
+        auto meta = parseMetaKey(buildMetaKey(path));
+        ASSERT_TRUE(meta.has_value());
+        EXPECT_EQ(*meta, path);
+
+        for (uint32_t version : {0u, 1u, 9u, 10u, 256u, 0xFF000000u, UINT32_MAX}) {
+            auto parsed = parseVersionKey(buildVersionKey(path, version));
+            ASSERT_TRUE(parsed.has_value());
+            EXPECT_EQ(parsed->path, path);
+            EXPECT_EQ(parsed->version, version);
+        }
+        // A type byte never decodes as the other
+        EXPECT_FALSE(parseVersionKey(buildMetaKey(path)).has_value());
+        EXPECT_FALSE(parseMetaKey(buildVersionKey(path, 1)).has_value());
+    }
+}
+
+TEST(KeyCodecTest, ByteOrderIsPathThenVersionOrder) {
+    std::vector<std::pair<std::string, uint32_t>> records;
+    for (const auto& path : tricky_paths) {
+        for (uint32_t version : {1u, 2u, 9u, 10u, 100u, 0xFF000000u}) {
+            records.emplace_back(path, version);
+        }
+    }
+    std::vector<std::pair<std::string, std::pair<std::string, uint32_t>>> keyed;
+    for (const auto& record : records) {
+        keyed.emplace_back(buildVersionKey(record.first, record.second), record);
+    }
+    std::sort(records.begin(), records.end());
+    std::sort(keyed.begin(), keyed.end());
+    for (size_t i = 0; i < records.size(); ++i) {
+        EXPECT_EQ(keyed[i].second, records[i]) << i;
+    }
+
+    std::vector<std::string> meta_keys;
+    for (const auto& path : tricky_paths) {
+        meta_keys.push_back(buildMetaKey(path));
+    }
+    auto sorted_paths = tricky_paths;
+    std::sort(sorted_paths.begin(), sorted_paths.end());
+    std::sort(meta_keys.begin(), meta_keys.end());
+    for (size_t i = 0; i < meta_keys.size(); ++i) {
+        EXPECT_EQ(parseMetaKey(meta_keys[i]), sorted_paths[i]);
+    }
+}
+
+TEST(KeyCodecTest, PrefixRangesHoldExactlyTheSubtree) {
+    // Problem: With text keys, "v:a:" also covered the versions of "a" itself.
+    for (const auto& prefix : tricky_paths) {
+        const std::string meta_prefix = metaKeyPrefix(prefix);
+        const std::string version_prefix = versionKeyPrefix(prefix);
+        for (const auto& path : tricky_paths) {
+            const bool under = startsWith(path, prefix);
+            EXPECT_EQ(startsWith(buildMetaKey(path), meta_prefix), under);
+            for (uint32_t version : {1u, 0x01000000u, 0xFF000000u, UINT32_MAX}) {
+                EXPECT_EQ(startsWith(buildVersionKey(path, version), version_prefix), under);
+            }
+        }
+    }
+}
+
+TEST(KeyCodecTest, MalformedAndLegacyKeys) {
+    EXPECT_FALSE(parseMetaKey("").has_value());
+    EXPECT_FALSE(parseMetaKey("m:app/db").has_value());
+    EXPECT_FALSE(parseMetaKey(std::string("\x01" "app", 4)).has_value());          // No terminator
+    EXPECT_FALSE(parseMetaKey(std::string("\x01" "a\0\x02\0\x01", 6)).has_value()); // Bad escape
+    EXPECT_FALSE(parseMetaKey(buildMetaKey("app") + "x").has_value());           // Trailing bytes
+    EXPECT_FALSE(parseVersionKey(buildMetaKey("app") + "ver").has_value());
+    auto truncated = buildVersionKey("app", 7);
+    truncated.pop_back();
+    EXPECT_FALSE(parseVersionKey(truncated).has_value());
+
+    auto legacy = parseLegacyVersionKey("v:svc:db:12");
+    ASSERT_TRUE(legacy.has_value());
+    EXPECT_EQ(legacy->path, "svc:db");
+    EXPECT_EQ(legacy->version, 12u);
+    EXPECT_FALSE(parseLegacyVersionKey("v:svc").has_value());
+    EXPECT_FALSE(parseLegacyVersionKey("v:svc:").has_value());
+    EXPECT_FALSE(parseLegacyVersionKey("v:svc:1x").has_value());
+    EXPECT_FALSE(parseLegacyVersionKey("m:svc:1").has_value());
+}
@@ -5,14 +5,40 @@
  * simulate anomalous conditions like process crashes, I/O errors and race conditions.
  */
 #include <gtest/gtest.h>
+#include "kallisto/engine/key_codec.hpp"
 #include "kallisto/engine/kv_engine.hpp"
+#include "kallisto/engine/metadata_codec.hpp"
+#include "kallisto/engine/read_awaiter.hpp"
+#include "kallisto/rocksdb_storage.hpp"
 #include <filesystem>
 #include <thread>
 #include <vector>
 #include <atomic>
+#include <coroutine>
+#include <future>
 
 using namespace kallisto::engine;
 
+namespace {
+
+// Minimal eager coroutine: enough to drive a co_await in a test
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+Detached readInto(ISecretEngine& engine, std::string path, std::promise<std::pair<ReadResult, std::thread::id>>& out) {
+    ReadResult result = co_await readVersion(engine, path);
+    out.set_value({std::move(result), std::this_thread::get_id()});
+}
+
+} // namespace
+
 class KvEngineTestV2 : public ::testing::Test {
 protected:
     std::string test_db_path = "/tmp/kallisto_kv_test_db_v2";
@@ -140,6 +166,111 @@ TEST_F(KvEngineTestV2, CrashRecoveryAndCacheMiss) {
     EXPECT_EQ(retrieved->value, "crash_proof");
 }
 
+TEST_F(KvEngineTestV2, LatestVersionHeadStaysConsistent) {
+    // Problem Description: Latest-version reads are served from the per-path head
+    // record. It must follow every write, delete and destroy, fill itself lazily
+    // after a restart, and never hide explicit reads of older versions.
+    {
+        auto engine = std::make_unique<KvEngine>(test_db_path);
+        ASSERT_TRUE(engine->put_version("head/db", SecretPayload{"one", 10}).has_value());
+        ASSERT_TRUE(engine->put_version("head/db", SecretPayload{"two", 20}).has_value());
+
+        auto latest = engine->read_version("head/db");
+        ASSERT_TRUE(latest.has_value());
+        EXPECT_EQ(latest->value, "two");
+        EXPECT_EQ(latest->ttl, 20u);
+        EXPECT_EQ(engine->read_version("head/db", 1)->value, "one");
+
+        ASSERT_TRUE(engine->soft_delete("head/db", 2).has_value());
+        EXPECT_EQ(engine->read_version("head/db").error(), EngineError::SoftDeleted);
+        ASSERT_TRUE(engine->put_version("head/db", SecretPayload{"three", 30}).has_value());
+        EXPECT_EQ(engine->read_version("head/db")->value, "three");
+    }
+
+    // Restart: heads come back without payloads and fill on the first latest read
+    auto engine = std::make_unique<KvEngine>(test_db_path);
+    EXPECT_EQ(engine->read_version("head/db")->value, "three");
+    EXPECT_EQ(engine->read_version("head/db")->value, "three");
+    EXPECT_EQ(engine->read_version("head/db", 1)->value, "one");
+
+    ASSERT_TRUE(engine->destroy_version("head/db", 3).has_value());
+    EXPECT_EQ(engine->read_version("head/db").error(), EngineError::Destroyed);
+}
+
+TEST_F(KvEngineTestV2, ParallelRecoveryRebuildsPathIndex) {
+    // Problem Description: Restart must rebuild the path index from the metadata records
+    // only, across several key ranges, and skip paths whose versions were all destroyed.
+    std::vector<std::string> paths;
+    for (const char* root : {"\x01raw", "/abs", "Alpha", "app", "m:lookalike", "zeta", "~tilde", "\xFFhigh"}) {
+        for (int i = 0; i < 20; ++i) {
+            paths.push_back(std::string(root) + "/svc-" + std::to_string(i));
+        }
+    }
+    {
+        auto engine = std::make_unique<KvEngine>(test_db_path);
+        for (const auto& path : paths) {
+            ASSERT_TRUE(engine->put_version(path, SecretPayload{"v", 0}).has_value());
+        }
+        ASSERT_TRUE(engine->destroy_version("app/svc-3", 1).has_value());
+    }
+
+    for (auto index_type : {kallisto::PathIndexType::BTREE, kallisto::PathIndexType::ART}) {
+        auto engine = std::make_unique<KvEngine>(test_db_path, index_type, RecoveryOptions{4, true});
+        for (const auto& path : paths) {
+            EXPECT_EQ(engine->isIndexedPath(path), path != "app/svc-3") << path;
+        }
+        EXPECT_FALSE(engine->isIndexedPath("m:app/svc-1")); // Raw keys never leak into the index
+        EXPECT_FALSE(engine->isIndexedPath("app/svc-1:1"));
+
+        auto read = engine->read_version("zeta/svc-7");
+        ASSERT_TRUE(read.has_value());
+        EXPECT_EQ(read->value, "v");
+    }
+}
+
+TEST_F(KvEngineTestV2, BackgroundRecoveryServesWhileWarming) {
+    // Problem Description: With background recovery the engine must serve reads and
+    // writes before the index is rebuilt, and writes made during warm-up must survive
+    // the bulk load that replaces the index.
+    std::vector<std::string> paths;
+    for (int i = 0; i < 2000; ++i) {
+        paths.push_back("warm/svc-" + std::to_string(i));
+    }
+    {
+        auto engine = std::make_unique<KvEngine>(test_db_path);
+        for (const auto& path : paths) {
+            ASSERT_TRUE(engine->put_version(path, SecretPayload{"v", 0}).has_value());
+        }
+    }
+
+    auto engine = std::make_unique<KvEngine>(test_db_path, kallisto::PathIndexType::BTREE,
+                                             RecoveryOptions{2, true, true});
+    auto read = engine->read_version("warm/svc-1999");
+    ASSERT_TRUE(read.has_value());
+    EXPECT_EQ(read->value, "v");
+    EXPECT_TRUE(engine->isIndexedPath("warm/svc-7"));
+    ASSERT_TRUE(engine->put_version("late/arrival", SecretPayload{"new", 0}).has_value());
+    ASSERT_TRUE(engine->destroy_version("warm/svc-5", 1).has_value());
+    EXPECT_FALSE(engine->isIndexedPath("warm/svc-5"));
+
+    engine->waitUntilReady();
+    auto status = engine->warmupStatus();
+    EXPECT_TRUE(status.ready);
+    EXPECT_DOUBLE_EQ(status.progress(), 1.0);
+    EXPECT_EQ(status.ranges_done, status.ranges_total);
+    EXPECT_GE(engine->recoveryStats().paths, paths.size() - 1);
+
+    EXPECT_TRUE(engine->isIndexedPath("late/arrival"));
+    EXPECT_FALSE(engine->isIndexedPath("warm/svc-5"));
+    EXPECT_TRUE(engine->isIndexedPath("warm/svc-1234"));
+    engine.reset();
+
+    // Shutdown while warming cancels the scan instead of blocking on it
+    auto warming = std::make_unique<KvEngine>(test_db_path, kallisto::PathIndexType::ART,
+                                              RecoveryOptions{1, false, true});
+    warming.reset();
+}
+
 TEST_F(KvEngineTestV2, ReadOnlyIOErrorSimulation) {
     // Problem Description: Simulate I/O write permission error (disk read-only)
     std::string read_only_dir = "/tmp/kallisto_readonly_test_v2";
@@ -196,3 +327,895 @@ TEST_F(KvEngineTestV2, ConcurrencyStressTest) {
     ASSERT_TRUE(meta.has_value());
     EXPECT_EQ(meta->current_version, 1000);
 }
+
+TEST_F(KvEngineTestV2, ConcurrentWritersToOnePathAreLinearizable) {
+    // Problem Description: Writers on different workers hitting the same path must
+    // each get a distinct version, and exactly one of several racing CAS writes
+    // against the same expected version may win.
+    // Every put queues the whole history: 2000 metadata records of up to
+    // 2000 versions must fit one worker's queue even if it never drains
+    WriteBehindOptions write_behind;
+    write_behind.queue_bytes = size_t{64} << 20;
+    auto engine = std::make_unique<KvEngine>(test_db_path, kallisto::PathIndexType::BTREE, RecoveryOptions{},
+                                             MountConfig{}, write_behind);
+    engine->changeSyncMode(ISecretEngine::SyncMode::BATCH);
+    engine->setMaxVersions(0); // Keep the full history to check every version id
+    constexpr int num_threads = 8;
+    constexpr int puts_per_thread = 250;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&, i]() {
+            for (int j = 0; j < puts_per_thread; ++j) {
+                auto res = engine->put_version("shared/db", SecretPayload{std::to_string(i) + ":" + std::to_string(j), 0});
+                EXPECT_TRUE(res.has_value()); // A rejected put, not a lost one
+                EXPECT_TRUE(engine->put_version("private/" + std::to_string(i), SecretPayload{"p", 0}).has_value());
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    auto meta = engine->read_metadata("shared/db");
+    ASSERT_TRUE(meta.has_value());
+    EXPECT_EQ(meta->current_version, static_cast<uint32_t>(num_threads * puts_per_thread));
+    ASSERT_EQ(meta->versions.size(), static_cast<size_t>(num_threads * puts_per_thread));
+    for (size_t v = 0; v < meta->versions.size(); ++v) {
+        EXPECT_EQ(meta->versions[v].version_id, v + 1);
+    }
+    EXPECT_EQ(engine->read_metadata("private/3")->current_version, static_cast<uint32_t>(puts_per_thread));
+
+    // CAS race: everyone expects the same current version, one write may land
+    const uint32_t expected = meta->current_version;
+    std::atomic<int> cas_winners{0};
+    threads.clear();
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&, i]() {
+            if (engine->put_version("shared/db", SecretPayload{"cas-" + std::to_string(i), 0}, expected)) {
+                cas_winners.fetch_add(1);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(cas_winners.load(), 1);
+    EXPECT_EQ(engine->read_metadata("shared/db")->current_version, expected + 1);
+}
+
+TEST_F(KvEngineTestV2, MaxVersionsPrunesOldestVersions) {
+    // Problem Description: History is bounded by the mount's max_versions. Each
+    // write past the limit drops the oldest version from the metadata and
+    // deletes its payload, so RocksDB does not grow with every rotation.
+    {
+        auto engine = std::make_unique<KvEngine>(test_db_path, kallisto::PathIndexType::BTREE, RecoveryOptions{},
+                                                 MountConfig{3});
+        for (int v = 1; v <= 5; ++v) {
+            ASSERT_TRUE(engine->put_version("app/db", SecretPayload{"v" + std::to_string(v), 0}).has_value());
+        }
+
+        auto meta = engine->read_metadata("app/db");
+        ASSERT_TRUE(meta.has_value());
+        EXPECT_EQ(meta->current_version, 5u);
+        ASSERT_EQ(meta->versions.size(), 3u);
+        EXPECT_EQ(meta->versions.front().version_id, 3u);
+        EXPECT_EQ(meta->versions.back().version_id, 5u);
+
+        EXPECT_EQ(engine->read_version("app/db", 1).error(), EngineError::InvalidVersion);
+        EXPECT_EQ(engine->read_version("app/db", 3)->value, "v3");
+        EXPECT_EQ(engine->read_version("app/db")->value, "v5");
+
+        // Per-key override: trims right away, without waiting for a write
+        ASSERT_TRUE(engine->set_max_versions("app/db", 1).has_value());
+        meta = engine->read_metadata("app/db");
+        ASSERT_EQ(meta->versions.size(), 1u);
+        EXPECT_EQ(meta->versions.front().version_id, 5u);
+        EXPECT_EQ(meta->max_versions, 1u);
+        EXPECT_EQ(engine->set_max_versions("missing/key", 1).error(), EngineError::NotFound);
+    }
+
+    // Pruned payloads are gone from disk, kept ones are not
+    kallisto::RocksDBStorage disk(test_db_path);
+    EXPECT_FALSE(disk.getRaw(buildVersionKey("app/db", 1)).has_value());
+    EXPECT_FALSE(disk.getRaw(buildVersionKey("app/db", 4)).has_value());
+    EXPECT_TRUE(disk.getRaw(buildVersionKey("app/db", 5)).has_value());
+}
+
+TEST_F(KvEngineTestV2, CompactionTrimsLegacyHistories) {
+    // Problem Description: Keys written by a build without a history limit (or
+    // before the limit was lowered) stay bloated until rewritten. The
+    // compaction pass finds them on disk and trims them in place.
+    {
+        auto engine = std::make_unique<KvEngine>(test_db_path);
+        engine->setMaxVersions(0);
+        for (int v = 1; v <= 20; ++v) {
+            ASSERT_TRUE(engine->put_version("legacy/key", SecretPayload{"v" + std::to_string(v), 0}).has_value());
+        }
+        ASSERT_EQ(engine->read_metadata("legacy/key")->versions.size(), 20u);
+    }
+
+    auto engine = std::make_unique<KvEngine>(test_db_path);
+    engine->waitUntilReady();
+    // The startup pass may already have run; either way the key ends up trimmed
+    engine->compactVersionHistory();
+    auto meta = engine->read_metadata("legacy/key");
+    ASSERT_TRUE(meta.has_value());
+    ASSERT_EQ(meta->versions.size(), 10u);
+    EXPECT_EQ(meta->versions.front().version_id, 11u);
+    EXPECT_EQ(engine->read_version("legacy/key")->value, "v20");
+    EXPECT_EQ(engine->compactVersionHistory(), 0u);
+    engine.reset();
+
+    kallisto::RocksDBStorage disk(test_db_path);
+    EXPECT_FALSE(disk.getRaw(buildVersionKey("legacy/key", 1)).has_value());
+    EXPECT_TRUE(disk.getRaw(buildVersionKey("legacy/key", 11)).has_value());
+}
+
+TEST_F(KvEngineTestV2, ImmediateWritesAreAtomicAndDurable) {
+    // Problem Description: In IMMEDIATE mode a put's payload and metadata go to
+    // disk as one batch, shared with concurrent writers' batches. Every
+    // acknowledged write must survive a restart with payload and metadata.
+    constexpr int num_threads = 4;
+    constexpr int puts_per_thread = 25;
+    {
+        auto engine = std::make_unique<KvEngine>(test_db_path);
+        ASSERT_EQ(engine->getSyncMode(), ISecretEngine::SyncMode::IMMEDIATE);
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; ++t) {
+            threads.emplace_back([&, t]() {
+                for (int i = 0; i < puts_per_thread; ++i) {
+                    EXPECT_TRUE(engine->put_version("team-" + std::to_string(t) + "/svc",
+                                                    SecretPayload{std::to_string(i), 0}).has_value());
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        // One durable commit per put: payload and metadata never go out separately
+        auto stats = engine->groupCommitStats();
+        EXPECT_EQ(stats.commits, static_cast<uint64_t>(num_threads * puts_per_thread));
+        EXPECT_LE(stats.groups, stats.commits);
+    }
+
+    auto engine = std::make_unique<KvEngine>(test_db_path);
+    for (int t = 0; t < num_threads; ++t) {
+        auto meta = engine->read_metadata("team-" + std::to_string(t) + "/svc");
+        ASSERT_TRUE(meta.has_value());
+        EXPECT_EQ(meta->current_version, static_cast<uint32_t>(puts_per_thread));
+        EXPECT_EQ(engine->read_version("team-" + std::to_string(t) + "/svc")->value,
+                  std::to_string(puts_per_thread - 1));
+    }
+}
+
+TEST_F(KvEngineTestV2, WriteBehindFlusherWakesOnDemand) {
+    // Problem Description: The BATCH-mode worker parks while the queue is
+    // empty instead of polling. A write after an idle period must wake it and
+    // reach RocksDB within the lag target; shutdown must flush what is left.
+    constexpr int puts = 200;
+    {
+        auto engine = std::make_unique<KvEngine>(test_db_path);
+        engine->changeSyncMode(ISecretEngine::SyncMode::BATCH);
+        engine->setFlushPolicy(FlushPolicy{std::chrono::milliseconds(2), 256});
+
+        // Let the worker park, then write
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        EXPECT_EQ(engine->flushStats().flushes, 0u);
+        ASSERT_TRUE(engine->put_version("idle/wake", SecretPayload{"first", 0}).has_value());
+
+        // One record: the put's payload and metadata together
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (engine->flushStats().records < 1 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        auto stats = engine->flushStats();
+        ASSERT_EQ(stats.records, 1u);
+        EXPECT_GE(stats.flushes, 1u);
+
+        for (int i = 0; i < puts; ++i) {
+            ASSERT_TRUE(engine->put_version("burst/" + std::to_string(i), SecretPayload{"v", 0}).has_value());
+        }
+        stats = engine->flushStats();
+        EXPECT_LE(stats.batch_size_max, 256u);
+    }
+
+    auto engine = std::make_unique<KvEngine>(test_db_path);
+    EXPECT_EQ(engine->read_version("idle/wake")->value, "first");
+    for (int i = 0; i < puts; ++i) {
+        EXPECT_TRUE(engine->read_version("burst/" + std::to_string(i)).has_value()) << i;
+    }
+}
+
+TEST_F(KvEngineTestV2, WriteBehindWorkersPreservePerKeyOrder) {
+    // Problem Description: BATCH-mode records are spread over several
+    // write-behind workers flushing concurrently. All records of one path go
+    // to the same worker, so the last metadata written for a path is the
+    // one on disk after a restart, and every version it lists has a payload.
+    constexpr int num_threads = 4;
+    constexpr int paths_per_thread = 50;
+    constexpr int versions = 5;
+    {
+        WriteBehindOptions write_behind;
+        write_behind.workers = 3;
+        auto engine = std::make_unique<KvEngine>(test_db_path, kallisto::PathIndexType::BTREE, RecoveryOptions{},
+                                                 MountConfig{}, write_behind);
+        ASSERT_EQ(engine->writeWorkerCount(), 3u);
+        engine->changeSyncMode(ISecretEngine::SyncMode::BATCH);
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; ++t) {
+            threads.emplace_back([&, t]() {
+                for (int v = 1; v <= versions; ++v) {
+                    for (int i = 0; i < paths_per_thread; ++i) {
+                        std::string path = "w" + std::to_string(t) + "/p" + std::to_string(i);
+                        EXPECT_TRUE(engine->put_version(path, SecretPayload{"v" + std::to_string(v), 0}).has_value());
+                    }
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+
+    auto engine = std::make_unique<KvEngine>(test_db_path);
+    for (int t = 0; t < num_threads; ++t) {
+        for (int i = 0; i < paths_per_thread; ++i) {
+            std::string path = "w" + std::to_string(t) + "/p" + std::to_string(i);
+            auto meta = engine->read_metadata(path);
+            ASSERT_TRUE(meta.has_value()) << path;
+            EXPECT_EQ(meta->current_version, static_cast<uint32_t>(versions)) << path;
+            EXPECT_EQ(engine->read_version(path)->value, "v" + std::to_string(versions)) << path;
+            EXPECT_EQ(engine->read_version(path, 1)->value, "v1") << path;
+        }
+    }
+}
+
+TEST_F(KvEngineTestV2, DurableWriteTicketsSettleAfterTheirFlush) {
+    // Problem Description: A BATCH-mode write can ask to be acknowledged only
+    // once it is on disk. Its ticket (worker, sequence) must not be reported
+    // durable before the flush carrying it, must be once that flush is done,
+    // and tickets settled earlier must answer right away. IMMEDIATE writes
+    // are durable on return.
+    WriteBehindOptions write_behind;
+    write_behind.workers = 2;
+    auto engine = std::make_unique<KvEngine>(test_db_path, kallisto::PathIndexType::BTREE, RecoveryOptions{},
+                                             MountConfig{}, write_behind);
+
+    auto immediate = engine->put_version_durable("durable/immediate", SecretPayload{"v", 0});
+    ASSERT_TRUE(immediate.has_value());
+    EXPECT_EQ(immediate->sequence, 0u);
+
+    engine->changeSyncMode(ISecretEngine::SyncMode::BATCH);
+    // Problem: a window long enough that the flush cannot beat the checks below
+    engine->setFlushPolicy(FlushPolicy{std::chrono::milliseconds(200), 4096});
+    std::vector<WriteTicket> tickets;
+    for (int i = 0; i < 20; ++i) {
+        auto ticket = engine->put_version_durable("durable/" + std::to_string(i), SecretPayload{"v", 0});
+        ASSERT_TRUE(ticket.has_value());
+        EXPECT_GT(ticket->sequence, 0u);
+        EXPECT_LT(ticket->stream, 2u);
+        tickets.push_back(*ticket);
+    }
+    // Sequences increase within a worker
+    for (size_t i = 1; i < tickets.size(); ++i) {
+        for (size_t j = 0; j < i; ++j) {
+            if (tickets[j].stream == tickets[i].stream) {
+                EXPECT_LT(tickets[j].sequence, tickets[i].sequence);
+            }
+        }
+    }
+
+    std::atomic<int> durable{0};
+    std::atomic<int> failed{0};
+    for (const auto& ticket : tickets) {
+        engine->whenDurable(ticket, [&](bool ok) { (ok ? durable : failed).fetch_add(1); });
+    }
+    EXPECT_LT(durable.load(), static_cast<int>(tickets.size()));
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (durable.load() < static_cast<int>(tickets.size()) && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(durable.load(), static_cast<int>(tickets.size()));
+    EXPECT_EQ(failed.load(), 0);
+
+    // Already settled: called on the spot
+    bool settled = false;
+    engine->whenDurable(tickets.front(), [&](bool ok) { settled = ok; });
+    EXPECT_TRUE(settled);
+}
+
+TEST_F(KvEngineTestV2, AsyncReadServesMissesOffTheCaller) {
+    // Problem Description: A cache miss must not run RocksDB reads on the
+    // caller's thread (an event loop). read_version_async answers hits in
+    // place and hands misses to the read I/O threads, which call back with
+    // the result; the co_await adapter resumes on that thread only for misses.
+    {
+        auto engine = std::make_unique<KvEngine>(test_db_path);
+        ASSERT_TRUE(engine->put_version("async/db", SecretPayload{"v1", 0}).has_value());
+        ASSERT_TRUE(engine->put_version("async/db", SecretPayload{"v2", 0}).has_value());
+    }
+
+    auto engine = std::make_unique<KvEngine>(test_db_path, kallisto::PathIndexType::BTREE, RecoveryOptions{},
+                                             MountConfig{}, WriteBehindOptions{}, ReadIoOptions{2, 1024});
+    const auto caller = std::this_thread::get_id();
+
+    // Cold: parked on an I/O thread
+    std::promise<std::pair<ReadResult, std::thread::id>> cold;
+    auto cached = engine->read_version_async("async/db", 1, [&](ReadResult result) {
+        cold.set_value({std::move(result), std::this_thread::get_id()});
+    });
+    EXPECT_FALSE(cached.has_value());
+    auto [cold_result, cold_thread] = cold.get_future().get();
+    ASSERT_TRUE(cold_result.has_value());
+    EXPECT_EQ(cold_result->value, "v1");
+    EXPECT_NE(cold_thread, caller);
+    EXPECT_EQ(engine->readIoStats().submitted, 1u);
+
+    // Warm now: answered in place, the callback is never called
+    cached = engine->read_version_async("async/db", 1, [](ReadResult) { FAIL() << "hit went async"; });
+    ASSERT_TRUE(cached.has_value());
+    ASSERT_TRUE(cached->has_value());
+    EXPECT_EQ((*cached)->value, "v1");
+
+    // Errors resolved from a cached head stay synchronous too
+    cached = engine->read_version_async("async/db", 9, [](ReadResult) { FAIL() << "error went async"; });
+    ASSERT_TRUE(cached.has_value());
+    EXPECT_EQ(cached->error(), EngineError::InvalidVersion);
+
+    // co_await: the latest payload is not cached yet, so this one suspends
+    std::promise<std::pair<ReadResult, std::thread::id>> awaited;
+    readInto(*engine, "async/db", awaited);
+    auto [latest, latest_thread] = awaited.get_future().get();
+    ASSERT_TRUE(latest.has_value());
+    EXPECT_EQ(latest->value, "v2");
+    EXPECT_NE(latest_thread, caller);
+
+    // ... and this one completes without suspending
+    std::promise<std::pair<ReadResult, std::thread::id>> hit;
+    readInto(*engine, "async/db", hit);
+    auto [again, again_thread] = hit.get_future().get();
+    EXPECT_EQ(again->value, "v2");
+    EXPECT_EQ(again_thread, caller);
+    EXPECT_EQ(engine->readIoStats().submitted, 2u);
+}
+
+TEST_F(KvEngineTestV2, ConcurrentMissesShareOneLoad) {
+    // Problem Description: A hot key read cold by many callers at once cost
+    // one RocksDB read (and one queued I/O task) per caller. Misses on the
+    // same key now attach to the load already in flight.
+    {
+        auto engine = std::make_unique<KvEngine>(test_db_path);
+        ASSERT_TRUE(engine->put_version("herd/blocker", SecretPayload{"b", 0}).has_value());
+        ASSERT_TRUE(engine->put_version("herd/hot", SecretPayload{"hot", 0}).has_value());
+    }
+
+    auto engine = std::make_unique<KvEngine>(test_db_path, kallisto::PathIndexType::BTREE, RecoveryOptions{},
+                                             MountConfig{}, WriteBehindOptions{}, ReadIoOptions{1, 1024});
+
+    // Hold the only I/O thread inside a callback so the herd queues up behind it
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::promise<void> blocked;
+    ASSERT_FALSE(engine->read_version_async("herd/blocker", 0, [&](ReadResult) {
+        blocked.set_value();
+        released.wait();
+    }).has_value());
+    blocked.get_future().wait();
+
+    constexpr int herd = 10;
+    const uint64_t reads_before = engine->storageReads();
+    std::atomic<int> served{0};
+    std::promise<void> all_served;
+    for (int i = 0; i < herd; ++i) {
+        ASSERT_FALSE(engine->read_version_async("herd/hot", 0, [&](ReadResult result) {
+            EXPECT_TRUE(result.has_value());
+            EXPECT_EQ(result->value, "hot");
+            if (served.fetch_add(1) + 1 == herd) {
+                all_served.set_value();
+            }
+        }).has_value());
+    }
+    // One queued task for the whole herd
+    EXPECT_EQ(engine->readIoStats().submitted, 2u);
+
+    release.set_value();
+    all_served.get_future().wait();
+    // Metadata and payload: one point read each
+    EXPECT_EQ(engine->storageReads() - reads_before, 2u);
+    EXPECT_GE(engine->missLoadStats().shared, herd - 1u);
+
+    // Blocking readers go through the same tables: no RocksDB read outside a load
+    engine.reset();
+    engine = std::make_unique<KvEngine>(test_db_path);
+    const uint64_t sync_before = engine->storageReads();
+    std::vector<std::thread> readers;
+    for (int i = 0; i < herd; ++i) {
+        readers.emplace_back([&]() {
+            auto result = engine->read_version("herd/hot");
+            ASSERT_TRUE(result.has_value());
+            EXPECT_EQ(result->value, "hot");
+        });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    const auto stats = engine->missLoadStats();
+    EXPECT_GE(stats.loads, 2u);
+    EXPECT_LE(engine->storageReads() - sync_before, stats.loads);
+}
+
+TEST_F(KvEngineTestV2, PutManyAndReadManyBatchTheWork) {
+    // Problem Description: Seeding 500 secrets or loading a service's 40 at
+    // boot paid the per-call costs each time. put_many queues one record per
+    // write-behind worker and chunk of items; read_many looks the heads up shard by shard and
+    // reads all cold paths with one MultiGet for metadata, one for payloads.
+    constexpr size_t count = 500;
+    std::vector<PathPayload> items;
+    for (size_t i = 0; i < count; ++i) {
+        items.emplace_back("seed/key-" + std::to_string(i), SecretPayload{"v" + std::to_string(i), 60});
+    }
+    // A path listed twice gets two versions, in order
+    items.emplace_back("seed/key-0", SecretPayload{"v0-bis", 60});
+    {
+        auto engine = std::make_unique<KvEngine>(test_db_path);
+        engine->changeSyncMode(ISecretEngine::SyncMode::BATCH);
+        const uint64_t records_before = engine->flushStats().records;
+        auto results = engine->put_many(items);
+        ASSERT_EQ(results.size(), items.size());
+        for (const auto& result : results) {
+            EXPECT_TRUE(result.has_value());
+        }
+        engine->forceFlush();
+        // One record per worker and chunk of items, not one per item
+        const size_t chunks = (items.size() + KvEngine::put_many_chunk - 1) / KvEngine::put_many_chunk;
+        EXPECT_LE(engine->flushStats().records - records_before, chunks * engine->writeWorkerCount());
+
+        auto meta = engine->read_metadata("seed/key-0");
+        ASSERT_TRUE(meta.has_value());
+        EXPECT_EQ(meta->current_version, 2u);
+        EXPECT_EQ(engine->read_version("seed/key-0", 1)->value, "v0");
+    }
+
+    auto engine = std::make_unique<KvEngine>(test_db_path);
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < count; i += 10) {
+        paths.push_back("seed/key-" + std::to_string(i));
+    }
+    paths.push_back("seed/missing");
+    const uint64_t reads_before = engine->storageReads();
+    auto results = engine->read_many(paths);
+    ASSERT_EQ(results.size(), paths.size());
+    EXPECT_EQ(results[0]->value, "v0-bis");
+    for (size_t i = 1; i + 1 < paths.size(); ++i) {
+        ASSERT_TRUE(results[i].has_value()) << paths[i];
+        EXPECT_EQ(results[i]->value, "v" + std::to_string(i * 10));
+    }
+    EXPECT_EQ(results.back().error(), EngineError::NotFound);
+    // Two MultiGets: every metadata key, then every payload key but the missing path's
+    EXPECT_EQ(engine->storageReads() - reads_before, 2 * paths.size() - 1);
+
+    // Warm now, and the tombstone answers the missing path: no disk at all
+    auto cached = engine->read_many_async(paths, [](std::vector<ReadResult>) { FAIL() << "warm batch went async"; });
+    ASSERT_TRUE(cached.has_value());
+    EXPECT_EQ((*cached)[1]->value, "v10");
+    EXPECT_EQ(cached->back().error(), EngineError::NotFound);
+    EXPECT_EQ(engine->storageReads() - reads_before, 2 * paths.size() - 1);
+
+    // IMMEDIATE: the whole set in one group commit
+    engine->changeSyncMode(ISecretEngine::SyncMode::IMMEDIATE);
+    const uint64_t writes_before = engine->groupCommitStats().commits;
+    auto written = engine->put_many(std::span<const PathPayload>(items.data(), 10));
+    for (const auto& result : written) {
+        EXPECT_TRUE(result.has_value());
+    }
+    EXPECT_EQ(engine->groupCommitStats().commits - writes_before, 1u);
+    EXPECT_EQ(engine->read_version("seed/key-3")->value, "v3");
+    EXPECT_EQ(engine->read_metadata("seed/key-3")->current_version, 2u);
+}
+
+TEST_F(KvEngineTestV2, TransactionsCommitAllOrNothing) {
+    // Problem Description: Rotating a credential pair, or moving a secret,
+    // took several writes: a crash or a concurrent writer in between left
+    // half of it. transact checks every condition under all the paths' locks
+    // and commits the writes as one WriteBatch. In BATCH mode writes queued
+    // before it must not reach RocksDB after it and undo it.
+    {
+        auto engine = std::make_unique<KvEngine>(test_db_path);
+        engine->changeSyncMode(ISecretEngine::SyncMode::BATCH);
+        ASSERT_TRUE(engine->put_version("acct/user", {"alice", 60}).has_value());
+        ASSERT_TRUE(engine->put_version("acct/pass", {"old-pass", 60}).has_value());
+        ASSERT_TRUE(engine->put_version("acct/legacy", {"gone-soon", 60}).has_value());
+
+        // A stale condition aborts everything, including the steps before it
+        std::vector<TxnOp> stale{
+            {TxnOp::Type::PUT, "acct/user", {"bob", 60}, 1},
+            {TxnOp::Type::PUT, "acct/pass", {"new-pass", 60}, 7},
+        };
+        auto aborted = engine->transact(stale);
+        ASSERT_FALSE(aborted.has_value());
+        EXPECT_EQ(aborted.error().op, 1u);
+        EXPECT_EQ(aborted.error().error, EngineError::CasMismatch);
+        EXPECT_EQ(engine->read_version("acct/user")->value, "alice");
+        EXPECT_EQ(engine->read_metadata("acct/user")->current_version, 1u);
+        EXPECT_FALSE(engine->read_version("acct/user", 2).has_value());
+
+        std::vector<TxnOp> missing{
+            {TxnOp::Type::PUT, "acct/user", {"bob", 60}, std::nullopt},
+            {TxnOp::Type::DELETE, "acct/nobody", {}, std::nullopt},
+        };
+        aborted = engine->transact(missing);
+        ASSERT_FALSE(aborted.has_value());
+        EXPECT_EQ(aborted.error().op, 1u);
+        EXPECT_EQ(aborted.error().error, EngineError::NotFound);
+        EXPECT_EQ(engine->read_version("acct/user")->value, "alice");
+
+        std::vector<TxnOp> rotate{
+            {TxnOp::Type::CHECK, "acct/user", {}, 1},
+            {TxnOp::Type::PUT, "acct/pass", {"new-pass", 60}, 1},
+            {TxnOp::Type::PUT, "acct/token", {"t-1", 60}, 0},
+            {TxnOp::Type::DELETE, "acct/legacy", {}, std::nullopt},
+        };
+        ASSERT_TRUE(engine->transact(rotate).has_value());
+        EXPECT_EQ(engine->read_version("acct/pass")->value, "new-pass");
+        EXPECT_EQ(engine->read_version("acct/token")->value, "t-1");
+        EXPECT_EQ(engine->read_version("acct/legacy").error(), EngineError::Destroyed);
+        EXPECT_FALSE(engine->isIndexedPath("acct/legacy"));
+    }
+
+    // On disk as committed: the queued first versions were written before
+    // the transaction, not on top of it at shutdown
+    auto engine = std::make_unique<KvEngine>(test_db_path);
+    EXPECT_EQ(engine->read_version("acct/user")->value, "alice");
+    EXPECT_EQ(engine->read_version("acct/pass")->value, "new-pass");
+    EXPECT_EQ(engine->read_metadata("acct/pass")->current_version, 2u);
+    EXPECT_EQ(engine->read_version("acct/pass", 1)->value, "old-pass");
+    EXPECT_EQ(engine->read_version("acct/token")->value, "t-1");
+    EXPECT_EQ(engine->read_version("acct/legacy").error(), EngineError::Destroyed);
+}
+
+TEST_F(KvEngineTestV2, ReadManyNeverSeesPartOfATransaction) {
+    // Problem Description: transact published its heads one by one, so a
+    // read_many of a credential pair could return the new user with the old
+    // password. Readers of several paths must see a transaction whole.
+    auto engine = std::make_unique<KvEngine>(test_db_path);
+    ASSERT_TRUE(engine->put_version("pair/user", {"0", 60}).has_value());
+    ASSERT_TRUE(engine->put_version("pair/pass", {"0", 60}).has_value());
+
+    constexpr int rounds = 300;
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+    std::atomic<int> reads{0};
+    std::vector<std::thread> readers;
+    const std::vector<std::string> pair{"pair/user", "pair/pass"};
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([&, t]() {
+            while (!done.load()) {
+                std::vector<ReadResult> results;
+                if (t == 0) {
+                    results = engine->read_many(pair);
+                } else {
+                    std::promise<std::vector<ReadResult>> later;
+                    auto cached = engine->read_many_async(pair, [&](std::vector<ReadResult> r) { later.set_value(std::move(r)); });
+                    results = cached ? std::move(*cached) : later.get_future().get();
+                }
+                if (!results[0] || !results[1] || results[0]->value != results[1]->value) {
+                    torn.fetch_add(1);
+                }
+                reads.fetch_add(1);
+            }
+        });
+    }
+    for (int i = 1; i <= rounds; ++i) {
+        std::vector<TxnOp> rotate{
+            {TxnOp::Type::PUT, "pair/user", {std::to_string(i), 60}, std::nullopt},
+            {TxnOp::Type::PUT, "pair/pass", {std::to_string(i), 60}, std::nullopt},
+        };
+        ASSERT_TRUE(engine->transact(rotate).has_value());
+    }
+    done.store(true);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(torn.load(), 0) << "of " << reads.load() << " reads";
+    EXPECT_GT(reads.load(), 0);
+}
+
+TEST_F(KvEngineTestV2, DestroyPrefixRemovesEveryPathUnderIt) {
+    // Problem Description: Decommissioning an application took one DELETE
+    // per secret, each a metadata read-modify-write plus deletes. destroyPrefix
+    // writes two range tombstones, clears the caches and the index in bulk,
+    // and must not let queued or cached state bring a path back.
+    constexpr int count = 200;
+    {
+        auto engine = std::make_unique<KvEngine>(test_db_path);
+        engine->changeSyncMode(ISecretEngine::SyncMode::BATCH);
+        for (int i = 0; i < count; ++i) {
+            const std::string path = "apps/billing/key-" + std::to_string(i);
+            ASSERT_TRUE(engine->put_version(path, {"v1", 60}).has_value());
+            ASSERT_TRUE(engine->put_version(path, {"v2", 60}).has_value());
+        }
+        ASSERT_TRUE(engine->put_version("apps/billing-v2/key-0", {"keep", 60}).has_value());
+        ASSERT_TRUE(engine->destroy_version("apps/billing/key-0", 2).has_value());
+
+        auto destroyed = engine->destroyPrefix("apps/billing/");
+        ASSERT_TRUE(destroyed.has_value());
+        EXPECT_EQ(*destroyed, static_cast<size_t>(count));
+
+        EXPECT_EQ(engine->read_version("apps/billing/key-7").error(), EngineError::NotFound);
+        EXPECT_EQ(engine->read_version("apps/billing/key-7", 1).error(), EngineError::NotFound);
+        EXPECT_EQ(engine->read_metadata("apps/billing/key-0").error(), EngineError::NotFound);
+        EXPECT_FALSE(engine->isIndexedPath("apps/billing/key-7"));
+        EXPECT_EQ(engine->read_version("apps/billing-v2/key-0")->value, "keep");
+        EXPECT_TRUE(engine->isIndexedPath("apps/billing-v2/key-0"));
+
+        // A path written again starts over at version 1
+        ASSERT_TRUE(engine->put_version("apps/billing/key-7", {"reborn", 60}).has_value());
+        EXPECT_EQ(engine->read_metadata("apps/billing/key-7")->current_version, 1u);
+    }
+
+    // Nothing queued before the destroy was written after it
+    auto engine = std::make_unique<KvEngine>(test_db_path);
+    EXPECT_EQ(engine->read_version("apps/billing/key-7")->value, "reborn");
+    EXPECT_EQ(engine->read_version("apps/billing/key-7", 2).error(), EngineError::InvalidVersion);
+    EXPECT_EQ(engine->read_version("apps/billing/key-8").error(), EngineError::NotFound);
+    EXPECT_EQ(engine->read_version("apps/billing-v2/key-0")->value, "keep");
+    EXPECT_EQ(engine->recoveryStats().paths, 2u);
+}
+
+TEST_F(KvEngineTestV2, DestroyPrefixStopsAtTheDirectory) {
+    // Problem: Paths are matched by bytes, so destroying apps/old also took
+    // apps/older. A prefix names a directory: only paths under apps/old/ go.
+    auto engine = std::make_unique<KvEngine>(test_db_path);
+    ASSERT_TRUE(engine->put_version("apps/old/user", {"a", 60}).has_value());
+    ASSERT_TRUE(engine->put_version("apps/old/db/pass", {"b", 60}).has_value());
+    ASSERT_TRUE(engine->put_version("apps/older/user", {"keep", 60}).has_value());
+    ASSERT_TRUE(engine->put_version("apps/old-v2/user", {"keep", 60}).has_value());
+
+    auto destroyed = engine->destroyPrefix("apps/old");
+    ASSERT_TRUE(destroyed.has_value());
+    EXPECT_EQ(*destroyed, 2u);
+    EXPECT_EQ(engine->read_version("apps/old/db/pass").error(), EngineError::NotFound);
+    EXPECT_EQ(engine->read_version("apps/older/user")->value, "keep");
+    EXPECT_EQ(engine->read_version("apps/old-v2/user")->value, "keep");
+    EXPECT_TRUE(engine->isIndexedPath("apps/older/user"));
+
+    // No prefix is not "everything": every caller reaches the engine unchecked
+    EXPECT_EQ(engine->destroyPrefix("").error(), EngineError::InvalidVersion);
+    EXPECT_EQ(engine->read_version("apps/older/user")->value, "keep");
+
+    // The async form runs the same destroy on the write pool
+    ASSERT_TRUE(engine->put_version("apps/older/pass", {"c", 60}).has_value());
+    std::promise<KvEngine::DestroyResult> settled;
+    auto in_place = engine->destroyPrefixAsync("apps/older", [&](KvEngine::DestroyResult result) {
+        settled.set_value(std::move(result));
+    });
+    ASSERT_FALSE(in_place.has_value());
+    auto async_destroyed = settled.get_future().get();
+    ASSERT_TRUE(async_destroyed.has_value());
+    EXPECT_EQ(*async_destroyed, 2u);
+    EXPECT_EQ(engine->read_version("apps/old-v2/user")->value, "keep");
+}
+
+TEST_F(KvEngineTestV2, MissingPathsAreAnsweredFromMemoryUntilWritten) {
+    // Problem Description: A client retrying a missing path in a loop cost
+    // one RocksDB Get per request. The first NotFound is remembered for the
+    // negative TTL; the put that creates the path makes it visible at once.
+    ReadIoOptions read_io;
+    read_io.negative_ttl = std::chrono::seconds(60);
+    auto engine = std::make_unique<KvEngine>(test_db_path, kallisto::PathIndexType::BTREE, RecoveryOptions{},
+                                             MountConfig{}, WriteBehindOptions{}, read_io);
+
+    EXPECT_EQ(engine->read_version("ghost/db").error(), EngineError::NotFound);
+    const uint64_t reads = engine->storageReads();
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(engine->read_version("ghost/db").error(), EngineError::NotFound);
+        EXPECT_EQ(engine->read_metadata("ghost/db").error(), EngineError::NotFound);
+    }
+    EXPECT_EQ(engine->storageReads(), reads);
+    EXPECT_EQ(engine->negativeCacheStats().hits, 200u);
+
+    // The async path answers a tombstone in place, without an I/O task
+    auto cached = engine->read_version_async("ghost/db", 0, [](ReadResult) { FAIL() << "tombstone went async"; });
+    ASSERT_TRUE(cached.has_value());
+    EXPECT_EQ(cached->error(), EngineError::NotFound);
+    EXPECT_EQ(engine->readIoStats().submitted, 0u);
+
+    ASSERT_TRUE(engine->put_version("ghost/db", SecretPayload{"alive", 0}).has_value());
+    auto read = engine->read_version("ghost/db");
+    ASSERT_TRUE(read.has_value());
+    EXPECT_EQ(read->value, "alive");
+    EXPECT_EQ(engine->negativeCacheStats().invalidations, 1u);
+
+    // Disabled: every miss goes to RocksDB
+    engine.reset();
+    read_io.negative_ttl = std::chrono::milliseconds(0);
+    engine = std::make_unique<KvEngine>(test_db_path, kallisto::PathIndexType::BTREE, RecoveryOptions{},
+                                        MountConfig{}, WriteBehindOptions{}, read_io);
+    const uint64_t before = engine->storageReads();
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(engine->read_version("ghost/other").error(), EngineError::NotFound);
+    }
+    EXPECT_EQ(engine->storageReads() - before, 10u);
+}
+
+TEST_F(KvEngineTestV2, LegacyKeyFormatIsMigratedOnOpen) {
+    // Problem Description: Format 1 keys were text ("m:<path>",
+    // "v:<path>:<decimal>"): versions sorted 10 before 9 and a ':' in a path
+    // made another path's versions fall under its prefix. A format 1
+    // database must be rewritten to format 2 on open, once, with nothing lost.
+    const std::vector<std::string> paths = {"cfg", "cfg:/1", "db/main", std::string("nul\0byte", 8)};
+    {
+        auto engine = std::make_unique<KvEngine>(test_db_path);
+        engine->setMaxVersions(0);
+        for (const auto& path : paths) {
+            for (int v = 1; v <= 12; ++v) {
+                ASSERT_TRUE(engine->put_version(path, SecretPayload{path + "#" + std::to_string(v), 0}).has_value());
+            }
+        }
+    }
+    {
+        // Turn the store back into format 1
+        kallisto::RocksDBStorage disk(test_db_path);
+        for (const auto& path : paths) {
+            auto meta = disk.getRaw(buildMetaKey(path));
+            ASSERT_TRUE(meta.has_value());
+            ASSERT_TRUE(disk.putRaw("m:" + path, *meta));
+            ASSERT_TRUE(disk.delRaw(buildMetaKey(path)));
+            for (uint32_t v = 1; v <= 12; ++v) {
+                auto payload = disk.getRaw(buildVersionKey(path, v));
+                ASSERT_TRUE(payload.has_value());
+                ASSERT_TRUE(disk.putRaw("v:" + path + ":" + std::to_string(v), *payload));
+                ASSERT_TRUE(disk.delRaw(buildVersionKey(path, v)));
+            }
+        }
+        // No version after the last ':': nothing to migrate it to
+        ASSERT_TRUE(disk.putRaw("v:orphan", "x"));
+        ASSERT_TRUE(disk.delRaw(std::string(key_format_key)));
+    }
+
+    auto engine = std::make_unique<KvEngine>(test_db_path);
+    engine->setMaxVersions(0);
+    engine->waitUntilReady();
+    EXPECT_EQ(engine->recoveryStats().paths, paths.size());
+    for (const auto& path : paths) {
+        EXPECT_TRUE(engine->isIndexedPath(path));
+        EXPECT_EQ(engine->read_metadata(path)->current_version, 12u);
+        EXPECT_EQ(engine->read_version(path, 9)->value, path + "#9");
+        EXPECT_EQ(engine->read_version(path)->value, path + "#12");
+    }
+
+    // A ':' in the prefix no longer reaches the versions of "cfg"
+    EXPECT_EQ(engine->destroyPrefix("cfg:").value(), 1u);
+    EXPECT_EQ(engine->read_version("cfg", 10)->value, "cfg#10");
+    EXPECT_EQ(engine->read_version("cfg:/1").error(), EngineError::NotFound);
+    engine.reset();
+
+    kallisto::RocksDBStorage disk(test_db_path);
+    EXPECT_FALSE(disk.getRaw("m:db/main").has_value());
+    EXPECT_FALSE(disk.getRaw("v:db/main:3").has_value());
+    EXPECT_TRUE(disk.getRaw(buildVersionKey("db/main", 3)).has_value());
+    EXPECT_EQ(disk.getRaw("v:orphan"), "x");
+    EXPECT_EQ(disk.getRaw(std::string(key_format_key)), std::string(1, static_cast<char>(key_format_version)));
+}
+
+TEST_F(KvEngineTestV2, WritesToAnUnreadablePathLeaveItsHistory) {
+    // Problem: A write treated any failure to load the path's head as a new
+    // path. A corrupt metadata record restarted the path at version 1 and
+    // its history was overwritten. Only NotFound means a new path.
+    {
+        kallisto::RocksDBStorage disk(test_db_path);
+        ASSERT_TRUE(disk.putRaw(buildMetaKey("db/torn"), "not metadata"));
+    }
+    auto engine = std::make_unique<KvEngine>(test_db_path);
+    EXPECT_EQ(engine->put_version("db/torn", {"v", 60}).error(), EngineError::StorageError);
+
+    const std::vector<PathPayload> items = {{"db/torn", {"v", 60}}, {"db/fresh", {"v", 60}}};
+    auto results = engine->put_many(items);
+    ASSERT_EQ(results.size(), 2u);
+    ASSERT_FALSE(results[0].has_value());
+    EXPECT_EQ(results[0].error(), EngineError::StorageError);
+    EXPECT_TRUE(results[1].has_value());
+    EXPECT_EQ(engine->read_version("db/fresh")->value, "v");
+    engine.reset();
+
+    kallisto::RocksDBStorage disk(test_db_path);
+    EXPECT_EQ(disk.getRaw(buildMetaKey("db/torn")), "not metadata");
+    EXPECT_FALSE(disk.getRaw(buildVersionKey("db/torn", 1)).has_value());
+}
+
+TEST_F(KvEngineTestV2, FailedConstructionStartsNoThread) {
+    // Problem: A write-behind worker that failed to build (no eventfd, an
+    // oversized queue) threw after the background recovery thread had
+    // started, and destroying that std::thread called std::terminate.
+    RecoveryOptions recovery;
+    recovery.background = true;
+    WriteBehindOptions write_behind;
+    write_behind.queue_bytes = size_t{1} << 30;
+    EXPECT_THROW(KvEngine(test_db_path, kallisto::PathIndexType::ART, recovery, MountConfig{}, write_behind), std::length_error);
+
+    // The database is closed and opens again
+    auto engine = std::make_unique<KvEngine>(test_db_path);
+    EXPECT_TRUE(engine->put_version("db/after", {"v", 60}).has_value());
+}
+
+TEST_F(KvEngineTestV2, NewerKeyFormatIsRefused) {
+    // Problem: A database written by a newer build was taken as current, and
+    // its keys read as missing paths. Opening it must fail, leaving it as is.
+    {
+        kallisto::RocksDBStorage disk(test_db_path);
+        ASSERT_TRUE(disk.putRaw(std::string(key_format_key), std::string(1, static_cast<char>(key_format_version + 1))));
+    }
+    EXPECT_THROW(KvEngine{test_db_path}, std::runtime_error);
+
+    kallisto::RocksDBStorage disk(test_db_path);
+    EXPECT_EQ(disk.getRaw(std::string(key_format_key)), std::string(1, static_cast<char>(key_format_version + 1)));
+}
+
+TEST_F(KvEngineTestV2, LegacyMetadataRecordsAreReencodedOnOpen) {
+    // Problem Description: Metadata records held the VersionState array as
+    // raw memory. Format 1 records must be re-encoded on open, and a
+    // migration cut short must resume without decoding a record twice.
+    std::vector<std::string> paths;
+    for (int i = 0; i < 5; ++i) {
+        paths.push_back("team/svc-" + std::to_string(i));
+    }
+    std::string torn;
+    {
+        auto engine = std::make_unique<KvEngine>(test_db_path);
+        for (const auto& path : paths) {
+            for (int v = 1; v <= 4; ++v) {
+                ASSERT_TRUE(engine->put_version(path, SecretPayload{"v" + std::to_string(v), 0}).has_value());
+            }
+            ASSERT_TRUE(engine->soft_delete(path, 1).has_value());
+            ASSERT_TRUE(engine->destroy_version(path, 2).has_value());
+        }
+    }
+    {
+        // As a run interrupted after the first record: the rest back in format 1
+        kallisto::RocksDBStorage disk(test_db_path);
+        for (size_t i = 1; i < paths.size(); ++i) {
+            auto raw = disk.getRaw(buildMetaKey(paths[i]));
+            ASSERT_TRUE(raw.has_value());
+            auto meta = deserializeMetadata(*raw);
+            ASSERT_TRUE(meta.has_value());
+            ASSERT_TRUE(disk.putRaw(buildMetaKey(paths[i]), serializeLegacyMetadata(*meta)));
+        }
+        ASSERT_TRUE(disk.putRaw(std::string(metadata_format_key), '\x01' + buildMetaKey(paths[0])));
+
+        // Cut short inside its history: unreadable, not an empty history
+        auto raw = disk.getRaw(buildMetaKey(paths[0]));
+        ASSERT_TRUE(raw.has_value());
+        torn = serializeLegacyMetadata(*deserializeMetadata(*raw));
+        torn.resize(torn.size() - 5);
+        ASSERT_TRUE(disk.putRaw(buildMetaKey("team/torn"), torn));
+    }
+
+    auto engine = std::make_unique<KvEngine>(test_db_path);
+    engine->waitUntilReady();
+    EXPECT_EQ(engine->recoveryStats().paths, paths.size());
+    for (const auto& path : paths) {
+        auto meta = engine->read_metadata(path);
+        ASSERT_TRUE(meta.has_value()) << path;
+        EXPECT_EQ(meta->current_version, 4u);
+        ASSERT_EQ(meta->versions.size(), 4u);
+        EXPECT_GT(meta->versions[0].deletion_time_ms, 0u);
+        EXPECT_TRUE(meta->versions[1].destroyed);
+        EXPECT_EQ(engine->read_version(path, 1).error(), EngineError::SoftDeleted);
+        EXPECT_EQ(engine->read_version(path)->value, "v4");
+    }
+    engine.reset();
+
+    kallisto::RocksDBStorage disk(test_db_path);
+    for (const auto& path : paths) {
+        auto raw = disk.getRaw(buildMetaKey(path));
+        ASSERT_TRUE(raw.has_value());
+        EXPECT_TRUE(deserializeMetadata(*raw).has_value()) << path;
+    }
+    EXPECT_EQ(disk.getRaw(buildMetaKey("team/torn")), torn);
+    EXPECT_EQ(disk.getRaw(std::string(metadata_format_key)), std::string(1, static_cast<char>(metadata_format_version)));
+}
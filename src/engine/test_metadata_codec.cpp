@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+
+#include "kallisto/engine/metadata_codec.hpp"
+
+#include <cstdint>
+#include <string>
+
+using namespace kallisto::engine;
+
+// =============================================================================
+// METADATA CODEC TEST SUITE
+//
+// Problem Description:
+//   Metadata records were the VersionState array copied as raw memory:
+//   24 bytes a version, 3 of them padding, host-endian and tied to the
+//   compiler's struct layout. The compact format must round-trip every
+//   field exactly, be a fraction of the size for real histories, reject
+//   truncated or corrupt input instead of reading past it, and still let
+//   format 1 records be read for migration.
+//
+// Coverage:
+//   1. Every field round-trips, extreme and out-of-order values included
+//   2. A typical history takes a fraction of the format 1 bytes
+//   3. Truncated, trailing and corrupt records are rejected
+//   4. Format 1 records decode, and are not mistaken for format 2
+//   5. The header decodes alone, with the version count
+// =============================================================================
+
+namespace {
+
+void expectSame(const KeyMetadata& a, const KeyMetadata& b) {
+    EXPECT_EQ(a.current_version, b.current_version);
+    EXPECT_EQ(a.max_versions, b.max_versions);
+    EXPECT_EQ(a.cas_required, b.cas_required);
+    EXPECT_EQ(a.delete_version_after_ms, b.delete_version_after_ms);
+    ASSERT_EQ(a.versions.size(), b.versions.size());
+    for (size_t i = 0; i < a.versions.size(); ++i) {
+        EXPECT_EQ(a.versions[i].version_id, b.versions[i].version_id) << i;
+        EXPECT_EQ(a.versions[i].created_time_ms, b.versions[i].created_time_ms) << i;
+        EXPECT_EQ(a.versions[i].deletion_time_ms, b.versions[i].deletion_time_ms) << i;
+        EXPECT_EQ(a.versions[i].destroyed, b.versions[i].destroyed) << i;
+    }
+}
+
+KeyMetadata typicalHistory() {
+    KeyMetadata meta;
+    meta.current_version = 14;
+    meta.max_versions = 10;
+    meta.delete_version_after_ms = 30ull * 24 * 3600 * 1000;
+    uint64_t created = 1767225600000; // 2026-01-01
+    for (uint32_t id = 5; id <= 14; ++id) {
+        created += 3600 * 1000 + id * 7919;
+        meta.versions.push_back({created, 0, id, false});
+    }
+    meta.versions[0].deletion_time_ms = meta.versions[0].created_time_ms + 86400 * 1000;
+    meta.versions[1].destroyed = true;
+    return meta;
+}
+
+} // namespace
+
+TEST(MetadataCodecTest, EveryFieldRoundTrips) {
+    KeyMetadata empty;
+    auto decoded = deserializeMetadata(serializeMetadata(empty));
+    ASSERT_TRUE(decoded.has_value());
+    expectSame(*decoded, empty);
+
+    decoded = deserializeMetadata(serializeMetadata(typicalHistory()));
+    ASSERT_TRUE(decoded.has_value());
+    expectSame(*decoded, typicalHistory());
+
+    // Deltas wrap: clocks stepping back and ids out of order still round-trip
+    KeyMetadata odd;
+    odd.current_version = UINT32_MAX;
+    odd.max_versions = UINT32_MAX;
+    odd.cas_required = true;
+    odd.delete_version_after_ms = UINT64_MAX;
+    odd.versions = {
+        {UINT64_MAX, 1, UINT32_MAX, true},
+        {0, UINT64_MAX, 0, false},
+        {1767225600000, 1767225500000, 7, true},
+        {1767225599999, 0, 3, false},
+        {5, 0, 4, true},
+    };
+    decoded = deserializeMetadata(serializeMetadata(odd));
+    ASSERT_TRUE(decoded.has_value());
+    expectSame(*decoded, odd);
+}
+
+TEST(MetadataCodecTest, TypicalHistoryIsCompact) {
+    // Problem: 10 versions cost 21 + 10 x 24 = 261 bytes in format 1.
+    const KeyMetadata meta = typicalHistory();
+    const std::string compact = serializeMetadata(meta);
+    const std::string legacy = serializeLegacyMetadata(meta);
+    EXPECT_EQ(legacy.size(), 261u);
+    EXPECT_LE(compact.size() * 3, legacy.size());
+}
+
+TEST(MetadataCodecTest, MalformedRecordsAreRejected) {
+    const std::string good = serializeMetadata(typicalHistory());
+    for (size_t size = 0; size < good.size(); ++size) {
+        EXPECT_FALSE(deserializeMetadata(good.substr(0, size)).has_value()) << size;
+    }
+    EXPECT_FALSE(deserializeMetadata(good + '\0').has_value());
+
+    std::string bad_format = good;
+    bad_format[0] = static_cast<char>(metadata_format_version + 1);
+    EXPECT_FALSE(deserializeMetadata(bad_format).has_value());
+
+    // A huge version count must fail, not allocate
+    std::string huge_count(1, static_cast<char>(metadata_format_version));
+    huge_count += std::string("\x01\x00\x00\x00", 4);
+    huge_count += std::string("\xFF\xFF\xFF\xFF\x0F", 5);
+    EXPECT_FALSE(deserializeMetadata(huge_count).has_value());
+
+    // An unterminated varint
+    std::string endless(1, static_cast<char>(metadata_format_version));
+    endless += std::string(12, '\xFF');
+    EXPECT_FALSE(deserializeMetadata(endless).has_value());
+}
+
+TEST(MetadataCodecTest, LegacyRecordsDecodeForMigration) {
+    const KeyMetadata meta = typicalHistory();
+    auto decoded = deserializeLegacyMetadata(serializeLegacyMetadata(meta));
+    ASSERT_TRUE(decoded.has_value());
+    expectSame(*decoded, meta);
+    EXPECT_FALSE(deserializeLegacyMetadata("short").has_value());
+
+    // A history cut short is rejected, not read as fewer versions
+    const std::string legacy = serializeLegacyMetadata(meta);
+    for (size_t size = 21; size < legacy.size(); ++size) {
+        EXPECT_FALSE(deserializeLegacyMetadata(legacy.substr(0, size)).has_value()) << size;
+    }
+
+    // current_version 14 starts a format 1 record with byte 14, not the format byte
+    EXPECT_FALSE(deserializeMetadata(serializeLegacyMetadata(meta)).has_value());
+}
+
+TEST(MetadataCodecTest, HeaderDecodesWithoutTheHistory) {
+    // Problem: Scans that only filter records (compaction candidates)
+    // decoded every history just to count it.
+    KeyMetadata meta = typicalHistory();
+    meta.cas_required = true;
+    const std::string record = serializeMetadata(meta);
+    auto header = deserializeMetadataHeader(record);
+    ASSERT_TRUE(header.has_value());
+    EXPECT_EQ(header->current_version, 14u);
+    EXPECT_EQ(header->max_versions, 10u);
+    EXPECT_TRUE(header->cas_required);
+    EXPECT_EQ(header->delete_version_after_ms, meta.delete_version_after_ms);
+    EXPECT_EQ(header->version_count, 10u);
+
+    EXPECT_FALSE(deserializeMetadataHeader(record.substr(0, 3)).has_value());
+    EXPECT_FALSE(deserializeMetadataHeader(serializeLegacyMetadata(meta)).has_value());
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include "kallisto/engine/negative_cache.hpp"
+
+#include <chrono>
+#include <string>
+
+using namespace kallisto::engine;
+using namespace std::chrono_literals;
+
+// =============================================================================
+// NEGATIVE CACHE TEST SUITE
+//
+// Problem Description:
+//   A missing path was looked up in RocksDB on every request, so clients
+//   retrying a 404 in a loop turned into a disk-read amplifier. Tombstones
+//   answer those lookups from memory, but must never hide a path a write
+//   has created, and must stay bounded in both time and space.
+//
+// Coverage:
+//   1. A tombstone answers until its TTL, then is dropped
+//   2. A write invalidates the tombstone and fails a racing insert
+//   3. A full shard drops expired tombstones first, then refuses
+//   4. A zero TTL disables the cache
+// =============================================================================
+
+namespace {
+
+using Clock = NegativeCache::Clock;
+
+} // namespace
+
+TEST(NegativeCacheTest, TombstoneExpiresAfterTtl) {
+    NegativeCache cache(1024, 100ms);
+    const auto now = Clock::now();
+    EXPECT_FALSE(cache.contains("app/missing", now));
+
+    ASSERT_TRUE(cache.insert("app/missing", cache.generation("app/missing"), now));
+    EXPECT_TRUE(cache.contains("app/missing", now + 50ms));
+    EXPECT_TRUE(cache.contains("app/missing", now + 99ms));
+    EXPECT_FALSE(cache.contains("app/missing", now + 100ms));
+    // Dropped on the expired lookup, not just hidden
+    EXPECT_FALSE(cache.contains("app/missing", now));
+
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.inserts, 1u);
+    EXPECT_EQ(stats.hits, 2u);
+    EXPECT_EQ(stats.expired, 1u);
+    EXPECT_EQ(stats.size, 0u);
+}
+
+TEST(NegativeCacheTest, WriteInvalidatesAndFailsRacingInsert) {
+    NegativeCache cache(1024, 10s);
+    ASSERT_TRUE(cache.insert("app/db", cache.generation("app/db")));
+    cache.invalidate("app/db");
+    EXPECT_FALSE(cache.contains("app/db"));
+    EXPECT_EQ(cache.stats().invalidations, 1u);
+
+    // Problem: A reader found the path missing on disk, then a write created
+    // it before the reader recorded the tombstone. The stale tombstone would
+    // answer NotFound for a path that exists.
+    const uint64_t before_read = cache.generation("app/db");
+    cache.invalidate("app/db");
+    EXPECT_FALSE(cache.insert("app/db", before_read));
+    EXPECT_FALSE(cache.contains("app/db"));
+    EXPECT_EQ(cache.stats().rejected, 1u);
+
+    // A fresh snapshot records it again
+    EXPECT_TRUE(cache.insert("app/db", cache.generation("app/db")));
+    EXPECT_TRUE(cache.contains("app/db"));
+}
+
+TEST(NegativeCacheTest, FullShardSweepsExpiredThenRefuses) {
+    // One tombstone per shard
+    NegativeCache cache(NegativeCache::num_shards, 100ms);
+    const auto now = Clock::now();
+    ASSERT_TRUE(cache.insert("first", cache.generation("first"), now));
+
+    // Another key of the same shard
+    std::string other;
+    for (int i = 0; other.empty(); ++i) {
+        const std::string key = "k" + std::to_string(i);
+        if (std::hash<std::string_view>{}(key) % NegativeCache::num_shards ==
+            std::hash<std::string_view>{}("first") % NegativeCache::num_shards) {
+            other = key;
+        }
+    }
+    EXPECT_FALSE(cache.insert(other, cache.generation(other), now + 10ms));
+    EXPECT_TRUE(cache.contains("first", now + 10ms));
+
+    // Once "first" has expired it makes room
+    EXPECT_TRUE(cache.insert(other, cache.generation(other), now + 200ms));
+    EXPECT_TRUE(cache.contains(other, now + 200ms));
+    EXPECT_EQ(cache.stats().size, 1u);
+    EXPECT_EQ(cache.stats().expired, 1u);
+}
+
+TEST(NegativeCacheTest, ZeroTtlDisables) {
+    NegativeCache cache(1024, 0ms);
+    EXPECT_FALSE(cache.enabled());
+    EXPECT_FALSE(cache.insert("app/x", cache.generation("app/x")));
+    EXPECT_FALSE(cache.contains("app/x"));
+    EXPECT_EQ(cache.stats().inserts, 0u);
+}
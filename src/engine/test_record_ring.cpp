@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+
+#include "kallisto/engine/record_ring.hpp"
+
+#include <cstring>
+#include <latch>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace kallisto::engine;
+
+// =============================================================================
+// RECORD RING TEST SUITE
+//
+// Problem Description:
+//   The write-behind queue was a slot array of std::string pairs: tens of MB
+//   idle and two allocations per record. The ring stores variable-length
+//   records in place. Records must come out whole and in reservation order,
+//   never straddle the end of the buffer, and the space they free must be
+//   reusable however producers and the consumer interleave.
+//
+// Coverage:
+//   1. Records round-trip, in order, and are only freed by release()
+//   2. Wrap-around inserts padding and keeps every record contiguous
+//   3. A full ring, an oversized record and an oversized capacity are rejected
+//   4. Concurrent producers: every record arrives exactly once, per-producer in order
+//   5. Sequence numbers increase in queue order and are covered once released
+// =============================================================================
+
+namespace {
+
+bool pushString(RecordRing& ring, std::string_view value) {
+    return ring.push(value.size(), [&](std::byte* dst) { std::memcpy(dst, value.data(), value.size()); });
+}
+
+std::vector<std::string> drain(RecordRing& ring) {
+    std::vector<std::string> out;
+    ring.peek(SIZE_MAX, [&](std::span<const std::byte> record) {
+        out.emplace_back(reinterpret_cast<const char*>(record.data()), record.size());
+    });
+    ring.release();
+    return out;
+}
+
+} // namespace
+
+TEST(RecordRingTest, RoundTripInOrder) {
+    RecordRing ring(4096);
+    EXPECT_EQ(ring.capacity(), 4096u);
+    EXPECT_TRUE(ring.empty());
+
+    ASSERT_TRUE(pushString(ring, "alpha"));
+    ASSERT_TRUE(pushString(ring, ""));
+    ASSERT_TRUE(pushString(ring, "a longer record of 29 bytes.."));
+    EXPECT_FALSE(ring.empty());
+    EXPECT_EQ(ring.sizeApprox(), 3u);
+
+    // peek() does not free: the bytes stay reserved until release()
+    std::vector<std::string> seen;
+    EXPECT_EQ(ring.peek(2, [&](std::span<const std::byte> r) {
+        seen.emplace_back(reinterpret_cast<const char*>(r.data()), r.size());
+    }), 2u);
+    EXPECT_EQ(seen, (std::vector<std::string>{"alpha", ""}));
+    EXPECT_EQ(ring.sizeApprox(), 3u);
+
+    ring.release();
+    EXPECT_EQ(ring.sizeApprox(), 1u);
+    EXPECT_EQ(drain(ring), (std::vector<std::string>{"a longer record of 29 bytes.."}));
+    EXPECT_TRUE(ring.empty());
+    EXPECT_EQ(ring.bytesApprox(), 0u);
+}
+
+TEST(RecordRingTest, WrapAroundKeepsRecordsContiguous) {
+    // Problem: 300-byte records do not divide 4096, so the tail regularly
+    // lands too close to the end and the next record must start over at 0.
+    RecordRing ring(4096);
+    uint64_t next = 0;
+    uint64_t expected = 0;
+    for (int round = 0; round < 100; ++round) {
+        for (int i = 0; i < 5; ++i) {
+            std::string value(300, static_cast<char>('a' + next % 26));
+            std::memcpy(value.data(), &next, sizeof(next));
+            ASSERT_TRUE(pushString(ring, value)) << "round " << round;
+            ++next;
+        }
+        for (const auto& value : drain(ring)) {
+            ASSERT_EQ(value.size(), 300u);
+            uint64_t id;
+            std::memcpy(&id, value.data(), sizeof(id));
+            EXPECT_EQ(id, expected);
+            EXPECT_EQ(value.back(), static_cast<char>('a' + expected % 26));
+            ++expected;
+        }
+    }
+    EXPECT_EQ(expected, next);
+}
+
+TEST(RecordRingTest, FullAndOversizedAreRejected) {
+    RecordRing ring(4096);
+    EXPECT_EQ(ring.maxRecordSize(), 2048u - 8);
+    EXPECT_FALSE(pushString(ring, std::string(ring.maxRecordSize() + 1, 'x')));
+
+    // 1016 + 8 header = 1024 bytes: exactly four fit
+    const std::string value(1016, 'y');
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(pushString(ring, value));
+    }
+    EXPECT_FALSE(pushString(ring, "z"));
+    EXPECT_EQ(ring.bytesApprox(), 4096u);
+
+    // Visited but unreleased records still hold their space
+    EXPECT_EQ(ring.peek(SIZE_MAX, [](std::span<const std::byte>) {}), 4u);
+    EXPECT_TRUE(ring.empty());
+    EXPECT_FALSE(pushString(ring, "z"));
+
+    ring.release();
+    EXPECT_TRUE(pushString(ring, std::string(ring.maxRecordSize(), 'w')));
+
+    // Problem: The header's 30-bit size field would silently truncate the
+    // largest records of a 1 GB ring.
+    EXPECT_THROW(RecordRing(RecordRing::max_capacity + 1), std::length_error);
+    EXPECT_THROW(RecordRing(size_t{1} << 30), std::length_error);
+}
+
+TEST(RecordRingTest, ConcurrentProducersLoseNothing) {
+    constexpr int num_producers = 4;
+    constexpr uint32_t per_producer = 20000;
+    RecordRing ring(16 * 1024);
+
+    std::latch start(num_producers + 1);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < num_producers; ++p) {
+        producers.emplace_back([&, p]() {
+            start.arrive_and_wait();
+            for (uint32_t seq = 0; seq < per_producer; ++seq) {
+                // Variable sizes: 9..72 bytes
+                const size_t size = 9 + (seq * 7 + p) % 64;
+                while (!ring.push(size, [&](std::byte* dst) {
+                    std::memset(dst, 0xAB, size);
+                    std::memcpy(dst, &p, sizeof(uint32_t));
+                    std::memcpy(dst + 4, &seq, sizeof(seq));
+                })) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<uint32_t> next(num_producers, 0);
+    uint64_t received = 0;
+    start.arrive_and_wait();
+    while (received < num_producers * uint64_t{per_producer}) {
+        received += ring.peek(SIZE_MAX, [&](std::span<const std::byte> record) {
+            uint32_t producer, seq;
+            std::memcpy(&producer, record.data(), sizeof(producer));
+            std::memcpy(&seq, record.data() + 4, sizeof(seq));
+            ASSERT_LT(producer, static_cast<uint32_t>(num_producers));
+            EXPECT_EQ(seq, next[producer]);
+            EXPECT_EQ(record.size(), 9 + (seq * 7 + producer) % 64);
+            EXPECT_EQ(record.back(), std::byte{0xAB});
+            next[producer] = seq + 1;
+        });
+        ring.release();
+        std::this_thread::yield();
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    EXPECT_TRUE(ring.empty());
+    EXPECT_EQ(ring.sizeApprox(), 0u);
+    for (int p = 0; p < num_producers; ++p) {
+        EXPECT_EQ(next[p], per_producer);
+    }
+}
+
+TEST(RecordRingTest, SequenceNumbersTrackRelease) {
+    // Problem: Durable writes wait for the release position of an fsynced
+    // flush to pass their sequence, across wrap-arounds too.
+    RecordRing ring(4096);
+    uint64_t last = 0;
+    for (int round = 0; round < 20; ++round) {
+        std::vector<uint64_t> sequences;
+        for (int i = 0; i < 3; ++i) {
+            const std::string value(500, 's');
+            const uint64_t sequence = ring.push(value.size(), [&](std::byte* dst) {
+                std::memcpy(dst, value.data(), value.size());
+            });
+            ASSERT_GT(sequence, last);
+            last = sequence;
+            sequences.push_back(sequence);
+        }
+        EXPECT_EQ(ring.peek(2, [](std::span<const std::byte>) {}), 2u);
+        const uint64_t released = ring.release();
+        EXPECT_GE(released, sequences[1]);
+        EXPECT_LT(released, sequences[2]);
+        EXPECT_EQ(drain(ring).size(), 1u);
+    }
+    EXPECT_EQ(ring.release(), last);
+}
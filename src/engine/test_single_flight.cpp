@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include "kallisto/engine/single_flight.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <latch>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace kallisto::engine;
+using namespace std::chrono_literals;
+
+// =============================================================================
+// SINGLE FLIGHT TEST SUITE
+//
+// Problem Description:
+//   When a hot key falls out of the cache, every reader missed at once and
+//   each ran its own RocksDB read for the same record. SingleFlight lets one
+//   caller per key load while the others wait for, or are called back with,
+//   its result. A finished flight must not be reused by later misses.
+//
+// Coverage:
+//   1. Concurrent blocking callers on one key share a single load
+//   2. Callbacks attached to a flight get the leader's result
+//   3. Distinct keys and successive misses load independently
+//   4. A load that throws releases its waiters with the exception
+// =============================================================================
+
+TEST(SingleFlightTest, ConcurrentCallersShareOneLoad) {
+    constexpr int threads = 8;
+    SingleFlight<int> flights;
+    std::atomic<int> loads{0};
+    std::latch start(threads);
+
+    std::vector<std::thread> callers;
+    std::vector<int> results(threads, 0);
+    for (int t = 0; t < threads; ++t) {
+        callers.emplace_back([&, t]() {
+            start.arrive_and_wait();
+            results[t] = flights.run("hot", [&]() {
+                loads.fetch_add(1);
+                // Long enough for every caller to arrive while it runs
+                std::this_thread::sleep_for(100ms);
+                return 42;
+            });
+        });
+    }
+    for (auto& caller : callers) {
+        caller.join();
+    }
+
+    for (int result : results) {
+        EXPECT_EQ(result, 42);
+    }
+    EXPECT_EQ(loads.load(), 1);
+    auto stats = flights.stats();
+    EXPECT_EQ(stats.loads, 1u);
+    EXPECT_EQ(stats.shared, threads - 1u);
+}
+
+TEST(SingleFlightTest, CallbacksGetTheLeadersResult) {
+    SingleFlight<std::string> flights;
+    std::function<void(const std::string&)> leader_done = [](const std::string&) { FAIL() << "leader called back"; };
+    ASSERT_TRUE(flights.join("k", leader_done));
+    // The leader keeps its own callback
+    EXPECT_TRUE(static_cast<bool>(leader_done));
+
+    std::vector<std::string> seen;
+    for (int i = 0; i < 3; ++i) {
+        std::function<void(const std::string&)> done = [&](const std::string& v) { seen.push_back(v); };
+        EXPECT_FALSE(flights.join("k", done));
+    }
+    // A blocking caller can share the same flight
+    std::string blocked;
+    std::thread waiter([&]() { blocked = flights.run("k", []() { return std::string("own load"); }); });
+    while (flights.stats().shared < 4) {
+        std::this_thread::yield();
+    }
+
+    flights.complete("k", "value");
+    waiter.join();
+    EXPECT_EQ(seen, (std::vector<std::string>{"value", "value", "value"}));
+    EXPECT_EQ(blocked, "value");
+}
+
+TEST(SingleFlightTest, FinishedFlightsAreNotReused) {
+    SingleFlight<int> flights;
+    int loads = 0;
+    EXPECT_EQ(flights.run("a", [&]() { return ++loads; }), 1);
+    EXPECT_EQ(flights.run("a", [&]() { return ++loads; }), 2);
+    EXPECT_EQ(flights.run("b", [&]() { return ++loads; }), 3);
+
+    // Completing a key with no flight is a no-op
+    flights.complete("c", 7);
+    EXPECT_EQ(flights.stats().loads, 3u);
+    EXPECT_EQ(flights.stats().shared, 0u);
+}
+
+TEST(SingleFlightTest, ThrowingLoadReleasesWaiters) {
+    // Problem: a leader whose load threw never published, and its followers waited forever
+    SingleFlight<int> flights;
+    std::latch loading(1);
+    std::thread leader([&]() {
+        EXPECT_THROW(flights.run("k",
+                                 [&]() -> int {
+                                     loading.count_down();
+                                     while (flights.stats().shared < 1) {
+                                         std::this_thread::yield();
+                                     }
+                                     throw std::runtime_error("disk");
+                                 }),
+                     std::runtime_error);
+    });
+    loading.wait();
+    EXPECT_THROW(flights.run("k", []() { return 1; }), std::runtime_error);
+    leader.join();
+
+    // The failed flight is not reused
+    EXPECT_EQ(flights.run("k", []() { return 2; }), 2);
+    EXPECT_EQ(flights.stats().loads, 2u);
+}
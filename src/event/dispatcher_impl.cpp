@@ -1,5 +1,6 @@
 #include "kallisto/event/dispatcher.hpp"
 #include "kallisto/logger.hpp"
+#include "kallisto/rcu/epoch_domain.hpp"
 
 #include <atomic>
 #include <cstring>
@@ -140,12 +141,21 @@ public:
 
     debug("[DISPATCHER] '" + name_ + "' entering event loop");
 
+    // Loop iterations are this thread's RCU quiescent points (QSBR)
+    auto& epoch_domain = rcu::EpochDomain::global();
+    epoch_domain.onlineThread();
+
     while (!exit_requested_) {
       processImmediateTasks();
       waitForAndDispatchEvents();
       applyDeferredMutations();
+
+      // No callback is running: nothing loaded during this iteration is still referenced
+      epoch_domain.quiescentState();
+      epoch_domain.tryReclaim();
     }
 
+    epoch_domain.offlineThread();
     running_ = false;
     debug("[DISPATCHER] '" + name_ + "' exited event loop");
   }
@@ -315,9 +325,14 @@ private:
       return; 
     }
 
+    // A sleeping loop holds no RCU references: stay offline so writers need not wait for it
+    auto& epoch_domain = rcu::EpochDomain::global();
+    epoch_domain.offlineThread();
+
     struct epoll_event events[max_events];
     int nfds = epoll_wait(epoll_fd_, events, max_events, epoll_timeout_ms);
 
+    epoch_domain.onlineThread();
     is_sleeping_.store(false, std::memory_order_release);
 
     if (nfds < 0) {
@@ -3,8 +3,11 @@
 
 namespace kallisto {
 
-KallistoCore::KallistoCore(const std::string& db_path) {
-    auto kv = std::make_shared<engine::KvEngine>(db_path);
+KallistoCore::KallistoCore(const std::string& db_path, engine::RecoveryOptions recovery,
+                           engine::MountConfig config, engine::WriteBehindOptions write_behind,
+                           engine::ReadIoOptions read_io) {
+    auto kv = std::make_shared<engine::KvEngine>(db_path, PathIndexType::BTREE, recovery, config, write_behind,
+                                                 read_io);
     default_kv_engine_ = kv.get();
     registry_.mount("secret", std::move(kv));
     LOG_INFO("[CORE] KallistoCore initialized with default KvEngine at 'secret'");
@@ -64,4 +67,33 @@ void KallistoCore::forceFlush() {
     registry_.flushAll();
 }
 
+void KallistoCore::attachWorkers(event::WorkerPool& workers, tls::Instance& tls) {
+    default_kv_engine_->attachWorkers(workers, tls);
+}
+
+engine::WarmupStatus KallistoCore::warmupStatus() const {
+    return default_kv_engine_->warmupStatus();
+}
+
+size_t KallistoCore::compactVersionHistory() {
+    return default_kv_engine_->compactVersionHistory();
+}
+
+tl::expected<size_t, engine::EngineError> KallistoCore::destroyPrefix(std::string_view prefix) {
+    return default_kv_engine_->destroyPrefix(prefix);
+}
+
+std::optional<engine::KvEngine::DestroyResult> KallistoCore::destroyPrefixAsync(std::string prefix,
+                                                                                engine::KvEngine::DestroyCallback done) {
+    return default_kv_engine_->destroyPrefixAsync(std::move(prefix), std::move(done));
+}
+
+engine::FlushStats KallistoCore::flushStats() const {
+    return default_kv_engine_->flushStats();
+}
+
+void KallistoCore::setFlushPolicy(const engine::FlushPolicy& policy) {
+    default_kv_engine_->setFlushPolicy(policy);
+}
+
 } // namespace kallisto
@@ -8,6 +8,7 @@
  */
 
 #include "kallisto/event/worker.hpp"
+#include "kallisto/thread_local/thread_local.hpp"
 #include "kallisto/server/http_handler.hpp"
 #include "kallisto/server/uds_admin_handler.hpp"
 #include "kallisto/kallisto_core.hpp"
@@ -45,6 +46,14 @@ struct ServerConfig {
     size_t num_workers = 4;
     std::string db_path = "/kallisto/data";
     std::string socket_path = "/var/run/kallisto/kallisto.sock";
+    size_t recovery_threads = 0;      // 0 = hardware concurrency
+    bool serve_while_warming = false; // Bind listeners before the path index is rebuilt
+    uint32_t max_versions = 10;       // Versions kept per key; 0 = unlimited
+    uint32_t flush_lag_ms = 5;        // BATCH mode: p99 enqueue-to-disk target
+    size_t write_workers = 4;         // BATCH mode: write-behind I/O threads
+    size_t write_queue_mb = 8;        // BATCH mode: queue buffer per write-behind worker
+    size_t read_threads = 4;          // Cache-miss reads, off the event loops
+    uint32_t negative_ttl_ms = 1000;  // NotFound remembered per path; 0 = off
 
     static ServerConfig parseFromArgs(int argc, char** argv) {
         ServerConfig config;
@@ -65,6 +74,22 @@ struct ServerConfig {
                 config.db_path = arg.substr(10);
             } else if (arg.find("--socket-path=") == 0) {
                 config.socket_path = arg.substr(14);
+            } else if (arg.find("--recovery-threads=") == 0) {
+                config.recovery_threads = std::stoul(arg.substr(19));
+            } else if (arg == "--serve-while-warming") {
+                config.serve_while_warming = true;
+            } else if (arg.find("--max-versions=") == 0) {
+                config.max_versions = static_cast<uint32_t>(std::stoul(arg.substr(15)));
+            } else if (arg.find("--flush-lag-ms=") == 0) {
+                config.flush_lag_ms = static_cast<uint32_t>(std::stoul(arg.substr(15)));
+            } else if (arg.find("--write-workers=") == 0) {
+                config.write_workers = std::stoul(arg.substr(16));
+            } else if (arg.find("--write-queue-mb=") == 0) {
+                config.write_queue_mb = std::stoul(arg.substr(17));
+            } else if (arg.find("--read-threads=") == 0) {
+                config.read_threads = std::stoul(arg.substr(15));
+            } else if (arg.find("--negative-ttl-ms=") == 0) {
+                config.negative_ttl_ms = std::stoul(arg.substr(18));
             }
         }
         return config;
@@ -86,6 +111,15 @@ struct ServerConfig {
                   << "  --workers=N        Number of worker threads (default: CPU cores)\n"
                   << "  --db-path=PATH     RocksDB data directory (default: /kallisto/data)\n"
                   << "  --socket-path=PATH Admin UDS socket path (default: /var/run/kallisto/kallisto.sock)\n"
+                  << "  --recovery-threads=N  Startup index rebuild threads (default: CPU cores)\n"
+                  << "  --serve-while-warming Accept connections while the index and cache rebuild;\n"
+                  << "                        GET /v1/sys/health returns 429 until ready\n"
+                  << "  --max-versions=N   Versions kept per key, 0 = unlimited (default: 10)\n"
+                  << "  --flush-lag-ms=N   BATCH mode p99 write-behind lag target (default: 5)\n"
+                  << "  --write-workers=N  BATCH mode write-behind I/O threads (default: 4)\n"
+                  << "  --write-queue-mb=N BATCH mode queue size per write-behind thread, in MB, at most 512 (default: 8)\n"
+                  << "  --read-threads=N   Threads serving cache-miss reads off the workers (default: 4)\n"
+                  << "  --negative-ttl-ms=N Answer repeated lookups of a missing path from memory, 0 = off (default: 1000)\n"
                   << std::endl;
     }
 
@@ -96,6 +130,12 @@ struct ServerConfig {
         info("  Workers:      " + std::to_string(num_workers));
         info("  DB Path:      " + db_path);
         info("  Socket Path:  " + socket_path);
+        info("  Warm-up:      " + std::string(serve_while_warming ? "serve while warming" : "before serving"));
+        info("  Write-behind: " + std::to_string(write_workers) + " workers x " + std::to_string(write_queue_mb) +
+             " MB, p99 lag target " + std::to_string(flush_lag_ms) + " ms");
+        info("  Read I/O:     " + std::to_string(read_threads) + " threads for cache misses, NotFound cached " +
+             std::to_string(negative_ttl_ms) + " ms");
+        info("  Max versions: " + (max_versions ? std::to_string(max_versions) : std::string("unlimited")));
         info("========================================");
     }
 };
@@ -107,7 +147,23 @@ struct ServerConfig {
 class KallistoServerApp {
 public:
     explicit KallistoServerApp(const ServerConfig& config) : config_(config) {
-        core_ = std::make_shared<KallistoCore>(config_.db_path);
+        tls_ = tls::createThreadLocalInstance();
+
+        // Serve-while-warming: reads miss to RocksDB until the cache is warm
+        engine::RecoveryOptions recovery;
+        recovery.threads = config_.recovery_threads;
+        recovery.background = config_.serve_while_warming;
+        recovery.warm_cache = config_.serve_while_warming;
+        engine::MountConfig mount;
+        mount.max_versions = config_.max_versions;
+        engine::WriteBehindOptions write_behind;
+        write_behind.workers = config_.write_workers;
+        write_behind.queue_bytes = config_.write_queue_mb << 20;
+        write_behind.flush.target_p99_lag = std::chrono::milliseconds(config_.flush_lag_ms);
+        engine::ReadIoOptions read_io;
+        read_io.threads = config_.read_threads;
+        read_io.negative_ttl = std::chrono::milliseconds(config_.negative_ttl_ms);
+        core_ = std::make_shared<KallistoCore>(config_.db_path, recovery, mount, write_behind, read_io);
         info("[SERVER] KallistoCore created and initialized with DB path: " + config_.db_path);
         
         worker_pool_ = createWorkerPool(config_.num_workers);
@@ -116,12 +172,20 @@ public:
 
     void start() {
         // Start workers and bind to HTTP endpoints
-        worker_pool_->start([this]() { bindHttpListeners(); });
+        worker_pool_->start([this]() {
+            registerWorkerThreads();
+            core_->attachWorkers(*worker_pool_, *tls_);
+            bindHttpListeners();
+        });
         
         // Start Admin UDS interface
         uds_admin_->start();
         
-        info("[SERVER] Kallisto is READY. Accepting connections.");
+        if (config_.serve_while_warming && !core_->warmupStatus().ready) {
+            info("[SERVER] Kallisto is WARMING. Accepting connections; /v1/sys/health reports progress.");
+        } else {
+            info("[SERVER] Kallisto is READY. Accepting connections.");
+        }
         info("[SERVER] Press Ctrl+C to shutdown.");
     }
 
@@ -146,6 +210,14 @@ public:
     }
 
 private:
+    void registerWorkerThreads() {
+        // registerThread must run on the thread it registers
+        for (size_t i = 0; i < worker_pool_->size(); ++i) {
+            auto& dispatcher = worker_pool_->getWorker(i).dispatcher();
+            dispatcher.post([this, &dispatcher]() { tls_->registerThread(dispatcher, false); });
+        }
+    }
+
     void bindHttpListeners() {
         info("[SERVER] All workers ready, binding listeners...");
         uint16_t port = config_.http_port;
@@ -163,6 +235,7 @@ private:
     }
 
     ServerConfig config_;
+    tls::InstancePtr tls_; // Outlives core_: the engine holds slots allocated from it
     std::shared_ptr<KallistoCore> core_;
     event::WorkerPoolPtr worker_pool_;
     std::unique_ptr<server::UdsAdminHandler> uds_admin_;
@@ -0,0 +1,152 @@
+#include "kallisto/rcu/epoch_domain.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace kallisto {
+namespace rcu {
+
+/**
+ * Per-thread bookkeeping. The record is shared with writers through the
+ * registry; everything else is only touched by the owning thread.
+ */
+struct EpochDomain::ThreadState {
+    explicit ThreadState(EpochDomain* owner) : domain(owner), record(new ThreadRecord) {
+        std::lock_guard lock(domain->registry_mutex_);
+        domain->thread_records_.push_back(record);
+    }
+
+    ~ThreadState() {
+        std::lock_guard lock(domain->registry_mutex_);
+        auto& records = domain->thread_records_;
+        records.erase(std::remove(records.begin(), records.end(), record), records.end());
+        delete record;
+    }
+
+    EpochDomain* domain;
+    ThreadRecord* record;
+    uint32_t pin_depth = 0;
+    bool online = false;
+};
+
+EpochDomain& EpochDomain::global() {
+    static EpochDomain domain;
+    return domain;
+}
+
+EpochDomain::~EpochDomain() {
+    // Process exit: no reader threads remain, run whatever is still queued
+    for (auto& retired : retired_objects_) {
+        retired.deleter();
+    }
+}
+
+EpochDomain::ThreadState& EpochDomain::localState() {
+    thread_local ThreadState state(this);
+    return state;
+}
+
+void EpochDomain::announce(ThreadRecord& record) {
+    // seq_cst store: writers scanning records either see this epoch, or this
+    // thread's next pointer load is ordered after their unpublish
+    uint64_t epoch = global_epoch_.load();
+    if (record.active_epoch.load(std::memory_order_relaxed) != epoch) {
+        record.active_epoch.store(epoch);
+    }
+}
+
+void EpochDomain::onlineThread() {
+    ThreadState& state = localState();
+    state.online = true;
+    if (state.pin_depth == 0) {
+        announce(*state.record);
+    }
+}
+
+void EpochDomain::offlineThread() {
+    ThreadState& state = localState();
+    state.online = false;
+    if (state.pin_depth == 0) {
+        state.record->active_epoch.store(0, std::memory_order_release);
+    }
+}
+
+void EpochDomain::quiescentState() {
+    ThreadState& state = localState();
+    if (state.online && state.pin_depth == 0) {
+        announce(*state.record);
+    }
+}
+
+EpochGuard EpochDomain::pin() {
+    ThreadState& state = localState();
+    // Online threads already announce an epoch that cannot advance while pinned
+    if (state.pin_depth++ == 0 && !state.online) {
+        announce(*state.record);
+    }
+    return EpochGuard(this);
+}
+
+void EpochDomain::unpin() {
+    ThreadState& state = localState();
+    if (--state.pin_depth == 0 && !state.online) {
+        state.record->active_epoch.store(0, std::memory_order_release);
+    }
+}
+
+void EpochDomain::retire(std::function<void()> deleter) {
+    std::lock_guard lock(retire_mutex_);
+    // Readers that announce the new epoch loaded their pointers after the unpublish
+    uint64_t retire_epoch = global_epoch_.fetch_add(1) + 1;
+    retired_objects_.push_back({retire_epoch, std::move(deleter)});
+    pending_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t EpochDomain::minimumActiveEpoch() const {
+    uint64_t minimum = std::numeric_limits<uint64_t>::max();
+    std::lock_guard lock(registry_mutex_);
+    for (const ThreadRecord* record : thread_records_) {
+        uint64_t epoch = record->active_epoch.load();
+        if (epoch != 0) {
+            minimum = std::min(minimum, epoch);
+        }
+    }
+    return minimum;
+}
+
+size_t EpochDomain::reclaim() {
+    std::unique_lock lock(retire_mutex_);
+    return reclaimLocked(lock);
+}
+
+size_t EpochDomain::tryReclaim() {
+    if (pending_count_.load(std::memory_order_relaxed) == 0) {
+        return 0;
+    }
+    std::unique_lock lock(retire_mutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return 0;
+    }
+    return reclaimLocked(lock);
+}
+
+size_t EpochDomain::reclaimLocked(std::unique_lock<std::mutex>& retire_lock) {
+    const uint64_t safe_epoch = minimumActiveEpoch();
+
+    std::vector<std::function<void()>> expired;
+    while (!retired_objects_.empty() && retired_objects_.front().retire_epoch <= safe_epoch) {
+        expired.push_back(std::move(retired_objects_.front().deleter));
+        retired_objects_.pop_front();
+    }
+    pending_count_.fetch_sub(expired.size(), std::memory_order_relaxed);
+    retire_lock.unlock();
+
+    // Deallocation runs outside the lock so writers can keep retiring
+    for (auto& deleter : expired) {
+        deleter();
+    }
+    return expired.size();
+}
+
+} // namespace rcu
+} // namespace kallisto
@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+
+#include "kallisto/event/dispatcher.hpp"
+#include "kallisto/rcu/epoch_domain.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+
+using namespace kallisto;
+
+namespace kallisto {
+  // Externally defined in dispatcher_impl.cpp
+  event::DispatcherFactoryPtr createDispatcherFactory();
+}
+
+// =============================================================================
+// EPOCH DOMAIN TEST SUITE
+//
+// Problem Description:
+//   EpochDomain frees retired RCU objects once no reader can still hold
+//   them. Freeing too early is a use-after-free on a lock-free read path;
+//   never freeing leaks every snapshot a writer ever published.
+//
+// Coverage:
+//   1. Retire without readers frees on the next reclaim
+//   2. A pinned reader (EBR) delays reclamation until it unpins
+//   3. Readers that pinned after the retire do not delay it
+//   4. Online threads (QSBR) delay until quiescentState / offline
+//   5. Nested guards keep the outermost epoch
+//   6. Dispatcher loop iterations act as quiescent points
+// =============================================================================
+
+class EpochDomainTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        domain_.reclaim(); // Start from an empty retire list
+        freed_.store(0);
+    }
+
+    static void retireCounter() {
+        rcu::EpochDomain::global().retire([]() { freed_.fetch_add(1); });
+    }
+
+    rcu::EpochDomain& domain_ = rcu::EpochDomain::global();
+    static inline std::atomic<int> freed_{0};
+};
+
+TEST_F(EpochDomainTest, RetireWithoutReadersFreesOnReclaim) {
+    retireCounter();
+    EXPECT_EQ(domain_.pendingCount(), 1u);
+
+    EXPECT_EQ(domain_.reclaim(), 1u);
+    EXPECT_EQ(freed_.load(), 1);
+    EXPECT_EQ(domain_.pendingCount(), 0u);
+}
+
+TEST_F(EpochDomainTest, PinnedReaderDelaysReclamation) {
+    // Problem: A reader on another thread pinned before the retire may still
+    // dereference the old object; it must survive until that reader unpins.
+    std::promise<void> pinned;
+    std::promise<void> release;
+    auto release_future = release.get_future();
+
+    std::thread reader([&]() {
+        auto guard = domain_.pin();
+        pinned.set_value();
+        release_future.wait();
+    });
+    pinned.get_future().wait();
+
+    retireCounter();
+    EXPECT_EQ(domain_.reclaim(), 0u);
+    EXPECT_EQ(freed_.load(), 0);
+
+    release.set_value();
+    reader.join();
+
+    EXPECT_EQ(domain_.reclaim(), 1u);
+    EXPECT_EQ(freed_.load(), 1);
+}
+
+TEST_F(EpochDomainTest, ReaderPinnedAfterRetireDoesNotDelay) {
+    retireCounter();
+
+    // This pin can only observe state published after the retire
+    auto guard = domain_.pin();
+    EXPECT_EQ(domain_.reclaim(), 1u);
+}
+
+TEST_F(EpochDomainTest, OnlineThreadDelaysUntilQuiescentState) {
+    // Problem: QSBR threads pay nothing per read, so the domain must assume
+    // they hold references until they explicitly report a quiescent state.
+    std::promise<void> online;
+    std::promise<void> quiesce;
+    std::promise<void> quiesced;
+    std::promise<void> go_offline;
+    auto quiesce_future = quiesce.get_future();
+    auto offline_future = go_offline.get_future();
+
+    std::thread reader([&]() {
+        domain_.onlineThread();
+        online.set_value();
+        quiesce_future.wait();
+        domain_.quiescentState();
+        quiesced.set_value();
+        offline_future.wait();
+        domain_.offlineThread();
+    });
+    online.get_future().wait();
+
+    retireCounter();
+    EXPECT_EQ(domain_.reclaim(), 0u);
+
+    quiesce.set_value();
+    quiesced.get_future().wait();
+    EXPECT_EQ(domain_.reclaim(), 1u);
+
+    // A second retire waits again until the thread quiesces or goes offline
+    retireCounter();
+    EXPECT_EQ(domain_.reclaim(), 0u);
+    go_offline.set_value();
+    reader.join();
+    EXPECT_EQ(domain_.reclaim(), 1u);
+    EXPECT_EQ(freed_.load(), 2);
+}
+
+TEST_F(EpochDomainTest, NestedGuardsKeepOutermostEpoch) {
+    std::promise<void> pinned;
+    std::promise<void> inner_released;
+    std::promise<void> release;
+    auto inner_future = inner_released.get_future();
+    auto release_future = release.get_future();
+    auto pinned_future = pinned.get_future();
+
+    std::thread reader([&]() {
+        auto outer = domain_.pin();
+        {
+            auto inner = domain_.pin();
+            pinned.set_value();
+            inner_future.wait();
+        }
+        release_future.wait();
+    });
+    pinned_future.wait();
+
+    retireCounter();
+    inner_released.set_value();
+    EXPECT_EQ(domain_.reclaim(), 0u); // Outer guard is still alive
+
+    release.set_value();
+    reader.join();
+    EXPECT_EQ(domain_.reclaim(), 1u);
+}
+
+TEST_F(EpochDomainTest, DispatcherLoopIterationsAreQuiescentPoints) {
+    // Problem: Workers never call the domain explicitly; the event loop must
+    // report quiescent states and reclaim on its own, even while idle.
+    auto factory = createDispatcherFactory();
+    auto dispatcher = factory->createDispatcher("rcu_worker");
+    std::thread loop([&]() { dispatcher->run(); });
+
+    retireCounter();
+    std::promise<void> iterated;
+    dispatcher->post([&]() { iterated.set_value(); });
+    iterated.get_future().wait();
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (freed_.load() == 0 && std::chrono::steady_clock::now() < deadline) {
+        domain_.reclaim();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(freed_.load(), 1);
+
+    dispatcher->exit();
+    loop.join();
+}
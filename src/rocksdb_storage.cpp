@@ -1,11 +1,31 @@
 #include "kallisto/rocksdb_storage.hpp"
 #include "kallisto/logger.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <filesystem>
 
+#ifdef KALLISTO_HAS_ROCKSDB
+#include <rocksdb/metadata.h>
+#endif
+
 namespace kallisto {
 
+namespace {
+
+// Smallest key greater than every key starting with prefix ("" = no bound)
+std::string prefixSuccessor(std::string prefix) {
+    while (!prefix.empty() && static_cast<uint8_t>(prefix.back()) == 0xFF) {
+        prefix.pop_back();
+    }
+    if (!prefix.empty()) {
+        prefix.back() = static_cast<char>(static_cast<uint8_t>(prefix.back()) + 1);
+    }
+    return prefix;
+}
+
+} // namespace
+
 #ifdef KALLISTO_HAS_ROCKSDB
 
 RocksDBStorage::RocksDBStorage(const std::string& db_path) {
@@ -23,6 +43,12 @@ RocksDBStorage::RocksDBStorage(const std::string& db_path) {
     options_.IncreaseParallelism();          // Use all available cores for compaction
     options_.OptimizeLevelStyleCompaction(); // Good default for mixed workloads
 
+    // Write-behind workers issue WriteBatches concurrently: let their memtable
+    // inserts run in parallel and pipeline WAL appends with memtable writes
+    options_.allow_concurrent_memtable_write = true;
+    options_.enable_write_thread_adaptive_yield = true;
+    options_.enable_pipelined_write = true;
+
     // WAL enabled by default (crash recovery)
     // Block cache: RocksDB will handle hot blocks internally
     
@@ -69,6 +95,7 @@ std::optional<SecretEntry> RocksDBStorage::get(const std::string& key) const {
     }
 
     std::string raw_value;
+    point_reads_.fetch_add(1, std::memory_order_relaxed);
     rocksdb::Status status = db_->Get(read_opts_, key, &raw_value);
 
     if (status.IsNotFound()) {
@@ -120,6 +147,7 @@ std::optional<std::string> RocksDBStorage::getRaw(const std::string& key) const
 		return std::nullopt;
 	}
     std::string raw_value;
+    point_reads_.fetch_add(1, std::memory_order_relaxed);
     rocksdb::Status status = db_->Get(read_opts_, key, &raw_value);
     if (status.IsNotFound()) { 
 		return std::nullopt;
@@ -131,6 +159,25 @@ std::optional<std::string> RocksDBStorage::getRaw(const std::string& key) const
     return raw_value;
 }
 
+std::vector<std::optional<std::string>> RocksDBStorage::multiGetRaw(const std::vector<std::string>& keys) const {
+    std::vector<std::optional<std::string>> results(keys.size());
+    if (!db_ || keys.empty()) { 
+		return results;
+	}
+    std::vector<rocksdb::Slice> slices(keys.begin(), keys.end());
+    std::vector<std::string> values;
+    point_reads_.fetch_add(keys.size(), std::memory_order_relaxed);
+    const auto statuses = db_->MultiGet(read_opts_, slices, &values);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (statuses[i].ok()) {
+            results[i] = std::move(values[i]);
+        } else if (!statuses[i].IsNotFound()) {
+            LOG_ERROR("[ROCKSDB] MULTI_GET_RAW failed for key '" + keys[i] + "': " + statuses[i].ToString());
+        }
+    }
+    return results;
+}
+
 bool RocksDBStorage::delRaw(const std::string& key) {
     if (!db_) { 
 		return false;
@@ -144,6 +191,52 @@ bool RocksDBStorage::delRaw(const std::string& key) {
 }
 
 bool RocksDBStorage::applyBatch(const std::vector<BatchOp>& ops) {
+    return writeBatch(ops, write_opts_);
+}
+
+bool RocksDBStorage::applyBatch(const std::vector<BatchOp>& ops, bool sync) {
+    rocksdb::WriteOptions write_opts;
+    write_opts.sync = sync;
+    return writeBatch(ops, write_opts);
+}
+
+bool RocksDBStorage::applyBatch(const std::vector<BatchOpView>& ops) {
+    return writeBatch(ops, write_opts_);
+}
+
+bool RocksDBStorage::applyBatch(const std::vector<BatchOpView>& ops, bool sync) {
+    rocksdb::WriteOptions write_opts;
+    write_opts.sync = sync;
+    return writeBatch(ops, write_opts);
+}
+
+bool RocksDBStorage::deletePrefixes(const std::vector<std::string>& prefixes) {
+    if (!db_ || prefixes.empty()) { 
+		return false;
+	}
+
+    rocksdb::WriteBatch batch;
+    for (const auto& prefix : prefixes) {
+        const std::string end = prefixSuccessor(prefix);
+        if (end.empty()) { 
+			LOG_ERROR("[ROCKSDB] deletePrefixes: prefix has no upper bound");
+			return false;
+		}
+        batch.DeleteRange(prefix, end);
+    }
+
+    rocksdb::WriteOptions write_opts;
+    write_opts.sync = true;
+    rocksdb::Status status = db_->Write(write_opts, &batch);
+    if (!status.ok()) {
+        LOG_ERROR("[ROCKSDB] deletePrefixes failed: " + status.ToString());
+        return false;
+    }
+    return true;
+}
+
+template <typename Op>
+bool RocksDBStorage::writeBatch(const std::vector<Op>& ops, const rocksdb::WriteOptions& write_opts) {
     if (!db_ || ops.empty()) { 
 		return false;
 	}
@@ -151,13 +244,13 @@ bool RocksDBStorage::applyBatch(const std::vector<BatchOp>& ops) {
     rocksdb::WriteBatch batch;
     for (const auto& op : ops) {
         if (op.type == BatchOp::Type::PUT) {
-            batch.Put(op.key, op.value);
+            batch.Put(rocksdb::Slice(op.key.data(), op.key.size()), rocksdb::Slice(op.value.data(), op.value.size()));
         } else {
-            batch.Delete(op.key);
+            batch.Delete(rocksdb::Slice(op.key.data(), op.key.size()));
         }
     }
     
-    rocksdb::Status status = db_->Write(write_opts_, &batch);
+    rocksdb::Status status = db_->Write(write_opts, &batch);
     if (!status.ok()) {
         LOG_ERROR("[ROCKSDB] applyBatch failed: " + status.ToString());
         return false;
@@ -188,6 +281,76 @@ void RocksDBStorage::iterateAll(std::function<void(const SecretEntry&)> callback
     }
 }
 
+void RocksDBStorage::iterateRange(const std::string& begin, const std::string& end,
+                                  const RawVisitor& callback) const {
+    if (!db_) {
+		return;
+	}
+
+    rocksdb::Slice upper_bound(end);
+    rocksdb::ReadOptions iter_opts = read_opts_;
+    iter_opts.fill_cache = false;
+    if (!end.empty()) {
+        iter_opts.iterate_upper_bound = &upper_bound;
+    }
+    std::unique_ptr<rocksdb::Iterator> it(db_->NewIterator(iter_opts));
+
+    for (it->Seek(begin); it->Valid(); it->Next()) {
+        rocksdb::Slice key = it->key();
+        rocksdb::Slice value = it->value();
+        callback(std::string_view(key.data(), key.size()), std::string_view(value.data(), value.size()));
+    }
+
+    if (!it->status().ok()) {
+        LOG_ERROR("[ROCKSDB] Range iterator error: " + it->status().ToString());
+    }
+}
+
+std::vector<std::string> RocksDBStorage::partitionPrefix(const std::string& prefix, size_t max_parts) const {
+    const std::string end = prefixSuccessor(prefix);
+    std::vector<std::string> boundaries{prefix};
+    max_parts = std::max<size_t>(max_parts, 1);
+
+    // Cut at SST smallest keys where the cumulative file size crosses k/max_parts
+    std::vector<std::pair<std::string, uint64_t>> file_starts;
+    uint64_t total_size = 0;
+    if (db_ && max_parts > 1) {
+        std::vector<rocksdb::LiveFileMetaData> files;
+        db_->GetLiveFilesMetaData(&files);
+        for (const auto& file : files) {
+            if (file.smallestkey > prefix && (end.empty() || file.smallestkey < end)) {
+                file_starts.emplace_back(file.smallestkey, file.size);
+                total_size += file.size;
+            }
+        }
+    }
+    std::sort(file_starts.begin(), file_starts.end());
+
+    uint64_t cumulative = 0;
+    for (const auto& [start_key, size] : file_starts) {
+        size_t part = boundaries.size();
+        if (part < max_parts && cumulative >= total_size * part / max_parts && start_key > boundaries.back()) {
+            boundaries.push_back(start_key);
+        }
+        cumulative += size;
+    }
+
+    if (boundaries.size() < max_parts) {
+        // Too few files to balance on: split the printable range of the next byte evenly.
+        // Keys outside it still land in the first or last range.
+        constexpr size_t first_printable = 0x21;
+        constexpr size_t printable_span = 0x7F - first_printable;
+        boundaries.assign(1, prefix);
+        for (size_t part = 1; part < max_parts; ++part) {
+            boundaries.push_back(prefix + static_cast<char>(first_printable + part * printable_span / max_parts));
+        }
+        boundaries.erase(std::unique(boundaries.begin(), boundaries.end()), boundaries.end());
+    }
+
+    boundaries.push_back(end);
+    return boundaries;
+}
+
 void RocksDBStorage::flush() {
     if (!db_) { 
 		return;
@@ -304,12 +467,23 @@ bool RocksDBStorage::del(const std::string&) {
 bool RocksDBStorage::putRaw(const std::string&, const std::string&) { return false; }
 std::optional<std::string> RocksDBStorage::getRaw(const std::string&) const { return std::nullopt; }
 bool RocksDBStorage::delRaw(const std::string&) { return false; }
+std::vector<std::optional<std::string>> RocksDBStorage::multiGetRaw(const std::vector<std::string>& keys) const {
+    return std::vector<std::optional<std::string>>(keys.size());
+}
 bool RocksDBStorage::applyBatch(const std::vector<BatchOp>&) { return false; }
+bool RocksDBStorage::applyBatch(const std::vector<BatchOp>&, bool) { return false; }
+bool RocksDBStorage::applyBatch(const std::vector<BatchOpView>&) { return false; }
+bool RocksDBStorage::applyBatch(const std::vector<BatchOpView>&, bool) { return false; }
+bool RocksDBStorage::deletePrefixes(const std::vector<std::string>&) { return false; }
 
 void RocksDBStorage::flush() {}
 void RocksDBStorage::set_sync(bool) {}
 bool RocksDBStorage::is_open() const { return false; }
 void RocksDBStorage::iterate_all(std::function<void(const SecretEntry&)>) const {}
+void RocksDBStorage::iterateRange(const std::string&, const std::string&, const RawVisitor&) const {}
+std::vector<std::string> RocksDBStorage::partitionPrefix(const std::string& prefix, size_t) const {
+    return {prefix, prefixSuccessor(prefix)};
+}
 
 std::string RocksDBStorage::serialize(const SecretEntry&) const { return ""; }
 SecretEntry RocksDBStorage::deserialize(const std::string&) const { return {}; }
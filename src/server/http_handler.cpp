@@ -6,10 +6,162 @@
 #include <sstream>
 #include <algorithm>
 #include <ctime>
+#include <optional>
 
 namespace kallisto {
 namespace server {
 
+namespace {
+
+// Requests naming more items than this are refused with 400
+constexpr size_t max_batch_items = 1000;
+
+// Value of a "name":"..." member (no escapes, like the rest of this parser)
+std::optional<std::string> stringField(const std::string& json, const std::string& name) {
+    auto pos = json.find("\"" + name + "\"");
+    if (pos == std::string::npos) {
+        return std::nullopt;
+    }
+    auto colon = json.find(':', pos);
+    auto quote1 = json.find('"', colon + 1);
+    auto quote2 = json.find('"', quote1 + 1);
+    if (colon == std::string::npos || quote1 == std::string::npos || quote2 == std::string::npos) {
+        return std::nullopt;
+    }
+    return json.substr(quote1 + 1, quote2 - quote1 - 1);
+}
+
+// Value of a "name":N member
+std::optional<uint32_t> uintField(const std::string& json, const std::string& name) {
+    auto pos = json.find("\"" + name + "\"");
+    if (pos == std::string::npos) {
+        return std::nullopt;
+    }
+    auto colon = json.find(':', pos);
+    auto end_pos = json.find_first_of(",}", colon + 1);
+    if (colon == std::string::npos || end_pos == std::string::npos) {
+        return std::nullopt;
+    }
+    std::string number = json.substr(colon + 1, end_pos - colon - 1);
+    number.erase(0, number.find_first_not_of(" \t\r\n"));
+    number.erase(number.find_last_not_of(" \t\r\n") + 1);
+    try {
+        return static_cast<uint32_t>(std::stoul(number));
+    } catch (...) {
+        return std::nullopt;
+    }
+}
+
+// Value of a "ttl":N member, or fallback
+uint32_t ttlField(const std::string& json, uint32_t fallback) {
+    return uintField(json, "ttl").value_or(fallback);
+}
+
+// Elements of a "name":[...] member: the quoted strings (open = '"'), or
+// the {...} objects (open = '{'). Strings and nesting are skipped whole, so
+// a ']' or '}' inside a value does not end an element or the array.
+std::optional<std::vector<std::string>> arrayField(const std::string& json, const std::string& name, char open) {
+    auto pos = json.find("\"" + name + "\"");
+    if (pos == std::string::npos) {
+        return std::nullopt;
+    }
+    auto begin = json.find('[', pos);
+    if (begin == std::string::npos) {
+        return std::nullopt;
+    }
+    std::vector<std::string> elements;
+    size_t start = 0; // Opening brace of the current object
+    int depth = 0;    // Nesting inside the current object
+    for (size_t at = begin + 1; at < json.size(); ++at) {
+        const char c = json[at];
+        if (c == '"') {
+            const size_t first = at;
+            for (++at; at < json.size() && json[at] != '"'; ++at) {
+                if (json[at] == '\\') {
+                    ++at;
+                }
+            }
+            if (at >= json.size()) {
+                return std::nullopt;
+            }
+            if (depth == 0) {
+                if (open != '"') {
+                    return std::nullopt;
+                }
+                elements.push_back(json.substr(first + 1, at - first - 1));
+            }
+        } else if (c == '{' || c == '[') {
+            if (depth == 0) {
+                if (c != open) {
+                    return std::nullopt;
+                }
+                start = at;
+            }
+            ++depth;
+        } else if (c == '}' || c == ']') {
+            if (depth == 0) {
+                if (c != ']') {
+                    return std::nullopt;
+                }
+                return elements;
+            }
+            if (--depth == 0) {
+                elements.push_back(json.substr(start, at - start + 1));
+            }
+        }
+    }
+    return std::nullopt; // Unterminated
+}
+
+// s as the contents of a JSON string
+std::string jsonEscape(std::string_view s) {
+    static constexpr char hex[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(s.size());
+    for (const char c : s) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out += "\\u00";
+                    out += hex[c >> 4];
+                    out += hex[c & 0xF];
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+// Engine key of an API path: the last segment is the key, the rest its directory
+std::string enginePath(const std::string& path) {
+    auto slash = path.find_last_of('/');
+    if (slash == std::string::npos) {
+        return "/" + path;
+    }
+    return path.substr(0, slash) + "/" + path.substr(slash + 1);
+}
+
+const char* errorText(engine::EngineError error) {
+    switch (error) {
+        case engine::EngineError::NotFound: return "not found";
+        case engine::EngineError::SoftDeleted: return "deleted";
+        case engine::EngineError::Destroyed: return "destroyed";
+        case engine::EngineError::InvalidVersion: return "invalid version";
+        case engine::EngineError::CasMismatch: return "check-and-set mismatch";
+        case engine::EngineError::QueueFull: return "queue full";
+        case engine::EngineError::StorageError: break;
+    }
+    return "storage error";
+}
+
+} // namespace
+
 // ---------------------------------------------------------------------------
 // Construction / Destruction
 // ---------------------------------------------------------------------------
@@ -17,10 +169,16 @@ namespace server {
 HttpHandler::HttpHandler(event::Dispatcher& dispatcher,
                          std::shared_ptr<KallistoCore> core)
     : dispatcher_(dispatcher)
-    , core_(std::move(core)) {
+    , core_(std::move(core))
+    , liveness_(std::make_shared<Liveness>()) {
+    liveness_->handler = this;
 }
 
 HttpHandler::~HttpHandler() {
+    {
+        std::lock_guard lock(liveness_->mutex);
+        liveness_->handler = nullptr;
+    }
     // Close all connections
     for (auto& [fd, conn] : connections_) {
         dispatcher_.removeFd(fd);
@@ -36,6 +194,7 @@ HttpHandler::~HttpHandler() {
 void HttpHandler::onNewConnection(int client_fd) {
     auto conn = std::make_unique<Connection>();
     conn->fd = client_fd;
+    conn->id = ++next_connection_id_;
     connections_[client_fd] = std::move(conn);
     
     // Register with epoll for reading
@@ -104,10 +263,16 @@ void HttpHandler::onReadable(int fd) {
         }
     }
     
+    processRequests(conn);
+}
+
+void HttpHandler::processRequests(Connection& conn) {
+    const int fd = conn.fd;
     // Process all complete requests in the buffer (HTTP pipelining support).
     // TCP may coalesce multiple HTTP requests into a single recv() call.
     // We must parse and handle each one, erasing only the consumed bytes.
-    while (!conn.read_buffer.empty()) {
+    // A parked response holds back the rest: responses go out in order.
+    while (!conn.read_buffer.empty() && !conn.awaiting_response) {
         auto req = parseRequest(conn.read_buffer);
         if (!req.valid) {
             break;  // Incomplete request — wait for more data
@@ -226,6 +391,11 @@ HttpHandler::HttpRequest HttpHandler::parseRequest(const std::string& buffer) {
             std::transform(lower_val.begin(), lower_val.end(), 
                            lower_val.begin(), ::tolower);
             req.keep_alive = (lower_val != "close");
+        } else if (lower_name == "x-kallisto-durable") {
+            std::string lower_val = value;
+            std::transform(lower_val.begin(), lower_val.end(), 
+                           lower_val.begin(), ::tolower);
+            req.durable = (lower_val == "true" || lower_val == "1");
         } else if (lower_name == "transfer-encoding") {
             // REJECT: We don't support chunked encoding (Quorum decision)
             req.valid = false;
@@ -258,6 +428,45 @@ HttpHandler::HttpRequest HttpHandler::parseRequest(const std::string& buffer) {
 
 void HttpHandler::handleRequest(Connection& conn, const HttpRequest& req) {
     conn.keep_alive = req.keep_alive;
+
+    // Route: /v1/sys/health (probes may append a query string)
+    if (req.method == "GET" && req.path.substr(0, req.path.find('?')) == "/v1/sys/health") {
+        handleHealth(conn);
+        return;
+    }
+    
+    // Route: /v1/secret/batch/{read,write}
+    if (req.path == "/v1/secret/batch/read" || req.path == "/v1/secret/batch/write") {
+        if (req.method != "POST") {
+            sendError(conn, 405, "Method Not Allowed");
+        } else if (req.path == "/v1/secret/batch/read") {
+            handleBatchRead(conn, req.body);
+        } else {
+            handleBatchWrite(conn, req.body);
+        }
+        return;
+    }
+    
+    // Route: /v1/secret/txn
+    if (req.path == "/v1/secret/txn") {
+        if (req.method != "POST") {
+            sendError(conn, 405, "Method Not Allowed");
+        } else {
+            handleTransaction(conn, req.body);
+        }
+        return;
+    }
+    
+    // Route: /v1/secret/prefix/:prefix
+    const std::string prefix_route = "/v1/secret/prefix/";
+    if (req.path.find(prefix_route) == 0) {
+        if (req.method != "DELETE") {
+            sendError(conn, 405, "Method Not Allowed");
+        } else {
+            handleDestroyPrefix(conn, req.path.substr(prefix_route.size()));
+        }
+        return;
+    }
     
     // Route: /v1/secret/data/:path
     const std::string prefix = "/v1/secret/data/";
@@ -272,7 +481,7 @@ void HttpHandler::handleRequest(Connection& conn, const HttpRequest& req) {
     if (req.method == "GET") {
         handleGetSecret(conn, secret_path);
     } else if (req.method == "POST") {
-        handlePutSecret(conn, secret_path, req.body);
+        handlePutSecret(conn, secret_path, req.body, req.durable);
     } else if (req.method == "DELETE") {
         handleDeleteSecret(conn, secret_path);
     } else {
@@ -299,60 +508,53 @@ void HttpHandler::handleGetSecret(Connection& conn, const std::string& path) {
         key = path.substr(slash + 1);
     }
     
-    auto result = core_->get(dir, key);
+    auto engine = core_->registry().resolve("secret");
+    if (!engine) {
+        sendError(conn, 500, "Secret engine not found");
+        return;
+    }
     
+    auto cached = engine->read_version_async(dir + "/" + key, 0,
+        [liveness = liveness_, fd = conn.fd, id = conn.id](engine::ReadResult result) {
+            postResponse(liveness, fd, id, [result = std::move(result)](HttpHandler& handler, Connection& parked) {
+                handler.sendSecret(parked, result);
+            });
+        });
+    if (cached) {
+        sendSecret(conn, *cached);
+        return;
+    }
+    // Cache miss: parked until the read I/O thread posts the result back
+    conn.awaiting_response = true;
+}
+
+void HttpHandler::sendSecret(Connection& conn, const engine::ReadResult& result) {
     if (!result.has_value()) {
-        sendError(conn, 404, "Secret not found");
+        if (result.error() == engine::EngineError::QueueFull) {
+            sendError(conn, 503, "Service Unavailable: Queue Full");
+        } else {
+            sendError(conn, 404, "Secret not found");
+        }
         return;
     }
     
-    auto& entry = result.value();
-    
-    // Vault-style JSON response
-    std::string json = "{\"data\":{\"data\":{\"value\":\"" + entry.value + "\"}},"
-                       "\"metadata\":{\"created_time\":" + 
-                       std::to_string(std::chrono::duration_cast<std::chrono::seconds>(
-                           entry.created_at.time_since_epoch()).count()) + "," +
-                       "\"ttl\":" + std::to_string(entry.ttl) + "}}";
+    // Vault-style JSON response (payloads carry no creation time)
+    std::string json = "{\"data\":{\"data\":{\"value\":\"" + result->value + "\"}},"
+                       "\"metadata\":{\"created_time\":0," +
+                       "\"ttl\":" + std::to_string(result->ttl) + "}}";
     
     sendResponse(conn, 200, "application/json", json);
 }
 
 void HttpHandler::handlePutSecret(Connection& conn, const std::string& path, 
-                                 const std::string& body) {
+                                 const std::string& body, bool durable) {
     if (path.empty() || body.empty()) {
         sendError(conn, 400, "Bad Request: Path and body required");
         return;
     }
     
-    std::string value;
-    uint32_t ttl = 3600;
-    
-    // Parse value
-    auto val_pos = body.find("\"value\"");
-    if (val_pos != std::string::npos) {
-        auto colon = body.find(':', val_pos);
-        auto quote1 = body.find('"', colon + 1);
-        auto quote2 = body.find('"', quote1 + 1);
-        if (quote1 != std::string::npos && quote2 != std::string::npos) {
-            value = body.substr(quote1 + 1, quote2 - quote1 - 1);
-        }
-    }
-    
-    // Parse ttl
-    auto ttl_pos = body.find("\"ttl\"");
-    if (ttl_pos != std::string::npos) {
-        auto colon = body.find(':', ttl_pos);
-        auto end_pos = body.find_first_of(",}", colon + 1);
-        if (colon != std::string::npos && end_pos != std::string::npos) {
-            std::string ttl_str = body.substr(colon + 1, end_pos - colon - 1);
-            ttl_str.erase(0, ttl_str.find_first_not_of(" \t\r\n"));
-            ttl_str.erase(ttl_str.find_last_not_of(" \t\r\n") + 1);
-            try {
-                ttl = std::stoul(ttl_str);
-            } catch (...) {}
-        }
-    }
+    std::string value = stringField(body, "value").value_or("");
+    uint32_t ttl = ttlField(body, 3600);
     
     if (value.empty()) { 
 		value = body;
@@ -373,9 +575,28 @@ void HttpHandler::handlePutSecret(Connection& conn, const std::string& path,
         return;
     }
     
-    auto res = engine->put_version(dir + "/" + key, payload);
+    tl::expected<engine::WriteTicket, engine::EngineError> res = engine::WriteTicket{};
+    if (durable) {
+        res = engine->put_version_durable(dir + "/" + key, payload);
+    } else if (auto put = engine->put_version(dir + "/" + key, payload); !put) {
+        res = tl::unexpected(put.error());
+    }
     
     if (res.has_value()) {
+        if (res->sequence != 0) {
+            // Parked until the flush carrying the write is fsynced
+            conn.awaiting_response = true;
+            engine->whenDurable(*res, [liveness = liveness_, fd = conn.fd, id = conn.id](bool was_durable) {
+                postResponse(liveness, fd, id, [was_durable](HttpHandler& handler, Connection& parked) {
+                    if (was_durable) {
+                        handler.sendResponse(parked, 200, "application/json", "{\"data\":{\"created\":true}}");
+                    } else {
+                        handler.sendError(parked, 500, "Failed to persist secret");
+                    }
+                });
+            });
+            return;
+        }
         sendResponse(conn, 200, "application/json", "{\"data\":{\"created\":true}}");
     } else {
         if (res.error() == engine::EngineError::QueueFull) {
@@ -386,6 +607,205 @@ void HttpHandler::handlePutSecret(Connection& conn, const std::string& path,
     }
 }
 
+void HttpHandler::handleBatchRead(Connection& conn, const std::string& body) {
+    auto paths = arrayField(body, "paths", '"');
+    if (!paths || paths->empty() || paths->size() > max_batch_items) {
+        sendError(conn, 400, "Bad Request: \"paths\" must list 1 to " + std::to_string(max_batch_items) + " paths");
+        return;
+    }
+    auto engine = core_ ? core_->registry().resolve("secret") : nullptr;
+    if (!engine) {
+        sendError(conn, 500, "Secret engine not found");
+        return;
+    }
+    
+    std::vector<std::string> keys;
+    keys.reserve(paths->size());
+    for (const auto& path : *paths) {
+        keys.push_back(enginePath(path));
+    }
+    auto cached = engine->read_many_async(keys,
+        [liveness = liveness_, fd = conn.fd, id = conn.id, paths = *paths](std::vector<engine::ReadResult> results) {
+            postResponse(liveness, fd, id,
+                [paths = std::move(paths), results = std::move(results)](HttpHandler& handler, Connection& parked) {
+                    handler.sendBatchRead(parked, paths, results);
+                });
+        });
+    if (cached) {
+        sendBatchRead(conn, *paths, *cached);
+        return;
+    }
+    // Some path missed the caches: parked like a single GET
+    conn.awaiting_response = true;
+}
+
+void HttpHandler::sendBatchRead(Connection& conn, const std::vector<std::string>& paths,
+                                const std::vector<engine::ReadResult>& results) {
+    // Per-path outcomes: the request itself succeeded
+    std::string json = "{\"data\":[";
+    for (size_t i = 0; i < paths.size(); ++i) {
+        json += i == 0 ? "{\"path\":\"" : ",{\"path\":\"";
+        json += jsonEscape(paths[i]) + "\",";
+        if (results[i]) {
+            json += "\"value\":\"" + jsonEscape(results[i]->value) + "\",\"ttl\":" + std::to_string(results[i]->ttl) + "}";
+        } else {
+            json += "\"error\":\"" + std::string(errorText(results[i].error())) + "\"}";
+        }
+    }
+    json += "]}";
+    sendResponse(conn, 200, "application/json", json);
+}
+
+void HttpHandler::handleBatchWrite(Connection& conn, const std::string& body) {
+    auto secrets = arrayField(body, "secrets", '{');
+    if (!secrets || secrets->empty() || secrets->size() > max_batch_items) {
+        sendError(conn, 400, "Bad Request: \"secrets\" must list 1 to " + std::to_string(max_batch_items) + " secrets");
+        return;
+    }
+    std::vector<std::string> paths;
+    std::vector<engine::PathPayload> items;
+    paths.reserve(secrets->size());
+    items.reserve(secrets->size());
+    for (const auto& secret : *secrets) {
+        auto path = stringField(secret, "path");
+        auto value = stringField(secret, "value");
+        if (!path || path->empty() || !value) {
+            sendError(conn, 400, "Bad Request: every secret needs a path and a value");
+            return;
+        }
+        items.emplace_back(enginePath(*path), engine::SecretPayload{*value, ttlField(secret, 3600)});
+        paths.push_back(std::move(*path));
+    }
+    auto engine = core_ ? core_->registry().resolve("secret") : nullptr;
+    if (!engine) {
+        sendError(conn, 500, "Secret engine not found");
+        return;
+    }
+    
+    auto results = engine->put_many(items);
+    std::string json = "{\"data\":[";
+    for (size_t i = 0; i < paths.size(); ++i) {
+        json += i == 0 ? "{\"path\":\"" : ",{\"path\":\"";
+        json += jsonEscape(paths[i]) + "\",";
+        if (results[i]) {
+            json += "\"created\":true}";
+        } else {
+            json += "\"error\":\"" + std::string(errorText(results[i].error())) + "\"}";
+        }
+    }
+    json += "]}";
+    sendResponse(conn, 200, "application/json", json);
+}
+
+void HttpHandler::handleTransaction(Connection& conn, const std::string& body) {
+    auto steps = arrayField(body, "ops", '{');
+    if (!steps || steps->empty() || steps->size() > max_batch_items) {
+        sendError(conn, 400, "Bad Request: \"ops\" must list 1 to " + std::to_string(max_batch_items) + " operations");
+        return;
+    }
+    std::vector<engine::TxnOp> ops;
+    ops.reserve(steps->size());
+    for (const auto& step : *steps) {
+        auto kind = stringField(step, "op");
+        auto path = stringField(step, "path");
+        if (!kind || !path || path->empty()) {
+            sendError(conn, 400, "Bad Request: every operation needs an op and a path");
+            return;
+        }
+        engine::TxnOp op;
+        op.path = enginePath(*path);
+        op.cas = uintField(step, "cas");
+        if (*kind == "put") {
+            auto value = stringField(step, "value");
+            if (!value) {
+                sendError(conn, 400, "Bad Request: a put needs a value");
+                return;
+            }
+            op.type = engine::TxnOp::Type::PUT;
+            op.payload = engine::SecretPayload{*value, ttlField(step, 3600)};
+        } else if (*kind == "delete") {
+            op.type = engine::TxnOp::Type::DELETE;
+        } else if (*kind == "check" && op.cas) {
+            op.type = engine::TxnOp::Type::CHECK;
+        } else {
+            sendError(conn, 400, "Bad Request: op must be put, delete or check (with a cas)");
+            return;
+        }
+        ops.push_back(std::move(op));
+    }
+    auto engine = core_ ? core_->registry().resolve("secret") : nullptr;
+    if (!engine) {
+        sendError(conn, 500, "Secret engine not found");
+        return;
+    }
+    
+    const size_t op_count = ops.size();
+    auto settled = engine->transact_async(std::move(ops),
+        [liveness = liveness_, fd = conn.fd, id = conn.id, op_count](engine::TxnResult result) {
+            postResponse(liveness, fd, id, [op_count, result = std::move(result)](HttpHandler& handler, Connection& parked) {
+                handler.sendTransaction(parked, op_count, result);
+            });
+        });
+    if (settled) {
+        sendTransaction(conn, op_count, *settled);
+        return;
+    }
+    // Parked until the commit's fsync: the worker goes on serving other connections
+    conn.awaiting_response = true;
+}
+
+void HttpHandler::sendTransaction(Connection& conn, size_t op_count, const engine::TxnResult& res) {
+    if (res) {
+        sendResponse(conn, 200, "application/json", "{\"data\":{\"committed\":true}}");
+        return;
+    }
+    // Nothing was written: name the step that failed
+    int status = 500;
+    switch (res.error().error) {
+        case engine::EngineError::CasMismatch: status = 409; break;
+        case engine::EngineError::NotFound: status = 404; break;
+        case engine::EngineError::QueueFull: status = 503; break;
+        default: break;
+    }
+    const std::string step = res.error().op < op_count ? "op " + std::to_string(res.error().op) : "commit";
+    sendError(conn, status, "Transaction aborted at " + step + ": " + errorText(res.error().error));
+}
+
+void HttpHandler::postResponse(const std::shared_ptr<Liveness>& liveness, int fd,
+                               uint64_t connection_id, Respond respond) {
+    // Called from engine threads (or inline): only this worker touches the connection
+    std::lock_guard lock(liveness->mutex);
+    if (!liveness->handler) { 
+		return;
+	}
+    liveness->handler->dispatcher_.post([liveness, fd, connection_id, respond = std::move(respond)]() {
+        HttpHandler* handler;
+        {
+            std::lock_guard handler_lock(liveness->mutex);
+            handler = liveness->handler;
+        }
+        if (handler) {
+            handler->completeParked(fd, connection_id, respond);
+        }
+    });
+}
+
+void HttpHandler::completeParked(int fd, uint64_t connection_id, const Respond& respond) {
+    auto it = connections_.find(fd);
+    if (it == connections_.end() || it->second->id != connection_id) {
+        return;  // Client went away while the engine worked
+    }
+    
+    auto& conn = *it->second;
+    conn.awaiting_response = false;
+    respond(*this, conn);
+    
+    // Resume the pipelined requests held back by this one
+    if (connections_.find(fd) != connections_.end()) {
+        processRequests(conn);
+    }
+}
+
 void HttpHandler::handleDeleteSecret(Connection& conn, const std::string& path) {
     if (!core_) { 
 		return;
@@ -403,6 +823,58 @@ void HttpHandler::handleDeleteSecret(Connection& conn, const std::string& path)
     sendResponse(conn, 204, "", "");
 }
 
+void HttpHandler::handleDestroyPrefix(Connection& conn, const std::string& prefix) {
+    if (!core_) {
+        sendError(conn, 500, "Core not initialized");
+        return;
+    }
+    if (prefix.empty()) {
+        sendError(conn, 400, "Bad Request: empty prefix");
+        return;
+    }
+    
+    auto settled = core_->destroyPrefixAsync(prefix,
+        [liveness = liveness_, fd = conn.fd, id = conn.id](engine::KvEngine::DestroyResult destroyed) {
+            postResponse(liveness, fd, id, [destroyed](HttpHandler& handler, Connection& parked) {
+                handler.sendDestroyed(parked, destroyed);
+            });
+        });
+    if (settled) {
+        sendDestroyed(conn, *settled);
+        return;
+    }
+    // Parked while the engine waits for recovery, holds off writers and fsyncs
+    conn.awaiting_response = true;
+}
+
+void HttpHandler::sendDestroyed(Connection& conn, const engine::KvEngine::DestroyResult& destroyed) {
+    if (!destroyed) {
+        const int status = destroyed.error() == engine::EngineError::QueueFull ? 503 : 500;
+        sendError(conn, status, "Failed to destroy prefix");
+        return;
+    }
+    sendResponse(conn, 200, "application/json", "{\"data\":{\"destroyed\":" + std::to_string(*destroyed) + "}}");
+}
+
+void HttpHandler::handleHealth(Connection& conn) {
+    if (!core_) {
+        sendError(conn, 500, "Core not initialized");
+        return;
+    }
+
+    // Reads and writes are served either way; while warming, reads that miss
+    // the cache go to RocksDB. 429 follows Vault's "up but not active" code so
+    // load balancers keep this node at a low weight until it is ready.
+    auto status = core_->warmupStatus();
+    std::ostringstream json;
+    json << "{\"initialized\":true,\"sealed\":false,\"standby\":false"
+         << ",\"warming\":" << (status.ready ? "false" : "true")
+         << ",\"warmup_progress\":" << status.progress()
+         << ",\"recovered_paths\":" << status.paths << "}";
+
+    sendResponse(conn, status.ready ? 200 : 429, "application/json", json.str());
+}
+
 // ---------------------------------------------------------------------------
 // HTTP Response Helpers
 // ---------------------------------------------------------------------------
@@ -461,7 +933,10 @@ std::string HttpHandler::statusText(int code) {
         case 400: return "Bad Request";
         case 404: return "Not Found";
         case 405: return "Method Not Allowed";
+        case 409: return "Conflict";
+        case 429: return "Too Many Requests";
         case 500: return "Internal Server Error";
+        case 503: return "Service Unavailable";
         default: return "Unknown";
     }
 }
@@ -5,6 +5,9 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include "kallisto/server/http_handler.hpp"
 #include "kallisto/event/dispatcher.hpp"
 #include "kallisto/kallisto_core.hpp"
@@ -32,6 +35,11 @@ protected:
                         std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
         core_ = std::make_shared<KallistoCore>(test_db_path_);
         handler_ = std::make_unique<HttpHandler>(dispatcher_, core_);
+        // Engine threads post parked responses back; runPosted() plays the event loop
+        ON_CALL(dispatcher_, post(testing::_)).WillByDefault([this](event::Dispatcher::PostCb cb) {
+            std::lock_guard lock(posted_mutex_);
+            posted_.push_back(std::move(cb));
+        });
     }
 
     void TearDown() override {
@@ -51,8 +59,25 @@ protected:
         fcntl(client_side, F_SETFL, O_NONBLOCK);
     }
 
+    // Waits for the engine to post at least one callback, then runs them all
+    size_t runPosted() {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        std::vector<event::Dispatcher::PostCb> ready;
+        while (ready.empty() && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            std::lock_guard lock(posted_mutex_);
+            ready.swap(posted_);
+        }
+        for (auto& cb : ready) {
+            cb();
+        }
+        return ready.size();
+    }
+
     std::string test_db_path_;
     MockDispatcher dispatcher_;
+    std::mutex posted_mutex_;
+    std::vector<event::Dispatcher::PostCb> posted_;
     std::shared_ptr<KallistoCore> core_;
     std::unique_ptr<HttpHandler> handler_;
 };
@@ -134,6 +159,28 @@ TEST_F(HttpHandlerTest, Handle404OnInvalidPath) {
     close(srv); close(cli);
 }
 
+TEST_F(HttpHandlerTest, HealthReportsReadyAfterRecovery) {
+    int srv, cli;
+    createSocketPair(srv, cli);
+    event::Dispatcher::FdCb captured_cb;
+    EXPECT_CALL(dispatcher_, addFd(srv, testing::_, testing::_)).WillOnce(testing::SaveArg<2>(&captured_cb));
+    handler_->onNewConnection(srv);
+
+    // Load balancer probes may carry a query string
+    std::string req = "GET /v1/sys/health?standbyok=true HTTP/1.1\r\nConnection: close\r\n\r\n";
+    send(cli, req.data(), req.size(), 0);
+    captured_cb(EPOLLIN);
+
+    char buf[4096];
+    ssize_t n = recv(cli, buf, sizeof(buf), 0);
+    ASSERT_GT(n, 0);
+    std::string res(buf, n);
+    EXPECT_THAT(res, testing::HasSubstr("200 OK"));
+    EXPECT_THAT(res, testing::HasSubstr("\"warming\":false"));
+    EXPECT_THAT(res, testing::HasSubstr("\"warmup_progress\":1"));
+    close(srv); close(cli);
+}
+
 TEST_F(HttpHandlerTest, Handle405OnInvalidMethod) {
     int srv, cli;
     createSocketPair(srv, cli);
@@ -169,6 +216,7 @@ TEST_F(HttpHandlerTest, HandlesPartialRequests) {
     std::string part2 = "rod/db HTTP/1.1\r\nConnection: close\r\n\r\n";
     send(cli, part2.data(), part2.size(), 0);
     captured_cb(EPOLLIN); // Now complete
+    ASSERT_EQ(runPosted(), 1u); // Cache miss: answered from a read I/O thread
     
     ssize_t n = recv(cli, buf, sizeof(buf), 0);
     ASSERT_GT(n, 0);
@@ -224,3 +272,262 @@ TEST_F(HttpHandlerTest, RejectsExpect100With400) {
     EXPECT_EQ(handler_->activeConnections(), 1);
     close(srv); close(cli);
 }
+
+TEST_F(HttpHandlerTest, DurableWriteIsParkedUntilFlushed) {
+    // Problem: In BATCH mode a POST with X-Kallisto-Durable is answered only
+    // once the write-behind flush carrying it is on disk. The flusher posts
+    // the completion back to this dispatcher; a request pipelined behind the
+    // parked one must not overtake it.
+    core_->changeSyncMode(KallistoCore::SyncMode::BATCH);
+    int srv, cli;
+    createSocketPair(srv, cli);
+    event::Dispatcher::FdCb captured_cb;
+    EXPECT_CALL(dispatcher_, addFd(srv, testing::_, testing::_)).WillOnce(testing::SaveArg<2>(&captured_cb));
+    handler_->onNewConnection(srv);
+    
+    std::string body = "{\"value\":\"durable_val\"}";
+    std::string req = "POST /v1/secret/data/app/durable HTTP/1.1\r\nX-Kallisto-Durable: true\r\n"
+                      "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body +
+                      "GET /v1/secret/data/app/durable HTTP/1.1\r\n\r\n";
+    send(cli, req.data(), req.size(), 0);
+    captured_cb(EPOLLIN);
+    
+    char buf[4096];
+    EXPECT_LT(recv(cli, buf, sizeof(buf), 0), 0); // Nothing sent yet
+    ASSERT_EQ(runPosted(), 1u);
+    
+    std::string res;
+    ssize_t n;
+    while ((n = recv(cli, buf, sizeof(buf), 0)) > 0) {
+        res.append(buf, n);
+    }
+    auto created = res.find("{\"data\":{\"created\":true}}");
+    auto read = res.find("durable_val");
+    ASSERT_NE(created, std::string::npos);
+    ASSERT_NE(read, std::string::npos);
+    EXPECT_LT(created, read);
+    EXPECT_EQ(res.find("HTTP/1.1 200 OK"), 0u);
+    close(srv); close(cli);
+}
+
+TEST_F(HttpHandlerTest, ColdReadIsParkedNotBlocking) {
+    // Problem: After a restart the caches are empty and a GET must read
+    // RocksDB. The worker must not do that read itself: the request is
+    // parked, the engine's read I/O thread posts the result back, and a
+    // request pipelined behind it is answered after it.
+    core_->put("cold", "db", "from_disk", 3600);
+    handler_.reset();
+    core_.reset();
+    core_ = std::make_shared<KallistoCore>(test_db_path_);
+    handler_ = std::make_unique<HttpHandler>(dispatcher_, core_);
+    
+    int srv, cli;
+    createSocketPair(srv, cli);
+    event::Dispatcher::FdCb captured_cb;
+    EXPECT_CALL(dispatcher_, addFd(srv, testing::_, testing::_)).WillOnce(testing::SaveArg<2>(&captured_cb));
+    handler_->onNewConnection(srv);
+    
+    std::string req = "GET /v1/secret/data/cold/db HTTP/1.1\r\n\r\n"
+                      "GET /v1/secret/data/cold/none HTTP/1.1\r\n\r\n";
+    send(cli, req.data(), req.size(), 0);
+    captured_cb(EPOLLIN);
+    
+    char buf[4096];
+    EXPECT_LT(recv(cli, buf, sizeof(buf), 0), 0); // Parked: nothing sent yet
+    // The first read, then the second (also a miss) once the first is answered
+    ASSERT_EQ(runPosted(), 1u);
+    ASSERT_EQ(runPosted(), 1u);
+    
+    std::string res;
+    ssize_t n;
+    while ((n = recv(cli, buf, sizeof(buf), 0)) > 0) {
+        res.append(buf, n);
+    }
+    auto found = res.find("from_disk");
+    auto missing = res.find("404 Not Found");
+    ASSERT_NE(found, std::string::npos);
+    ASSERT_NE(missing, std::string::npos);
+    EXPECT_LT(found, missing);
+    EXPECT_EQ(res.find("HTTP/1.1 200 OK"), 0u);
+    close(srv); close(cli);
+}
+
+TEST_F(HttpHandlerTest, BatchWriteThenBatchRead) {
+    // Problem: Seeding or loading many secrets took one request per path.
+    // The batch routes take a list and answer one entry per item, in order,
+    // errors included; a batch read that misses the caches is parked.
+    int srv, cli;
+    createSocketPair(srv, cli);
+    event::Dispatcher::FdCb captured_cb;
+    EXPECT_CALL(dispatcher_, addFd(srv, testing::_, testing::_)).WillOnce(testing::SaveArg<2>(&captured_cb));
+    handler_->onNewConnection(srv);
+    
+    std::string body = "{\"secrets\":[{\"path\":\"svc/user\",\"value\":\"admin\",\"ttl\":60},"
+                       "{\"path\":\"svc/pass\",\"value\":\"hunter2\"}]}";
+    std::string req = "POST /v1/secret/batch/write HTTP/1.1\r\nContent-Length: " + std::to_string(body.size()) +
+                      "\r\n\r\n" + body;
+    send(cli, req.data(), req.size(), 0);
+    captured_cb(EPOLLIN);
+    
+    char buf[4096];
+    ssize_t n = recv(cli, buf, sizeof(buf), 0);
+    ASSERT_GT(n, 0);
+    std::string res(buf, n);
+    EXPECT_THAT(res, testing::HasSubstr("200 OK"));
+    EXPECT_THAT(res, testing::HasSubstr("{\"data\":[{\"path\":\"svc/user\",\"created\":true},"
+                                        "{\"path\":\"svc/pass\",\"created\":true}]}"));
+    
+    // Written values are cached: answered in place
+    body = "{\"paths\":[\"svc/pass\",\"svc/none\",\"svc/user\"]}";
+    req = "POST /v1/secret/batch/read HTTP/1.1\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+    send(cli, req.data(), req.size(), 0);
+    captured_cb(EPOLLIN);
+    ASSERT_EQ(runPosted(), 1u); // svc/none is not cached: read on an I/O thread
+    
+    res.clear();
+    while ((n = recv(cli, buf, sizeof(buf), 0)) > 0) {
+        res.append(buf, n);
+    }
+    EXPECT_THAT(res, testing::HasSubstr("200 OK"));
+    EXPECT_THAT(res, testing::HasSubstr("{\"data\":[{\"path\":\"svc/pass\",\"value\":\"hunter2\",\"ttl\":3600},"
+                                        "{\"path\":\"svc/none\",\"error\":\"not found\"},"
+                                        "{\"path\":\"svc/user\",\"value\":\"admin\",\"ttl\":60}]}"));
+    
+    // Malformed: no list
+    body = "{\"paths\":\"svc/user\"}";
+    req = "POST /v1/secret/batch/read HTTP/1.1\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+    send(cli, req.data(), req.size(), 0);
+    captured_cb(EPOLLIN);
+    n = recv(cli, buf, sizeof(buf), 0);
+    ASSERT_GT(n, 0);
+    EXPECT_THAT(std::string(buf, n), testing::HasSubstr("400 Bad Request"));
+    close(srv); close(cli);
+}
+
+TEST_F(HttpHandlerTest, BatchBodiesAreParsedAndEscapedAsJson) {
+    // Problem: the list parser ended an element at the first ']' or '}', even
+    // inside a value, and batch answers pasted paths and values in unescaped.
+    int srv, cli;
+    createSocketPair(srv, cli);
+    event::Dispatcher::FdCb captured_cb;
+    EXPECT_CALL(dispatcher_, addFd(srv, testing::_, testing::_)).WillOnce(testing::SaveArg<2>(&captured_cb));
+    handler_->onNewConnection(srv);
+
+    std::string body = "{\"secrets\":[{\"path\":\"svc/a\",\"value\":\"x]}y\"},{\"path\":\"svc/b\",\"value\":\"[{\"}]}";
+    std::string req = "POST /v1/secret/batch/write HTTP/1.1\r\nContent-Length: " + std::to_string(body.size()) +
+                      "\r\n\r\n" + body;
+    send(cli, req.data(), req.size(), 0);
+    captured_cb(EPOLLIN);
+    char buf[4096];
+    ssize_t n = recv(cli, buf, sizeof(buf), 0);
+    ASSERT_GT(n, 0);
+    EXPECT_THAT(std::string(buf, n), testing::HasSubstr("{\"path\":\"svc/a\",\"created\":true},"
+                                                        "{\"path\":\"svc/b\",\"created\":true}"));
+    auto a = core_->get("svc", "a");
+    ASSERT_TRUE(a.has_value());
+    EXPECT_EQ(a->value, "x]}y");
+
+    core_->put("svc", "quoted", "say \"hi\"\\\n\x01", 60);
+    body = "{\"paths\":[\"svc/quoted\",\"svc/b\"]}";
+    req = "POST /v1/secret/batch/read HTTP/1.1\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+    send(cli, req.data(), req.size(), 0);
+    captured_cb(EPOLLIN);
+    n = recv(cli, buf, sizeof(buf), 0);
+    ASSERT_GT(n, 0);
+    EXPECT_THAT(std::string(buf, n), testing::HasSubstr("{\"path\":\"svc/quoted\",\"value\":\"say \\\"hi\\\"\\\\\\n\\u0001\",\"ttl\":60},"
+                                                        "{\"path\":\"svc/b\",\"value\":\"[{\",\"ttl\":3600}"));
+
+    // An unterminated list is refused
+    body = "{\"paths\":[\"svc/a\"";
+    req = "POST /v1/secret/batch/read HTTP/1.1\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+    send(cli, req.data(), req.size(), 0);
+    captured_cb(EPOLLIN);
+    n = recv(cli, buf, sizeof(buf), 0);
+    ASSERT_GT(n, 0);
+    EXPECT_THAT(std::string(buf, n), testing::HasSubstr("400 Bad Request"));
+    close(srv); close(cli);
+}
+
+TEST_F(HttpHandlerTest, TransactionCommitsAllOrNothing) {
+    // Problem: Rotating a credential pair took one request per secret, and
+    // a failure in between left half of it. POST /v1/secret/txn commits a
+    // list of puts, deletes and checks together, or answers which step failed.
+    // The commit runs on an engine thread: the connection is parked meanwhile.
+    int srv, cli;
+    createSocketPair(srv, cli);
+    event::Dispatcher::FdCb captured_cb;
+    EXPECT_CALL(dispatcher_, addFd(srv, testing::_, testing::_)).WillOnce(testing::SaveArg<2>(&captured_cb));
+    handler_->onNewConnection(srv);
+    
+    auto post = [&](const std::string& body, bool parked = true) {
+        std::string req = "POST /v1/secret/txn HTTP/1.1\r\nContent-Length: " + std::to_string(body.size()) +
+                          "\r\n\r\n" + body;
+        send(cli, req.data(), req.size(), 0);
+        captured_cb(EPOLLIN);
+        if (parked) {
+            EXPECT_EQ(runPosted(), 1u);
+        }
+        char buf[4096];
+        ssize_t n = recv(cli, buf, sizeof(buf), 0);
+        return n > 0 ? std::string(buf, n) : std::string();
+    };
+    
+    auto res = post("{\"ops\":[{\"op\":\"put\",\"path\":\"db/user\",\"value\":\"admin\",\"cas\":0},"
+                    "{\"op\":\"put\",\"path\":\"db/pass\",\"value\":\"s3cret\",\"ttl\":60}]}");
+    EXPECT_THAT(res, testing::HasSubstr("200 OK"));
+    EXPECT_THAT(res, testing::HasSubstr("{\"data\":{\"committed\":true}}"));
+    
+    // db/user is at version 1 now: the check fails and the put is not applied
+    res = post("{\"ops\":[{\"op\":\"put\",\"path\":\"db/pass\",\"value\":\"rotated\"},"
+               "{\"op\":\"check\",\"path\":\"db/user\",\"cas\":0}]}");
+    EXPECT_THAT(res, testing::HasSubstr("409 Conflict"));
+    EXPECT_THAT(res, testing::HasSubstr("Transaction aborted at op 1: check-and-set mismatch"));
+    auto engine = core_->registry().resolve("secret");
+    EXPECT_EQ(engine->read_version("db/pass")->value, "s3cret");
+    
+    res = post("{\"ops\":[{\"op\":\"put\",\"path\":\"db/pass\",\"value\":\"rotated\",\"cas\":1},"
+               "{\"op\":\"delete\",\"path\":\"db/user\"}]}");
+    EXPECT_THAT(res, testing::HasSubstr("200 OK"));
+    EXPECT_EQ(engine->read_version("db/pass")->value, "rotated");
+    EXPECT_EQ(engine->read_version("db/user").error(), engine::EngineError::Destroyed);
+    
+    // A check without a condition is refused
+    res = post("{\"ops\":[{\"op\":\"check\",\"path\":\"db/user\"}]}", false);
+    EXPECT_THAT(res, testing::HasSubstr("400 Bad Request"));
+    close(srv); close(cli);
+}
+
+TEST_F(HttpHandlerTest, DestroyPrefixDeletesTheSubtree) {
+    // Problem: Decommissioning an app took one DELETE per secret.
+    // DELETE /v1/secret/prefix/<prefix> destroys every path under it at once.
+    int srv, cli;
+    createSocketPair(srv, cli);
+    event::Dispatcher::FdCb captured_cb;
+    EXPECT_CALL(dispatcher_, addFd(srv, testing::_, testing::_)).WillOnce(testing::SaveArg<2>(&captured_cb));
+    handler_->onNewConnection(srv);
+    
+    core_->put("apps/old", "user", "admin", 3600);
+    core_->put("apps/old/db", "pass", "secret", 3600);
+    core_->put("apps/older", "user", "admin", 3600);
+    
+    std::string req = "DELETE /v1/secret/prefix/apps/old/ HTTP/1.1\r\n\r\n";
+    send(cli, req.data(), req.size(), 0);
+    captured_cb(EPOLLIN);
+    ASSERT_EQ(runPosted(), 1u); // Destroyed on the engine's write pool
+    char buf[4096];
+    ssize_t n = recv(cli, buf, sizeof(buf), 0);
+    ASSERT_GT(n, 0);
+    std::string res(buf, n);
+    EXPECT_THAT(res, testing::HasSubstr("200 OK"));
+    EXPECT_THAT(res, testing::HasSubstr("{\"data\":{\"destroyed\":2}}"));
+    EXPECT_FALSE(core_->get("apps/old/db", "pass").has_value());
+    EXPECT_TRUE(core_->get("apps/older", "user").has_value());
+    
+    req = "GET /v1/secret/prefix/apps/ HTTP/1.1\r\n\r\n";
+    send(cli, req.data(), req.size(), 0);
+    captured_cb(EPOLLIN);
+    n = recv(cli, buf, sizeof(buf), 0);
+    ASSERT_GT(n, 0);
+    EXPECT_THAT(std::string(buf, n), testing::HasSubstr("405 Method Not Allowed"));
+    close(srv); close(cli);
+}
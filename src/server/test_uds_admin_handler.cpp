@@ -105,7 +105,31 @@ TEST_F(UdsAdminTest, WhitespaceTolerance) {
     EXPECT_EQ(resp, "OK: Mode changed to BATCH.\n");
 }
 
-// Test 4: Resource Cleanup (Zombie Socket Prevention)
+// Test 4: COMPACT reports how many versions it pruned
+TEST_F(UdsAdminTest, CompactReportsPrunedVersions) {
+    handler = std::make_unique<UdsAdminHandler>(core, socket_path);
+    handler->start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    // Every write already trims to the mount limit, so nothing is left over
+    core->put("app", "key", "value");
+    std::string resp = sendCommand("COMPACT");
+    EXPECT_EQ(resp, "OK: Pruned 0 versions.\n");
+}
+
+// Test 5: STATS reports the write-behind flusher
+TEST_F(UdsAdminTest, StatsReportsFlusher) {
+    handler = std::make_unique<UdsAdminHandler>(core, socket_path);
+    handler->start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    std::string resp = sendCommand("STATS");
+    EXPECT_EQ(resp.rfind("OK: Write-behind flusher\n", 0), 0u);
+    EXPECT_NE(resp.find("lag (us):"), std::string::npos);
+    EXPECT_LT(resp.size(), 1023u); // Fits the CLI's single recv
+}
+
+// Test 6: Resource Cleanup (Zombie Socket Prevention)
 TEST_F(UdsAdminTest, ResourceCleanup) {
     handler = std::make_unique<UdsAdminHandler>(core, socket_path);
     handler->start();
@@ -117,3 +141,21 @@ TEST_F(UdsAdminTest, ResourceCleanup) {
     // After stop, the file should be unlinked
     EXPECT_FALSE(std::filesystem::exists(socket_path));
 }
+
+// Test 7: DESTROY_PREFIX reports how many paths it destroyed
+TEST_F(UdsAdminTest, DestroyPrefixReportsDestroyedPaths) {
+    handler = std::make_unique<UdsAdminHandler>(core, socket_path);
+    handler->start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    core->put("apps/old", "user", "admin");
+    core->put("apps/old", "pass", "secret");
+    core->put("apps/new", "user", "admin");
+    std::string resp = sendCommand("DESTROY_PREFIX apps/old/");
+    EXPECT_EQ(resp, "OK: Destroyed 2 paths.\n");
+    EXPECT_FALSE(core->get("apps/old", "user").has_value());
+    EXPECT_TRUE(core->get("apps/new", "user").has_value());
+
+    // No prefix: not a command
+    EXPECT_EQ(sendCommand("DESTROY_PREFIX "), "UNKNOWN COMMAND\n");
+}
@@ -102,6 +102,25 @@ void UdsAdminHandler::acceptLoop() {
     }
 }
 
+namespace {
+
+std::string formatFlushStats(const engine::FlushStats& stats) {
+    auto triple = [](uint64_t p50, uint64_t p99, uint64_t max) {
+        return std::to_string(p50) + " / " + std::to_string(p99) + " / " + std::to_string(max);
+    };
+    return "OK: Write-behind flusher\n"
+           "  flushes:           " + std::to_string(stats.flushes) + " (" + std::to_string(stats.records) + " records)\n"
+           "  batch limit:       " + std::to_string(stats.batch_limit) + "\n"
+           "  flush window:      " + std::to_string(stats.window_us) + " us\n"
+           "  arrival rate:      " + std::to_string(static_cast<uint64_t>(stats.arrival_rate)) + " records/s\n"
+           "  write latency:     " + std::to_string(stats.write_latency_us) + " us\n"
+           "  queue depth:       " + triple(stats.queue_depth_p50, stats.queue_depth_p99, stats.queue_depth_max) + " (p50 / p99 / max)\n"
+           "  batch size:        " + triple(stats.batch_size_p50, stats.batch_size_p99, stats.batch_size_max) + "\n"
+           "  lag (us):          " + triple(stats.lag_p50_us, stats.lag_p99_us, stats.lag_max_us) + "\n";
+}
+
+} // namespace
+
 void UdsAdminHandler::handleClient(int client_fd) {
     char buf[1024];
     ssize_t bytes = ::recv(client_fd, buf, sizeof(buf) - 1, 0);
@@ -131,6 +150,21 @@ void UdsAdminHandler::handleClient(int client_fd) {
         core_->changeSyncMode(KallistoCore::SyncMode::IMMEDIATE);
         kallisto::info("[UDS Admin] Sync mode changed to IMMEDIATE.");
         response = "OK: Mode changed to IMMEDIATE.\n";
+    } else if (cmd == "COMPACT") {
+        size_t pruned = core_->compactVersionHistory();
+        kallisto::info("[UDS Admin] Version history compacted, pruned " + std::to_string(pruned) + " versions.");
+        response = "OK: Pruned " + std::to_string(pruned) + " versions.\n";
+    } else if (cmd.rfind("DESTROY_PREFIX ", 0) == 0) {
+        const std::string prefix = cmd.substr(cmd.find_first_not_of(' ', 15));
+        auto destroyed = core_->destroyPrefix(prefix);
+        if (destroyed) {
+            kallisto::info("[UDS Admin] Destroyed " + std::to_string(*destroyed) + " paths under " + prefix);
+            response = "OK: Destroyed " + std::to_string(*destroyed) + " paths.\n";
+        } else {
+            response = "ERROR: Prefix not destroyed.\n";
+        }
+    } else if (cmd == "STATS") {
+        response = formatFlushStats(core_->flushStats());
     }
 
     ::send(client_fd, response.c_str(), response.size(), 0);
@@ -25,16 +25,28 @@ ShardedCuckooTable::ShardedCuckooTable(size_t total_capacity) {
   }
 }
 
-bool ShardedCuckooTable::insert(const std::string& key, const SecretEntry& entry) {
-  return getShard(key)->insert(key, entry);
+bool ShardedCuckooTable::insert(const std::string& key, const SecretEntry& entry, bool overwrite) {
+  return getShard(key)->insert(key, entry, overwrite);
 }
 
 std::optional<SecretEntry> ShardedCuckooTable::lookup(const std::string& key) const {
   return getShard(key)->lookup(key);
 }
 
+std::shared_ptr<const std::string> ShardedCuckooTable::lookupShared(const std::string& key) const {
+  return getShard(key)->lookupShared(key);
+}
+
 bool ShardedCuckooTable::remove(const std::string& key) { return getShard(key)->remove(key); }
 
+size_t ShardedCuckooTable::removePrefix(const std::string& prefix) {
+  size_t removed = 0;
+  for (auto& shard : shards_) {
+    removed += shard->removePrefix(prefix);
+  }
+  return removed;
+}
+
 std::vector<SecretEntry> ShardedCuckooTable::getAllEntries() const {
   std::vector<SecretEntry> all;
 
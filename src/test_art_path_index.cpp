@@ -0,0 +1,299 @@
+#include <gtest/gtest.h>
+
+#include "kallisto/art_path_index.hpp"
+#include "kallisto/btree_index.hpp"
+#include "kallisto/tls_btree_manager.hpp"
+
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// =============================================================================
+// ART PATH INDEX TEST SUITE
+//
+// Problem Description:
+//   ArtPathIndex is the radix-tree alternative to BTreeIndex behind the same
+//   IPathIndex contract. Its nodes change type (4/16/48/256) as fan-out moves
+//   and its prefixes are split and re-merged on every update, all through
+//   path copying. A slip in any of those leaves paths unreachable or visible
+//   in snapshots that should never have seen them.
+//
+// Coverage:
+//   1. Insert/validate/remove basics and duplicate handling
+//   2. Paths that are prefixes of other paths (terminal inner nodes)
+//   3. Node growth and shrink across all four inner node types
+//   4. Ordered prefix iteration (matches BTreeIndex and std::set)
+//   5. Structural sharing: clones stay isolated from later writes
+//   6. Bottom-up bulk load matches incremental inserts
+//   7. TlsBTreeManager RCU with the ART backend
+// =============================================================================
+
+namespace {
+
+std::vector<std::string> collectPrefix(const kallisto::IPathIndex& index, std::string_view prefix) {
+    std::vector<std::string> paths;
+    index.iteratePrefix(prefix, [&](const std::string& path) { paths.push_back(path); });
+    return paths;
+}
+
+} // namespace
+
+class ArtPathIndexTest : public ::testing::Test {
+protected:
+    kallisto::ArtPathIndex art;
+};
+
+TEST_F(ArtPathIndexTest, BasicInsertionAndValidation) {
+    EXPECT_TRUE(art.insertPath("/api/v1/users"));
+    EXPECT_TRUE(art.insertPath("/api/v1/auth"));
+
+    EXPECT_TRUE(art.validatePath("/api/v1/users"));
+    EXPECT_TRUE(art.validatePath("/api/v1/auth"));
+    EXPECT_FALSE(art.validatePath("/api/v1/settings"));
+    EXPECT_FALSE(art.validatePath("/api/v1/"));
+    EXPECT_EQ(art.size(), 2u);
+}
+
+TEST_F(ArtPathIndexTest, DuplicateInsertionIsIdempotent) {
+    EXPECT_TRUE(art.insertPath("/dup"));
+    EXPECT_TRUE(art.insertPath("/dup"));
+    EXPECT_EQ(art.size(), 1u);
+}
+
+TEST_F(ArtPathIndexTest, EmptyTreeAndEmptyPath) {
+    EXPECT_FALSE(art.validatePath(""));
+    EXPECT_FALSE(art.removePath("/anything"));
+
+    EXPECT_TRUE(art.insertPath(""));
+    EXPECT_TRUE(art.validatePath(""));
+    EXPECT_FALSE(art.validatePath("/a"));
+}
+
+TEST_F(ArtPathIndexTest, PathThatIsPrefixOfAnotherPath) {
+    // Problem: "/a" ends inside the compressed prefix of "/a/b/c". The split
+    // must mark the new inner node terminal instead of dropping either path.
+    art.insertPath("/a/b/c");
+    art.insertPath("/a");
+    art.insertPath("/a/b");
+
+    EXPECT_TRUE(art.validatePath("/a"));
+    EXPECT_TRUE(art.validatePath("/a/b"));
+    EXPECT_TRUE(art.validatePath("/a/b/c"));
+    EXPECT_FALSE(art.validatePath("/a/"));
+
+    // Removing the middle path must keep both neighbours reachable
+    EXPECT_TRUE(art.removePath("/a/b"));
+    EXPECT_TRUE(art.validatePath("/a"));
+    EXPECT_TRUE(art.validatePath("/a/b/c"));
+    EXPECT_FALSE(art.validatePath("/a/b"));
+}
+
+TEST_F(ArtPathIndexTest, GrowsAndShrinksThroughEveryNodeType) {
+    // Problem: 256 children push one node through Node4 -> 16 -> 48 -> 256,
+    // including the 0x00 and 0xFF bytes; removal walks it back down.
+    for (int byte = 0; byte < 256; ++byte) {
+        art.insertPath(std::string("k/") + static_cast<char>(byte));
+    }
+    for (int byte = 0; byte < 256; ++byte) {
+        ASSERT_TRUE(art.validatePath(std::string("k/") + static_cast<char>(byte))) << byte;
+    }
+
+    for (int byte = 0; byte < 256; byte += 2) {
+        ASSERT_TRUE(art.removePath(std::string("k/") + static_cast<char>(byte)));
+    }
+    for (int byte = 0; byte < 256; ++byte) {
+        ASSERT_EQ(art.validatePath(std::string("k/") + static_cast<char>(byte)), byte % 2 == 1) << byte;
+    }
+
+    for (int byte = 1; byte < 255; byte += 2) {
+        ASSERT_TRUE(art.removePath(std::string("k/") + static_cast<char>(byte)));
+    }
+    EXPECT_TRUE(art.validatePath("k/\xFF"));
+    EXPECT_EQ(art.size(), 1u);
+}
+
+TEST_F(ArtPathIndexTest, PrefixIterationIsOrderedAndBounded) {
+    for (const char* path : {"prod/db/password", "prod/db/user", "prod/cache", "prod", "prods/x",
+                             "staging/db/password", "prod/db/\xFFhigh"}) {
+        art.insertPath(path);
+    }
+
+    std::vector<std::string> expected = {"prod/db/password", "prod/db/user", "prod/db/\xFFhigh"};
+    EXPECT_EQ(collectPrefix(art, "prod/db/"), expected);
+
+    expected = {"prod", "prod/cache", "prod/db/password", "prod/db/user", "prod/db/\xFFhigh", "prods/x"};
+    EXPECT_EQ(collectPrefix(art, "prod"), expected);
+
+    // Prefix ending in the middle of a compressed segment
+    expected = {"staging/db/password"};
+    EXPECT_EQ(collectPrefix(art, "sta"), expected);
+
+    EXPECT_TRUE(collectPrefix(art, "prod/dc").empty());
+    EXPECT_TRUE(collectPrefix(art, "zzz").empty());
+    EXPECT_EQ(collectPrefix(art, "").size(), art.size());
+}
+
+TEST_F(ArtPathIndexTest, CloneIsIsolatedFromLaterWrites) {
+    // Problem: Clones share nodes with the original. A write that mutated a
+    // shared node in place would leak into a published RCU snapshot.
+    for (int i = 0; i < 100; ++i) {
+        art.insertPath("/shared/" + std::to_string(i));
+    }
+    auto snapshot = art.clone();
+
+    art.insertPath("/shared/new");
+    art.removePath("/shared/7");
+    art.insertPath("/shared");
+
+    EXPECT_FALSE(snapshot->validatePath("/shared/new"));
+    EXPECT_TRUE(snapshot->validatePath("/shared/7"));
+    EXPECT_FALSE(snapshot->validatePath("/shared"));
+
+    EXPECT_TRUE(art.validatePath("/shared/new"));
+    EXPECT_FALSE(art.validatePath("/shared/7"));
+    EXPECT_TRUE(art.validatePath("/shared"));
+}
+
+TEST_F(ArtPathIndexTest, BulkLoadMatchesIncrementalInserts) {
+    // Problem: Bulk load derives prefixes, terminal flags and node types from
+    // the sorted runs alone; any slip shows up as a path that insert finds
+    // but the bulk-built tree does not (or vice versa).
+    std::set<std::string> reference = {"", "/a", "/a/b", "/a/b/c", "/a/bc", "/b", std::string("k/\0", 3), "k/\xFF"};
+    for (int byte = 0; byte < 256; byte += 3) {
+        reference.insert(std::string("fan/") + static_cast<char>(byte) + "/leaf");
+    }
+
+    art.insertPath("stale"); // Replaced, not merged
+    std::vector<std::string> sorted_paths(reference.begin(), reference.end());
+    sorted_paths.push_back(sorted_paths.back()); // Duplicates are dropped
+    art.bulkLoad(sorted_paths);
+
+    EXPECT_EQ(art.size(), reference.size());
+    EXPECT_FALSE(art.validatePath("stale"));
+    EXPECT_FALSE(art.validatePath("/a/"));
+    EXPECT_EQ(collectPrefix(art, ""), std::vector<std::string>(reference.begin(), reference.end()));
+
+    // Updates on top of a bulk-built tree keep working
+    EXPECT_TRUE(art.removePath("/a/b"));
+    EXPECT_TRUE(art.validatePath("/a/b/c"));
+    art.insertPath("/a/b/d");
+    EXPECT_TRUE(art.validatePath("/a/b/d"));
+
+    art.bulkLoad({});
+    EXPECT_EQ(art.size(), 0u);
+    EXPECT_FALSE(art.validatePath(""));
+}
+
+TEST(ArtPathIndexFuzzTest, RandomizedChurnMatchesBTreeAndReferenceSet) {
+    // Problem: Random insert/remove churn over overlapping hierarchical paths
+    // exercises every split/merge/type change; both backends and std::set must
+    // agree on membership and on prefix listings.
+    kallisto::ArtPathIndex art;
+    kallisto::BTreeIndex btree(3);
+    std::set<std::string> reference;
+    std::mt19937 rng(2024);
+
+    auto randomPath = [&]() {
+        std::string path = "env" + std::to_string(rng() % 3);
+        for (unsigned depth = rng() % 4; depth > 0; --depth) {
+            path += "/" + std::to_string(rng() % 20);
+        }
+        return path;
+    };
+
+    for (int op = 0; op < 20000; ++op) {
+        std::string path = randomPath();
+        if (rng() % 3 == 0) {
+            bool expected = reference.erase(path) == 1;
+            ASSERT_EQ(art.removePath(path), expected) << path;
+            btree.removePath(path);
+        } else {
+            art.insertPath(path);
+            btree.insertPath(path);
+            reference.insert(path);
+        }
+    }
+
+    ASSERT_EQ(art.size(), reference.size());
+    for (const auto& path : reference) {
+        ASSERT_TRUE(art.validatePath(path)) << path;
+    }
+
+    for (const char* prefix : {"", "env1", "env1/1", "env2/13/", "env0/5/5"}) {
+        std::vector<std::string> expected;
+        for (auto it = reference.lower_bound(prefix); it != reference.end() && it->starts_with(prefix); ++it) {
+            expected.push_back(*it);
+        }
+        EXPECT_EQ(collectPrefix(art, prefix), expected) << prefix;
+        EXPECT_EQ(collectPrefix(btree, prefix), expected) << prefix;
+    }
+}
+
+// =============================================================================
+// TLS BTREE MANAGER WITH ART BACKEND
+//
+// Problem Description:
+//   The manager publishes ART snapshots that share structure with the
+//   previous master. Readers must keep a consistent view while the writer
+//   path-copies new versions.
+// =============================================================================
+
+class TlsArtManagerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        manager_ = std::make_unique<kallisto::TlsBTreeManager>(3, kallisto::PathIndexType::ART);
+    }
+
+    void TearDown() override {
+        manager_->drainGarbage();
+    }
+
+    std::unique_ptr<kallisto::TlsBTreeManager> manager_;
+};
+
+TEST_F(TlsArtManagerTest, SnapshotsFollowRcuSemantics) {
+    EXPECT_TRUE(manager_->insertPathIfAbsent("/art/a"));
+    EXPECT_FALSE(manager_->insertPathIfAbsent("/art/a"));
+    auto old_snapshot = manager_->getLocalSnapshot();
+
+    EXPECT_TRUE(manager_->insertPathIfAbsent("/art/b"));
+    EXPECT_TRUE(manager_->removePathIfPresent("/art/a"));
+
+    auto new_snapshot = manager_->getLocalSnapshot();
+    EXPECT_TRUE(old_snapshot->validatePath("/art/a"));
+    EXPECT_FALSE(old_snapshot->validatePath("/art/b"));
+    EXPECT_FALSE(new_snapshot->validatePath("/art/a"));
+    EXPECT_TRUE(new_snapshot->validatePath("/art/b"));
+}
+
+TEST_F(TlsArtManagerTest, ConcurrentReadersAndWriter) {
+    // Problem: Readers walking a snapshot while the writer path-copies and
+    // the GC drops replaced nodes must never see a freed node.
+    constexpr int num_iterations = 1000;
+
+    auto writer_thread = std::thread([this]() {
+        for (int i = 0; i < num_iterations; ++i) {
+            manager_->insertPathIfAbsent("/thread/safe/" + std::to_string(i));
+            if (i % 4 == 0) {
+                manager_->removePathIfPresent("/thread/safe/" + std::to_string(i / 2));
+            }
+        }
+    });
+
+    auto reader_thread = std::thread([this]() {
+        for (int i = 0; i < num_iterations; ++i) {
+            auto snapshot = manager_->getLocalSnapshot();
+            snapshot->validatePath("/thread/safe/" + std::to_string(i));
+            snapshot->iteratePrefix("/thread/safe/9", [](const std::string&) {});
+        }
+    });
+
+    writer_thread.join();
+    reader_thread.join();
+
+    manager_->insertPathIfAbsent("/dummy/force/sync");
+    auto final_snapshot = manager_->getLocalSnapshot();
+    EXPECT_TRUE(final_snapshot->validatePath("/thread/safe/999"));
+}
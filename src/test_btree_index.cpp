@@ -1,10 +1,18 @@
 #include <gtest/gtest.h>
 
 #include "kallisto/btree_index.hpp"
+#include "kallisto/event/worker.hpp"
+#include "kallisto/thread_local/thread_local.hpp"
 #include "kallisto/tls_btree_manager.hpp"
 
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <random>
+#include <set>
 #include <string>
 #include <thread>
+#include <vector>
 
 // =============================================================================
 // BTREE INDEX TEST SUITE
@@ -20,6 +28,10 @@
 //   3. High-volume splitting (100+ paths force root splits)
 //   4. Boundary values (empty string, very long paths)
 //   5. Deep copy correctness (RCU depends on this)
+//   6. Removal with borrow/merge rebalancing and root shrinking
+//   7. Prefix-compressed key blocks (shared prefixes, prefix-of-key, high bytes)
+//   8. Ordered prefix iteration across leaves
+//   9. Bottom-up bulk load keeps the occupancy invariants updates rely on
 // =============================================================================
 
 class BTreeIndexTest : public ::testing::Test {
@@ -90,14 +102,242 @@ TEST_F(BTreeIndexTest, DeepCopyDoesNotShareNodes) {
     EXPECT_FALSE(clone.validatePath("/original/only"));
 }
 
+TEST_F(BTreeIndexTest, RemoveExistingPath) {
+    btree.insertPath("/api/v1/users");
+    btree.insertPath("/api/v1/auth");
+
+    EXPECT_TRUE(btree.removePath("/api/v1/users"));
+    EXPECT_FALSE(btree.validatePath("/api/v1/users"));
+    EXPECT_TRUE(btree.validatePath("/api/v1/auth"));
+}
+
+TEST_F(BTreeIndexTest, RemoveMissingPathReturnsFalse) {
+    EXPECT_FALSE(btree.removePath("/never/inserted"));
+
+    btree.insertPath("/present");
+    EXPECT_FALSE(btree.removePath("/absent"));
+    EXPECT_TRUE(btree.validatePath("/present"));
+}
+
+TEST_F(BTreeIndexTest, RemoveTwiceIsIdempotent) {
+    btree.insertPath("/once");
+    EXPECT_TRUE(btree.removePath("/once"));
+    EXPECT_FALSE(btree.removePath("/once"));
+}
+
+TEST_F(BTreeIndexTest, RemoveInternalKeysForcesMergesAndBorrows) {
+    // Problem: Deleting half of a multi-level tree in random order exercises
+    // predecessor/successor replacement, sibling borrows and merges on every level.
+    constexpr int path_count = 1000;
+    std::vector<int> removal_order;
+    for (int i = 0; i < path_count; ++i) {
+        btree.insertPath("/churn/" + std::to_string(i));
+        if (i % 2 == 0) {
+            removal_order.push_back(i);
+        }
+    }
+
+    std::mt19937 rng(42);
+    std::shuffle(removal_order.begin(), removal_order.end(), rng);
+    for (int i : removal_order) {
+        ASSERT_TRUE(btree.removePath("/churn/" + std::to_string(i)));
+    }
+
+    for (int i = 0; i < path_count; ++i) {
+        EXPECT_EQ(btree.validatePath("/churn/" + std::to_string(i)), i % 2 != 0) << "path " << i;
+    }
+}
+
+TEST_F(BTreeIndexTest, RemoveAllThenReinsert) {
+    // Problem: Draining the tree must collapse it back to an empty root leaf
+    // that still accepts inserts (root shrinking path).
+    for (int i = 0; i < 300; ++i) {
+        btree.insertPath("/drain/" + std::to_string(i));
+    }
+    for (int i = 299; i >= 0; --i) {
+        ASSERT_TRUE(btree.removePath("/drain/" + std::to_string(i)));
+    }
+    for (int i = 0; i < 300; ++i) {
+        EXPECT_FALSE(btree.validatePath("/drain/" + std::to_string(i)));
+    }
+
+    EXPECT_TRUE(btree.insertPath("/drain/again"));
+    EXPECT_TRUE(btree.validatePath("/drain/again"));
+}
+
+TEST_F(BTreeIndexTest, RemoveEmptyStringPath) {
+    btree.insertPath("");
+    btree.insertPath("/a");
+    EXPECT_TRUE(btree.removePath(""));
+    EXPECT_FALSE(btree.validatePath(""));
+    EXPECT_TRUE(btree.validatePath("/a"));
+}
+
+TEST_F(BTreeIndexTest, RemoveFromCloneDoesNotAffectOriginal) {
+    for (int i = 0; i < 50; ++i) {
+        btree.insertPath("/rcu/" + std::to_string(i));
+    }
+
+    kallisto::BTreeIndex clone(btree);
+    for (int i = 0; i < 50; ++i) {
+        clone.removePath("/rcu/" + std::to_string(i));
+    }
+
+    for (int i = 0; i < 50; ++i) {
+        EXPECT_TRUE(btree.validatePath("/rcu/" + std::to_string(i)));
+        EXPECT_FALSE(clone.validatePath("/rcu/" + std::to_string(i)));
+    }
+}
+
+TEST_F(BTreeIndexTest, SharedPrefixPathsAreDistinguished) {
+    // Problem: Every key in a node shares "prod/payments/", so the search runs
+    // entirely on suffix heads; keys that differ only past byte 8 of the suffix
+    // must fall back to the full comparison.
+    for (int i = 0; i < 200; ++i) {
+        btree.insertPath("prod/payments/checkout-api/db/password-" + std::to_string(i));
+    }
+    for (int i = 0; i < 200; ++i) {
+        EXPECT_TRUE(btree.validatePath("prod/payments/checkout-api/db/password-" + std::to_string(i)));
+    }
+    EXPECT_FALSE(btree.validatePath("prod/payments/checkout-api/db/password-"));
+    EXPECT_FALSE(btree.validatePath("prod/payments/checkout-api/db/password-200"));
+    EXPECT_FALSE(btree.validatePath("prod/payments/"));
+    EXPECT_FALSE(btree.validatePath("prod/payments/checkout-api/db/password-1999"));
+}
+
+TEST_F(BTreeIndexTest, KeyThatIsPrefixOfAnotherKey) {
+    // Problem: Zero-padded heads make "a" and "a\0" tie; both must still be exact.
+    const std::string with_nul("prod/a\0", 7);
+    btree.insertPath("prod/a");
+    btree.insertPath("prod/ab");
+    btree.insertPath(with_nul);
+
+    EXPECT_TRUE(btree.validatePath("prod/a"));
+    EXPECT_TRUE(btree.validatePath("prod/ab"));
+    EXPECT_TRUE(btree.validatePath(with_nul));
+    EXPECT_FALSE(btree.validatePath("prod/"));
+    EXPECT_FALSE(btree.validatePath("prod/abc"));
+
+    EXPECT_TRUE(btree.removePath("prod/a"));
+    EXPECT_TRUE(btree.validatePath(with_nul));
+    EXPECT_TRUE(btree.validatePath("prod/ab"));
+}
+
+TEST_F(BTreeIndexTest, HighBitBytesKeepUnsignedOrdering) {
+    // Problem: UTF-8 paths contain bytes >= 0x80; heads must order them after ASCII.
+    for (int i = 0; i < 60; ++i) {
+        btree.insertPath("k/\xC3\xA9t\xC3\xA9/" + std::to_string(i));
+        btree.insertPath("k/ete/" + std::to_string(i));
+    }
+    for (int i = 0; i < 60; ++i) {
+        EXPECT_TRUE(btree.validatePath("k/\xC3\xA9t\xC3\xA9/" + std::to_string(i)));
+        EXPECT_TRUE(btree.validatePath("k/ete/" + std::to_string(i)));
+    }
+    EXPECT_FALSE(btree.validatePath("k/\xFF"));
+}
+
+TEST_F(BTreeIndexTest, ProbeOutsideNodePrefixRange) {
+    // Problem: Probes sorting before/after a node's shared prefix must be
+    // rejected by the single prefix comparison, not by reading heads.
+    for (int i = 0; i < 40; ++i) {
+        btree.insertPath("mmm/" + std::to_string(i));
+    }
+    EXPECT_FALSE(btree.validatePath("aaa"));
+    EXPECT_FALSE(btree.validatePath("zzz"));
+    EXPECT_FALSE(btree.validatePath("mm"));
+    EXPECT_FALSE(btree.validatePath(""));
+}
+
+TEST_F(BTreeIndexTest, PrefixIterationSpansLeavesInOrder) {
+    // Problem: A prefix range usually straddles several leaves. The walk must
+    // start at the first candidate leaf and stop right after the range.
+    for (int i = 0; i < 200; ++i) {
+        btree.insertPath("svc/" + std::to_string(i));
+        btree.insertPath("svd/" + std::to_string(i));
+    }
+
+    std::vector<std::string> visited;
+    btree.iteratePrefix("svc/1", [&](const std::string& path) { visited.push_back(path); });
+
+    std::vector<std::string> expected;
+    for (int i = 0; i < 200; ++i) {
+        std::string path = "svc/" + std::to_string(i);
+        if (path.starts_with("svc/1")) {
+            expected.push_back(path);
+        }
+    }
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(visited, expected);
+}
+
+TEST(BTreeIndexBulkLoadTest, BulkLoadedTreeSupportsLookupsAndUpdates) {
+    // Problem: Bulk load builds leaves and separators directly. Uneven runs
+    // would leave nodes below t-1 keys and break later borrow/merge steps.
+    for (int degree : {2, 3, 16}) {
+        for (size_t count : {0u, 1u, 3u, 4u, 31u, 32u, 33u, 1000u}) {
+            std::vector<std::string> sorted_paths;
+            for (size_t i = 0; i < count; ++i) {
+                sorted_paths.push_back("bulk/" + std::to_string(i));
+            }
+            std::sort(sorted_paths.begin(), sorted_paths.end());
+            if (count > 0) {
+                sorted_paths.push_back(sorted_paths.back()); // Duplicates are dropped
+            }
+            std::set<std::string> reference(sorted_paths.begin(), sorted_paths.end());
+
+            kallisto::BTreeIndex index(degree);
+            index.insertPath("stale/path"); // Replaced, not merged
+            index.bulkLoad(sorted_paths);
+            EXPECT_FALSE(index.validatePath("stale/path"));
+
+            std::vector<std::string> visited;
+            index.iteratePrefix("", [&](const std::string& path) { visited.push_back(path); });
+            ASSERT_EQ(visited, std::vector<std::string>(reference.begin(), reference.end()))
+                << "degree " << degree << " count " << count;
+
+            // Every path must stay removable and the tree usable afterwards
+            index.insertPath("bulk/extra");
+            for (const auto& path : reference) {
+                ASSERT_TRUE(index.removePath(path)) << path;
+            }
+            EXPECT_TRUE(index.validatePath("bulk/extra"));
+        }
+    }
+}
+
+TEST(BTreeIndexFuzzTest, RandomizedChurnMatchesReferenceSet) {
+    // Problem: Interleaved inserts/removes over a small key space hit every
+    // split/borrow/merge combination; the index must agree with std::set.
+    for (int degree : {2, 3, 16}) {
+        kallisto::BTreeIndex index(degree);
+        std::set<std::string> reference;
+        std::mt19937 rng(degree);
+
+        for (int op = 0; op < 20000; ++op) {
+            std::string path = "fuzz/" + std::to_string(rng() % 512) + "/k";
+            if (rng() % 3 == 0) {
+                EXPECT_EQ(index.removePath(path), reference.erase(path) == 1);
+            } else {
+                index.insertPath(path);
+                reference.insert(path);
+            }
+        }
+
+        for (int i = 0; i < 512; ++i) {
+            std::string path = "fuzz/" + std::to_string(i) + "/k";
+            ASSERT_EQ(index.validatePath(path), reference.count(path) == 1) << "degree " << degree;
+        }
+    }
+}
+
 // =============================================================================
 // TLS BTREE MANAGER TEST SUITE (RCU Concurrency)
 //
 // Problem Description:
-//   TlsBTreeManager implements Envoy-style RCU for lock-free reads.
-//   Each worker thread holds a thread-local snapshot. Writes create a
-//   new master copy and dispatch it to all workers. Old copies go to
-//   a GC queue for deferred deallocation.
+//   TlsBTreeManager implements RCU for lock-free reads. Readers load the
+//   published master under an epoch pin (no refcount). Writes create a
+//   new master copy, publish it and retire the old copy to the epoch
+//   domain for deferred deallocation.
 //
 // Coverage:
 //   1. Initial snapshot is valid
@@ -106,13 +346,13 @@ TEST_F(BTreeIndexTest, DeepCopyDoesNotShareNodes) {
 //   4. GC drains old snapshots without crashing
 //   5. Thread safety under concurrent read/write
 //   6. Boundary: multiple rapid updates
+//   7. removePathIfPresent publishes a pruned snapshot
 // =============================================================================
 
 class TlsBTreeManagerTest : public ::testing::Test {
 protected:
     void SetUp() override {
-        // nullptr for workers triggers synchronous fallback (no event loop needed)
-        manager_ = std::make_unique<kallisto::TlsBTreeManager>(3, nullptr);
+        manager_ = std::make_unique<kallisto::TlsBTreeManager>(3);
     }
 
     void TearDown() override {
@@ -124,7 +364,7 @@ protected:
 
 TEST_F(TlsBTreeManagerTest, InitialSnapshotIsValid) {
     auto snapshot = manager_->getLocalSnapshot();
-    EXPECT_NE(snapshot, nullptr);
+    EXPECT_NE(snapshot.get(), nullptr);
     EXPECT_FALSE(snapshot->validatePath("/missing/path"));
 }
 
@@ -148,6 +388,28 @@ TEST_F(TlsBTreeManagerTest, DuplicateInsertReturnsFalse) {
     EXPECT_FALSE(manager_->insertPathIfAbsent("/dup/path"));
 }
 
+TEST_F(TlsBTreeManagerTest, RemovePathPublishesPrunedSnapshot) {
+    ASSERT_TRUE(manager_->insertPathIfAbsent("/doomed/path"));
+    auto old_snapshot = manager_->getLocalSnapshot();
+
+    EXPECT_TRUE(manager_->removePathIfPresent("/doomed/path"));
+
+    auto new_snapshot = manager_->getLocalSnapshot();
+    EXPECT_FALSE(new_snapshot->validatePath("/doomed/path"));
+
+    // Readers holding the old snapshot keep seeing the path (RCU immutability)
+    EXPECT_TRUE(old_snapshot->validatePath("/doomed/path"));
+    EXPECT_NE(old_snapshot.get(), new_snapshot.get());
+}
+
+TEST_F(TlsBTreeManagerTest, RemoveMissingPathReturnsFalse) {
+    auto snapshot_before = manager_->getLocalSnapshot();
+    EXPECT_FALSE(manager_->removePathIfPresent("/not/indexed"));
+
+    // No-op removals must not publish a new snapshot
+    EXPECT_EQ(snapshot_before.get(), manager_->getLocalSnapshot().get());
+}
+
 TEST_F(TlsBTreeManagerTest, GarbageCollectionDrainsWithoutCrash) {
     manager_->insertPathIfAbsent("/gc/path/1");
     manager_->insertPathIfAbsent("/gc/path/2");
@@ -202,3 +464,133 @@ TEST_F(TlsBTreeManagerTest, ConcurrentReadersAndWriter) {
         EXPECT_TRUE(final_snapshot->validatePath("/thread/safe/" + std::to_string(i)));
     }
 }
+
+// =============================================================================
+// TLS BTREE MANAGER ON WORKER THREADS
+//
+// Problem Description:
+//   In the server every worker has its own Dispatcher and caches the master
+//   in a tls::Slot. A worker that missed a version bump would validate
+//   against a stale (possibly retired) index; one that reloads on every read
+//   defeats the cache.
+//
+// Coverage:
+//   1. Each worker loads the master once, then serves reads from its slot
+//   2. A publish is visible on every worker's next read
+//   3. Workers keep reading safely while the writer publishes and reclaims
+//   4. Unregistered threads fall back to the shared master
+// =============================================================================
+
+namespace kallisto {
+event::WorkerPoolPtr createWorkerPool(size_t num_workers);
+}
+
+class TlsBTreeManagerWorkerTest : public ::testing::Test {
+protected:
+    static constexpr size_t num_workers = 3;
+
+    void SetUp() override {
+        pool_ = kallisto::createWorkerPool(num_workers);
+        tls_ = kallisto::tls::createThreadLocalInstance();
+        pool_->start(nullptr);
+        runOnAllWorkers([this](kallisto::event::Dispatcher& dispatcher) {
+            tls_->registerThread(dispatcher, false);
+            return true;
+        });
+
+        manager_ = std::make_unique<kallisto::TlsBTreeManager>(3);
+        manager_->attachWorkers(*pool_, *tls_);
+    }
+
+    void TearDown() override {
+        pool_->stop(); // No posted read may outlive the manager
+        manager_.reset();
+    }
+
+    // Runs fn on every worker's event loop and waits for all results
+    std::vector<bool> runOnAllWorkers(const std::function<bool(kallisto::event::Dispatcher&)>& fn) {
+        std::vector<std::future<bool>> results;
+        for (size_t i = 0; i < pool_->size(); ++i) {
+            auto& dispatcher = pool_->getWorker(i).dispatcher();
+            auto done = std::make_shared<std::promise<bool>>();
+            results.push_back(done->get_future());
+            dispatcher.post([fn, done, &dispatcher]() { done->set_value(fn(dispatcher)); });
+        }
+        std::vector<bool> values;
+        for (auto& result : results) {
+            values.push_back(result.get());
+        }
+        return values;
+    }
+
+    std::vector<bool> validateOnAllWorkers(const std::string& path) {
+        return runOnAllWorkers([this, path](kallisto::event::Dispatcher&) {
+            return manager_->getLocalSnapshot()->validatePath(path);
+        });
+    }
+
+    kallisto::event::WorkerPoolPtr pool_;
+    kallisto::tls::InstancePtr tls_;
+    std::unique_ptr<kallisto::TlsBTreeManager> manager_;
+};
+
+TEST_F(TlsBTreeManagerWorkerTest, WorkersReloadOnlyWhenVersionMoves) {
+    // Problem: Steady-state reads must be served from the worker's slot;
+    // only a publish may send a worker back to the shared master.
+    const std::vector<bool> none(num_workers, false);
+    const std::vector<bool> all(num_workers, true);
+
+    EXPECT_EQ(validateOnAllWorkers("/svc/a"), none);
+    EXPECT_EQ(manager_->localViewRefreshes(), num_workers); // Warm-up load per worker
+
+    for (int i = 0; i < 10; ++i) {
+        validateOnAllWorkers("/svc/a");
+    }
+    EXPECT_EQ(manager_->localViewRefreshes(), num_workers);
+
+    ASSERT_TRUE(manager_->insertPathIfAbsent("/svc/a"));
+    EXPECT_EQ(validateOnAllWorkers("/svc/a"), all);
+    EXPECT_EQ(manager_->localViewRefreshes(), 2 * num_workers);
+
+    ASSERT_TRUE(manager_->removePathIfPresent("/svc/a"));
+    EXPECT_EQ(validateOnAllWorkers("/svc/a"), none);
+    EXPECT_EQ(manager_->localViewRefreshes(), 3 * num_workers);
+}
+
+TEST_F(TlsBTreeManagerWorkerTest, WorkersReadWhileWriterPublishes) {
+    // Problem: Workers validate in a loop while the writer publishes and
+    // reclaims; a cached pointer must never outlive its grace period.
+    constexpr int num_paths = 300;
+    std::atomic<bool> writing{true};
+
+    auto readers_done = std::async(std::launch::async, [&]() {
+        while (writing.load()) {
+            runOnAllWorkers([&](kallisto::event::Dispatcher&) {
+                auto snapshot = manager_->getLocalSnapshot();
+                for (int i = 0; i < num_paths; i += 7) {
+                    snapshot->validatePath("/load/" + std::to_string(i));
+                }
+                return true;
+            });
+        }
+    });
+
+    for (int i = 0; i < num_paths; ++i) {
+        manager_->insertPathIfAbsent("/load/" + std::to_string(i));
+    }
+    writing.store(false);
+    readers_done.get();
+
+    for (int i = 0; i < num_paths; i += 37) {
+        EXPECT_EQ(validateOnAllWorkers("/load/" + std::to_string(i)), std::vector<bool>(num_workers, true));
+    }
+}
+
+TEST_F(TlsBTreeManagerWorkerTest, UnregisteredThreadUsesSharedMaster) {
+    manager_->insertPathIfAbsent("/main/thread");
+    uint64_t refreshes = manager_->localViewRefreshes();
+
+    auto snapshot = manager_->getLocalSnapshot();
+    EXPECT_TRUE(snapshot->validatePath("/main/thread"));
+    EXPECT_EQ(manager_->localViewRefreshes(), refreshes);
+}
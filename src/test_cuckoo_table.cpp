@@ -2,6 +2,7 @@
 
 #include "kallisto/cuckoo_table.hpp"
 
+#include <memory>
 #include <string>
 #include <thread>
 #include <vector>
@@ -24,6 +25,7 @@ using namespace kallisto;
 //   5. Concurrency safety (multi-threaded readers + writers)
 //   6. Fuzz-like stress testing with high load factors
 //   7. Free list recycling after remove + re-insert
+//   8. Shared values: no-overwrite inserts, prefix removal, buffer release
 // =============================================================================
 
 class CuckooTableTest : public ::testing::Test {
@@ -383,3 +385,60 @@ TEST_F(CuckooTableTest, DoubleInsertUpdatesInPlace) {
     }
     EXPECT_EQ(count, 1) << "Duplicate insert must update, not create a second entry";
 }
+
+// ---------------------------------------------------------------------------
+// 9. Shared Values (engine payload cache)
+// ---------------------------------------------------------------------------
+
+TEST_F(CuckooTableTest, SharedValueIsReturnedWithoutCopy) {
+    SecretEntry entry;
+    entry.shared_value = std::make_shared<const std::string>("payload");
+    ASSERT_TRUE(table_->insert("v1", entry));
+
+    auto shared = table_->lookupShared("v1");
+    EXPECT_EQ(shared, entry.shared_value) << "The cached buffer itself, not a copy";
+    EXPECT_EQ(table_->lookupShared("v2"), nullptr);
+}
+
+TEST_F(CuckooTableTest, InsertWithoutOverwriteKeepsExistingEntry) {
+    // Problem: a reader filling in a payload must not replace the buffer a writer cached
+    SecretEntry first;
+    first.shared_value = std::make_shared<const std::string>("first");
+    SecretEntry second;
+    second.shared_value = std::make_shared<const std::string>("second");
+
+    EXPECT_TRUE(table_->insert("v1", first));
+    EXPECT_TRUE(table_->insert("v1", second, false));
+    EXPECT_EQ(table_->lookupShared("v1"), first.shared_value);
+    EXPECT_TRUE(table_->insert("v1", second));
+    EXPECT_EQ(table_->lookupShared("v1"), second.shared_value);
+}
+
+TEST_F(CuckooTableTest, RemovePrefixRemovesOnlyMatchingKeys) {
+    for (int i = 0; i < 50; ++i) {
+        table_->insert("apps/a/" + std::to_string(i), makeEntry("", "v"));
+        table_->insert("apps/b/" + std::to_string(i), makeEntry("", "v"));
+    }
+    EXPECT_EQ(table_->removePrefix("apps/a/"), 50u);
+    EXPECT_EQ(table_->removePrefix("apps/a/"), 0u);
+    for (int i = 0; i < 50; ++i) {
+        EXPECT_FALSE(table_->lookup("apps/a/" + std::to_string(i)).has_value()) << i;
+        EXPECT_TRUE(table_->lookup("apps/b/" + std::to_string(i)).has_value()) << i;
+    }
+}
+
+TEST_F(CuckooTableTest, RemovedEntriesReleaseSharedValue) {
+    // Problem: removed storage is only reused later; it must not pin the buffer
+    auto buffer = std::make_shared<const std::string>("payload");
+    SecretEntry entry;
+    entry.shared_value = buffer;
+    table_->insert("v1", entry);
+    table_->insert("v2", entry);
+    entry.shared_value.reset();
+    EXPECT_EQ(buffer.use_count(), 3);
+
+    table_->remove("v1");
+    EXPECT_EQ(buffer.use_count(), 2);
+    table_->removePrefix("v");
+    EXPECT_EQ(buffer.use_count(), 1);
+}
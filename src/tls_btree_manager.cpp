@@ -1,85 +1,160 @@
 #include "kallisto/tls_btree_manager.hpp"
+#include "kallisto/event/worker.hpp"
 #include "kallisto/logger.hpp"
 
 namespace kallisto {
 
-thread_local std::shared_ptr<const BTreeIndex> TlsBTreeManager::tls_btree = nullptr;
-std::mutex TlsBTreeManager::gc_mutex;
-std::vector<std::shared_ptr<const BTreeIndex>> TlsBTreeManager::gc_queue;
+TlsBTreeManager::TlsBTreeManager(int degree, PathIndexType index_type)
+    : degree_(degree), index_type_(index_type) {
+    master_index_.store(createIndex().release());
+    if (index_type == PathIndexType::ART) {
+        LOG_INFO("[TLS_BTREE] Manager initialized with ART backend");
+    } else {
+        LOG_INFO("[TLS_BTREE] Manager initialized with degree=" + std::to_string(degree));
+    }
+}
 
-TlsBTreeManager::TlsBTreeManager(int degree, event::WorkerPool* worker_pool)
-    : worker_pool_(worker_pool) {
-    master_btree_ = std::make_shared<const BTreeIndex>(degree);
-    tls_btree = master_btree_;
-    LOG_INFO("[TLS_BTREE] Manager initialized with degree=" + std::to_string(degree));
+TlsBTreeManager::~TlsBTreeManager() {
+    // Readers on other threads may still be inside a read-side section
+    rcu::EpochDomain::global().retireObject(master_index_.exchange(nullptr));
+    drainGarbage();
 }
 
-std::shared_ptr<const BTreeIndex> TlsBTreeManager::getLocalSnapshot() const {
-    if (!tls_btree) {
-        std::lock_guard lock(const_cast<std::mutex&>(master_mutex_));
-        tls_btree = master_btree_;
-        LOG_DEBUG("[TLS_BTREE] Thread acquired master snapshot via fallback");
+void TlsBTreeManager::attachWorkers(event::WorkerPool& workers, tls::Instance& tls) {
+    local_view_slot_ = tls.allocateSlot();
+    local_view_slot_->set([](event::Dispatcher&) -> tls::ThreadLocalObjectPtr {
+        return std::make_shared<LocalIndexView>();
+    });
+
+    // Warm every view so the first request on a worker does not pay the reload
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers.getWorker(i).dispatcher().post([this]() { loadLocalView(); });
     }
-    return tls_btree;
+    LOG_INFO("[TLS_BTREE] Attached to " + std::to_string(workers.size()) + " workers");
 }
 
-bool TlsBTreeManager::insertPathIfAbsent(const std::string& path) {
-    auto new_master = createUpdatedMaster(path);
-    if (!new_master) {
-        LOG_DEBUG("[TLS_BTREE] Path already exists, skipping: " + path);
-        return false;
+PathIndexSnapshot TlsBTreeManager::getLocalSnapshot() const {
+    // Pin before loading: the pointer is only protected once the epoch is announced
+    rcu::EpochGuard guard = rcu::EpochDomain::global().pin();
+    const IPathIndex* index = loadLocalView();
+    if (!index) {
+        index = master_index_.load();
+    }
+    return PathIndexSnapshot(std::move(guard), index);
+}
+
+const IPathIndex* TlsBTreeManager::loadLocalView() const {
+    if (!local_view_slot_) {
+        return nullptr;
+    }
+    auto slot_object = local_view_slot_->get();
+    if (!slot_object) {
+        return nullptr; // Thread not registered, or slot not initialized on it yet
     }
 
-    LOG_INFO("[TLS_BTREE] New path inserted: " + path);
-    dispatchUpdate(new_master);
+    // The writer stores the master before bumping the version and retires the
+    // old one only after. An unchanged version therefore proves the cached
+    // pointer was not retired before this read-side section began.
+    auto& view = static_cast<LocalIndexView&>(*slot_object);
+    uint64_t version = master_version_.load();
+    if (view.version != version) {
+        view.index = master_index_.load();
+        view.version = version;
+        local_view_refreshes_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return view.index;
+}
+
+bool TlsBTreeManager::insertPathIfAbsent(std::string_view path) {
+    {
+        std::lock_guard lock(master_mutex_);
+        // Only writers retire the master, and they all hold master_mutex_
+        const IPathIndex* current = master_index_.load(std::memory_order_relaxed);
+        if (current->validatePath(path)) {
+            LOG_DEBUG("[TLS_BTREE] Path already exists, skipping: " + std::string(path));
+            return false;
+        }
+
+        auto updated_clone = current->clone();
+        updated_clone->insertPath(std::string(path));
+        publishMaster(std::move(updated_clone));
+    }
+
+    LOG_INFO("[TLS_BTREE] New path inserted: " + std::string(path));
     drainGarbage();
     return true;
 }
 
-std::shared_ptr<const BTreeIndex> TlsBTreeManager::createUpdatedMaster(const std::string& path) {
-    std::lock_guard lock(master_mutex_);
+bool TlsBTreeManager::removePathIfPresent(std::string_view path) {
+    {
+        std::lock_guard lock(master_mutex_);
+        const IPathIndex* current = master_index_.load(std::memory_order_relaxed);
+        if (!current->validatePath(path)) {
+            LOG_DEBUG("[TLS_BTREE] Path not indexed, skipping removal: " + std::string(path));
+            return false;
+        }
 
-    if (master_btree_->validatePath(path)) {
-        return nullptr;
+        auto pruned_clone = current->clone();
+        pruned_clone->removePath(std::string(path));
+        publishMaster(std::move(pruned_clone));
     }
 
-    auto updated_clone = std::make_shared<BTreeIndex>(*master_btree_);
-    updated_clone->insertPath(path);
-    master_btree_ = updated_clone;
-
-    return updated_clone;
+    LOG_INFO("[TLS_BTREE] Path removed: " + std::string(path));
+    drainGarbage();
+    return true;
 }
 
-void TlsBTreeManager::dispatchUpdate(const std::shared_ptr<const BTreeIndex>& new_master) const {
-    if (!worker_pool_) {
-        updateLocalSnapshot(new_master);
-        return;
+std::vector<std::string> TlsBTreeManager::removePrefix(std::string_view prefix) {
+    std::vector<std::string> removed;
+    {
+        std::lock_guard lock(master_mutex_);
+        const IPathIndex* current = master_index_.load(std::memory_order_relaxed);
+        current->iteratePrefix(prefix, [&](const std::string& path) { removed.push_back(path); });
+        if (removed.empty()) {
+            return removed;
+        }
+
+        auto pruned_clone = current->clone();
+        for (const auto& path : removed) {
+            pruned_clone->removePath(path);
+        }
+        publishMaster(std::move(pruned_clone));
     }
 
-    for (size_t i = 0; i < worker_pool_->size(); ++i) {
-        auto& worker = worker_pool_->getWorker(i);
-        worker.dispatcher().post([new_master]() {
-            updateLocalSnapshot(new_master);
-        });
+    LOG_INFO("[TLS_BTREE] Removed " + std::to_string(removed.size()) + " paths under prefix: " + std::string(prefix));
+    drainGarbage();
+    return removed;
+}
+
+void TlsBTreeManager::bulkLoad(std::vector<std::string> sorted_paths) {
+    const size_t path_count = sorted_paths.size();
+    auto loaded = createIndex();
+    loaded->bulkLoad(std::move(sorted_paths));
+    {
+        std::lock_guard lock(master_mutex_);
+        publishMaster(std::move(loaded));
     }
+
+    LOG_INFO("[TLS_BTREE] Bulk loaded " + std::to_string(path_count) + " paths");
+    drainGarbage();
 }
 
-void TlsBTreeManager::updateLocalSnapshot(std::shared_ptr<const BTreeIndex> new_master) {
-    if (tls_btree) {
-        std::lock_guard gc_lock(gc_mutex);
-        gc_queue.push_back(std::move(tls_btree));
+std::unique_ptr<IPathIndex> TlsBTreeManager::createIndex() const {
+    if (index_type_ == PathIndexType::ART) {
+        return std::make_unique<ArtPathIndex>();
     }
-    tls_btree = std::move(new_master);
+    return std::make_unique<BTreeIndex>(degree_);
+}
+
+void TlsBTreeManager::publishMaster(std::unique_ptr<IPathIndex> new_master) {
+    const IPathIndex* old_master = master_index_.exchange(new_master.release());
+    master_version_.fetch_add(1);
+    rcu::EpochDomain::global().retireObject(old_master);
 }
 
 void TlsBTreeManager::drainGarbage() {
-    std::vector<std::shared_ptr<const BTreeIndex>> to_delete;
-    {
-        std::lock_guard<std::mutex> lock(gc_mutex);
-        to_delete.swap(gc_queue);
-    }
     // Deallocation happens here on the writer thread, not the reader hot path
-    to_delete.clear();
+    rcu::EpochDomain::global().reclaim();
 }
 
 } // namespace kallisto